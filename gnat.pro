@@ -36,16 +36,30 @@ INCLUDEPATH += . \
 
 # Input
 HEADERS += gnat.h \
+           gui/CCompiledTree.h \
            gui/CEditStyleToolkit.h \
            gui/CGNATWindow.h \
+           gui/CLevelEvaluator.h \
            gui/CStyleToolkit.h \
+           gui/CTreeBounds.h \
+           gui/CTraceCache.h \
+           gui/CTraceRowIndex.h \
+           gui/CTraceRunner.h \
+           gui/CTraceTableModel.h \
+           gui/CTreeGeneratorBase.h \
+           gui/CTreeLayout.h \
            gui/IGNATView.h \
+           gui/ChanceTreeView/CChanceTreeEvaluator.h \
+           gui/ChanceTreeView/CChanceTreeGenerator.h \
            gui/ChanceTreeView/CChanceTreeGraph.h \
            gui/ChanceTreeView/CChanceTreeView.h \
+           gui/ChanceTreeView/CCompiledChanceTree.h \
            gui/ChanceTreeView/SChanceTreeTrace.h \
            gui/PuzzleView/CPuzzleGraph.h \
            gui/PuzzleView/CPuzzleTrace.h \
            gui/PuzzleView/CPuzzleView.h \
+           gui/TreeView/CTreeEvaluator.h \
+           gui/TreeView/CTreeGenerator.h \
            gui/TreeView/CTreeGraph.h \
            gui/TreeView/CTreeView.h \
            gui/TreeView/STreeTrace.h \
@@ -78,6 +92,7 @@ HEADERS += gnat.h \
            gui/TreeView/TraceView/CTreeTraceView.h \
            gui/ChanceTreeView/TraceView/TreeTracers/CChanceTreeTracerSelector.h \
            gui/ChanceTreeView/TraceView/TreeTracers/CExpectMTracer.h \
+           gui/ChanceTreeView/TraceView/TreeTracers/CExpectMCTSTracer.h \
            gui/PuzzleView/TraceView/PuzzleTracers/CBDTracer.h \
            gui/PuzzleView/TraceView/PuzzleTracers/CPuzzleTracerSelector.h \
            gui/PuzzleView/TraceView/PuzzleTracers/CSATraceNode.h \
@@ -85,18 +100,31 @@ HEADERS += gnat.h \
            gui/PuzzleView/TraceView/PuzzleTracers/IOpenList.h \
            gui/PuzzleView/TraceView/PuzzleTracers/IPuzzleTracer.h \
            gui/TreeView/TraceView/TreeTracers/CGeneralMTracer.h \
+           gui/TreeView/TraceView/TreeTracers/CParallelABTracer.h \
+           gui/TreeView/TraceView/TreeTracers/CMCTSTracer.h \
+           gui/TreeView/TraceView/TreeTracers/CPNTracer.h \
            gui/TreeView/TraceView/TreeTracers/CTreeTracerSelector.h
 SOURCES += gnat.cpp \
            gui/CEditStyleToolkit.cpp \
            gui/CGNATWindow.cpp \
+           gui/CLevelEvaluator.cpp \
            gui/CStyleToolkit.cpp \
+           gui/CTraceCache.cpp \
+           gui/CTraceRunner.cpp \
+           gui/CTraceTableModel.cpp \
+           gui/CTreeGeneratorBase.cpp \
            gui/IGNATView.cpp \
+           gui/ChanceTreeView/CChanceTreeEvaluator.cpp \
+           gui/ChanceTreeView/CChanceTreeGenerator.cpp \
            gui/ChanceTreeView/CChanceTreeGraph.cpp \
            gui/ChanceTreeView/CChanceTreeView.cpp \
+           gui/ChanceTreeView/CCompiledChanceTree.cpp \
            gui/ChanceTreeView/SChanceTreeTrace.cpp \
            gui/PuzzleView/CPuzzleGraph.cpp \
            gui/PuzzleView/CPuzzleTrace.cpp \
            gui/PuzzleView/CPuzzleView.cpp \
+           gui/TreeView/CTreeEvaluator.cpp \
+           gui/TreeView/CTreeGenerator.cpp \
            gui/TreeView/CTreeGraph.cpp \
            gui/TreeView/CTreeView.cpp \
            gui/TreeView/STreeTrace.cpp \
@@ -129,11 +157,15 @@ SOURCES += gnat.cpp \
            gui/TreeView/TraceView/CTreeTraceView.cpp \
            gui/ChanceTreeView/TraceView/TreeTracers/CChanceTreeTracerSelector.cpp \
            gui/ChanceTreeView/TraceView/TreeTracers/CExpectMTracer.cpp \
+           gui/ChanceTreeView/TraceView/TreeTracers/CExpectMCTSTracer.cpp \
            gui/PuzzleView/TraceView/PuzzleTracers/CBDTracer.cpp \
            gui/PuzzleView/TraceView/PuzzleTracers/CPuzzleTracerSelector.cpp \
            gui/PuzzleView/TraceView/PuzzleTracers/CUDTracer.cpp \
            gui/PuzzleView/TraceView/PuzzleTracers/IOpenList.cpp \
            gui/PuzzleView/TraceView/PuzzleTracers/IPuzzleTracer.cpp \
            gui/TreeView/TraceView/TreeTracers/CGeneralMTracer.cpp \
+           gui/TreeView/TraceView/TreeTracers/CParallelABTracer.cpp \
+           gui/TreeView/TraceView/TreeTracers/CMCTSTracer.cpp \
+           gui/TreeView/TraceView/TreeTracers/CPNTracer.cpp \
            gui/TreeView/TraceView/TreeTracers/CTreeTracerSelector.cpp
 RESOURCES += Resources/gnat.qrc
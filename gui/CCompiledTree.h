@@ -0,0 +1,427 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CCompiledTree.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the CCompiledTree template, a flat copy of
+///               a tree that the tracers search instead of the nodes
+///               themselves.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CCOMPILEDTREE_H_
+#define _CCOMPILEDTREE_H_
+
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree
+///
+/// @description  The parts of a tree a search reads, laid out in arrays.
+///               Nodes are numbered in preorder, the root being 0, and each
+///               array holds one thing about every node: its parent, value,
+///               quiescent flag and history value. The children of a node
+///               are a run of the children array given by its offset and
+///               count. Names, positions and everything else the search
+///               does not read stay with the nodes, which can be had back
+///               from their numbers.
+///
+///               Every node is also given a shape, a number it shares with
+///               exactly those nodes whose subtrees are the same as its own:
+///               the same values and quiescent flags laid out the same way.
+///               A search can keep one result for all the nodes of a shape
+///               instead of one for each node.
+///
+///               Node is the node struct of the tree. It must have
+///               s_childList, s_value, s_quiescent and s_history.
+///
+/// @limitations  The copy refers to the nodes it was made from and must not
+///               outlive them. It does not follow later edits of the tree.
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+class CCompiledTree
+{
+public:
+    void compile( const Node *root );
+    void clear();
+
+    int count() const;
+    int childCount( int node ) const;
+    int child( int node, int i ) const;
+    int parent( int node ) const;
+    float value( int node ) const;
+    bool isQuiescent( int node ) const;
+    int history( int node ) const;
+    int shape( int node ) const;
+    const Node *node( int index ) const;
+
+protected:
+    void compileNodes( const Node *root );
+    void findShapes( const QVector<qreal> &data, int stride );
+
+    struct SPending
+    {
+        const Node *s_node;
+        int         s_parent;
+        int         s_slot;
+    };
+
+    QVector<const Node *>   m_nodes;
+    QVector<int>            m_parents;
+    QVector<int>            m_childOffsets;
+    QVector<int>            m_childCounts;
+    QVector<int>            m_children;
+    QVector<float>          m_values;
+    QVector<bool>           m_quiescent;
+    QVector<int>            m_history;
+    QVector<int>            m_shapes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::compile
+///
+/// @description  Makes the copy of a tree and finds the shape of every node.
+/// @pre          None
+/// @post         The copy holds the tree below root, or nothing if root is
+///               NULL.
+///
+/// @param root:  The root of the tree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CCompiledTree<Node>::compile( const Node *root )
+{
+    compileNodes( root );
+    findShapes( QVector<qreal>(), 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::compileNodes
+///
+/// @description  Makes the copy of a tree, without the shapes. The tree is
+///               walked with a stack of its own, so any depth of tree can be
+///               copied.
+/// @pre          None
+/// @post         The copy holds the tree below root, or nothing if root is
+///               NULL.
+///
+/// @param root:  The root of the tree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CCompiledTree<Node>::compileNodes( const Node *root )
+{
+    clear();
+    if( root == NULL )
+        return;
+
+    // Nodes still to be numbered, with their parent and where their number
+    // goes in the parent's run of children.
+    QVector<SPending> stack;
+    SPending pending;
+    pending.s_node = root;
+    pending.s_parent = -1;
+    pending.s_slot = -1;
+    stack.append( pending );
+
+    while( !stack.isEmpty() )
+    {
+        pending = stack.last();
+        stack.pop_back();
+
+        const Node *cur = pending.s_node;
+        int index = m_nodes.count();
+        int childCount = cur->s_childList.count();
+        int offset = m_children.count();
+
+        m_nodes.append( cur );
+        m_parents.append( pending.s_parent );
+        m_childOffsets.append( offset );
+        m_childCounts.append( childCount );
+        m_values.append( cur->s_value );
+        m_quiescent.append( cur->s_quiescent );
+        m_history.append( cur->s_history );
+        if( pending.s_slot >= 0 )
+            m_children[pending.s_slot] = index;
+
+        // The first child is pushed last so that it is numbered next.
+        m_children.resize( offset + childCount );
+        for( int i = childCount - 1; i >= 0; --i )
+        {
+            SPending next;
+            next.s_node = cur->s_childList[i];
+            next.s_parent = index;
+            next.s_slot = offset + i;
+            stack.append( next );
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::clear
+///
+/// @description  Empties the copy.
+/// @pre          None
+/// @post         The copy has no nodes.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CCompiledTree<Node>::clear()
+{
+    m_nodes.clear();
+    m_parents.clear();
+    m_childOffsets.clear();
+    m_childCounts.clear();
+    m_children.clear();
+    m_values.clear();
+    m_quiescent.clear();
+    m_history.clear();
+    m_shapes.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::findShapes
+///
+/// @description  Finds the shape of every node. A node is keyed by its value,
+///               its quiescent flag, its part of data and the shapes of its
+///               children in order, and nodes with equal keys share a shape.
+///               Children are numbered after their parents, so going through
+///               the nodes backwards finds every child's shape first.
+/// @pre          The nodes have been copied.
+/// @post         shape() gives the shape of every node.
+///
+/// @param data:   Anything else the shape of a node depends on, stride values
+///                for each node, or empty if stride is 0.
+/// @param stride: The number of values of data for each node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CCompiledTree<Node>::findShapes( const QVector<qreal> &data, int stride )
+{
+    QHash<QByteArray, int> shapes;
+    QByteArray key;
+    m_shapes.resize( m_nodes.count() );
+    for( int i = m_nodes.count() - 1; i >= 0; --i )
+    {
+        float value = m_values[i];
+        char quiescent = m_quiescent[i];
+        const int *children = m_children.constData() + m_childOffsets[i];
+
+        key.clear();
+        key.append( (const char *)&value, sizeof( value ) );
+        key.append( quiescent );
+        if( stride > 0 )
+            key.append( (const char *)( data.constData() + i * stride ),
+                        stride * sizeof( qreal ) );
+        for( int c = 0; c < m_childCounts[i]; ++c )
+        {
+            int childShape = m_shapes[children[c]];
+            key.append( (const char *)&childShape, sizeof( childShape ) );
+        }
+
+        int shape = shapes.value( key, -1 );
+        if( shape < 0 )
+        {
+            shape = shapes.count();
+            shapes.insert( key, shape );
+        }
+        m_shapes[i] = shape;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::count
+///
+/// @description  Returns the number of nodes.
+/// @pre          None
+/// @post         None
+///
+/// @return int:  The number of nodes.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+int CCompiledTree<Node>::count() const
+{
+    return m_nodes.count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::childCount
+///
+/// @description  Returns the number of children of a node.
+/// @pre          node is a node of the copy.
+/// @post         None
+///
+/// @param node:  The node.
+///
+/// @return int:  The number of children.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+int CCompiledTree<Node>::childCount( int node ) const
+{
+    return m_childCounts[node];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::child
+///
+/// @description  Returns a child of a node.
+/// @pre          0 <= i < childCount( node )
+/// @post         None
+///
+/// @param node:  The node.
+/// @param i:     Which child, in the order of the tree.
+///
+/// @return int:  The child.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+int CCompiledTree<Node>::child( int node, int i ) const
+{
+    return m_children[m_childOffsets[node] + i];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::parent
+///
+/// @description  Returns the parent of a node.
+/// @pre          node is a node of the copy.
+/// @post         None
+///
+/// @param node:  The node.
+///
+/// @return int:  The parent, or -1 for the root.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+int CCompiledTree<Node>::parent( int node ) const
+{
+    return m_parents[node];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::value
+///
+/// @description  Returns the value of a node.
+/// @pre          node is a node of the copy.
+/// @post         None
+///
+/// @param node:  The node.
+///
+/// @return float: The value.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+float CCompiledTree<Node>::value( int node ) const
+{
+    return m_values[node];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::isQuiescent
+///
+/// @description  Tells whether a node is quiescent.
+/// @pre          node is a node of the copy.
+/// @post         None
+///
+/// @param node:  The node.
+///
+/// @return bool: The quiescent flag of the node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+bool CCompiledTree<Node>::isQuiescent( int node ) const
+{
+    return m_quiescent[node];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::history
+///
+/// @description  Returns the preset history value of a node.
+/// @pre          node is a node of the copy.
+/// @post         None
+///
+/// @param node:  The node.
+///
+/// @return int:  The history value.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+int CCompiledTree<Node>::history( int node ) const
+{
+    return m_history[node];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::shape
+///
+/// @description  Returns the shape of a node. Two nodes have the same shape
+///               if and only if their subtrees are the same.
+/// @pre          node is a node of the copy.
+/// @post         None
+///
+/// @param node:  The node.
+///
+/// @return int:  The shape, from 0 up to the number of shapes.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+int CCompiledTree<Node>::shape( int node ) const
+{
+    return m_shapes[node];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledTree::node
+///
+/// @description  Returns the node a number stands for, for its name and the
+///               other things the copy does not keep.
+/// @pre          index is a node of the copy.
+/// @post         None
+///
+/// @param index: The number of the node.
+///
+/// @return const Node *: The node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+const Node *CCompiledTree<Node>::node( int index ) const
+{
+    return m_nodes[index];
+}
+
+#endif//_CCOMPILEDTREE_H_
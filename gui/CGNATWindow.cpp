@@ -23,6 +23,7 @@
 #include "IGNATView.h"
 #include "CStyleToolkit.h"
 #include "CEditStyleToolkit.h"
+#include "CTraceCache.h"
 #include <QAction>
 #include <QActionGroup>
 #include <QMenuBar>
@@ -518,6 +519,26 @@ void CGNATWindow::preferencesClicked()
     dialog->activateWindow();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CGNATWindow::traceCacheToggled
+///
+/// @description     This function is called when the user checks or unchecks
+///                  Settings --> Keep Traces on Disk.
+///
+/// @pre             None
+/// @post            Traces are kept on disk from now on if on is true. If it
+///                  is false, the traces kept so far are removed.
+///
+/// @param on:       True if the action was checked.
+///
+/// @limitations     None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CGNATWindow::traceCacheToggled( bool on )
+{
+    CTraceCacheBase::setPersistent( on );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CGNATWindow::saveSettings
 ///
@@ -581,6 +602,12 @@ void CGNATWindow::setupActions()
     m_preferencesAction = new QAction("Preferences...", this);
     connect(m_preferencesAction, SIGNAL(activated()), this, SLOT(preferencesClicked()));
 
+    m_traceCacheAction = new QAction( "Keep Traces on Disk", this );
+    m_traceCacheAction->setCheckable( true );
+    m_traceCacheAction->setChecked( CTraceCacheBase::isPersistent() );
+    connect( m_traceCacheAction, SIGNAL(toggled(bool)), this,
+             SLOT(traceCacheToggled(bool)) );
+
     m_aboutAction = new QAction( "About...", this );
     connect( m_aboutAction, SIGNAL(activated()), this, SLOT(aboutClicked()));
 }
@@ -682,6 +709,7 @@ void CGNATWindow::setupMenuBar()
 
     m_settingsMenu = m_menuBar->addMenu("Settings");
     m_settingsMenu->addAction(m_preferencesAction);
+    m_settingsMenu->addAction(m_traceCacheAction);
 
     m_helpMenu = m_menuBar->addMenu("Help");
     m_helpMenu->addAction(m_aboutAction);
@@ -66,6 +66,7 @@ private slots:
     void saveAsClicked();
     void saveImageClicked();
 	void preferencesClicked();
+    void traceCacheToggled( bool on );
     void aboutClicked();
 
 private:
@@ -89,6 +90,7 @@ private:
     QAction    *m_saveAsAction;
     QAction    *m_saveImageAction;
 	QAction    *m_preferencesAction;
+    QAction    *m_traceCacheAction;
     QAction    *m_exitAction;
     QAction    *m_aboutAction;
 
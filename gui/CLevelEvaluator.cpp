@@ -0,0 +1,450 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CLevelEvaluator.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the
+///               CLevelEvaluator class.
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "CLevelEvaluator.h"
+#include <QRunnable>
+#include <QThread>
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelHelper
+///
+/// @description  Runs on a pool thread and works out one slice of a level.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CLevelHelper : public QRunnable
+{
+public:
+    CLevelHelper( const CLevelEvaluator *evaluator, float *results,
+                  int begin, int end )
+        : m_evaluator( evaluator ), m_results( results ),
+          m_begin( begin ), m_end( end ) {}
+
+    void run()
+    {
+        m_evaluator->propagateRange( m_results, m_begin, m_end );
+    }
+
+private:
+    const CLevelEvaluator  *m_evaluator;
+    float                  *m_results;
+    int                     m_begin;
+    int                     m_end;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::CLevelEvaluator
+///
+/// @description  This is the constructor of the CLevelEvaluator class.
+/// @pre          None
+/// @post         The evaluator holds an empty tree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CLevelEvaluator::CLevelEvaluator()
+{
+    m_levelStarts.append( 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::~CLevelEvaluator
+///
+/// @description  This is the destructor of the CLevelEvaluator class.
+/// @pre          None
+/// @post         All pool threads have finished.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CLevelEvaluator::~CLevelEvaluator()
+{
+    m_pool.waitForDone();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::count
+///
+/// @description  Returns the number of nodes in the copy. Nodes below an end
+///               point are not in it.
+/// @pre          None
+/// @post         None
+///
+/// @return int:  The number of nodes.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CLevelEvaluator::count() const
+{
+    return m_kinds.count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::levelCount
+///
+/// @description  Returns the number of levels in the copy, the root being
+///               level 0.
+/// @pre          None
+/// @post         None
+///
+/// @return int:  The number of levels.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CLevelEvaluator::levelCount() const
+{
+    return m_levelStarts.count() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::value
+///
+/// @description  Returns the backed-up value of a node.
+/// @pre          The values have been propagated.
+/// @post         None
+///
+/// @param index: The node, by its place in the copy.
+///
+/// @return float: The backed-up value.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+float CLevelEvaluator::value( int index ) const
+{
+    return m_results[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::rootValue
+///
+/// @description  Returns the backed-up value of the root.
+/// @pre          The values have been propagated.
+/// @post         None
+///
+/// @return float: The value of the root, or 0 for an empty tree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+float CLevelEvaluator::rootValue() const
+{
+    return m_results.isEmpty() ? 0.0F : m_results[0];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::representative
+///
+/// @description  Returns the node whose value a node shares. Nothing below a
+///               shared node is in the copy, but its subtree is the same as
+///               that of the node returned.
+/// @pre          index is a node of the copy.
+/// @post         None
+///
+/// @param index: The place of the node in the copy.
+///
+/// @return int:  The place of the node it shares the value of, or index if
+///               it is not shared.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CLevelEvaluator::representative( int index ) const
+{
+    return m_kinds[index] == SharedNode ? m_childOffsets[index] : index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::clearLevels
+///
+/// @description  Empties the copy so a new one can be made.
+/// @pre          None
+/// @post         The copy has no nodes and no levels.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CLevelEvaluator::clearLevels()
+{
+    m_kinds.clear();
+    m_childOffsets.clear();
+    m_childCounts.clear();
+    m_values.clear();
+    m_weights.clear();
+    m_results.clear();
+    m_levelStarts.clear();
+    m_levelStarts.append( 0 );
+    m_sharedNodes.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::addNode
+///
+/// @description  Adds a node to the level being made.
+/// @pre          Its parent, if any, is in the level before.
+/// @post         The node is last in the copy and has no children yet.
+///
+/// @param kind:   How the value of the node is found.
+/// @param value:  The value of the node as an end point.
+/// @param weight: The weight of the node in the sum of a chance parent.
+///
+/// @return int:  The place of the node in the copy.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CLevelEvaluator::addNode( ENodeKind kind, float value, qreal weight )
+{
+    m_kinds.append( (char)kind );
+    m_childOffsets.append( 0 );
+    m_childCounts.append( 0 );
+    m_values.append( value );
+    m_weights.append( weight );
+    return m_kinds.count() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::setChildren
+///
+/// @description  Tells a node where its children are.
+/// @pre          The children were added one after the other.
+/// @post         None
+///
+/// @param node:  The place of the node.
+/// @param first: The place of its first child.
+/// @param count: The number of children.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CLevelEvaluator::setChildren( int node, int first, int count )
+{
+    m_childOffsets[node] = first;
+    m_childCounts[node] = count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::shareNode
+///
+/// @description  Makes a node take its value from another node of the same
+///               level with the same subtree, so the subtree is only copied
+///               and worked out once.
+/// @pre          The node has just been added, and representative is an
+///               earlier node of the same level that is not shared.
+/// @post         The node is a shared node with no children.
+///
+/// @param node:           The place of the node.
+/// @param representative: The place of the node it shares the value of.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CLevelEvaluator::shareNode( int node, int representative )
+{
+    m_kinds[node] = (char)SharedNode;
+    m_childOffsets[node] = representative;
+    m_childCounts[node] = 0;
+    m_sharedNodes.append( node );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::endLevel
+///
+/// @description  Closes the level being made. The nodes added after this go
+///               in the next level.
+/// @pre          None
+/// @post         If any node was added since the last call, there is one
+///               more level.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CLevelEvaluator::endLevel()
+{
+    if( m_kinds.count() > m_levelStarts.last() )
+        m_levelStarts.append( m_kinds.count() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::propagate
+///
+/// @description  Works out the backed-up value of every node, one level at a
+///               time from the bottom. Each level only reads the one below
+///               it, so its slices can be done at once on different threads.
+///               The shared nodes of a level are given their values once the
+///               rest of it is done.
+/// @pre          The copy has been made.
+/// @post         value() gives the backed-up value of every node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CLevelEvaluator::propagate()
+{
+    m_results.resize( m_kinds.count() );
+    float *results = m_results.data();
+
+    int threads = qMax( 1, QThread::idealThreadCount() );
+    int shared = m_sharedNodes.count();
+    for( int level = levelCount() - 1; level >= 0; --level )
+    {
+        int begin = levelStart( level );
+        int end = levelEnd( level );
+        int slices = qMin( threads, (end - begin) / MinParallelLevel + 1 );
+
+        // The calling thread does the first slice while the pool does the
+        // rest.
+        int size = (end - begin + slices - 1) / slices;
+        for( int s = 1; s < slices; ++s )
+        {
+            int first = begin + s * size;
+            int last = qMin( end, first + size );
+            m_pool.start( new CLevelHelper( this, results, first, last ) );
+        }
+        propagateRange( results, begin, qMin( end, begin + size ) );
+        m_pool.waitForDone();
+
+        for( ; shared > 0 && m_sharedNodes[shared - 1] >= begin; --shared )
+        {
+            int node = m_sharedNodes[shared - 1];
+            results[node] = results[m_childOffsets[node]];
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::kind
+///
+/// @description  Returns how the value of a node is found.
+/// @pre          index is a node of the copy.
+/// @post         None
+///
+/// @param index: The place of the node.
+///
+/// @return ENodeKind: The kind of the node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CLevelEvaluator::ENodeKind CLevelEvaluator::kind( int index ) const
+{
+    return (ENodeKind)m_kinds[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::levelStart
+///
+/// @description  Returns the place of the first node of a level.
+/// @pre          0 <= level < levelCount()
+/// @post         None
+///
+/// @param level: The level.
+///
+/// @return int:  The place of its first node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CLevelEvaluator::levelStart( int level ) const
+{
+    return m_levelStarts[level];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::levelEnd
+///
+/// @description  Returns the place just past the last node of a level.
+/// @pre          0 <= level < levelCount()
+/// @post         None
+///
+/// @param level: The level.
+///
+/// @return int:  The place after its last node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CLevelEvaluator::levelEnd( int level ) const
+{
+    return m_levelStarts[level + 1];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator::propagateRange
+///
+/// @description  Works out the backed-up values of a run of nodes of one
+///               level. The children of a node are a run of the level below,
+///               so each node is worked out by one loop over flat arrays,
+///               without recursion. Shared nodes are left for propagate().
+/// @pre          The level below has been worked out.
+/// @post         results holds the values of the nodes from begin to end.
+///
+/// @param results: The backed-up values, written in place.
+/// @param begin:   The first node.
+/// @param end:     The node after the last.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CLevelEvaluator::propagateRange( float *results, int begin,
+                                      int end ) const
+{
+    const char *kinds = m_kinds.constData();
+    const int *offsets = m_childOffsets.constData();
+    const int *counts = m_childCounts.constData();
+    const float *values = m_values.constData();
+    const qreal *weights = m_weights.constData();
+
+    for( int i = begin; i < end; ++i )
+    {
+        const float *child = results + offsets[i];
+        int n = counts[i];
+        float v;
+        switch( kinds[i] )
+        {
+        case MaxNode:
+            v = child[0];
+            for( int c = 1; c < n; ++c )
+                v = child[c] > v ? child[c] : v;
+            break;
+
+        case MinNode:
+            v = child[0];
+            for( int c = 1; c < n; ++c )
+                v = child[c] < v ? child[c] : v;
+            break;
+
+        case ChanceNode:
+        {
+            const qreal *weight = weights + offsets[i];
+            qreal sum = 0.0;
+            for( int c = 0; c < n; ++c )
+                sum += weight[c] * child[c];
+            v = sum;
+            break;
+        }
+
+        case SharedNode:
+            // Filled in once the rest of the level is done.
+            continue;
+
+        default:
+            v = values[i];
+            break;
+        }
+        results[i] = v;
+    }
+}
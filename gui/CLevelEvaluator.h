@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CLevelEvaluator.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the CLevelEvaluator
+///               class, the part of the tree evaluators shared by the tree
+///               and chance tree views.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CLEVELEVALUATOR_H_
+#define _CLEVELEVALUATOR_H_
+
+#include <QVector>
+#include <QThreadPool>
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLevelEvaluator
+///
+/// @description  Finds the backed-up value of every node of a tree from a
+///               flat copy of it laid out one level after another. The
+///               children of a node are a run of the next level, so a level
+///               is worked out from the one below it with a min, max or
+///               weighted sum over each run, starting from the bottom. Large
+///               levels are split between threads.
+///
+///               Subclasses make the copy. They decide, by the depth limit
+///               and quiescence rules, which nodes are end points and do not
+///               copy anything below them. A node whose subtree is the same
+///               as that of a node already in its level can share that
+///               node's value instead of having its subtree copied.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CLevelEvaluator
+{
+public:
+    enum ENodeKind { EndPoint, MaxNode, MinNode, ChanceNode, SharedNode };
+
+    CLevelEvaluator();
+    ~CLevelEvaluator();
+
+    int count() const;
+    int levelCount() const;
+    float value( int index ) const;
+    float rootValue() const;
+    int representative( int index ) const;
+
+protected:
+    void clearLevels();
+    int addNode( ENodeKind kind, float value, qreal weight );
+    void setChildren( int node, int first, int count );
+    void shareNode( int node, int representative );
+    void endLevel();
+    void propagate();
+
+    ENodeKind kind( int index ) const;
+    int levelStart( int level ) const;
+    int levelEnd( int level ) const;
+
+private:
+    friend class CLevelHelper;
+
+    void propagateRange( float *results, int begin, int end ) const;
+
+    // Levels smaller than this are not worth handing to other threads.
+    enum { MinParallelLevel = 16384 };
+
+    QVector<char>       m_kinds;
+    QVector<int>        m_childOffsets;
+    QVector<int>        m_childCounts;
+    QVector<float>      m_values;
+    // The weight of each node in the sum of a chance parent, 1 otherwise.
+    QVector<qreal>      m_weights;
+    QVector<float>      m_results;
+    // Where each level starts, followed by the end of the last level.
+    QVector<int>        m_levelStarts;
+    // The shared nodes, in order. Their child offset is the node they share
+    // the value of.
+    QVector<int>        m_sharedNodes;
+    QThreadPool         m_pool;
+};
+
+#endif//_CLEVELEVALUATOR_H_
@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTraceCache.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the CTraceCacheBase
+///               class. The CTraceCache template itself lives in the header.
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "CTraceCache.h"
+#include <QSettings>
+#include <QDir>
+#include <QFileInfo>
+#include <QDesktopServices>
+
+////////////////////////////////////////////////////////////////////////////////
+/// traceDirectory
+///
+/// @description  Returns the directory the trace files are kept in.
+///
+////////////////////////////////////////////////////////////////////////////////
+static QString traceDirectory()
+{
+    return QDesktopServices::storageLocation( QDesktopServices::CacheLocation )
+           + "/traces";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCacheBase::isPersistent
+///
+/// @description  Tells whether traces are kept on disk. This is a user
+///               setting and is off unless turned on.
+/// @pre          None
+/// @post         None
+///
+/// @return bool: True if traces are kept on disk.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CTraceCacheBase::isPersistent()
+{
+    QSettings settings;
+    return settings.value( "tracecache", false ).toBool();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCacheBase::setPersistent
+///
+/// @description  Turns keeping traces on disk on or off. Turning it off
+///               removes the files kept so far.
+/// @pre          None
+/// @post         The setting is saved.
+///
+/// @param on:    True to keep traces on disk.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceCacheBase::setPersistent( bool on )
+{
+    QSettings settings;
+    settings.setValue( "tracecache", on );
+
+    if( on )
+        return;
+
+    QDir dir( traceDirectory() );
+    QString name;
+    foreach( name, dir.entryList( QDir::Files ) )
+        dir.remove( name );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCacheBase::fileName
+///
+/// @description  Returns the path of the file a trace is kept in.
+/// @pre          None
+/// @post         None
+///
+/// @param kind:  The kind of trace.
+/// @param key:   The key of the trace.
+///
+/// @return QString: The path of the file, which may not exist.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+QString CTraceCacheBase::fileName( const QString &kind, const QByteArray &key )
+{
+    return traceDirectory() + "/" + kind + "-" + QString( key.toHex() )
+           + ".trace";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCacheBase::makeDirectory
+///
+/// @description  Creates the directory the trace files are kept in.
+/// @pre          None
+/// @post         The directory exists unless it could not be made.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceCacheBase::makeDirectory()
+{
+    QDir().mkpath( traceDirectory() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCacheBase::trimDirectory
+///
+/// @description  Removes the oldest trace files while there are more than
+///               MaxFiles of them.
+/// @pre          None
+/// @post         At most MaxFiles trace files are left.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceCacheBase::trimDirectory()
+{
+    QDir dir( traceDirectory() );
+    QFileInfoList files = dir.entryInfoList( QDir::Files, QDir::Time );
+
+    // The list is newest first.
+    while( files.count() > MaxFiles )
+        dir.remove( files.takeLast().fileName() );
+}
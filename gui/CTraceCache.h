@@ -0,0 +1,326 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTraceCache.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the CTraceCacheBase
+///               class and the CTraceCache template, which keep the traces a
+///               view has already made so they can be shown again at once.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CTRACECACHE_H_
+#define _CTRACECACHE_H_
+
+#include <QList>
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QDataStream>
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCacheBase
+///
+/// @description  The parts of CTraceCache that do not depend on the kind of
+///               trace: the setting that turns keeping traces on disk on and
+///               off, and where on disk they are kept.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CTraceCacheBase
+{
+public:
+    static bool isPersistent();
+    static void setPersistent( bool on );
+
+protected:
+    static QString fileName( const QString &kind, const QByteArray &key );
+    static void makeDirectory();
+    static void trimDirectory();
+
+    // Format of the trace files. Bump the version when a trace's write()
+    // changes, and also when a tracer makes different rows for the same
+    // key, so that old files are passed over instead of shown as current.
+    enum { FileMagic = 0x474e5443, FileVersion = 2 };
+    // Most trace files kept on disk; the oldest go first.
+    enum { MaxFiles = 256 };
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCache
+///
+/// @description  A bounded cache of traces of one kind, T, looked up by the
+///               key the tracer selector makes from the graph and settings.
+///               The cache owns its traces and drops the least recently used
+///               one when it is full. The most recently used trace is never
+///               dropped, so the view may keep showing it.
+///
+///               When isPersistent() is on, traces are also written to disk
+///               and a trace missing from memory is looked for there, so the
+///               cache lasts from one run to the next. T must then provide
+///               void write( QDataStream & ) const and
+///               static T *read( QDataStream & ).
+///
+/// @limitations  A trace read back from disk only has the rows of its grid,
+///               not the data the tracer made them from.
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class T>
+class CTraceCache : public CTraceCacheBase
+{
+public:
+    CTraceCache( const QString &kind, int capacity = DefaultCapacity );
+    ~CTraceCache();
+
+    T *find( const QByteArray &key );
+    void insert( const QByteArray &key, T *trace );
+    void clear();
+
+private:
+    struct SEntry
+    {
+        QByteArray  s_key;
+        T          *s_trace;
+    };
+
+    void add( const QByteArray &key, T *trace );
+    T *load( const QByteArray &key ) const;
+    void save( const QByteArray &key, const T *trace ) const;
+
+    enum { DefaultCapacity = 16 };
+
+    QString         m_kind;
+    int             m_capacity;
+    // The most recently used entry comes first.
+    QList<SEntry>   m_entries;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCache::CTraceCache
+///
+/// @description      This is the constructor of the CTraceCache class.
+/// @pre              None
+/// @post             The cache is empty.
+///
+/// @param kind:      Names the kind of trace kept, so that caches of
+///                   different kinds do not share files on disk.
+/// @param capacity:  The most traces kept in memory. At least one is kept.
+///
+/// @limitations      None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class T>
+CTraceCache<T>::CTraceCache( const QString &kind, int capacity )
+: m_kind( kind ), m_capacity( capacity < 1 ? 1 : capacity )
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCache::~CTraceCache
+///
+/// @description  This is the destructor of the CTraceCache class.
+/// @pre          None
+/// @post         All the traces in memory are deleted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class T>
+CTraceCache<T>::~CTraceCache()
+{
+    clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCache::find
+///
+/// @description  Looks up a trace, first in memory and then, if traces are
+///               kept on disk, on disk.
+/// @pre          None
+/// @post         A trace found becomes the most recently used.
+///
+/// @param key:   The key the trace was inserted with.
+///
+/// @return T *:  The trace, still owned by the cache, or NULL if there is
+///               none.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class T>
+T *CTraceCache<T>::find( const QByteArray &key )
+{
+    for( int i = 0; i < m_entries.count(); ++i )
+        if( m_entries[i].s_key == key )
+        {
+            m_entries.move( i, 0 );
+            return m_entries.first().s_trace;
+        }
+
+    if( !isPersistent() )
+        return NULL;
+
+    T *trace = load( key );
+    if( trace != NULL )
+        add( key, trace );
+    return trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCache::insert
+///
+/// @description  Adds a trace as the most recently used, writing it to disk
+///               as well if traces are kept there.
+/// @pre          None
+/// @post         The cache owns the trace. Any trace already kept under the
+///               key is deleted.
+///
+/// @param key:   The key to find the trace by later.
+/// @param trace: The trace. Nothing is done if it is NULL.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void CTraceCache<T>::insert( const QByteArray &key, T *trace )
+{
+    if( trace == NULL )
+        return;
+
+    add( key, trace );
+    if( isPersistent() )
+        save( key, trace );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCache::clear
+///
+/// @description  Empties the cache in memory. Files on disk are kept.
+/// @pre          None
+/// @post         All the traces in memory are deleted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void CTraceCache<T>::clear()
+{
+    while( !m_entries.isEmpty() )
+        delete m_entries.takeFirst().s_trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCache::add
+///
+/// @description  Puts a trace first in memory and drops the least recently
+///               used ones that no longer fit.
+/// @pre          trace is not NULL.
+/// @post         The cache owns the trace.
+///
+/// @param key:   The key of the trace.
+/// @param trace: The trace.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void CTraceCache<T>::add( const QByteArray &key, T *trace )
+{
+    for( int i = 0; i < m_entries.count(); ++i )
+        if( m_entries[i].s_key == key )
+        {
+            if( m_entries[i].s_trace != trace )
+                delete m_entries[i].s_trace;
+            m_entries.removeAt( i );
+            break;
+        }
+
+    SEntry entry;
+    entry.s_key = key;
+    entry.s_trace = trace;
+    m_entries.prepend( entry );
+
+    while( m_entries.count() > m_capacity )
+        delete m_entries.takeLast().s_trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCache::load
+///
+/// @description  Reads a trace from disk.
+/// @pre          None
+/// @post         A file that could not be read is removed.
+///
+/// @param key:   The key of the trace.
+///
+/// @return T *:  The trace, owned by the caller, or NULL if there is none.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class T>
+T *CTraceCache<T>::load( const QByteArray &key ) const
+{
+    QFile file( fileName( m_kind, key ) );
+    if( !file.open( QIODevice::ReadOnly ) )
+        return NULL;
+
+    QDataStream in( &file );
+    in.setVersion( QDataStream::Qt_4_0 );
+
+    quint32 magic = 0, version = 0;
+    QByteArray fileKey;
+    in >> magic >> version >> fileKey;
+
+    T *trace = NULL;
+    if( magic == (quint32)FileMagic && version == (quint32)FileVersion
+        && fileKey == key )
+        trace = T::read( in );
+
+    file.close();
+    if( trace == NULL )
+        file.remove();
+    return trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceCache::save
+///
+/// @description  Writes a trace to disk, unless it is there already.
+/// @pre          None
+/// @post         The oldest files are removed if there are too many.
+///
+/// @param key:   The key of the trace.
+/// @param trace: The trace.
+///
+/// @limitations  A write that fails is silently given up.
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class T>
+void CTraceCache<T>::save( const QByteArray &key, const T *trace ) const
+{
+    QFile file( fileName( m_kind, key ) );
+    if( file.exists() )
+        return;
+
+    makeDirectory();
+    if( !file.open( QIODevice::WriteOnly ) )
+        return;
+
+    QDataStream out( &file );
+    out.setVersion( QDataStream::Qt_4_0 );
+    out << (quint32)FileMagic << (quint32)FileVersion << key;
+    trace->write( out );
+
+    file.close();
+    if( out.status() != QDataStream::Ok )
+        file.remove();
+
+    trimDirectory();
+}
+
+#endif//_CTRACECACHE_H_
@@ -0,0 +1,251 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTraceRowIndex.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the CTraceRowIndex template, a flat list
+///               of the rows of a trace shared by everything that shows or
+///               saves it.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CTRACEROWINDEX_H_
+#define _CTRACEROWINDEX_H_
+
+#include <QVector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRowIndex
+///
+/// @description  The rows of a trace in the order they are shown, built in
+///               one pass over the calls. A row refers to the call and line
+///               it shows, so any row can be had at once without making the
+///               text of the rows before it. The first row of each depth is
+///               kept as well, so a depth's rows are a range of the index.
+///
+///               Call is the call struct of the trace and Line its line
+///               struct. Rows that are not lines, such as the blank row
+///               between depths, are told apart by their kind.
+///
+/// @limitations  The index refers to the trace and must not outlive it.
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Call, class Line>
+class CTraceRowIndex
+{
+public:
+    enum ERowKind { LineRow, BlankRow, PreludeRow, CommentRow };
+
+    struct SRow
+    {
+        ERowKind    s_kind;
+        Call       *s_call;
+        Line       *s_line;
+    };
+
+    void beginDepth();
+    void addRow( ERowKind kind, Call *call, Line *line = NULL );
+    void addLines( Call *call );
+    void addCall( Call *call );
+
+    int rowCount() const;
+    const SRow &row( int index ) const;
+
+    int depthCount() const;
+    int depthBegin( int depth ) const;
+    int depthEnd( int depth ) const;
+
+private:
+    QVector<SRow>   m_rows;
+    // The first row of each depth.
+    QVector<int>    m_depths;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRowIndex::beginDepth
+///
+/// @description  Starts a new depth. The rows added after this belong to it.
+/// @pre          None
+/// @post         None
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Call, class Line>
+void CTraceRowIndex<Call, Line>::beginDepth()
+{
+    m_depths.append( m_rows.count() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRowIndex::addRow
+///
+/// @description  Adds a row to the end.
+/// @pre          None
+/// @post         None
+///
+/// @param kind:  What the row shows.
+/// @param call:  The call the row belongs to. May be NULL for a blank row.
+/// @param line:  The line shown, for a line row.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Call, class Line>
+void CTraceRowIndex<Call, Line>::addRow( ERowKind kind, Call *call, Line *line )
+{
+    SRow row;
+    row.s_kind = kind;
+    row.s_call = call;
+    row.s_line = line;
+    m_rows.append( row );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRowIndex::addLines
+///
+/// @description  Adds a row for each line of a call, but not of the calls it
+///               makes.
+/// @pre          None
+/// @post         None
+///
+/// @param call:  The call.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Call, class Line>
+void CTraceRowIndex<Call, Line>::addLines( Call *call )
+{
+    Line *curLine;
+    foreach( curLine, call->s_lines )
+        addRow( LineRow, call, curLine );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRowIndex::addCall
+///
+/// @description  Adds a row for each line of a call and, depth first, of the
+///               calls it makes.
+/// @pre          Call has s_children.
+/// @post         None
+///
+/// @param call:  The call.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Call, class Line>
+void CTraceRowIndex<Call, Line>::addCall( Call *call )
+{
+    addLines( call );
+
+    Call *curCall;
+    foreach( curCall, call->s_children )
+        addCall( curCall );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRowIndex::rowCount
+///
+/// @description  Returns the number of rows.
+/// @pre          None
+/// @post         None
+///
+/// @return int:  The number of rows.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Call, class Line>
+int CTraceRowIndex<Call, Line>::rowCount() const
+{
+    return m_rows.count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRowIndex::row
+///
+/// @description  Returns a row.
+/// @pre          index is a row.
+/// @post         None
+///
+/// @param index: The row.
+///
+/// @return const SRow &: The row.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Call, class Line>
+const typename CTraceRowIndex<Call, Line>::SRow &
+CTraceRowIndex<Call, Line>::row( int index ) const
+{
+    return m_rows[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRowIndex::depthCount
+///
+/// @description  Returns the number of depths begun.
+/// @pre          None
+/// @post         None
+///
+/// @return int:  The number of depths.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Call, class Line>
+int CTraceRowIndex<Call, Line>::depthCount() const
+{
+    return m_depths.count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRowIndex::depthBegin
+///
+/// @description  Returns the first row of a depth.
+/// @pre          depth is a depth.
+/// @post         None
+///
+/// @param depth: The depth.
+///
+/// @return int:  The first row of the depth.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Call, class Line>
+int CTraceRowIndex<Call, Line>::depthBegin( int depth ) const
+{
+    return m_depths[depth];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRowIndex::depthEnd
+///
+/// @description  Returns the row just after the last row of a depth.
+/// @pre          depth is a depth.
+/// @post         None
+///
+/// @param depth: The depth.
+///
+/// @return int:  The first row of the next depth, or the number of rows for
+///               the last depth.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Call, class Line>
+int CTraceRowIndex<Call, Line>::depthEnd( int depth ) const
+{
+    if( depth + 1 < m_depths.count() )
+        return m_depths[depth + 1];
+    return m_rows.count();
+}
+
+#endif//_CTRACEROWINDEX_H_
@@ -0,0 +1,495 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTraceRunner.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the ITraceJob
+///               interface and the CTraceRunner class, which run traces away
+///               from the GUI thread.
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "CTraceRunner.h"
+#include <QWidget>
+#include <QHBoxLayout>
+#include <QProgressBar>
+#include <QToolButton>
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceJob::ITraceJob
+///
+/// @description  This is the constructor of the ITraceJob class.
+/// @pre          None
+/// @post         The job is not cancelled and is not deleted by the thread
+///               pool that runs it.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+ITraceJob::ITraceJob()
+: m_cancel( 0 )
+{
+    setAutoDelete( false );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceJob::~ITraceJob
+///
+/// @description  This is the destructor of the ITraceJob class.
+/// @pre          The job is not running.
+/// @post         None
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+ITraceJob::~ITraceJob()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceJob::run
+///
+/// @description  Runs the job. This is called on a worker thread.
+/// @pre          None
+/// @post         execute() has returned and finished() has been emitted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void ITraceJob::run()
+{
+    execute();
+    emit finished();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceJob::cancel
+///
+/// @description  Asks the job to stop. It may be called from any thread.
+/// @pre          None
+/// @post         The cancel token is set.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void ITraceJob::cancel()
+{
+    m_cancel.fetchAndStoreOrdered( 1 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceJob::isCancelled
+///
+/// @description  Tells whether the job has been asked to stop.
+/// @pre          None
+/// @post         None
+///
+/// @return bool: True if cancel() has been called.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool ITraceJob::isCancelled() const
+{
+    return m_cancel != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceJob::cancelToken
+///
+/// @description  Returns the flag that cancel() sets, for handing on to the
+///               tracers that can stop part way.
+/// @pre          None
+/// @post         None
+///
+/// @return const QAtomicInt *: The cancel token. It lives as long as the job.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+const QAtomicInt *ITraceJob::cancelToken() const
+{
+    return &m_cancel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceJob::setKey
+///
+/// @description  Sets the key of the trace the job makes.
+/// @pre          None
+/// @post         None
+///
+/// @param key:   The key. May be empty.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void ITraceJob::setKey( const QByteArray &key )
+{
+    m_key = key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceJob::key
+///
+/// @description  Returns the key of the trace the job makes, so that the
+///               trace can be cached under it once it is done.
+/// @pre          None
+/// @post         None
+///
+/// @return QByteArray: The key the job was started with.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+QByteArray ITraceJob::key() const
+{
+    return m_key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::CTraceRunner
+///
+/// @description    This is the constructor of the CTraceRunner class. It
+///                 creates the progress widget, which starts out hidden.
+/// @pre            None
+/// @post           The runner is idle and has a single worker thread.
+///
+/// @param parent:  This is a pointer to the parent QObject.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+CTraceRunner::CTraceRunner( QObject *parent )
+: QObject( parent )
+{
+    m_running = NULL;
+    m_pending = NULL;
+    m_result = NULL;
+
+    m_pool.setMaxThreadCount( 1 );
+
+    m_scheduleTimer.setSingleShot( true );
+    m_scheduleTimer.setInterval( ScheduleDelay );
+    connect( &m_scheduleTimer, SIGNAL(timeout()), this, SIGNAL(scheduled()) );
+
+    m_progressTimer.setSingleShot( true );
+    m_progressTimer.setInterval( ProgressDelay );
+    connect( &m_progressTimer, SIGNAL(timeout()), this, SLOT(showProgress()) );
+
+    // The widget itself always stays visible so that it keeps its place in
+    // the tool bar; only its contents are shown and hidden.
+    m_progressWidget = new QWidget;
+    m_progressBar = new QProgressBar;
+    m_progressBar->setRange( 0, 0 );
+    m_progressBar->setTextVisible( false );
+    m_progressBar->setMaximumWidth( 80 );
+    m_cancelButton = new QToolButton;
+    m_cancelButton->setText( "Cancel" );
+    m_cancelButton->setToolTip( "Stop the trace that is running" );
+    connect( m_cancelButton, SIGNAL(clicked()), this, SLOT(cancel()) );
+
+    QHBoxLayout *layout = new QHBoxLayout( m_progressWidget );
+    layout->setMargin( 0 );
+    layout->addWidget( m_progressBar );
+    layout->addWidget( m_cancelButton );
+
+    updateProgress();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::~CTraceRunner
+///
+/// @description  This is the destructor of the CTraceRunner class. It cancels
+///               any job that is running and waits for it to end.
+/// @pre          None
+/// @post         All jobs are deleted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CTraceRunner::~CTraceRunner()
+{
+    if( m_running != NULL )
+        m_running->cancel();
+    m_pool.waitForDone();
+
+    delete m_running;
+    delete m_pending;
+    delete m_result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::start
+///
+/// @description  Starts a job. If a job is already running it is cancelled
+///               and the new one waits for it to end; a job that was already
+///               waiting is dropped.
+/// @pre          None
+/// @post         The runner owns the job, which carries the key.
+///
+/// @param job:   This is the job to run.
+/// @param key:   Identifies the trace the job makes, so that isCurrent() can
+///               tell when starting it again would be wasted. May be empty.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceRunner::start( ITraceJob *job, const QByteArray &key )
+{
+    m_key = key;
+    job->setKey( key );
+
+    if( m_running == NULL )
+    {
+        launch( job );
+        return;
+    }
+
+    m_running->cancel();
+    delete m_pending;
+    m_pending = job;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::isCurrent
+///
+/// @description  Tells whether the newest job started had the given key. Its
+///               trace is then either on show or on its way, so there is no
+///               need to start the job again.
+/// @pre          None
+/// @post         None
+///
+/// @param key:   The key of the job about to be started.
+///
+/// @return bool: True if the newest job had this key and was not cancelled.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CTraceRunner::isCurrent( const QByteArray &key ) const
+{
+    return !key.isEmpty() && key == m_key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::setCurrent
+///
+/// @description  Records that the trace with the given key is on show
+///               without a job having made it, as when it was found in a
+///               cache. Any running or waiting job is dropped.
+/// @pre          None
+/// @post         isCurrent( key ) is true.
+///
+/// @param key:   The key of the trace on show.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceRunner::setCurrent( const QByteArray &key )
+{
+    cancel();
+    m_key = key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::isBusy
+///
+/// @description  Tells whether a job is running.
+/// @pre          None
+/// @post         None
+///
+/// @return bool: True if a job is running.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CTraceRunner::isBusy() const
+{
+    return m_running != NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::takeResult
+///
+/// @description  Hands over the last job to finish, once finished() has been
+///               emitted.
+/// @pre          None
+/// @post         The caller owns the job and must delete it.
+///
+/// @return ITraceJob *: The finished job, or NULL if there is none.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+ITraceJob *CTraceRunner::takeResult()
+{
+    ITraceJob *job = m_result;
+    m_result = NULL;
+    return job;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::getProgressWidget
+///
+/// @description  Returns the widget with the busy indicator and the cancel
+///               button, for placing in a tool bar.
+/// @pre          None
+/// @post         None
+///
+/// @return QWidget *: The progress widget. It is owned by whatever it is
+///                    placed in.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+QWidget *CTraceRunner::getProgressWidget()
+{
+    return m_progressWidget;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::schedule
+///
+/// @description  This function is a Qt slot. It asks for a retrace. The
+///               scheduled() signal follows shortly after the last of a run
+///               of requests, so dragging a node or typing a value costs one
+///               trace rather than one per change.
+/// @pre          None
+/// @post         scheduled() will be emitted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceRunner::schedule()
+{
+    m_scheduleTimer.start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::cancel
+///
+/// @description  This function is a Qt slot. It stops the running job and
+///               drops any waiting one. Nothing is reported, so the last
+///               trace stays on show.
+/// @pre          None
+/// @post         The running job, if any, has been asked to stop.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceRunner::cancel()
+{
+    m_key.clear();
+    if( m_running != NULL )
+        m_running->cancel();
+    delete m_pending;
+    m_pending = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::jobFinished
+///
+/// @description  This function is a Qt slot, called on the GUI thread when
+///               the running job ends. The job is reported unless it was
+///               cancelled, and the waiting job, if any, is started.
+/// @pre          A job is running.
+/// @post         finished() has been emitted if the job ran to the end.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceRunner::jobFinished()
+{
+    // The worker may not have left run() quite yet.
+    m_pool.waitForDone();
+
+    ITraceJob *job = m_running;
+    m_running = NULL;
+
+    if( m_pending != NULL )
+    {
+        ITraceJob *next = m_pending;
+        m_pending = NULL;
+        launch( next );
+    }
+    else
+        updateProgress();
+
+    if( job->isCancelled() )
+    {
+        delete job;
+        return;
+    }
+
+    delete m_result;
+    m_result = job;
+    emit finished();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::showProgress
+///
+/// @description  This function is a Qt slot, called when a job has been
+///               running long enough to be worth showing.
+/// @pre          None
+/// @post         The busy indicator is shown if a job is still running.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceRunner::showProgress()
+{
+    m_progressBar->setVisible( isBusy() );
+    m_cancelButton->setVisible( isBusy() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::launch
+///
+/// @description  Starts a job on the worker thread.
+/// @pre          No job is running.
+/// @post         The job is running.
+///
+/// @param job:   This is the job to run.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceRunner::launch( ITraceJob *job )
+{
+    m_running = job;
+    connect( job, SIGNAL(finished()), this, SLOT(jobFinished()),
+             Qt::QueuedConnection );
+    m_pool.start( job );
+    updateProgress();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner::updateProgress
+///
+/// @description  Brings the progress widget up to date. The busy indicator
+///               only appears once a job has run for a little while, so that
+///               quick traces do not make it flicker.
+/// @pre          None
+/// @post         None
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceRunner::updateProgress()
+{
+    if( isBusy() )
+    {
+        if( m_progressBar->isHidden() )
+            m_progressTimer.start();
+        return;
+    }
+
+    m_progressTimer.stop();
+    m_progressBar->setVisible( false );
+    m_cancelButton->setVisible( false );
+}
@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTraceRunner.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the ITraceJob interface
+///               and the CTraceRunner class, which run traces away from the
+///               GUI thread.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CTRACERUNNER_H_
+#define _CTRACERUNNER_H_
+
+#include <QObject>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QThreadPool>
+#include <QTimer>
+#include <QByteArray>
+
+class QWidget;
+class QProgressBar;
+class QToolButton;
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceJob
+///
+/// @description  A single trace to be run by a CTraceRunner. A job is built on
+///               the GUI thread and must take copies of everything it needs
+///               there, the graph included, since execute() is called on a
+///               worker thread while the user goes on editing.
+///
+/// @limitations  execute() should check the cancel token now and then if the
+///               tracer is able to; a job that does not is still abandoned
+///               when cancelled, it just keeps its thread busy until it ends.
+///
+////////////////////////////////////////////////////////////////////////////////
+class ITraceJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    ITraceJob();
+    virtual ~ITraceJob();
+
+    void run();
+
+    void cancel();
+    bool isCancelled() const;
+    const QAtomicInt *cancelToken() const;
+
+    void setKey( const QByteArray &key );
+    QByteArray key() const;
+
+signals:
+    void finished();
+
+protected:
+    virtual void execute() = 0;
+
+private:
+    QAtomicInt  m_cancel;
+    QByteArray  m_key;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceRunner
+///
+/// @description  This class runs the trace jobs of one trace view, one at a
+///               time, on a thread of its own. Starting a job while another
+///               is running cancels the running one, and only the last job
+///               started is ever reported, so a burst of edits ends in a
+///               single trace of the final graph. It also provides the busy
+///               indicator and cancel button shown in the tool bar.
+///
+///               Views ask for a retrace with schedule(). Requests that come
+///               in close together are merged into one scheduled() signal,
+///               and a job whose key matches the trace already on its way or
+///               on show is not started at all.
+///
+/// @limitations  Jobs never overlap, so a tracer that keeps state between
+///               calls is still only ever used by one trace at a time.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CTraceRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    CTraceRunner( QObject *parent );
+    ~CTraceRunner();
+
+    void start( ITraceJob *job, const QByteArray &key = QByteArray() );
+    bool isCurrent( const QByteArray &key ) const;
+    void setCurrent( const QByteArray &key );
+    bool isBusy() const;
+    ITraceJob *takeResult();
+
+    QWidget *getProgressWidget();
+
+public slots:
+    void schedule();
+    void cancel();
+
+signals:
+    void scheduled();
+    void finished();
+
+private slots:
+    void jobFinished();
+    void showProgress();
+
+private:
+    void launch( ITraceJob *job );
+    void updateProgress();
+
+    // Runs longer than this, in milliseconds, show the busy indicator.
+    enum { ProgressDelay = 250 };
+    // Requests less than this many milliseconds apart are merged.
+    enum { ScheduleDelay = 40 };
+
+    QThreadPool     m_pool;
+    ITraceJob      *m_running;
+    ITraceJob      *m_pending;
+    ITraceJob      *m_result;
+    // Key of the newest job started, empty if unknown or cancelled.
+    QByteArray      m_key;
+
+    QTimer          m_scheduleTimer;
+    QTimer          m_progressTimer;
+    QWidget        *m_progressWidget;
+    QProgressBar   *m_progressBar;
+    QToolButton    *m_cancelButton;
+};
+
+#endif//_CTRACERUNNER_H_
@@ -0,0 +1,303 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTraceTableModel.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the ITraceRowSource
+///               interface and the CTraceTableModel class.
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "CTraceTableModel.h"
+#include <QFontMetrics>
+#include <QTableView>
+#include <QHeaderView>
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceRowSource::~ITraceRowSource
+///
+/// @description  This is the destructor of the ITraceRowSource interface.
+/// @pre          None
+/// @post         None
+///
+/// @limitations  It actually does nothing...
+///
+////////////////////////////////////////////////////////////////////////////////
+ITraceRowSource::~ITraceRowSource()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::CTraceTableModel
+///
+/// @description    This is the constructor of the CTraceTableModel class.
+/// @pre            None
+/// @post           The model is empty.
+///
+/// @param parent:  This is a pointer to the parent QObject.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+CTraceTableModel::CTraceTableModel( QObject *parent )
+: QAbstractTableModel( parent )
+{
+    m_source = NULL;
+    m_cachedIndex = -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::~CTraceTableModel
+///
+/// @description  This is the destructor of the CTraceTableModel class.
+/// @pre          None
+/// @post         The row source is deleted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CTraceTableModel::~CTraceTableModel()
+{
+    delete m_source;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::setSource
+///
+/// @description        Shows another trace.
+/// @pre                None
+/// @post               The model owns the source and the old one is deleted.
+///                     Attached views are reset.
+///
+/// @param columnNames: The headings of the columns.
+/// @param source:      The rows of the trace. May be NULL for no rows.
+///
+/// @limitations        None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceTableModel::setSource( const QStringList &columnNames,
+                                  ITraceRowSource *source )
+{
+    beginResetModel();
+
+    delete m_source;
+    m_source = source;
+    m_columnNames = columnNames;
+    m_cachedIndex = -1;
+    m_cachedCells.clear();
+
+    endResetModel();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::setFont
+///
+/// @description  Sets the font the cells are drawn in.
+/// @pre          None
+/// @post         Attached views redraw every cell.
+///
+/// @param font:  The font.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceTableModel::setFont( const QFont &font )
+{
+    m_font = font;
+    if( rowCount() > 0 && columnCount() > 0 )
+        emit dataChanged( index( 0, 0 ),
+                          index( rowCount() - 1, columnCount() - 1 ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::rowCount
+///
+/// @description    Returns the number of rows of the trace.
+/// @pre            None
+/// @post           None
+///
+/// @param parent:  Unused, the model is a flat table.
+///
+/// @return int:    The number of rows.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CTraceTableModel::rowCount( const QModelIndex &parent ) const
+{
+    if( parent.isValid() || m_source == NULL )
+        return 0;
+    return m_source->rowCount();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::columnCount
+///
+/// @description    Returns the number of columns of the trace.
+/// @pre            None
+/// @post           None
+///
+/// @param parent:  Unused, the model is a flat table.
+///
+/// @return int:    The number of columns.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CTraceTableModel::columnCount( const QModelIndex &parent ) const
+{
+    if( parent.isValid() )
+        return 0;
+    return m_columnNames.count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::data
+///
+/// @description      Returns the text or font of a cell.
+/// @pre              None
+/// @post             None
+///
+/// @param index:     The cell.
+/// @param role:      What is wanted of it.
+///
+/// @return QVariant: The text for the display role, the font for the font
+///                   role, or nothing.
+///
+/// @limitations      None
+///
+////////////////////////////////////////////////////////////////////////////////
+QVariant CTraceTableModel::data( const QModelIndex &index, int role ) const
+{
+    if( !index.isValid() || m_source == NULL )
+        return QVariant();
+
+    if( role == Qt::FontRole )
+        return m_font;
+    if( role != Qt::DisplayRole )
+        return QVariant();
+
+    return cachedRow( index.row() ).value( index.column() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::headerData
+///
+/// @description          Returns the heading of a column. Rows are numbered
+///                       from one.
+/// @pre                  None
+/// @post                 None
+///
+/// @param section:       The column or row.
+/// @param orientation:   Whether section is a column or a row.
+/// @param role:          What is wanted of it.
+///
+/// @return QVariant:     The heading, or nothing.
+///
+/// @limitations          None
+///
+////////////////////////////////////////////////////////////////////////////////
+QVariant CTraceTableModel::headerData( int section,
+                                       Qt::Orientation orientation,
+                                       int role ) const
+{
+    if( role != Qt::DisplayRole )
+        return QVariant();
+
+    if( orientation == Qt::Vertical )
+        return section + 1;
+    return m_columnNames.value( section );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::sampleWidths
+///
+/// @description  Estimates how wide each column's text is, in the cell font,
+///               from its heading and a sample of rows spread over the whole
+///               trace, rather than from every row.
+/// @pre          None
+/// @post         None
+///
+/// @return QList<int>: The width in pixels of the widest text seen in each
+///                     column.
+///
+/// @limitations  A long cell that is not sampled may be cut short; the user
+///               can still widen its column.
+///
+////////////////////////////////////////////////////////////////////////////////
+QList<int> CTraceTableModel::sampleWidths() const
+{
+    QFontMetrics metrics( m_font );
+    int columns = columnCount();
+    int rows = rowCount();
+
+    QList<int> widths;
+    for( int j = 0; j < columns; ++j )
+        widths.append( metrics.width( m_columnNames[j] ) );
+
+    // Every row of a small trace, or evenly spaced rows of a big one.
+    int step = rows / WidthSamples + 1;
+    for( int i = 0; i < rows; i += step )
+    {
+        QStringList cells = m_source->row( i );
+        for( int j = 0; j < columns && j < cells.count(); ++j )
+            widths[j] = qMax( widths[j], metrics.width( cells[j] ) );
+    }
+
+    return widths;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::fitView
+///
+/// @description  Sizes the rows and columns of a view of this model. Every
+///               row gets the height of one line of text, so the view never
+///               has to measure rows, and the columns get the widths found
+///               by sampleWidths().
+/// @pre          The view shows this model.
+/// @post         None
+///
+/// @param view:  The view.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTraceTableModel::fitView( QTableView *view ) const
+{
+    QFontMetrics metrics( m_font );
+    view->verticalHeader()->setResizeMode( QHeaderView::Fixed );
+    view->verticalHeader()->setDefaultSectionSize( metrics.height()
+                                                   + RowPadding );
+
+    QList<int> widths = sampleWidths();
+    for( int j = 0; j < widths.count(); ++j )
+        view->setColumnWidth( j, widths[j] + CellPadding );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel::cachedRow
+///
+/// @description  Returns the cells of a row, making them only if the row is
+///               not the one last asked for.
+/// @pre          The model has a source.
+/// @post         The row is the cached one.
+///
+/// @param index: The row.
+///
+/// @return const QStringList &: The cells of the row.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+const QStringList &CTraceTableModel::cachedRow( int index ) const
+{
+    if( index != m_cachedIndex )
+    {
+        m_cachedCells = m_source->row( index );
+        m_cachedIndex = index;
+    }
+    return m_cachedCells;
+}
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTraceTableModel.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the ITraceRowSource
+///               interface and the CTraceTableModel class, which show a trace
+///               in a table view without building the whole grid.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CTRACETABLEMODEL_H_
+#define _CTRACETABLEMODEL_H_
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QFont>
+#include <QList>
+
+class QTableView;
+
+////////////////////////////////////////////////////////////////////////////////
+/// ITraceRowSource
+///
+/// @description  Gives the rows of a trace one at a time, in the order they
+///               are shown. Each kind of trace view provides one.
+///
+/// @limitations  The source refers to the trace and must not outlive it.
+///
+////////////////////////////////////////////////////////////////////////////////
+class ITraceRowSource
+{
+public:
+    virtual ~ITraceRowSource();
+
+    virtual int rowCount() const = 0;
+    virtual QStringList row( int index ) const = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTraceTableModel
+///
+/// @description  A read only table model over a trace. The text of a cell is
+///               only made when the view asks for it, so a trace of any size
+///               is shown at once and only the rows in sight ever become
+///               strings.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CTraceTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    CTraceTableModel( QObject *parent );
+    ~CTraceTableModel();
+
+    void setSource( const QStringList &columnNames, ITraceRowSource *source );
+    void setFont( const QFont &font );
+
+    int rowCount( const QModelIndex &parent = QModelIndex() ) const;
+    int columnCount( const QModelIndex &parent = QModelIndex() ) const;
+    QVariant data( const QModelIndex &index,
+                   int role = Qt::DisplayRole ) const;
+    QVariant headerData( int section, Qt::Orientation orientation,
+                         int role = Qt::DisplayRole ) const;
+
+    QList<int> sampleWidths() const;
+    void fitView( QTableView *view ) const;
+
+private:
+    const QStringList &cachedRow( int index ) const;
+
+    // Most rows looked at by sampleWidths().
+    enum { WidthSamples = 200 };
+    // Space in pixels left around the text of a cell.
+    enum { CellPadding = 12, RowPadding = 6 };
+
+    QStringList         m_columnNames;
+    ITraceRowSource    *m_source;
+    QFont               m_font;
+
+    // The view asks for the cells of a row one after another, so the last
+    // row made is kept.
+    mutable int         m_cachedIndex;
+    mutable QStringList m_cachedCells;
+};
+
+#endif//_CTRACETABLEMODEL_H_
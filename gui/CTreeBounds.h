@@ -0,0 +1,224 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTreeBounds.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the CTreeBounds template, which keeps the
+///               bounding rectangle of every subtree of a tree so nodes can
+///               be found by position without searching the whole tree.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CTREEBOUNDS_H_
+#define _CTREEBOUNDS_H_
+
+#include <QVector>
+#include <QRect>
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeBounds
+///
+/// @description  Keeps in each node the smallest rectangle holding its
+///               position and the positions of all the nodes below it, so
+///               the tree is its own hierarchy of bounding boxes. A search
+///               for the nodes near a point only goes into the subtrees
+///               whose rectangles it meets, which for a laid out tree is a
+///               few subtrees on each level.
+///
+///               Moving a node only changes the rectangles on the path from
+///               it to the root, and moved() works them out again, stopping
+///               at the first that stays the same. Changes that are harder
+///               to follow make the rectangles invalid, and update() works
+///               them all out again before the next search.
+///
+///               Node is the node struct of the tree. It must have
+///               s_childList, s_parent, s_position and s_bounds.
+///
+/// @limitations  The rectangles are only right while every change to the
+///               tree is either followed by moved() or makes them invalid.
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+class CTreeBounds
+{
+public:
+    CTreeBounds();
+
+    void update( Node *root );
+    void moved( Node *node );
+    void invalidate();
+
+    bool isValid() const;
+
+private:
+    struct SPending
+    {
+        Node   *s_node;
+        bool    s_expanded;
+    };
+
+    static QRect nodeBounds( const Node *node );
+
+    bool    m_valid;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeBounds::CTreeBounds
+///
+/// @description  Makes the bounds, invalid until the first update().
+/// @pre          None
+/// @post         isValid() is false.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+CTreeBounds<Node>::CTreeBounds()
+{
+    m_valid = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeBounds::update
+///
+/// @description  Works out the rectangle of every subtree if they are not
+///               valid, children first. The tree is walked with a stack of
+///               its own, so any depth of tree can be bounded.
+/// @pre          None
+/// @post         Every node of the tree holds the rectangle of its subtree.
+///
+/// @param root:  The root of the tree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeBounds<Node>::update( Node *root )
+{
+    if( m_valid || root == NULL )
+        return;
+
+    QVector<SPending> stack;
+    SPending pending;
+    pending.s_node = root;
+    pending.s_expanded = false;
+    stack.append( pending );
+
+    while( !stack.isEmpty() )
+    {
+        pending = stack.last();
+        if( !pending.s_expanded )
+        {
+            // The node is bounded when it comes up again, after its children.
+            stack.last().s_expanded = true;
+            Node *cur = pending.s_node;
+            for( int i = 0; i < cur->s_childList.count(); ++i )
+            {
+                SPending next;
+                next.s_node = cur->s_childList[i];
+                next.s_expanded = false;
+                stack.append( next );
+            }
+            continue;
+        }
+        stack.pop_back();
+        pending.s_node->s_bounds = nodeBounds( pending.s_node );
+    }
+    m_valid = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeBounds::moved
+///
+/// @description  Works out the rectangles again after a node has moved or had
+///               children added or removed, from the node up to the root.
+/// @pre          The rectangles of the children of node are right.
+/// @post         Every node of the tree holds the rectangle of its subtree,
+///               if the rectangles are valid.
+///
+/// @param node:  The node that changed.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeBounds<Node>::moved( Node *node )
+{
+    if( !m_valid )
+        return;
+
+    for( Node *cur = node; cur != NULL; cur = cur->s_parent )
+    {
+        // The rectangles above are made from this one, so they stay too
+        // if it does. The node's own may already have been shifted with
+        // its subtree, so it does not end the walk.
+        QRect bounds = nodeBounds( cur );
+        if( bounds == cur->s_bounds && cur != node )
+            return;
+        cur->s_bounds = bounds;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeBounds::invalidate
+///
+/// @description  Marks the rectangles as no longer right, to be worked out
+///               again by the next update().
+/// @pre          None
+/// @post         isValid() is false.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeBounds<Node>::invalidate()
+{
+    m_valid = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeBounds::isValid
+///
+/// @description  Tells whether the rectangles are right.
+/// @pre          None
+/// @post         None
+///
+/// @return bool: True if every node holds the rectangle of its subtree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+bool CTreeBounds<Node>::isValid() const
+{
+    return m_valid;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeBounds::nodeBounds
+///
+/// @description  Returns the rectangle of a subtree from the node's position
+///               and the rectangles of its children.
+/// @pre          The rectangles of the children are right.
+/// @post         None
+///
+/// @param node:  The root of the subtree.
+///
+/// @return QRect: The rectangle.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+QRect CTreeBounds<Node>::nodeBounds( const Node *node )
+{
+    QRect bounds( node->s_position, node->s_position );
+    for( int i = 0; i < node->s_childList.count(); ++i )
+        bounds = bounds.united( node->s_childList[i]->s_bounds );
+    return bounds;
+}
+
+#endif//_CTREEBOUNDS_H_
@@ -0,0 +1,388 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTreeGeneratorBase.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the SGeneratorConfig
+///               struct and the CTreeGeneratorBase class.
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "CTreeGeneratorBase.h"
+#include "../gnat.h"
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QStringList>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////
+/// SGeneratorConfig::SGeneratorConfig
+///
+/// @description  This is the constructor for the SGeneratorConfig struct. It
+///               describes the small tree the generator has always offered
+///               first.
+/// @pre          None
+/// @post         None
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+SGeneratorConfig::SGeneratorConfig()
+{
+    s_seed      = 1;
+    s_depth     = 4;
+    s_minBranch = 1;
+    s_maxBranch = 4;
+    s_quiescent = 0;
+    s_maxNodes  = 1000000;
+    s_values    = NoValues;
+    s_minValue  = 0;
+    s_maxValue  = 100;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::CTreeGeneratorBase
+///
+/// @description  This is the constructor of the CTreeGeneratorBase class.
+/// @pre          None
+/// @post         The random numbers start from the seed of config.
+///
+/// @param config: The tree to make.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CTreeGeneratorBase::CTreeGeneratorBase( const SGeneratorConfig &config )
+: m_config( config )
+{
+    m_nodeCount = 1;
+    m_truncated = false;
+    m_state = config.s_seed;
+    m_haveSpare = false;
+    m_spare = 0.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::nodeCount
+///
+/// @description  Returns the number of nodes made so far, the root included.
+/// @pre          None
+/// @post         None
+///
+/// @return int:  The number of nodes.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CTreeGeneratorBase::nodeCount() const
+{
+    return m_nodeCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::isTruncated
+///
+/// @description  Tells whether the tree was cut short by the node limit.
+/// @pre          None
+/// @post         None
+///
+/// @return bool: True if nodes were left out to stay within the limit.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CTreeGeneratorBase::isTruncated() const
+{
+    return m_truncated;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::nodeName
+///
+/// @description  Returns the name of the index'th node in breadth first
+///               order: A to Z, then AA to ZZ, then AAA and so on, with no
+///               limit on the number of nodes.
+/// @pre          index is not negative.
+/// @post         None
+///
+/// @param index: The position of the node, from 0 for the root.
+///
+/// @return QString: The name.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+QString CTreeGeneratorBase::nodeName( int index )
+{
+    QString name;
+    for( int n = index + 1; n > 0; n = ( n - 1 ) / 26 )
+        name.prepend( QChar( 'A' + ( n - 1 ) % 26 ) );
+    return name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::askConfig
+///
+/// @description  Prompts the user for the depth, branching factors,
+///               quiescent percentage, node limit, seed and node values of
+///               a random tree. The dialogs start at the values last entered.
+/// @pre          None
+/// @post         config holds the answers if the user did not cancel.
+///
+/// @param parent: The widget the dialogs belong to.
+/// @param config: Set to the tree described.
+///
+/// @return bool: False if the user cancelled or gave a bad range.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CTreeGeneratorBase::askConfig( QWidget *parent, SGeneratorConfig &config )
+{
+    // Declaring this static will make the dialogs default to the values most
+    // recently entered.
+    static SGeneratorConfig last;
+    SGeneratorConfig next = last;
+    bool ok;
+
+    next.s_depth = QInputDialog::getInteger( parent,
+                    QObject::tr("Depth"), QObject::tr("Enter depth"),
+                    next.s_depth, 0, 64, 1, &ok );
+    if( !ok ) return false;
+
+    next.s_minBranch = QInputDialog::getInteger( parent,
+                    QObject::tr("Branching Factor"),
+                    QObject::tr("Enter MIN branching factor"),
+                    next.s_minBranch, 1, 64, 1, &ok );
+    if( !ok ) return false;
+
+    next.s_maxBranch = QInputDialog::getInteger( parent,
+                    QObject::tr("Branching Factor"),
+                    QObject::tr("Enter MAX branching factor"),
+                    qMax( next.s_maxBranch, next.s_minBranch ),
+                    next.s_minBranch, 64, 1, &ok );
+    if( !ok ) return false;
+
+    next.s_quiescent = QInputDialog::getInteger( parent,
+                    QObject::tr("Quiescent Percentage"),
+                    QObject::tr("Enter Quiescent Percentage"),
+                    next.s_quiescent, 0, 100, 1, &ok );
+    if( !ok ) return false;
+
+    next.s_maxNodes = QInputDialog::getInteger( parent,
+                    QObject::tr("Node Limit"),
+                    QObject::tr("Enter the most nodes to make"),
+                    next.s_maxNodes, 1, 10000000, 1000, &ok );
+    if( !ok ) return false;
+
+    next.s_seed = QInputDialog::getInteger( parent,
+                    QObject::tr("Seed"),
+                    QObject::tr("Enter seed (the same seed gives the same "
+                                "tree)"),
+                    (int)next.s_seed, 0, 2147483647, 1, &ok );
+    if( !ok ) return false;
+
+    QStringList kinds;
+    kinds << QObject::tr("None") << QObject::tr("Uniform")
+          << QObject::tr("Normal");
+    QString kind = QInputDialog::getItem( parent,
+                    QObject::tr("Node Values"),
+                    QObject::tr("Choose how values are drawn"),
+                    kinds, (int)next.s_values, false, &ok );
+    if( !ok ) return false;
+    next.s_values = (SGeneratorConfig::EValueDistribution)kinds.indexOf( kind );
+
+    if( next.s_values != SGeneratorConfig::NoValues )
+    {
+        next.s_minValue = QInputDialog::getInteger( parent,
+                        QObject::tr("Minimum Value"),
+                        QObject::tr("Enter minimum value"), next.s_minValue,
+                        (int)MIN_FLOAT_VAL, (int)MAX_FLOAT_VAL, 1, &ok );
+        if( !ok ) return false;
+
+        next.s_maxValue = QInputDialog::getInteger( parent,
+                        QObject::tr("Maximum Value"),
+                        QObject::tr("Enter maximum value"), next.s_maxValue,
+                        (int)MIN_FLOAT_VAL, (int)MAX_FLOAT_VAL, 1, &ok );
+        if( !ok ) return false;
+
+        if( next.s_minValue >= next.s_maxValue )
+        {
+            QMessageBox::critical( NULL, QObject::tr("Error!"),
+                                   QObject::tr("Max value must be greater "
+                                               "than min value."),
+                                   QMessageBox::Ok, QMessageBox::NoButton );
+            return false;
+        }
+    }
+
+    last = next;
+    config = next;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::nextRandom
+///
+/// @description  Returns the next random number. The numbers come from the
+///               SplitMix64 sequence of the seed, so they are the same on
+///               every platform and for every run.
+/// @pre          None
+/// @post         The sequence moves on by one.
+///
+/// @return quint32: The number.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+quint32 CTreeGeneratorBase::nextRandom()
+{
+    m_state += Q_UINT64_C(0x9e3779b97f4a7c15);
+    quint64 z = m_state;
+    z = ( z ^ ( z >> 30 ) ) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+    z = ( z ^ ( z >> 27 ) ) * Q_UINT64_C(0x94d049bb133111eb);
+    z = z ^ ( z >> 31 );
+    return (quint32)( z >> 32 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::randomInt
+///
+/// @description  Returns a random whole number in a range.
+/// @pre          min <= max
+/// @post         The sequence moves on by one.
+///
+/// @param min:   The smallest number wanted.
+/// @param max:   The largest number wanted.
+///
+/// @return int:  The number.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CTreeGeneratorBase::randomInt( int min, int max )
+{
+    quint64 range = (quint64)( (qint64)max - min + 1 );
+    return (int)( min + (qint64)( ( nextRandom() * range ) >> 32 ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::randomPercent
+///
+/// @description  Returns true percent times in a hundred.
+/// @pre          None
+/// @post         The sequence moves on by one.
+///
+/// @param percent: The chance of true.
+///
+/// @return bool: The outcome.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CTreeGeneratorBase::randomPercent( int percent )
+{
+    return randomInt( 0, 99 ) < percent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::randomValue
+///
+/// @description  Returns a value for a node, drawn as the config asks. Normal
+///               values are centred in the range with a sixth of it as the
+///               standard deviation, and are kept inside it.
+/// @pre          None
+/// @post         The sequence moves on unless no values are wanted.
+///
+/// @return float: The value, a whole number, or 0 if no values are wanted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+float CTreeGeneratorBase::randomValue()
+{
+    switch( m_config.s_values )
+    {
+    case SGeneratorConfig::UniformValues:
+        return (float)randomInt( m_config.s_minValue, m_config.s_maxValue );
+
+    case SGeneratorConfig::NormalValues:
+    {
+        double mean = ( (double)m_config.s_minValue + m_config.s_maxValue )
+                      / 2.0;
+        double deviation = ( (double)m_config.s_maxValue
+                             - m_config.s_minValue ) / 6.0;
+        double value = floor( mean + deviation * randomNormal() + 0.5 );
+        return (float)qBound( (double)m_config.s_minValue, value,
+                              (double)m_config.s_maxValue );
+    }
+
+    default:
+        return 0.0F;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::branchCount
+///
+/// @description  Returns a random number of children for a node.
+/// @pre          None
+/// @post         The sequence moves on by one.
+///
+/// @return int:  A number between the branching factors.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CTreeGeneratorBase::branchCount()
+{
+    return randomInt( m_config.s_minBranch, m_config.s_maxBranch );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::randomUnit
+///
+/// @description  Returns a random number above 0 and below 1.
+/// @pre          None
+/// @post         The sequence moves on by one.
+///
+/// @return double: The number.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+double CTreeGeneratorBase::randomUnit()
+{
+    return ( nextRandom() + 0.5 ) / 4294967296.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase::randomNormal
+///
+/// @description  Returns a random number from the standard normal
+///               distribution, by the Box-Muller transform.
+/// @pre          None
+/// @post         The sequence moves on by two every other call.
+///
+/// @return double: The number.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+double CTreeGeneratorBase::randomNormal()
+{
+    if( m_haveSpare )
+    {
+        m_haveSpare = false;
+        return m_spare;
+    }
+
+    double radius = sqrt( -2.0 * log( randomUnit() ) );
+    double angle = 2.0 * 3.14159265358979323846 * randomUnit();
+    m_spare = radius * sin( angle );
+    m_haveSpare = true;
+    return radius * cos( angle );
+}
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTreeGeneratorBase.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the SGeneratorConfig
+///               struct and the CTreeGeneratorBase class, the parts of the
+///               random tree generators shared by the tree and chance tree
+///               views.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CTREEGENERATORBASE_H_
+#define _CTREEGENERATORBASE_H_
+
+#include <QString>
+#include <QtGlobal>
+
+class QWidget;
+
+////////////////////////////////////////////////////////////////////////////////
+/// SGeneratorConfig
+///
+/// @description  Describes a random tree. The same description, seed
+///               included, always gives the same tree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SGeneratorConfig
+{
+    enum EValueDistribution { NoValues, UniformValues, NormalValues };
+
+    SGeneratorConfig();
+
+    quint32             s_seed;
+    int                 s_depth;
+    int                 s_minBranch;
+    int                 s_maxBranch;
+    int                 s_quiescent;    // percent of nodes made quiescent
+    int                 s_maxNodes;
+    EValueDistribution  s_values;
+    int                 s_minValue;
+    int                 s_maxValue;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGeneratorBase
+///
+/// @description  The parts of a random tree generator that do not depend on
+///               the kind of node: the random numbers, drawn from the seed
+///               alone so that no other use of rand() changes the tree, the
+///               node values, and the names given to generated nodes.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CTreeGeneratorBase
+{
+public:
+    CTreeGeneratorBase( const SGeneratorConfig &config );
+
+    int nodeCount() const;
+    bool isTruncated() const;
+
+    static QString nodeName( int index );
+    static bool askConfig( QWidget *parent, SGeneratorConfig &config );
+
+protected:
+    quint32 nextRandom();
+    int randomInt( int min, int max );
+    bool randomPercent( int percent );
+    float randomValue();
+    int branchCount();
+
+    SGeneratorConfig    m_config;
+    int                 m_nodeCount;
+    bool                m_truncated;
+
+private:
+    double randomUnit();
+    double randomNormal();
+
+    quint64             m_state;
+    // randomNormal() makes two numbers at a time and keeps the second.
+    bool                m_haveSpare;
+    double              m_spare;
+};
+
+#endif//_CTREEGENERATORBASE_H_
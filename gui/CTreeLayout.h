@@ -0,0 +1,757 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTreeLayout.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the CTreeLayout template, which places the
+///               nodes of a tree so that it is drawn tidily and narrowly.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CTREELAYOUT_H_
+#define _CTREELAYOUT_H_
+
+#include <QVector>
+#include <QHash>
+#include <QPoint>
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout
+///
+/// @description  Places the nodes of a tree a level apart, each parent
+///               centred over its first and last child, with every subtree
+///               pushed as close to the one on its left as the levels they
+///               share allow. This is the layout of Walker, in the linear
+///               time form of Buchheim, Junger and Leipert and of van der
+///               Ploeg: a subtree is laid out once, relative to its root, and
+///               its left and right outlines are followed down by threads
+///               from the bottom of a short subtree into a deeper neighbour,
+///               so placing a subtree beside its siblings only walks as many
+///               levels as the shorter side has.
+///
+///               The layout is kept after it is made. When a node gains or
+///               loses children only the subtrees on the path from it to the
+///               root are merged again: beginChange() takes those merges
+///               apart, threads and all, before the tree is edited and
+///               endChange() redoes them afterwards. Nodes whose place did
+///               not change are not written again.
+///
+///               Node is the node struct of the tree. It must have
+///               s_childList, s_parent and s_position.
+///
+/// @limitations  The layout refers to the nodes it was made from. It must be
+///               cleared before any of them are deleted other than through
+///               forget(), and after any edit that does not go through
+///               beginChange() and endChange().
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+class CTreeLayout
+{
+public:
+    CTreeLayout();
+    ~CTreeLayout();
+
+    void layout( Node *root, int left, int top, int xSpacing, int ySpacing );
+    void beginChange( Node *node );
+    void endChange( Node *node );
+    void forget( Node *node );
+    void clear();
+
+    bool isValid() const;
+
+private:
+    struct SLayoutNode;
+
+    // A thread set while merging the children of a node, and how much the
+    // node at its top was moved against its own modifier, to be undone.
+    struct SThread
+    {
+        SLayoutNode *s_node;
+        bool         s_left;
+        qreal        s_diff;
+    };
+
+    struct SLayoutNode
+    {
+        Node               *s_node;
+        int                 s_depth;
+        // The place relative to the parent's children before the parent's
+        // modifiers, and the shift of this node and its subtree.
+        qreal               s_prelim;
+        qreal               s_mod;
+        // The deepest node on the left and right outlines of the subtree,
+        // and the sum of the modifiers down to each.
+        SLayoutNode        *s_el;
+        SLayoutNode        *s_er;
+        qreal               s_msel;
+        qreal               s_mser;
+        // The next node of the left and right outlines below a leaf.
+        SLayoutNode        *s_tl;
+        SLayoutNode        *s_tr;
+        SLayoutNode        *s_first;
+        SLayoutNode        *s_last;
+        QVector<SThread>    s_threads;
+        // The x the node was last placed at.
+        qreal               s_x;
+        bool                s_dirty;
+    };
+
+    struct SPending
+    {
+        Node   *s_node;
+        int     s_depth;
+        bool    s_expanded;
+    };
+
+    struct SPlacing
+    {
+        SLayoutNode    *s_entry;
+        qreal           s_modSum;
+    };
+
+    SLayoutNode *entry( const Node *node ) const;
+    void firstWalk( Node *node, int depth );
+    void merge( SLayoutNode *t );
+    void unmerge( SLayoutNode *t );
+    void separate( SLayoutNode *t, SLayoutNode *left, SLayoutNode *right );
+    void setExtremes( SLayoutNode *t );
+    void place( bool full );
+
+    static SLayoutNode *nextLeft( const SLayoutNode *t );
+    static SLayoutNode *nextRight( const SLayoutNode *t );
+
+    QHash<const Node *, SLayoutNode *>  m_entries;
+    Node                               *m_root;
+    int                                 m_left;
+    int                                 m_top;
+    int                                 m_xSpacing;
+    int                                 m_ySpacing;
+    // What is added to the x of every node relative to the root.
+    qreal                               m_frame;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::CTreeLayout
+///
+/// @description  Makes an empty layout.
+/// @pre          None
+/// @post         isValid() is false.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+CTreeLayout<Node>::CTreeLayout()
+{
+    m_root = NULL;
+    m_left = 0;
+    m_top = 0;
+    m_xSpacing = 1;
+    m_ySpacing = 1;
+    m_frame = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::~CTreeLayout
+///
+/// @description  Frees the layout. The nodes are left alone.
+/// @pre          None
+/// @post         None
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+CTreeLayout<Node>::~CTreeLayout()
+{
+    clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::layout
+///
+/// @description  Lays out the whole tree below root and moves every node to
+///               its place. The leftmost node is put at left and the root at
+///               top.
+/// @pre          None
+/// @post         Every node of the tree is placed and the layout is kept for
+///               later changes, unless root is NULL.
+///
+/// @param root:     The root of the tree.
+/// @param left:     The x of the leftmost node.
+/// @param top:      The y of the root.
+/// @param xSpacing: The distance between the centres of neighbouring nodes.
+/// @param ySpacing: The distance between levels.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::layout( Node *root, int left, int top, int xSpacing,
+                                int ySpacing )
+{
+    clear();
+    if( root == NULL )
+        return;
+
+    m_root = root;
+    m_left = left;
+    m_top = top;
+    m_xSpacing = xSpacing;
+    m_ySpacing = ySpacing;
+    firstWalk( root, 0 );
+    place( true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::beginChange
+///
+/// @description  Gets ready for the children of a node to change. The merges
+///               of the node and everything above it are taken apart, so the
+///               subtrees beside the path are as they were when first laid
+///               out on their own.
+/// @pre          The children of node have not been changed yet.
+/// @post         endChange( node ) must be called once they have, or the
+///               layout cleared. The layout is cleared if node is not in it.
+///
+/// @param node:  The node whose children are about to change.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::beginChange( Node *node )
+{
+    if( !isValid() )
+        return;
+
+    QVector<SLayoutNode *> path;
+    for( Node *cur = node; cur != NULL; cur = cur->s_parent )
+    {
+        SLayoutNode *t = entry( cur );
+        if( t == NULL )
+        {
+            clear();
+            return;
+        }
+        path.append( t );
+    }
+    if( path.last()->s_node != m_root )
+    {
+        clear();
+        return;
+    }
+
+    // The root was merged last, so it is taken apart first.
+    for( int i = path.count() - 1; i >= 0; --i )
+    {
+        unmerge( path[i] );
+        path[i]->s_dirty = true;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::endChange
+///
+/// @description  Lays out the new children of a node, merges the subtrees on
+///               the path from it to the root again and moves the nodes whose
+///               places changed. The tree only moves right if it would
+///               otherwise go past the left edge it was laid out against.
+/// @pre          beginChange( node ) was called before its children changed,
+///               and removed children were forgotten.
+/// @post         Every node of the tree is placed.
+///
+/// @param node:  The node whose children changed.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::endChange( Node *node )
+{
+    if( !isValid() )
+        return;
+
+    SLayoutNode *t = entry( node );
+    if( t == NULL )
+    {
+        clear();
+        return;
+    }
+
+    for( int i = 0; i < node->s_childList.count(); ++i )
+    {
+        Node *child = node->s_childList[i];
+        if( entry( child ) == NULL )
+            firstWalk( child, t->s_depth + 1 );
+    }
+
+    for( Node *cur = node; cur != NULL; cur = cur->s_parent )
+        merge( entry( cur ) );
+    place( false );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::forget
+///
+/// @description  Drops a subtree from the layout, for when it is about to be
+///               taken out of the tree.
+/// @pre          beginChange() was called for the parent of node.
+/// @post         None of the subtree's nodes are in the layout.
+///
+/// @param node:  The root of the subtree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::forget( Node *node )
+{
+    if( node == m_root )
+    {
+        clear();
+        return;
+    }
+
+    QVector<Node *> stack;
+    stack.append( node );
+    while( !stack.isEmpty() )
+    {
+        Node *cur = stack.last();
+        stack.pop_back();
+        delete m_entries.take( cur );
+        for( int i = 0; i < cur->s_childList.count(); ++i )
+            stack.append( cur->s_childList[i] );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::clear
+///
+/// @description  Throws the layout away. The nodes stay where they are.
+/// @pre          None
+/// @post         isValid() is false.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::clear()
+{
+    qDeleteAll( m_entries );
+    m_entries.clear();
+    m_root = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::isValid
+///
+/// @description  Tells whether there is a layout to change.
+/// @pre          None
+/// @post         None
+///
+/// @return bool: True if a tree has been laid out since the layout was last
+///               cleared.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+bool CTreeLayout<Node>::isValid() const
+{
+    return m_root != NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::entry
+///
+/// @description  Returns the layout of a node.
+/// @pre          None
+/// @post         None
+///
+/// @param node:  The node.
+///
+/// @return SLayoutNode *: The layout of the node, or NULL if it has none.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+typename CTreeLayout<Node>::SLayoutNode *
+CTreeLayout<Node>::entry( const Node *node ) const
+{
+    return m_entries.value( node, NULL );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::firstWalk
+///
+/// @description  Lays out a subtree relative to its root, children first.
+///               The tree is walked with a stack of its own, so any depth of
+///               tree can be laid out.
+/// @pre          None of the nodes of the subtree are in the layout.
+/// @post         Every node of the subtree has a layout, merged with its
+///               siblings.
+///
+/// @param node:  The root of the subtree.
+/// @param depth: The level of node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::firstWalk( Node *node, int depth )
+{
+    QVector<SPending> stack;
+    SPending pending;
+    pending.s_node = node;
+    pending.s_depth = depth;
+    pending.s_expanded = false;
+    stack.append( pending );
+
+    while( !stack.isEmpty() )
+    {
+        pending = stack.last();
+        if( !pending.s_expanded )
+        {
+            // The node is merged when it comes up again, after its children.
+            stack.last().s_expanded = true;
+            Node *cur = pending.s_node;
+            for( int i = 0; i < cur->s_childList.count(); ++i )
+            {
+                SPending next;
+                next.s_node = cur->s_childList[i];
+                next.s_depth = pending.s_depth + 1;
+                next.s_expanded = false;
+                stack.append( next );
+            }
+            continue;
+        }
+        stack.pop_back();
+
+        SLayoutNode *t = new SLayoutNode;
+        t->s_node = pending.s_node;
+        t->s_depth = pending.s_depth;
+        t->s_prelim = 0;
+        t->s_mod = 0;
+        t->s_tl = NULL;
+        t->s_tr = NULL;
+        t->s_x = 0;
+        t->s_dirty = true;
+        m_entries.insert( pending.s_node, t );
+        merge( t );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::merge
+///
+/// @description  Places the children of a node side by side, each as close
+///               to those before it as their outlines allow, and centres the
+///               node over its first and last child.
+/// @pre          The children are laid out and not merged.
+/// @post         The node's subtree is laid out relative to the node.
+///
+/// @param t:     The node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::merge( SLayoutNode *t )
+{
+    const Node *node = t->s_node;
+    t->s_threads.clear();
+    t->s_first = NULL;
+    t->s_last = NULL;
+    if( node->s_childList.isEmpty() )
+    {
+        t->s_prelim = 0;
+        setExtremes( t );
+        return;
+    }
+
+    SLayoutNode *prev = entry( node->s_childList.first() );
+    t->s_first = prev;
+    for( int i = 1; i < node->s_childList.count(); ++i )
+    {
+        SLayoutNode *cur = entry( node->s_childList[i] );
+        separate( t, prev, cur );
+        prev = cur;
+    }
+    t->s_last = prev;
+
+    t->s_prelim = ( t->s_first->s_prelim + t->s_first->s_mod
+                    + t->s_last->s_mod + t->s_last->s_prelim ) / 2;
+    setExtremes( t );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::unmerge
+///
+/// @description  Undoes merge(): takes out the threads it set, with the moves
+///               that went with them, and puts the children back at their
+///               own outlines with no shift.
+/// @pre          The node is merged and none of its ancestors are.
+/// @post         Each child's subtree is laid out as it was before the merge.
+///
+/// @param t:     The node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::unmerge( SLayoutNode *t )
+{
+    for( int i = t->s_threads.count() - 1; i >= 0; --i )
+    {
+        const SThread &thread = t->s_threads[i];
+        if( thread.s_left )
+            thread.s_node->s_tl = NULL;
+        else
+            thread.s_node->s_tr = NULL;
+        thread.s_node->s_mod -= thread.s_diff;
+        thread.s_node->s_prelim += thread.s_diff;
+    }
+    t->s_threads.clear();
+
+    const Node *node = t->s_node;
+    for( int i = 0; i < node->s_childList.count(); ++i )
+    {
+        SLayoutNode *child = entry( node->s_childList[i] );
+        child->s_mod = 0;
+        setExtremes( child );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::separate
+///
+/// @description  Moves a child of a node right until it is at least the node
+///               spacing clear of the children before it on every level they
+///               share. If one side is deeper, the outline of the other is
+///               threaded on into it.
+/// @pre          left is the child before right, and the children up to left
+///               are merged.
+/// @post         The children up to right are merged.
+///
+/// @param t:     The parent.
+/// @param left:  The child before right.
+/// @param right: The child being placed.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::separate( SLayoutNode *t, SLayoutNode *left,
+                                  SLayoutNode *right )
+{
+    // The right outline of the children so far and the left outline of the
+    // new one, with the sum of the modifiers down to each.
+    SLayoutNode *sr = left;
+    SLayoutNode *cl = right;
+    qreal mssr = sr->s_mod;
+    qreal mscl = cl->s_mod;
+    while( sr != NULL && cl != NULL )
+    {
+        qreal dist = ( mssr + sr->s_prelim + m_xSpacing )
+                   - ( mscl + cl->s_prelim );
+        if( dist > 0 )
+        {
+            mscl += dist;
+            right->s_mod += dist;
+            right->s_msel += dist;
+            right->s_mser += dist;
+        }
+
+        sr = nextRight( sr );
+        if( sr != NULL )
+            mssr += sr->s_mod;
+        cl = nextLeft( cl );
+        if( cl != NULL )
+            mscl += cl->s_mod;
+    }
+
+    SThread thread;
+    if( sr == NULL && cl != NULL )
+    {
+        // The new child is deeper: the left outline of all the children
+        // goes on down its own.
+        SLayoutNode *first = t->s_first;
+        SLayoutNode *li = first->s_el;
+        thread.s_node = li;
+        thread.s_left = true;
+        thread.s_diff = ( mscl - cl->s_mod ) - first->s_msel;
+        li->s_tl = cl;
+        li->s_mod += thread.s_diff;
+        li->s_prelim -= thread.s_diff;
+        t->s_threads.append( thread );
+        first->s_el = right->s_el;
+        first->s_msel = right->s_msel;
+    }
+    else if( sr != NULL && cl == NULL )
+    {
+        // The children before are deeper: the right outline of the new
+        // child goes on down theirs.
+        SLayoutNode *ri = right->s_er;
+        thread.s_node = ri;
+        thread.s_left = false;
+        thread.s_diff = ( mssr - sr->s_mod ) - right->s_mser;
+        ri->s_tr = sr;
+        ri->s_mod += thread.s_diff;
+        ri->s_prelim -= thread.s_diff;
+        t->s_threads.append( thread );
+        right->s_er = left->s_er;
+        right->s_mser = left->s_mser;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::setExtremes
+///
+/// @description  Finds the deepest nodes of the left and right outlines of a
+///               subtree from those of its first and last child.
+/// @pre          The children are merged with each other.
+/// @post         The extremes of the subtree are set.
+///
+/// @param t:     The root of the subtree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::setExtremes( SLayoutNode *t )
+{
+    if( t->s_first == NULL )
+    {
+        t->s_el = t;
+        t->s_er = t;
+        t->s_msel = 0;
+        t->s_mser = 0;
+    }
+    else
+    {
+        t->s_el = t->s_first->s_el;
+        t->s_msel = t->s_first->s_msel;
+        t->s_er = t->s_last->s_er;
+        t->s_mser = t->s_last->s_mser;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::place
+///
+/// @description  Adds up the modifiers from the root down and moves the
+///               nodes to their places. A subtree that was not changed and
+///               whose root did not move is skipped, as none of its nodes
+///               moved either.
+/// @pre          The tree is laid out.
+/// @post         Every node is at its place.
+///
+/// @param full:  True to put the leftmost node at the left edge and move
+///               every node, false to keep the root where it was unless the
+///               tree would go past the left edge.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+void CTreeLayout<Node>::place( bool full )
+{
+    // The leftmost node is on the left outline of the root.
+    SLayoutNode *t = entry( m_root );
+    qreal modSum = t->s_mod;
+    qreal minX = t->s_prelim + modSum;
+    for( t = nextLeft( t ); t != NULL; t = nextLeft( t ) )
+    {
+        modSum += t->s_mod;
+        minX = qMin( minX, t->s_prelim + modSum );
+    }
+
+    if( full || minX + m_frame < m_left )
+    {
+        full = true;
+        m_frame = m_left - minX;
+    }
+
+    QVector<SPlacing> stack;
+    SPlacing placing;
+    placing.s_entry = entry( m_root );
+    placing.s_modSum = 0;
+    stack.append( placing );
+    while( !stack.isEmpty() )
+    {
+        placing = stack.last();
+        stack.pop_back();
+
+        t = placing.s_entry;
+        modSum = placing.s_modSum + t->s_mod;
+        qreal x = t->s_prelim + modSum + m_frame;
+        if( !full && !t->s_dirty && x == t->s_x )
+            continue;
+
+        t->s_x = x;
+        t->s_dirty = false;
+        t->s_node->s_position = QPoint( qRound( x ),
+                                        m_top + t->s_depth * m_ySpacing );
+
+        const Node *node = t->s_node;
+        for( int i = 0; i < node->s_childList.count(); ++i )
+        {
+            SPlacing next;
+            next.s_entry = entry( node->s_childList[i] );
+            next.s_modSum = modSum;
+            stack.append( next );
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::nextLeft
+///
+/// @description  Returns the node below on the left outline of a subtree.
+/// @pre          None
+/// @post         None
+///
+/// @param t:     A node of the outline.
+///
+/// @return SLayoutNode *: The first child, or the thread of a leaf, or NULL
+///                        at the bottom of the outline.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+typename CTreeLayout<Node>::SLayoutNode *
+CTreeLayout<Node>::nextLeft( const SLayoutNode *t )
+{
+    return t->s_first != NULL ? t->s_first : t->s_tl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeLayout::nextRight
+///
+/// @description  Returns the node below on the right outline of a subtree.
+/// @pre          None
+/// @post         None
+///
+/// @param t:     A node of the outline.
+///
+/// @return SLayoutNode *: The last child, or the thread of a leaf, or NULL
+///                        at the bottom of the outline.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+template<class Node>
+typename CTreeLayout<Node>::SLayoutNode *
+CTreeLayout<Node>::nextRight( const SLayoutNode *t )
+{
+    return t->s_last != NULL ? t->s_last : t->s_tr;
+}
+
+#endif//_CTREELAYOUT_H_
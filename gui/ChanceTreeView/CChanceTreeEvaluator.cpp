@@ -0,0 +1,187 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CChanceTreeEvaluator.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the
+///               CChanceTreeEvaluator class.
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "CChanceTreeEvaluator.h"
+#include "CChanceTreeGraph.h"
+#include "CCompiledChanceTree.h"
+#include <QHash>
+#include <climits>
+
+////////////////////////////////////////////////////////////////////////////////
+/// SShareKey
+///
+/// @description  What a node of a level must match for another node to share
+///               its value: the same subtree, the same depth left and the
+///               same player to move.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SShareKey
+{
+    int     s_shape;
+    int     s_depth;
+    int     s_qsDepth;
+    bool    s_max;
+
+    bool operator==( const SShareKey &other ) const
+    {
+        return s_shape == other.s_shape && s_depth == other.s_depth
+            && s_qsDepth == other.s_qsDepth && s_max == other.s_max;
+    }
+};
+
+inline uint qHash( const SShareKey &key )
+{
+    return qHash( key.s_shape ) ^ qHash( key.s_depth * 31 + key.s_qsDepth )
+        ^ ( key.s_max ? 0x9e3779b9U : 0U );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeEvaluator::evaluate
+///
+/// @description  Copies the tree below root a level at a time and works out
+///               the value of every node in the copy. The copy stops at the
+///               end points: leaves, and min and max nodes at the depth limit
+///               that are not quiescent or have no quiescence depth left.
+///               Only moves into a min or max node use up depth, so a chance
+///               node and its outcomes are at the same depth. A node with
+///               the same subtree, depth left and player to move as one
+///               before it in its level shares its value.
+/// @pre          None
+/// @post         value() gives the expectiminimax value of every node of the
+///               copy and node() the node it belongs to.
+///
+/// @param root:       The root of the tree, or NULL.
+/// @param depthLimit: The depth of the search, or less than 0 for none.
+/// @param qsDepth:    The quiescence depth of the search.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeEvaluator::evaluate( SChanceTreeNode *root, int depthLimit,
+                                     int qsDepth )
+{
+    clearLevels();
+    m_nodes.clear();
+    if( root == NULL )
+        return;
+    if( depthLimit < 0 )
+        depthLimit = INT_MAX;
+
+    // The shapes of the nodes, for finding the same subtree twice.
+    CCompiledChanceTree tree;
+    tree.compile( root );
+
+    // The depth and quiescence depth left below each node of the copy,
+    // whether max moves there or, at a chance node, right after it, and its
+    // number in the compiled tree.
+    QVector<int> depths;
+    QVector<int> qsDepths;
+    QVector<bool> maxes;
+    QVector<int> ids;
+    // The first node of the next level with each key.
+    QHash<SShareKey, int> shared;
+
+    ENodeKind rootKind = root->s_chance ? ChanceNode : MaxNode;
+    addNode( root->s_childList.isEmpty() ? EndPoint : rootKind,
+             root->s_value, 1.0 );
+    m_nodes.append( root );
+    depths.append( depthLimit );
+    qsDepths.append( qsDepth );
+    maxes.append( true );
+    ids.append( 0 );
+    endLevel();
+
+    for( int level = 0; level < levelCount(); ++level )
+    {
+        shared.clear();
+        for( int i = levelStart( level ); i < levelEnd( level ); ++i )
+        {
+            if( kind( i ) == EndPoint || kind( i ) == SharedNode )
+                continue;
+
+            const SChanceTreeNode *node = m_nodes[i];
+            bool chance = kind( i ) == ChanceNode;
+            // The outcomes of a chance node are moves of the player who
+            // faces it; after a min or max node the other player moves.
+            bool max = chance ? maxes[i] : !maxes[i];
+            int first = count();
+            for( int c = 0; c < node->s_childList.count(); ++c )
+            {
+                SChanceTreeNode *child = node->s_childList[c];
+                int id = tree.child( ids[i], c );
+                int depth = depths[i];
+                int qs = qsDepths[i];
+                bool isEndPoint = child->s_childList.isEmpty();
+                ENodeKind childKind = ChanceNode;
+                if( !child->s_chance )
+                {
+                    if( depth > 0 )
+                        depth--;
+                    else
+                        qs--;
+                    if( depth == 0 && (!child->s_quiescent || qs <= 0) )
+                        isEndPoint = true;
+                    childKind = max ? MaxNode : MinNode;
+                }
+
+                qreal weight = chance ? child->s_probability / 100.0 : 1.0;
+                int index = addNode( isEndPoint ? EndPoint : childKind,
+                                     child->s_value, weight );
+                m_nodes.append( child );
+                depths.append( depth );
+                qsDepths.append( qs );
+                maxes.append( max );
+                ids.append( id );
+
+                if( !isEndPoint )
+                {
+                    SShareKey key;
+                    key.s_shape = tree.shape( id );
+                    key.s_depth = depth;
+                    key.s_qsDepth = qs;
+                    key.s_max = max;
+                    int match = shared.value( key, -1 );
+                    if( match >= 0 )
+                        shareNode( index, match );
+                    else
+                        shared.insert( key, index );
+                }
+            }
+            setChildren( i, first, count() - first );
+        }
+        endLevel();
+    }
+
+    propagate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeEvaluator::node
+///
+/// @description  Returns the node of the tree a node of the copy stands for.
+/// @pre          index is a node of the copy.
+/// @post         None
+///
+/// @param index: The place of the node in the copy.
+///
+/// @return SChanceTreeNode *: The node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+SChanceTreeNode *CChanceTreeEvaluator::node( int index ) const
+{
+    return m_nodes[index];
+}
@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CChanceTreeEvaluator.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the
+///               CChanceTreeEvaluator class, which finds the expectiminimax
+///               value of every node of a chance tree.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CCHANCETREEEVALUATOR_H_
+#define _CCHANCETREEEVALUATOR_H_
+
+#include "../CLevelEvaluator.h"
+
+struct SChanceTreeNode;
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeEvaluator
+///
+/// @description  Finds the expectiminimax value of every node of a chance
+///               tree, the root being a max node. A chance node is worth the
+///               sum of its children weighted by their probabilities. Depth
+///               is counted in moves, as the expectimax tracer counts it, and
+///               the same quiescence rules make a node an end point, so the
+///               value of the root is the one a full trace returns.
+///
+/// @limitations  The copy refers to the nodes it was made from and must not
+///               outlive them.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CChanceTreeEvaluator : public CLevelEvaluator
+{
+public:
+    void evaluate( SChanceTreeNode *root, int depthLimit, int qsDepth );
+
+    SChanceTreeNode *node( int index ) const;
+
+private:
+    QVector<SChanceTreeNode *>    m_nodes;
+};
+
+#endif//_CCHANCETREEEVALUATOR_H_
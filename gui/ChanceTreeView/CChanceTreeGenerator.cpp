@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CChanceTreeGenerator.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the
+///               CChanceTreeGenerator class.
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "CChanceTreeGenerator.h"
+#include "CChanceTreeGraph.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGenerator::CChanceTreeGenerator
+///
+/// @description  This is the constructor of the CChanceTreeGenerator class.
+/// @pre          None
+/// @post         None
+///
+/// @param config: The tree to make.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CChanceTreeGenerator::CChanceTreeGenerator( const SGeneratorConfig &config )
+: CTreeGeneratorBase( config )
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGenerator::generate
+///
+/// @description  Grows a random chance tree below root, a move at a time.
+///               Max and min nodes other than the root may be made quiescent
+///               and are given values if the config asks for them.
+/// @pre          root is a max or min node with no children.
+/// @post         The tree is made, or as much of it as the node limit
+///               allows; isTruncated() tells which.
+///
+/// @param root:  The root of the new tree.
+///
+/// @limitations  A move is only made if the chance node and every outcome
+///               it could have fit within the node limit, so a truncated
+///               tree may stop a little short of it.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeGenerator::generate( SChanceTreeNode *root )
+{
+    QVector<SChanceTreeNode *> level;
+    QVector<SChanceTreeNode *> nextLevel;
+    SChanceTreeNode *parent;
+
+    root->s_value = randomValue();
+    level.append( root );
+
+    for( int depth = 0; depth < m_config.s_depth && !m_truncated; depth++ )
+    {
+        nextLevel.clear();
+
+        foreach( parent, level )
+        {
+            int branch = branchCount();
+            parent->s_childList.reserve( branch );
+
+            for( int i = 0; i < branch; i++ )
+            {
+                if( m_nodeCount + 1 + m_config.s_maxBranch
+                    > m_config.s_maxNodes )
+                {
+                    m_truncated = true;
+                    break;
+                }
+
+                SChanceTreeNode *chance = new SChanceTreeNode;
+                chance->s_parent = parent;
+                chance->s_chance = true;
+                chance->s_max = parent->s_max;
+                parent->s_childList.append( chance );
+                m_nodeCount++;
+
+                addOutcomes( chance, nextLevel );
+            }
+
+            if( m_truncated )
+                break;
+        }
+
+        level = nextLevel;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGenerator::addOutcomes
+///
+/// @description  Gives a chance node a random number of outcomes.
+/// @pre          chance is a chance node with no children.
+/// @post         The outcomes are added to chance and to nextLevel.
+///
+/// @param chance:    The chance node.
+/// @param nextLevel: The nodes that make the next move.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeGenerator::addOutcomes( SChanceTreeNode *chance,
+                                        QVector<SChanceTreeNode *> &nextLevel )
+{
+    QVector<int> probabilities = randomProbabilities( branchCount() );
+
+    chance->s_childList.reserve( probabilities.count() );
+    for( int i = 0; i < probabilities.count(); i++ )
+    {
+        SChanceTreeNode *child = new SChanceTreeNode;
+        child->s_parent = chance;
+        child->s_chance = false;
+        child->s_max = !chance->s_max;
+        child->s_probability = probabilities[i];
+        child->s_quiescent = randomPercent( m_config.s_quiescent );
+        child->s_value = randomValue();
+        chance->s_childList.append( child );
+        nextLevel.append( child );
+    }
+    m_nodeCount += probabilities.count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGenerator::randomProbabilities
+///
+/// @description  Returns random percentages for the outcomes of a chance
+///               node. Each is at least 1 and together they make 100.
+/// @pre          0 < outcomes <= 100
+/// @post         None
+///
+/// @param outcomes: The number of outcomes.
+///
+/// @return QVector<int>: The percentage of each outcome.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+QVector<int> CChanceTreeGenerator::randomProbabilities( int outcomes )
+{
+    QVector<int> weights( outcomes );
+    int total = 0;
+    for( int i = 0; i < outcomes; i++ )
+    {
+        weights[i] = randomInt( 1, 100 );
+        total += weights[i];
+    }
+
+    // Each outcome gets 1, and what is left is shared by weight. What the
+    // rounding down leaves over goes to the first outcomes.
+    int spare = 100 - outcomes;
+    QVector<int> probabilities( outcomes );
+    int given = 0;
+    for( int i = 0; i < outcomes; i++ )
+    {
+        probabilities[i] = 1 + spare * weights[i] / total;
+        given += probabilities[i];
+    }
+    for( int i = 0; given < 100; i = ( i + 1 ) % outcomes, given++ )
+        probabilities[i]++;
+
+    return probabilities;
+}
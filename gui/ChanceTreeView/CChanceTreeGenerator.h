@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CChanceTreeGenerator.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the
+///               CChanceTreeGenerator class, which makes random trees for the
+///               chance tree view.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CCHANCETREEGENERATOR_H_
+#define _CCHANCETREEGENERATOR_H_
+
+#include "../CTreeGeneratorBase.h"
+#include <QVector>
+
+struct SChanceTreeNode;
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGenerator
+///
+/// @description  Makes a random chance tree from an SGeneratorConfig. The
+///               depth counts moves: each child of a max or min node is a
+///               chance node, whose children are the outcomes, nodes of the
+///               other player with probabilities that add up to 100. A
+///               chance node always gets its outcomes, so the tracers never
+///               meet a chance leaf. Like CTreeGenerator, the tree is made a
+///               level at a time.
+///
+/// @limitations  The nodes are not named or laid out; that is left to the
+///               model.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CChanceTreeGenerator : public CTreeGeneratorBase
+{
+public:
+    CChanceTreeGenerator( const SGeneratorConfig &config );
+
+    void generate( SChanceTreeNode *root );
+
+private:
+    void addOutcomes( SChanceTreeNode *chance,
+                      QVector<SChanceTreeNode *> &nextLevel );
+    QVector<int> randomProbabilities( int outcomes );
+};
+
+#endif//_CCHANCETREEGENERATOR_H_
@@ -361,6 +361,8 @@ SChanceTreeNode::SChanceTreeNode() : s_probPosition(-100,-100)
     s_quiescent = false;
     s_value     = 0.0F;
     s_history   = 0;
+    s_backedUpValue = 0.0F;
+    s_evaluation = 0;
     s_parent    = NULL;
     s_chance    = false;
     s_max       = true;
@@ -383,3 +385,39 @@ SChanceTreeNode::~SChanceTreeNode()
     while( !s_childList.isEmpty() )
         delete s_childList.takeFirst();
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// SChanceTreeNode::clone
+///
+/// @description  Makes a deep copy of the node and everything below it.
+/// @pre          None
+/// @post         None
+///
+/// @return SChanceTreeNode *: The copy. Its parent is NULL and the caller owns
+///                            it.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+SChanceTreeNode *SChanceTreeNode::clone() const
+{
+    SChanceTreeNode *node = new SChanceTreeNode;
+    node->s_name = s_name;
+    node->s_chance = s_chance;
+    node->s_probability = s_probability;
+    node->s_max = s_max;
+    node->s_quiescent = s_quiescent;
+    node->s_value = s_value;
+    node->s_history = s_history;
+    node->s_position = s_position;
+    node->s_probPosition = s_probPosition;
+
+    const SChanceTreeNode *child;
+    foreach( child, s_childList )
+    {
+        SChanceTreeNode *childCopy = child->clone();
+        childCopy->s_parent = node;
+        node->s_childList.append( childCopy );
+    }
+    return node;
+}
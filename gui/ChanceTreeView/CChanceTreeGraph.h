@@ -18,6 +18,7 @@
 #include <QString>
 #include <QList>
 #include <QPoint>
+#include <QRect>
 #include <QDataStream>
 
 struct SChanceTreeNode;
@@ -78,6 +79,8 @@ struct SChanceTreeNode
     SChanceTreeNode();
     ~SChanceTreeNode();
 
+    SChanceTreeNode *clone() const;
+
     ///This variable stores the name of the node.
     QString                 s_name;
 
@@ -99,12 +102,24 @@ struct SChanceTreeNode
     ///This variable stores the preset history table value
     int                     s_history;
 
+    ///This variable stores the value backed up to the node by the last
+    ///evaluation of the tree that reached it.
+    qreal                   s_backedUpValue;
+
+    ///This variable stores the number of the evaluation that set
+    ///s_backedUpValue, or 0 if none has.
+    int                     s_evaluation;
+
     ///This variable stores a pointer to the parent node of the node.
     SChanceTreeNode              *s_parent;
 
     ///This variable stores the location on the screen of the node.
     QPoint                  s_position;
 
+    ///This variable stores the smallest rectangle holding the positions of
+    ///the node and all the nodes below it, for finding nodes quickly.
+    QRect                   s_bounds;
+
     ///This variable stores the location of the probability text, if any.
     QPoint                  s_probPosition;
 
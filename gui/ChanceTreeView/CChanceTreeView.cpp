@@ -13,6 +13,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "CChanceTreeView.h"
+#include "GraphView/CChanceTreeGraphModel.h"
 #include "GraphView/CChanceTreeGraphView.h"
 #include "TraceView/CChanceTreeTraceView.h"
 #include <QAction>
@@ -111,6 +112,24 @@ void CChanceTreeView::connectTraceAction( QAction *action )
     connect( action, SIGNAL(toggled(bool)), m_traceView, SLOT(setShown(bool)) );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeView::evaluateTree
+///
+/// @description  This function shows the backed-up value of every node of
+///               the tree, found with the depth limit and quiescence depth
+///               the trace is using.
+/// @pre          None
+/// @post         The backed-up values are shown until the tree is edited.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeView::evaluateTree()
+{
+    m_graphView->getModel()->evaluate( m_traceView->depthLimit(),
+                                       m_traceView->qsDepth() );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeView::loadFromFile
 ///
@@ -264,6 +283,10 @@ void CChanceTreeView::setupToolBar()
     tempAction = m_toolBar->addAction(QIcon(":/autolayout.png"), "Auto Layout");
     connect( tempAction, SIGNAL(activated()), m_graphView, SLOT(autoLayout()) );
 
+    // "Evaluate Tree" button
+    tempAction = m_toolBar->addAction(QIcon(":/trace.png"), "Evaluate Tree");
+    connect( tempAction, SIGNAL(activated()), this, SLOT(evaluateTree()) );
+
     m_toolBar->addSeparator();
     
 
@@ -277,6 +300,9 @@ void CChanceTreeView::setupToolBar()
     tempLabel = m_traceView->getAILabel();
     m_toolBar->addWidget( tempLabel );
 
+    // Progress of the running trace
+    m_toolBar->addWidget( m_traceView->getProgressWidget() );
+
     // Depth spinbox
     tempLabel = new QLabel( m_toolBar );
     tempLabel->setTextFormat(Qt::AutoText);
@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CCompiledChanceTree.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the
+///               CCompiledChanceTree class.
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "CCompiledChanceTree.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledChanceTree::compile
+///
+/// @description  Makes the copy of a chance tree. The shape of a node also
+///               depends on which nodes are chance nodes and on their
+///               probabilities.
+/// @pre          None
+/// @post         The copy holds the tree below root, or nothing if root is
+///               NULL.
+///
+/// @param root:  The root of the tree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CCompiledChanceTree::compile( const SChanceTreeNode *root )
+{
+    compileNodes( root );
+
+    m_chance.clear();
+    m_probabilities.clear();
+    m_chance.reserve( m_nodes.count() );
+    m_probabilities.reserve( m_nodes.count() );
+    QVector<qreal> data;
+    data.reserve( m_nodes.count() * 2 );
+    for( int i = 0; i < m_nodes.count(); ++i )
+    {
+        m_chance.append( m_nodes[i]->s_chance );
+        m_probabilities.append( m_nodes[i]->s_probability );
+        data.append( m_nodes[i]->s_chance ? 1.0 : 0.0 );
+        data.append( m_nodes[i]->s_probability );
+    }
+    findShapes( data, 2 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledChanceTree::clear
+///
+/// @description  Empties the copy.
+/// @pre          None
+/// @post         The copy has no nodes.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CCompiledChanceTree::clear()
+{
+    CCompiledTree<SChanceTreeNode>::clear();
+    m_chance.clear();
+    m_probabilities.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledChanceTree::isChance
+///
+/// @description  Tells whether a node is a chance node.
+/// @pre          node is a node of the copy.
+/// @post         None
+///
+/// @param node:  The node.
+///
+/// @return bool: True for a chance node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CCompiledChanceTree::isChance( int node ) const
+{
+    return m_chance[node];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledChanceTree::probability
+///
+/// @description  Returns the probability of a node, the chance of it
+///               following its parent if that is a chance node.
+/// @pre          node is a node of the copy.
+/// @post         None
+///
+/// @param node:  The node.
+///
+/// @return qreal: The probability as a percentage.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+qreal CCompiledChanceTree::probability( int node ) const
+{
+    return m_probabilities[node];
+}
@@ -0,0 +1,44 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CCompiledChanceTree.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the
+///               CCompiledChanceTree class, the flat copy of a chance tree
+///               searched by the chance tracers.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CCOMPILEDCHANCETREE_H_
+#define _CCOMPILEDCHANCETREE_H_
+
+#include "CChanceTreeGraph.h"
+#include "../CCompiledTree.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// CCompiledChanceTree
+///
+/// @description  A CCompiledTree of a chance tree, which also keeps which
+///               nodes are chance nodes and the probability of every node.
+///
+/// @limitations  As for CCompiledTree.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CCompiledChanceTree : public CCompiledTree<SChanceTreeNode>
+{
+public:
+    void compile( const SChanceTreeNode *root );
+    void clear();
+
+    bool isChance( int node ) const;
+    qreal probability( int node ) const;
+
+private:
+    QVector<bool>       m_chance;
+    QVector<qreal>      m_probabilities;
+};
+
+#endif//_CCOMPILEDCHANCETREE_H_
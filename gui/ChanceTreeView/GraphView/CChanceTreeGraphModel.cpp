@@ -16,6 +16,10 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "CChanceTreeGraphModel.h"
+#include "../../CTreeGeneratorBase.h"
+#include "../CChanceTreeEvaluator.h"
+#include <QVector>
+#include <QFontMetrics>
 #include <ctime>
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeGraphModel::CChanceTreeGraphModel
@@ -35,6 +39,8 @@ CChanceTreeGraphModel::CChanceTreeGraphModel( QObject *parent )
 {
     m_data = NULL;
     m_style = CStyleToolkit::instance();
+    m_evaluation = 0;
+    m_evaluationCount = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -93,12 +99,25 @@ void CChanceTreeGraphModel::addChildNode( SChanceTreeNode *node, QPoint point )
         newNode->s_max = node->s_max;
     }
 
+    //If the tree is auto laid out, keep it so by laying out again only the
+    //subtrees the new node is added to.
+    m_layout.beginChange( node );
+
     //Add the new node to the child list of the parent node.
     node->s_childList.append( newNode );
 
     //Resort the parent node's child list and signal the canvas to redraw
     //the model.
     sortChildNodes( node );
+    m_layout.endChange( node );
+
+    //The layout may have moved other nodes as well.
+    if ( m_layout.isValid() )
+        m_bounds.invalidate();
+    else
+        m_bounds.moved( newNode );
+
+    clearEvaluation();
     emit repaint();
     emit retrace();
 }
@@ -130,6 +149,8 @@ SChanceTreeNode * CChanceTreeGraphModel::addChildNodeBasic( SChanceTreeNode *nod
         newNode = new SChanceTreeNode;
         newNode->s_position = QPoint(0,0);
         newNode->s_parent = node;
+        m_layout.clear();
+        m_bounds.invalidate();
         if(node->s_chance)
         {
             newNode->s_chance = false;
@@ -203,6 +224,7 @@ void CChanceTreeGraphModel::addParentNode( SChanceTreeNode *node )
     shiftSubTree( node, point );
 
     //Signal the canvas to redraw the model.
+    clearEvaluation();
     emit repaint();
     emit retrace();
 }
@@ -211,7 +233,11 @@ void CChanceTreeGraphModel::addParentNode( SChanceTreeNode *node )
 /// CChanceTreeGraphModel::autoLayout
 ///
 /// @description  This function moves all the nodes to form a nicely spaced out
-///               tree.
+///               tree. Each level is a row and every subtree is packed as
+///               close to its left neighbour as the rows they share allow,
+///               with each parent centred over its children. The layout is
+///               kept so that adding or deleting nodes afterwards only lays
+///               out the changed part of the tree again.
 /// @pre          None
 /// @post         The tree has been arranged.
 ///
@@ -220,162 +246,38 @@ void CChanceTreeGraphModel::addParentNode( SChanceTreeNode *node )
 ////////////////////////////////////////////////////////////////////////////////
 void CChanceTreeGraphModel::autoLayout()
 {
-    //This variable is used as the x value of the left most node in the tree.
-    int x = m_style->getNodeRadius() + m_style->getBoldWidth() +
-            m_style->getPen().width();
-
-    //Align the x values of all the nodes in the tree.
-    autoLayoutX( m_data->getRootNode(), x );
-
-    //Set the Y value of the root node to be on the screen.
-    m_data->getRootNode()->s_position.setY( m_style->getNodeRadius() +
-                                            m_style->getBoldWidth() +
-                                            m_style->getPen().width() );
+    //This variable is the distance of the left most node and the root node
+    //from the edges of the canvas.
+    int margin = m_style->getNodeRadius() + m_style->getBoldWidth() +
+                 m_style->getPen().width();
 
-    //Align the y values of all the nodes in the tree.
-    autoLayoutY( m_data->getRootNode() );
+    //Arrange the tree with the nodes and the levels evenly spaced.
+    m_layout.layout( m_data->getRootNode(), margin, margin,
+                     m_style->getNodeRadius() / 2 * 5,
+                     m_style->getNodeRadius() * 3 );
+    m_bounds.invalidate();
 
     emit repaint();
 }
 
-////////////////////////////////////////////////////////////////////////////////
-/// CChanceTreeGraphModel::autoLayoutX
-///
-/// @description  This function arranges the given node and all its children
-///               such that the left most child (or the given node, if it has
-///               no children), uses the x value indicated.  Any node that has
-///               children will use the average x value of its children to
-///               determine its own x value.  The value x is passed by reference
-///               so it may be continually used to properly space the whole
-///               tree.
-/// @pre          X must be the value where the left most node will be placed.
-/// @post         The x values for the position of the given node and all its
-///               children have been set.
-///
-/// @param node:  This is a pointer to the node which needs to be arranged.
-/// @param x:     This is a reference to the position to use for the next node.
-///               When a node uses this value, it increments it for the next
-///               leaf node to use.
-///
-/// @limitations  None
-///
-////////////////////////////////////////////////////////////////////////////////
-void CChanceTreeGraphModel::autoLayoutX( SChanceTreeNode *node, int &x )
-{
-    //This constant is static so as not to redeclare it during the recursive
-    //funtion call.  It indicates how far apart each node should be.
-    static const int nodeSpacing = m_style->getNodeRadius() / 2 * 5;
-
-    //Make sure a valid node is passed in.
-    if ( node == NULL )
-        return;
-
-    //Check if the given node is a leaf node.
-    if ( node->s_childList.isEmpty() )
-    {
-        //Set the leaf node's x value to the given value.
-        node->s_position.setX( x );
-
-        //Increment the x value for the next leaf node and return.
-        x += nodeSpacing;
-        return;
-    }
-
-    //////////////////////////////////////////////////////////////////
-    //
-    // Description:   This loop recursively calls this function on
-    //                the children of the given node to properly
-    //                set their x values so the given node can set
-    //                its x value.
-    //
-    // Precondition:  The given node must have at least 1 child.
-    // Postcondition: The children of the given node have had their
-    //                x values set.
-    //
-    //////////////////////////////////////////////////////////////////
-    for ( int i = 0; i < node->s_childList.size(); i++ )
-    {
-        autoLayoutX( node->s_childList[ i ], x );
-    }
-
-    //Set the x value of the given node to the average of the child nodes so
-    //as to center it above its children.
-    node->s_position.setX( ( node->s_childList.first()->s_position.x() +
-                             node->s_childList.last()->s_position.x() ) / 2 );
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// CChanceTreeGraphModel::autoLayoutY
-///
-/// @description  This function sets the y value of the given node and its
-///               children for the autoLayout functionality.
-/// @pre          The given node must have its y value set to the desired value.
-/// @post         The y value of the node and its children have been set.
-///
-/// @param node:  This is a pointer to the node which needs to have its
-///               children's y values set.
-///
-/// @limitations  None
-///
-////////////////////////////////////////////////////////////////////////////////
-void CChanceTreeGraphModel::autoLayoutY( SChanceTreeNode *node )
-{
-    //This constant is static so as not to redeclare it during the recursive
-    //funtion call.  It indicates how far apart each node should be.
-    static const int nodeSpacing = m_style->getNodeRadius() * 3;
-    static const int chanceNodeSpacing = m_style->getNodeRadius() * 4;
-
-    //Make sure the node passed in is valid.
-    if ( node == NULL )
-        return;
-
-    //////////////////////////////////////////////////////////////////
-    //
-    // Description:   This loop recursively calls this function on
-    //                the children of the given node to properly
-    //                set their y values.
-    //
-    // Precondition:  The y value of the given node is set.
-    // Postcondition: The children of the given node have had their
-    //                y values set.
-    //
-    //////////////////////////////////////////////////////////////////
-    int space = (node->s_chance) ? chanceNodeSpacing : nodeSpacing;
-    for ( int i = 0; i < node->s_childList.size(); i++ )
-    {
-        //Set the y value of the current child node and then call this function
-        //to arrange the child's children properly.
-        
-        node->s_childList[ i ]->s_position.setY( node->s_position.y() + space );
-        autoLayoutY( node->s_childList[ i ] );
-    }
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeGraphModel::autoName
 ///
 /// @description  This function names all the nodes alphabetically, starting
-///               with A in a breadth first manner.
+///               with A in a breadth first manner. After Z come AA to ZZ,
+///               then AAA and so on.
 /// @pre          None
 /// @post         All the nodes are named alphabetically, breadth-first.
 ///
-/// @limitations  This function can only autoname up to 702 nodes.
+/// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
 void CChanceTreeGraphModel::autoName()
 {
-    //This variable is used as a loop variable.
-    int i;
-
-    //These variables are used to store the letters used to make the names for
-    //the nodes.
-    char firstLetter = ( 'A' - 1 ), secondLetter = 'A';
-
-    //This list is used for traversing through the tree breadth first.
-    QList<SChanceTreeNode *> nodeList;
-
-    //THis variable is used to store the name of the next node.
-    QString name;
+    //This list is used for traversing through the tree breadth first. Nodes
+    //are never taken off the front, the index of the next node to name is
+    //kept instead.
+    QVector<SChanceTreeNode *> nodeList;
 
     //Place the root node in the list to begin traversing the tree.
     nodeList.append( m_data->getRootNode() );
@@ -390,49 +292,16 @@ void CChanceTreeGraphModel::autoName()
     // Postcondition: Each node in the tree is named alphabetically.
     //
     //////////////////////////////////////////////////////////////////
-    while ( !nodeList.empty() )
+    for ( int i = 0; i < nodeList.size(); i++ )
     {
-        //Clear the name variable for the next name.
-        name.clear();
-
-        //Check if the name should be 2 letters long.  If it should, start with
-        //the first letter.
-        if ( firstLetter >= 'A' )
-            name.append( QChar( firstLetter ) );
-
-        //Append the second letter.
-        name.append( QChar( secondLetter ) );
-
-        //Check if the second letter is still before 'Z' in the alphabet.  If it
-        //is, increment by 1 letter.
-        if ( secondLetter < 'Z' )
-            secondLetter++;
-        //Otherwise, set the second letter back to 'A' and increment the first
-        //letter by one.
-        else
-        {
-            secondLetter = 'A';
-            firstLetter++;
-        }
+        SChanceTreeNode *node = nodeList[ i ];
 
         //Set the name of the node.
-        nodeList.front()->s_name = name;
-
-        //////////////////////////////////////////////////////////////
-        //
-        // Description:   This loop adds all the immediate children of
-        //                the current node to the queue.
-        //
-        // Precondition:  None.
-        // Postcondition: All the immediate child nodes of the current
-        //                node are appended to the queue.
-        //
-        //////////////////////////////////////////////////////////////
-        for ( i = 0; i < nodeList.front()->s_childList.size(); i++ )
-            nodeList.append( nodeList.front()->s_childList[ i ] );
+        node->s_name = CTreeGeneratorBase::nodeName( i );
 
-        //Pop the node at the front of the queue.
-        nodeList.removeFirst();
+        //Add all the immediate children of the current node to the queue.
+        for ( int j = 0; j < node->s_childList.size(); j++ )
+            nodeList.append( node->s_childList[ j ] );
     }
 
     emit repaint();
@@ -458,6 +327,7 @@ void CChanceTreeGraphModel::autoNumber( int min, int max )
     //Seed the random number generator.
     srand( time( NULL ) );
     autoNumberHelper( min, max, m_data->getRootNode() );
+    clearEvaluation();
     emit repaint();
     emit retrace();
 }
@@ -489,6 +359,118 @@ void CChanceTreeGraphModel::autoNumberHelper( int min, int max, SChanceTreeNode
         autoNumberHelper( min, max, node->s_childList[ i ] );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGraphModel::backUpEvaluation
+///
+/// @description  This function works out the backed-up value of the given
+///               node again from those of its children, and so on up the path
+///               to the root. It stops at the first node whose value does not
+///               change, as nothing above it can change either.
+/// @pre          The node was an inner node of the last evaluation.
+/// @post         The backed-up values on the path to the root are current.
+///
+/// @param node:  This is a pointer to the node whose children have changed.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeGraphModel::backUpEvaluation( SChanceTreeNode *node )
+{
+    //Find whether max or min moves at each node from the root down: the
+    //players take turns, except that a chance node does not take a turn.
+    QList<SChanceTreeNode *> path;
+    for ( SChanceTreeNode *parent = node; parent != NULL;
+          parent = parent->s_parent )
+        path.prepend( parent );
+
+    QVector<bool> maxes( path.size() );
+    maxes[ 0 ] = true;
+    for ( int i = 1; i < path.size(); i++ )
+        maxes[ i ] = path[ i - 1 ]->s_chance ? maxes[ i - 1 ]
+                                             : !maxes[ i - 1 ];
+
+    for ( int i = path.size() - 1; i >= 0; i-- )
+    {
+        node = path[ i ];
+        qreal value;
+        if ( node->s_chance )
+        {
+            value = 0.0;
+            for ( int j = 0; j < node->s_childList.size(); j++ )
+            {
+                SChanceTreeNode *child = node->s_childList[ j ];
+                value += child->s_probability / 100.0
+                         * child->s_backedUpValue;
+            }
+            value = (float)value;
+        }
+        else
+        {
+            value = node->s_childList[ 0 ]->s_backedUpValue;
+            for ( int j = 1; j < node->s_childList.size(); j++ )
+            {
+                qreal childValue = node->s_childList[ j ]->s_backedUpValue;
+                if ( maxes[ i ] ? childValue > value : childValue < value )
+                    value = childValue;
+            }
+        }
+
+        if ( value == node->s_backedUpValue )
+            break;
+        node->s_backedUpValue = value;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGraphModel::clearEvaluation
+///
+/// @description  This function stops the backed-up values of the last
+///               evaluation from being shown, as an edit has made them stale.
+/// @pre          None
+/// @post         No node is evaluated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeGraphModel::clearEvaluation()
+{
+    m_evaluation = 0;
+    m_principalVariation.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGraphModel::copyEvaluation
+///
+/// @description  This function gives the nodes below one node the backed-up
+///               values of those below another node with the same subtree.
+///               The evaluation only works out one of such subtrees in each
+///               level, and this fills in the others.
+/// @pre          The two nodes have the same subtree, and the one copied from
+///               has been evaluated.
+/// @post         The nodes below to are evaluated as those below from are.
+///
+/// @param from:  This is a pointer to the node whose subtree was evaluated.
+/// @param to:    This is a pointer to the node whose subtree is filled in.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeGraphModel::copyEvaluation( const SChanceTreeNode *from,
+                                            SChanceTreeNode *to )
+{
+    //The children of an end point were not evaluated.
+    if ( from->s_childList.isEmpty() || !isEvaluated( from->s_childList[ 0 ] ) )
+        return;
+
+    for ( int i = 0; i < from->s_childList.size(); i++ )
+    {
+        to->s_childList[ i ]->s_backedUpValue =
+            from->s_childList[ i ]->s_backedUpValue;
+        to->s_childList[ i ]->s_evaluation = m_evaluation;
+        copyEvaluation( from->s_childList[ i ], to->s_childList[ i ] );
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeGraphModel::createNewData
 ///
@@ -507,7 +489,10 @@ void CChanceTreeGraphModel::createNewData()
     {
         delete m_data;
     }
+    m_layout.clear();
+    m_bounds.invalidate();
     m_data = new CChanceTreeGraph;
+    clearEvaluation();
     realignData();
 }
 
@@ -529,12 +514,22 @@ void CChanceTreeGraphModel::deleteNode( SChanceTreeNode *node )
         return;
 
     //Check if the indicated node is not the root node.  If not, remove the
-    //indicated node from its parent's child list.
+    //indicated node from its parent's child list, laying out again only the
+    //subtrees it is taken from if the tree is auto laid out.
     if ( node->s_parent != NULL )
     {
+        SChanceTreeNode *parent = node->s_parent;
         editNodeProb( node, 0.0 );
-        node->s_parent->s_childList.removeAt(
-            node->s_parent->s_childList.indexOf( node ) );
+        m_layout.beginChange( parent );
+        m_layout.forget( node );
+        parent->s_childList.removeAt( parent->s_childList.indexOf( node ) );
+        m_layout.endChange( parent );
+
+        //The layout may have moved other nodes as well.
+        if ( m_layout.isValid() )
+            m_bounds.invalidate();
+        else
+            m_bounds.moved( parent );
     }
     //Otherwise, create a new root node.
     else
@@ -548,6 +543,7 @@ void CChanceTreeGraphModel::deleteNode( SChanceTreeNode *node )
 
     //Signal the canvas to redraw the model.
     emit quickEditOff();
+    clearEvaluation();
     emit repaint();
     emit retrace();
 }
@@ -641,6 +637,8 @@ void CChanceTreeGraphModel::editNodePosition( SChanceTreeNode *node, QPoint poin
     if ( node != NULL )
     {
         node->s_position = point;
+        m_layout.clear();
+        m_bounds.moved( node );
 
         //Check if the node has a parent node and resort the parent node's
         //child list if there is a parent.
@@ -672,6 +670,7 @@ void CChanceTreeGraphModel::editNodeQuiescentFlag( SChanceTreeNode *node, bool q
     if ( node != NULL )
     {
         node->s_quiescent = quiescent;
+        clearEvaluation();
         emit repaint();
         emit retrace();
     }
@@ -682,7 +681,9 @@ void CChanceTreeGraphModel::editNodeQuiescentFlag( SChanceTreeNode *node, bool q
 ///
 /// @description   This function updates the value of the given node.
 /// @pre           None
-/// @post          The given node's value is updated.
+/// @post          The given node's value is updated, along with the backed-up
+///                values above it if it was an end point of the last
+///                evaluation.
 ///
 /// @param node:   This is a pointer to the ndoe whose value is being updated.
 /// @param value:  This is the new value for the node.
@@ -696,6 +697,7 @@ void CChanceTreeGraphModel::editNodeValue( SChanceTreeNode *node, qreal value )
     if ( node != NULL )
     {
         node->s_value = value;
+        updateEvaluation( node );
         emit repaint();
         emit retrace();
     }
@@ -706,7 +708,8 @@ void CChanceTreeGraphModel::editNodeValue( SChanceTreeNode *node, qreal value )
 ///
 /// @description   This function updates the value of the given node.
 /// @pre           None
-/// @post          The given node's value is updated.
+/// @post          The given node's value is updated, along with the backed-up
+///                values above it if it was evaluated.
 ///
 /// @param node:   This is a pointer to the ndoe whose value is being updated.
 /// @param value:  This is the new value for the node.
@@ -780,6 +783,14 @@ void CChanceTreeGraphModel::editNodeProb( SChanceTreeNode *node, qreal value )
                 remaining--;
             }
         }
+
+        //Only the weights under the parent changed, so its value and those
+        //above it are all that need working out again.
+        if ( isEvaluated( node ) )
+        {
+            backUpEvaluation( parent );
+            findPrincipalVariation();
+        }
         emit repaint();
         emit retrace();
     }
@@ -808,6 +819,8 @@ void CChanceTreeGraphModel::editSubTreePosition( SChanceTreeNode *parent, QPoint
 
     //Move the given node and its subtree.
     shiftSubTree( parent, point - parent->s_position );
+    m_layout.clear();
+    m_bounds.moved( parent );
 
     //Check if the node has a parent node and resort the parent node's
     //child list if there is a parent.
@@ -817,6 +830,55 @@ void CChanceTreeGraphModel::editSubTreePosition( SChanceTreeNode *parent, QPoint
     emit repaint();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGraphModel::evaluate
+///
+/// @description       This function finds the expectiminimax value of every
+///                    node with the given search limits and keeps it in the
+///                    node to be shown.
+/// @pre               None
+/// @post              Every node the evaluation reached is evaluated until
+///                    the tree is next edited.
+///
+/// @param depthLimit: The depth of the search, or less than 0 for none.
+/// @param qsDepth:    The quiescence depth of the search.
+///
+/// @limitations       None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeGraphModel::evaluate( int depthLimit, int qsDepth )
+{
+    if ( m_data == NULL )
+        return;
+
+    CChanceTreeEvaluator evaluator;
+    evaluator.evaluate( m_data->getRootNode(), depthLimit, qsDepth );
+
+    //Number the evaluation so that values left in nodes by an older one are
+    //not shown.
+    m_evaluation = ++m_evaluationCount;
+    for ( int i = 0; i < evaluator.count(); i++ )
+    {
+        SChanceTreeNode *node = evaluator.node( i );
+        node->s_backedUpValue = evaluator.value( i );
+        node->s_evaluation = m_evaluation;
+    }
+
+    //A node that shares the value of an identical subtree was evaluated
+    //without its children. Deeper nodes go first so that every subtree they
+    //are filled in from is complete.
+    for ( int i = evaluator.count() - 1; i >= 0; i-- )
+    {
+        int representative = evaluator.representative( i );
+        if ( representative != i )
+            copyEvaluation( evaluator.node( representative ),
+                            evaluator.node( i ) );
+    }
+    findPrincipalVariation();
+
+    emit repaint();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeGraphModel::findMaxDepth
 ///
@@ -880,7 +942,9 @@ SChanceTreeNode * CChanceTreeGraphModel::findNode( QPoint point )
 	QRect rect( 0, 0, nodeRadius * 2, nodeRadius * 2 );
 	rect.moveCenter( point );
 
-    //Recurse through the tree and find any nodes which contain the point.
+    //Recurse through the tree and find any nodes which contain the point,
+    //bringing the rectangles around the subtrees up to date first.
+    m_bounds.update( getRootNode() );
 	node = findNodeHelper( getRootNode(), rect );
 
 	return node;
@@ -892,7 +956,9 @@ SChanceTreeNode * CChanceTreeGraphModel::findNode( QPoint point )
 /// @description          This function recursively calls itself so that the
 ///                       given node and all children nodes beneath it are
 ///                       searched for the center point of the given rect.
-/// @pre                  None
+///                       A subtree is skipped if the rect does not meet the
+///                       rectangle around it.
+/// @pre                  The rectangles around the subtrees are up to date.
 /// @post                 None
 ///
 /// @param node:          This is a pointer to the node which is being checked
@@ -910,7 +976,8 @@ SChanceTreeNode * CChanceTreeGraphModel::findNode( QPoint point )
 ////////////////////////////////////////////////////////////////////////////////
 SChanceTreeNode * CChanceTreeGraphModel::findNodeHelper( SChanceTreeNode *node, QRect &rect )
 {
-    if ( node == NULL )
+    //Skip the subtree if none of its nodes have their center in the rect.
+    if ( node == NULL || !rect.intersects( node->s_bounds ) )
         return NULL;
 
 	SChanceTreeNode *returnNode = NULL;
@@ -1002,19 +1069,68 @@ SChanceTreeNode * CChanceTreeGraphModel::findProb( QPoint point )
         QRect rect( 0, 0, 25*2, 25 );
 	rect.moveCenter( point );
 
-    //Recurse through the tree and find any nodes which contain the point.
-	node = findProbHelper( getRootNode(), rect );
+    //A probability is drawn beside the middle of the line from its node up to
+    //the parent, at most half its text's width and height and 5 more away.
+    //The rect is widened by that much to test the rectangles around the
+    //subtrees, which hold the lines but not what is drawn beside them.
+    QFontMetrics metrics( m_style->getFont() );
+    int margin = 5 + ( metrics.width( "0.00000e-00" ) + metrics.height() ) / 2;
+    QRect spanRect = rect.adjusted( -margin, -margin, margin, margin );
+
+    //Recurse through the tree and find any nodes which contain the point,
+    //bringing the rectangles around the subtrees up to date first.
+    m_bounds.update( getRootNode() );
+	node = findProbHelper( getRootNode(), rect, spanRect );
 
 	return node;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGraphModel::findPrincipalVariation
+///
+/// @description  This function finds the principal variation of the last
+///               evaluation: the path from the root that follows, at each
+///               min or max node, the leftmost child whose value was backed
+///               up to it. The path ends at a chance node, as every outcome
+///               of one adds to its value.
+/// @pre          None
+/// @post         m_principalVariation holds the nodes on the path.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeGraphModel::findPrincipalVariation()
+{
+    m_principalVariation.clear();
+
+    SChanceTreeNode *node = getRootNode();
+    while ( node != NULL && isEvaluated( node ) )
+    {
+        m_principalVariation.insert( node );
+        if ( node->s_chance )
+            break;
+
+        SChanceTreeNode *best = NULL;
+        for ( int i = 0; i < node->s_childList.size() && best == NULL; i++ )
+        {
+            SChanceTreeNode *child = node->s_childList[ i ];
+            if ( isEvaluated( child )
+                 && child->s_backedUpValue == node->s_backedUpValue )
+                best = child;
+        }
+        node = best;
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeGraphModel::findProbHelper
 ///
 /// @description          This function recursively calls itself so that the
 ///                       given node and all children nodes beneath it are
 ///                       searched for the center point of the given rect.
-/// @pre                  None
+///                       The children are skipped if no probability below
+///                       the node can be drawn that close to the point.
+/// @pre                  The rectangles around the subtrees are up to date.
 /// @post                 None
 ///
 /// @param node:          This is a pointer to the node which is being checked
@@ -1023,6 +1139,8 @@ SChanceTreeNode * CChanceTreeGraphModel::findProb( QPoint point )
 ///                       clicked.  If the center of a node exists inside the
 ///                       rect, the point where the user clicked would be inside
 ///                       the node.
+/// @param spanRect:      This is rect widened by the farthest a probability is
+///                       drawn from the line it belongs to.
 ///
 /// @return SChanceTreeNode *:  Returns a pointer to the node which contains the given
 ///                       point and NULL if no node contains the point.
@@ -1030,7 +1148,9 @@ SChanceTreeNode * CChanceTreeGraphModel::findProb( QPoint point )
 /// @limitations          None
 ///
 ////////////////////////////////////////////////////////////////////////////////
-SChanceTreeNode * CChanceTreeGraphModel::findProbHelper( SChanceTreeNode *node, QRect &rect )
+SChanceTreeNode * CChanceTreeGraphModel::findProbHelper( SChanceTreeNode *node,
+                                                         QRect &rect,
+                                                         QRect &spanRect )
 {
     if ( node == NULL )
         return NULL;
@@ -1074,8 +1194,9 @@ SChanceTreeNode * CChanceTreeGraphModel::findProbHelper( SChanceTreeNode *node,
 
 	}
 
-    //Check if a node was found that contains the center of the rect or not.
-	if ( returnNode == NULL )
+    //Check if a node was found that contains the center of the rect or not,
+    //and if the lines below the node come near enough for one of theirs to.
+	if ( returnNode == NULL && spanRect.intersects( node->s_bounds ) )
 	{
         //////////////////////////////////////////////////////////////
         //
@@ -1088,7 +1209,8 @@ SChanceTreeNode * CChanceTreeGraphModel::findProbHelper( SChanceTreeNode *node,
         //////////////////////////////////////////////////////////////
 		for ( int i = 0; i < node->s_childList.size(); i++ )
 		{
-			returnNode = findProbHelper( node->s_childList[i], rect );
+			returnNode = findProbHelper( node->s_childList[i], rect,
+			                             spanRect );
 
 			if ( returnNode != NULL )
 				break;
@@ -1276,6 +1398,46 @@ SChanceTreeNode * CChanceTreeGraphModel::getRootNode() const
     return node;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGraphModel::isEvaluated
+///
+/// @description   This function tells whether the given node has a backed-up
+///                value from the last evaluation that should be shown.
+/// @pre           None
+/// @post          None
+///
+/// @param node:   This is a pointer to the node.
+///
+/// @return bool:  True if s_backedUpValue of the node is current.
+///
+/// @limitations   None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CChanceTreeGraphModel::isEvaluated( const SChanceTreeNode *node ) const
+{
+    return m_evaluation != 0 && node->s_evaluation == m_evaluation;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGraphModel::isPrincipal
+///
+/// @description   This function tells whether the given node is on the
+///                principal variation of the last evaluation.
+/// @pre           None
+/// @post          None
+///
+/// @param node:   This is a pointer to the node.
+///
+/// @return bool:  True if the node is on the principal variation.
+///
+/// @limitations   None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CChanceTreeGraphModel::isPrincipal( const SChanceTreeNode *node ) const
+{
+    return m_principalVariation.contains( node );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeGraphModel::load
 ///
@@ -1293,7 +1455,10 @@ void CChanceTreeGraphModel::load( const QString &filename )
     if ( m_data == NULL )
         createNewData();
 
+    m_layout.clear();
+    m_bounds.invalidate();
     m_data->load( filename );
+    clearEvaluation();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1319,6 +1484,7 @@ void CChanceTreeGraphModel::realignData()
         shiftOffset.setY( 0 );
 
     shiftSubTree( m_data->getRootNode(), -shiftOffset );
+    m_layout.clear();
 
     emit repaint();
 }
@@ -1347,7 +1513,13 @@ void CChanceTreeGraphModel::rehook( SChanceTreeNode *parent, SChanceTreeNode *no
     parent->s_childList.append( node );
     node->s_parent = parent;
     sortChildNodes( parent );
+    m_layout.clear();
+
+    //The subtree may have been changed in ways not followed while it was off
+    //the tree.
+    m_bounds.invalidate();
 
+    clearEvaluation();
     emit repaint();
     emit retrace();
 }
@@ -1386,6 +1558,8 @@ void CChanceTreeGraphModel::save( const QString &filename ) const
 ////////////////////////////////////////////////////////////////////////////////
 void CChanceTreeGraphModel::setRootNode( SChanceTreeNode *node )
 {
+    m_layout.clear();
+    m_bounds.invalidate();
     if ( m_data != NULL )
         m_data->setRootNode( node );
 }
@@ -1427,6 +1601,7 @@ void CChanceTreeGraphModel::shiftSubTree( SChanceTreeNode *parent, QPoint point
         shiftSubTree( parent->s_childList[i], point );
     }
     parent->s_position = parent->s_position + point;
+    parent->s_bounds.translate( point );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1510,10 +1685,44 @@ void CChanceTreeGraphModel::unhook( SChanceTreeNode *node )
     if ( node == NULL )
         return;
 
-    node->s_parent->s_childList.removeAt(
-        node->s_parent->s_childList.indexOf( node ) );
+    SChanceTreeNode *parent = node->s_parent;
+    parent->s_childList.removeAt( parent->s_childList.indexOf( node ) );
     node->s_parent = NULL;
+    m_layout.clear();
+    m_bounds.moved( parent );
 
+    clearEvaluation();
     emit repaint();
     emit retrace();
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeGraphModel::updateEvaluation
+///
+/// @description  This function brings the last evaluation up to date after
+///               the value of the given node has changed. Only an end point
+///               of the evaluation has its value backed up, so only then do
+///               the values on the path to the root need working out again.
+/// @pre          None
+/// @post         The backed-up values and principal variation are current.
+///
+/// @param node:  This is a pointer to the node whose value has changed.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeGraphModel::updateEvaluation( SChanceTreeNode *node )
+{
+    if ( !isEvaluated( node ) )
+        return;
+
+    //The children of an inner node of the evaluation were all evaluated.
+    if ( !node->s_childList.isEmpty()
+         && isEvaluated( node->s_childList[ 0 ] ) )
+        return;
+
+    node->s_backedUpValue = (float)node->s_value;
+    if ( node->s_parent != NULL )
+        backUpEvaluation( node->s_parent );
+    findPrincipalVariation();
+}
@@ -19,9 +19,12 @@
 
 #include "../CChanceTreeGraph.h"
 #include "../../CStyleToolkit.h"
+#include "../../CTreeBounds.h"
+#include "../../CTreeLayout.h"
 #include <QObject>
 #include <QRect>
 #include <QList>
+#include <QSet>
 
 typedef QPair<const SChanceTreeNode*, int> HistoryValue;
 typedef QList<HistoryValue> HistoryTable;
@@ -65,6 +68,7 @@ public:
     void editNodeValue( SChanceTreeNode *node, qreal value );
     void editNodeProb( SChanceTreeNode *node, qreal value );
     void editSubTreePosition( SChanceTreeNode *parent, QPoint point );
+    void evaluate( int depthLimit, int qsDepth );
 
     int findMaxDepth( SChanceTreeNode *node );
     SChanceTreeNode * findNode( QPoint point );
@@ -73,6 +77,8 @@ public:
     QPoint getHistoryPosition() const;
     HistoryTable getHistoryTable() const;
     SChanceTreeNode * getRootNode() const;
+    bool isEvaluated( const SChanceTreeNode *node ) const;
+    bool isPrincipal( const SChanceTreeNode *node ) const;
 
     void load( const QString &filename );
     void realignData();
@@ -83,16 +89,20 @@ public:
     void unhook( SChanceTreeNode *node );
 
 private:
-    void autoLayoutX( SChanceTreeNode *node, int &x );
-    void autoLayoutY( SChanceTreeNode *node );
     void autoNumberHelper( int min, int max, SChanceTreeNode *node );
+    void backUpEvaluation( SChanceTreeNode *node );
+    void clearEvaluation();
+    void copyEvaluation( const SChanceTreeNode *from, SChanceTreeNode *to );
     SChanceTreeNode * findNodeHelper( SChanceTreeNode *node, QRect &rect );
-    SChanceTreeNode * findProbHelper( SChanceTreeNode *node, QRect &rect );
+    void findPrincipalVariation();
+    SChanceTreeNode * findProbHelper( SChanceTreeNode *node, QRect &rect,
+                                      QRect &spanRect );
     QRect getContainingRectHelper( SChanceTreeNode *parent ) const;
     void getHistoryTableHelper( const SChanceTreeNode *node,
          HistoryTable &table ) const;
     void shiftSubTree( SChanceTreeNode *parent, QPoint point );
     bool sortChildNodes( SChanceTreeNode *parent );
+    void updateEvaluation( SChanceTreeNode *node );
 
     //This variable is a pointer to the data set currently being used.
     CChanceTreeGraph     *m_data;
@@ -104,6 +114,25 @@ private:
     //This is a pointer to the style toolkit instance for quicker reference.
     CStyleToolkit  *m_style;
 
+    //This variable is the number of the evaluation whose backed-up values
+    //are shown, or 0 if none are.
+    int             m_evaluation;
+
+    //This variable counts the evaluations made so far.
+    int             m_evaluationCount;
+
+    //This variable holds the nodes on the principal variation of the last
+    //evaluation.
+    QSet<const SChanceTreeNode *> m_principalVariation;
+
+    //This variable holds the last auto layout, kept while the tree is only
+    //changed by adding and deleting nodes so those can be laid out alone.
+    CTreeLayout<SChanceTreeNode> m_layout;
+
+    //This variable keeps the rectangle around each subtree for finding the
+    //node at a point.
+    CTreeBounds<SChanceTreeNode> m_bounds;
+
 signals:
     void quickEditOff();
     void repaint();
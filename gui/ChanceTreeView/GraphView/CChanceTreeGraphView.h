@@ -72,8 +72,6 @@ protected slots:
 private:
     void setupCanvas();
     void updateCanvasSize();
-    bool generateSubTree( SChanceTreeNode * root, int depth, 
-                          int minBranch, int maxBranch, int qp, int &treeSize);
 
     QWidget                *m_canvas;
     CChanceTreeHistoryArtist     *m_historyArtist;
@@ -311,6 +311,8 @@ void CChanceTreeNodeArtist::paintNode( const SChanceTreeNode *node,
 	string.append( QString::number( node->s_value ) );
     painter->drawText( rect, Qt::AlignCenter, string );
     painter->setPen( backupPen );
+
+    paintBackedUpValue( node, painter );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -353,6 +355,45 @@ void CChanceTreeNodeArtist::paintChanceNode( const SChanceTreeNode *node,
         string.append( QString::number( node->s_value ) );
     painter->drawText( rect, Qt::AlignCenter, string );
     painter->setPen( backupPen );
+
+    paintBackedUpValue( node, painter );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeNodeArtist::paintBackedUpValue
+///
+/// @description     This function paints the backed-up value of a node under
+///                  it, if the last evaluation of the tree found one. Values
+///                  on the principal variation are bold.
+/// @pre             None
+/// @post            The backed-up value of the node is painted if it is
+///                  current.
+///
+/// @param node:     This is a pointer to the node.
+/// @param painter:  This is a pointer to the QPainter object to be used to
+///                  paint the value on the screen.
+///
+/// @limitations     None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeNodeArtist::paintBackedUpValue( const SChanceTreeNode *node,
+                                                QPainter *painter )
+{
+    if ( !m_model->isEvaluated( node ) )
+        return;
+
+    int radius = m_style->getNodeRadius();
+    QRect rect( 0, 0, radius * 4, radius );
+    rect.moveCenter( node->s_position + QPoint( 0, radius * 2 ) );
+
+    //Bold the values on the principal variation.
+    QFont backupFont = painter->font();
+    QFont font = painter->font();
+    font.setBold( m_model->isPrincipal( node ) );
+    painter->setFont( font );
+    painter->drawText( rect, Qt::AlignCenter,
+                       QString( "=%1" ).arg( node->s_backedUpValue ) );
+    painter->setFont( backupFont );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -44,6 +44,7 @@ public:
     void toggleMinMaxHeuristics(bool b);
 
 private:
+    void paintBackedUpValue( const SChanceTreeNode *node, QPainter *painter );
     QPoint paintSpanNumber( QPoint nodeFromPos, QPoint nodeToPos, qreal num, QPainter *painter);
     qreal angleNorthOfEast( QPoint nodeFromPos, QPoint nodeToPos );
 
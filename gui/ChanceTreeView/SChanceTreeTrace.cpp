@@ -13,6 +13,7 @@
 ///
 ////////////////////////////////////////////////////////////////////////////////
 #include "SChanceTreeTrace.h"
+#include <QDataStream>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// SChanceTreeTrace::SChanceTreeTrace
@@ -27,6 +28,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 SChanceTreeTrace::SChanceTreeTrace()
 {
+    s_conf = STraceConfig();
+    s_graph = NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -50,6 +53,102 @@ SChanceTreeTrace::~SChanceTreeTrace()
         else
             delete s_depths.takeFirst();
     }
+    delete s_graph;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// rowsFromCall
+///
+/// @description  Collects the rows of a call and, depth first, of the calls
+///               it makes, in the order the trace view shows them.
+///
+////////////////////////////////////////////////////////////////////////////////
+static void rowsFromCall( SChanceTreeCall *call, const STraceConfig &conf,
+                          QList<QStringList> &rows )
+{
+    SExpectMLine *curLine;
+    foreach( curLine, call->s_lines )
+        rows.append( curLine->toStringList( call, conf ) );
+
+    SChanceTreeCall *curCall;
+    foreach( curCall, call->s_children )
+        rowsFromCall( curCall, conf, rows );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SChanceTreeTrace::write
+///
+/// @description     Writes the trace to a stream, for keeping on disk. Only
+///                  the rows of each depth are written, not the lines they
+///                  come from.
+/// @pre             None
+/// @post            None
+///
+/// @param out:      The stream to write to.
+///
+/// @limitations     None
+///
+////////////////////////////////////////////////////////////////////////////////
+void SChanceTreeTrace::write( QDataStream &out ) const
+{
+    out << s_aiName << s_columnNames << (qint32)s_depths.count();
+
+    SChanceTreeCall *curDepth;
+    foreach( curDepth, s_depths )
+    {
+        QList<QStringList> rows;
+        rowsFromCall( curDepth, s_conf, rows );
+
+        out << curDepth->s_returnValue << (qint32)rows.count();
+        QStringList row;
+        foreach( row, rows )
+            out << row;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SChanceTreeTrace::read
+///
+/// @description     Reads a trace written by write(). Each depth is read back
+///                  as a single call whose lines hold the rows as they were
+///                  shown.
+/// @pre             None
+/// @post            None
+///
+/// @param in:       The stream to read from.
+///
+/// @return SChanceTreeTrace *: The trace, owned by the caller, or NULL if the
+///                  stream did not hold one.
+///
+/// @limitations     None
+///
+////////////////////////////////////////////////////////////////////////////////
+SChanceTreeTrace *SChanceTreeTrace::read( QDataStream &in )
+{
+    SChanceTreeTrace *trace = new SChanceTreeTrace;
+    qint32 depths = 0, rows = 0;
+    in >> trace->s_aiName >> trace->s_columnNames >> depths;
+
+    for( ; depths > 0 && in.status() == QDataStream::Ok; --depths )
+    {
+        SChanceTreeCall *call = new SChanceTreeCall;
+        trace->s_depths.append( call );
+        in >> call->s_returnValue >> rows;
+
+        for( ; rows > 0 && in.status() == QDataStream::Ok; --rows )
+        {
+            SExpectMLine *line = new SExpectMLine;
+            in >> line->s_cells;
+            call->s_lines.append( line );
+        }
+    }
+
+    if( in.status() != QDataStream::Ok )
+    {
+        delete trace;
+        return NULL;
+    }
+    return trace;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -66,6 +165,14 @@ SChanceTreeTrace::~SChanceTreeTrace()
 SChanceTreeCall::SChanceTreeCall()
 {
     s_returnValue = 0;
+    s_error = 0;
+    s_node = NULL;
+    s_root = false;
+    s_max = true;
+    s_depth = 0;
+    s_qsDepth = 0;
+    s_alpha = 0;
+    s_beta = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -18,8 +18,10 @@
 #include <QString>
 #include <QStringList>
 #include <QSize>
+#include <QVector>
 #include "TraceView/TreeTracers/CExpectMTracer.h"
 
+class QDataStream;
 struct SChanceTreeCall;
 struct SExpectMLine;
 //class IChanceTreeLine;
@@ -61,6 +63,18 @@ struct SChanceTreeTrace
     //Iterative-Deepening(ID) trace. If the trace is not ID then there will only
     //be one entry in the list.
     QList<SChanceTreeCall *>  s_depths;
+
+    //This variable is the configuration the trace was made with, which says
+    //what the cells of its lines show.
+    STraceConfig        s_conf;
+
+    //This variable is the copy of the tree the trace was made from. The
+    //lines refer to its nodes, so the trace owns it. It is NULL for a trace
+    //read back from disk, whose lines keep their own text.
+    SChanceTreeNode    *s_graph;
+
+    void write( QDataStream &out ) const;
+    static SChanceTreeTrace *read( QDataStream &in );
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -88,6 +102,24 @@ struct SChanceTreeCall
 
     QList<SExpectMLine *>  s_lines;
     float               s_returnValue;
+    // Estimated standard error of s_returnValue when chance nodes below were
+    // sampled, 0 when it is exact.
+    float               s_error;
+
+    // What the call was made with, for the text of its lines.
+    const SChanceTreeNode  *s_node;
+    bool                s_root;
+    bool                s_max;
+    int                 s_depth;
+    int                 s_qsDepth;
+    float               s_alpha;
+    float               s_beta;
+
+    // The children of the node in the order they were searched, and their
+    // history values when the call began. Each line shows the part of this
+    // list from its own child on.
+    QVector<const SChanceTreeNode *>  s_open;
+    QVector<int>        s_openHistory;
 
     SExpectMLine *operator[](int index);
 };
@@ -16,6 +16,8 @@
 #include "../SChanceTreeTrace.h"
 #include "../GraphView/CChanceTreeGraphModel.h"
 #include "../../CStyleToolkit.h"
+#include "../../CTraceRunner.h"
+#include "../../CTraceTableModel.h"
 #include "TreeTracers/CChanceTreeTracerSelector.h"
 #include <QComboBox>
 #include <QSpinBox>
@@ -34,7 +36,8 @@
 /// @pre            None
 /// @post           The default values for the stored trace, and style are set
 ///                 and the CChanceTreeSelector is initialized and connected to the
-///                 retrace() slot.
+///                 retrace() slot. Traces are run in the background by
+///                 m_runner, which reports to the showTrace() slot.
 ///
 /// @param parent:  This is a pointer to the parent QObject.
 ///
@@ -42,9 +45,10 @@
 ///
 ////////////////////////////////////////////////////////////////////////////////
 CChanceTreeTraceView::CChanceTreeTraceView( QWidget *parent )
-: QTableWidget( parent )
+: QTableView( parent ), m_cache( "chancetree" )
 {
     m_trace = NULL;
+    m_rows = NULL;
     m_style = CStyleToolkit::instance();
 
     //The m_selector encapsulates all the editables in the tool bar that have to
@@ -52,6 +56,13 @@ CChanceTreeTraceView::CChanceTreeTraceView( QWidget *parent )
     //three will emit the activiated() signal.
     m_selector = new CChanceTreeTracerSelector( this );
     connect( m_selector, SIGNAL(activated()), this, SLOT( retrace() ) );
+
+    m_model = new CTraceTableModel( this );
+    setModel( m_model );
+
+    m_runner = new CTraceRunner( this );
+    connect( m_runner, SIGNAL(scheduled()), this, SLOT( startTrace() ) );
+    connect( m_runner, SIGNAL(finished()), this, SLOT( showTrace() ) );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -60,15 +71,16 @@ CChanceTreeTraceView::CChanceTreeTraceView( QWidget *parent )
 /// @description  This is the destructor for the CChanceTreeTraceView class which
 ///               frees up dynamically allocated memory.
 /// @pre          None
-/// @post         The trace is deleted if it exists.
+/// @post         Any running trace is stopped. The traces are deleted with
+///               the cache.
 ///
 /// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
 CChanceTreeTraceView::~CChanceTreeTraceView()
 {
-    if ( m_trace != NULL )
-        delete m_trace;
+    //The running job uses the selector, so stop it first.
+    delete m_runner;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -173,6 +185,42 @@ QSpinBox *CChanceTreeTraceView::getQSDepthSelector()
     return m_selector->getQSDepthSelector();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceView::depthLimit
+///
+/// @description          This function returns the depth the trace is
+///                       limited to.
+/// @pre                  None
+/// @post                 None
+///
+/// @return int:          The depth limit, or -1 if there is none.
+///
+/// @limitations          None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CChanceTreeTraceView::depthLimit() const
+{
+    return m_selector->depthLimit();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceView::qsDepth
+///
+/// @description          This function returns the quiescence depth the
+///                       trace uses.
+/// @pre                  None
+/// @post                 None
+///
+/// @return int:          The quiescence depth, 0 if it is off.
+///
+/// @limitations          None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CChanceTreeTraceView::qsDepth() const
+{
+    return m_selector->qsDepth();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeTraceView::getAILabel
 ///
@@ -190,117 +238,124 @@ QLabel *CChanceTreeTraceView::getAILabel()
     return m_selector->getAILabel();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceView::getProgressWidget
+///
+/// @description          This function returns a pointer to the widget that
+///                       shows a trace is running and lets the user cancel it.
+/// @pre                  None
+/// @post                 A pointer to the progress widget is returned.
+///
+/// @return QWidget *:    This is a pointer to the progress widget.
+///
+/// @limitations          None
+///
+////////////////////////////////////////////////////////////////////////////////
+QWidget *CChanceTreeTraceView::getProgressWidget()
+{
+    return m_runner->getProgressWidget();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeTraceView::retrace
 ///
-/// @description  This function is a Qt slot. Calling it will update the trace
-///               to reflect the current states of the Graph Model and the
-///               Trace Selector.
+/// @description  This function is a Qt slot. Calling it asks for a trace of
+///               the current states of the Graph Model and the Trace Selector.
+///               Calls that come in close together, such as those made while
+///               a node is dragged, lead to a single startTrace().
 /// @pre          None
-/// @post         The trace is updated and repainted.
+/// @post         startTrace() will be called.
 ///
 /// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
 void CChanceTreeTraceView::retrace()
 {
-    //Delete any existing trace
-    if( m_trace != NULL )
-        delete m_trace;
-
-    //Perform the actual trace
-    m_trace = m_selector->trace( m_graphModel->getRootNode() );
-
-    //Get the string grid
-    QList<QStringList> lines = gridFromTrace( m_trace );
-    int rows = lines.count();
-    int columns = m_trace->s_columnNames.count();
-
-    //Update the table parameters
-    setColumnCount(columns);
-    setHorizontalHeaderLabels( m_trace->s_columnNames );
-    setRowCount(rows);
-
-    //For loop through the 2d array of QStrings
-    QTableWidgetItem *item;
-    int i,j;
-    for( i = 0; i < rows; ++i )
-        for( j = 0; j < columns; ++j )
-        {
-            //create the item, set the text, set the font, plug it in.
-            item = new QTableWidgetItem(lines[i][j]);
-            item->setFont( m_style->getFont() );
-            setItem( i, j, item );
-        }
-
-    //Resize all the columns to be just the right width
-    for( j = 0; j < columns; ++j )
-        resizeColumnToContents(j);
+    m_runner->schedule();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// CChanceTreeTraceView::gridFromCall
-///
-/// @description          This is a recursive function that returns a 2d array
-///                       of QStrings that represents the trace from the call.
-/// @pre                  None
-/// @post                 The grid is returned.
-///
-/// @param call:          This is the call to be converted to a grid of strings.
+/// CChanceTreeTraceView::startTrace
 ///
-/// @return QList<QStringList>: This is the 2d array of QString
+/// @description  This function is a Qt slot. It starts a trace of the current
+///               states of the Graph Model and the Trace Selector in the
+///               background, unless the trace on show or on its way already
+///               reflects them or the cache holds one that does. A trace that
+///               is still running is abandoned.
+/// @pre          None
+/// @post         The trace is shown from the cache or started if needed.
+///               showTrace() is called when a started trace is done.
 ///
-/// @limitations          None
+/// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QList<QStringList> CChanceTreeTraceView::gridFromCall( SChanceTreeCall *call )
+void CChanceTreeTraceView::startTrace()
 {
-    QList<QStringList> lineGrid;
-
-    SExpectMLine *curLine;
-    foreach( curLine, call->s_lines )
-        lineGrid += curLine->toStringList();
+    QByteArray key = m_selector->traceKey( m_graphModel->getRootNode() );
+    if( m_runner->isCurrent( key ) )
+        return;
 
-    SChanceTreeCall *curCall;
-    foreach( curCall, call->s_children )
-        lineGrid += gridFromCall( curCall );
+    //A trace made before for the same graph and settings is shown at once.
+    SChanceTreeTrace *trace = m_cache.find( key );
+    if( trace != NULL )
+    {
+        m_runner->setCurrent( key );
+        m_trace = trace;
+        updateTable();
+        return;
+    }
 
-    return lineGrid;
+    m_runner->start( m_selector->createJob( m_graphModel->getRootNode() ), key );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// CChanceTreeTraceView::gridFromTrace
-///
-/// @description          This function returns a 2d array of QStrings that
-///                       represents the trace.
-/// @pre                  None
-/// @post                 The grid is returned.
-///
-/// @param trace:         This is the trace to be converted to a grid of strings.
+/// CChanceTreeTraceView::showTrace
 ///
-/// @return QList<QStringList>: This is the 2d array of QString
+/// @description  This function is a Qt slot, called when a background trace
+///               is done. The new trace is cached and replaces the one on
+///               show.
+/// @pre          None
+/// @post         The trace is updated and repainted.
 ///
-/// @limitations          None
+/// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QList<QStringList> CChanceTreeTraceView::gridFromTrace( SChanceTreeTrace *trace )
+void CChanceTreeTraceView::showTrace()
 {
-    QList<QStringList> stringGrid;
+    CChanceTreeTraceJob *job =
+        static_cast<CChanceTreeTraceJob *>( m_runner->takeResult() );
+    if( job == NULL )
+        return;
 
-    QStringList blankLine;
-    for( int i = trace->s_columnNames.count(); i > 0; --i )
-        blankLine.append("");
+    //The cache owns the traces, the one on show included.
+    m_trace = job->takeTrace();
+    m_cache.insert( job->key(), m_trace );
+    delete job;
 
-    SChanceTreeCall *rootCall;
-    foreach( rootCall, trace->s_depths )
-    {
-        stringGrid += gridFromCall( rootCall );
-        stringGrid += blankLine;
-    }
-    if( !stringGrid.isEmpty() )
-        stringGrid.takeLast();
+    updateTable();
+}
 
-    return stringGrid;
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceView::updateTable
+///
+/// @description  Fills the table from the trace on show, in the current font.
+/// @pre          None
+/// @post         The table is updated and repainted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTraceView::updateTable()
+{
+    if( m_trace == NULL )
+        return;
+
+    //The rows are indexed once per trace, for showing and for saving,
+    //and the model makes the text of a cell only when it comes into sight.
+    m_model->setFont( m_style->getFont() );
+    m_rows = new CChanceTreeTraceRows( m_trace );
+    m_model->setSource( m_trace->s_columnNames, m_rows );
+    m_model->fitView( this );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -351,7 +406,7 @@ void CChanceTreeTraceView::saveTrace()
 
     // \begin{tabluar}{l|l|l|l|l}
     stream<<"\\begin{tabular}{l";
-    for( int i = columnCount(); i > 1; --i )
+    for( int i = m_model->columnCount(); i > 1; --i )
         stream<<"|l";
     stream<<"}\n";
 
@@ -365,10 +420,11 @@ void CChanceTreeTraceView::saveTrace()
     stream<<rowEnd;
 
     // All the lines
-    QList<QStringList> grid = gridFromTrace(m_trace);
     QStringList curLine;
-    foreach( curLine, grid )
+    for( int i = 0; i < m_rows->rowCount(); ++i )
     {
+        curLine = m_rows->row( i );
+
         // If the first and second cells are empty then consider it a depth
         // seperation in the grid.
         if( curLine[0].isEmpty() && curLine[1].isEmpty() )
@@ -451,3 +507,91 @@ void CChanceTreeTraceView::setGraphModel( CChanceTreeGraphModel *model )
     connect( model, SIGNAL(retrace()), this, SLOT(retrace()) );
     retrace();
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceRows::CChanceTreeTraceRows
+///
+/// @description    This is the constructor of the CChanceTreeTraceRows class.
+///                 It indexes the rows of the trace in one pass.
+/// @pre            None
+/// @post           None
+///
+/// @param trace:   This is the trace. It must outlive the object.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+CChanceTreeTraceRows::CChanceTreeTraceRows( SChanceTreeTrace *trace )
+{
+    m_trace = trace;
+    m_columns = trace->s_columnNames.count();
+
+    for( int i = 0; i < trace->s_depths.count(); ++i )
+    {
+        if( i > 0 )
+            m_index.addRow( CIndex::BlankRow, NULL );
+        m_index.beginDepth();
+        m_index.addCall( trace->s_depths[i] );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceRows::rowCount
+///
+/// @description    Returns the number of rows.
+/// @pre            None
+/// @post           None
+///
+/// @return int:    The number of rows.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CChanceTreeTraceRows::rowCount() const
+{
+    return m_index.rowCount();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceRows::row
+///
+/// @description    Returns the cells of a row.
+/// @pre            index is a row.
+/// @post           None
+///
+/// @param index:   The row.
+///
+/// @return QStringList: The cells of the row.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+QStringList CChanceTreeTraceRows::row( int index ) const
+{
+    const CIndex::SRow &row = m_index.row( index );
+    if( row.s_kind == CIndex::LineRow )
+        return row.s_line->toStringList( row.s_call, m_trace->s_conf );
+
+    QStringList cells;
+    for( int i = m_columns; i > 0; --i )
+        cells.append( "" );
+    return cells;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceRows::index
+///
+/// @description    Returns the index of the rows, which tells what each row
+///                 shows and where each depth starts.
+/// @pre            None
+/// @post           None
+///
+/// @return const CIndex &: The index.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+const CChanceTreeTraceRows::CIndex &CChanceTreeTraceRows::index() const
+{
+    return m_index;
+}
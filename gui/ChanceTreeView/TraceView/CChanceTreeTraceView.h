@@ -16,11 +16,14 @@
 #ifndef _CCHANCETREETRACEVIEW_H_
 #define _CCHANCETREETRACEVIEW_H_
 
-#include <QTableWidget>
+#include <QTableView>
 #include <QList>
 #include <QStringList>
 #include <QMenu>
 #include <QToolButton>
+#include "../../CTraceCache.h"
+#include "../../CTraceTableModel.h"
+#include "../../CTraceRowIndex.h"
 
 class QLabel;
 class QComboBox;
@@ -28,24 +31,29 @@ class QSpinBox;
 class CChanceTreeGraphModel;
 class CStyleToolkit;
 class CChanceTreeTracerSelector;
+class CTraceRunner;
+class CChanceTreeTraceRows;
 struct SChanceTreeCall;
 struct SChanceTreeTrace;
+struct SExpectMLine;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeTraceView
 ///
 /// @description  This class allows the user to view the trace of a tree. It is
-///               based on the QTableWidget which it uses for all of the display
-///               and drawing functionality.
+///               based on the QTableView which it uses for all of the display
+///               and drawing functionality. The cells are given by a
+///               CTraceTableModel, which makes their text only as they come
+///               into sight.
 ///
-/// @limitations  The QTableWidget allows for minimal customization in how the
+/// @limitations  The QTableView allows for minimal customization in how the
 ///               grid is drawn. Row and Column headers and the fonts can be
 ///               changed as well as the cell contents. It cannot change the
 ///               thickness or color of individual lines, nor can it display any
 ///               not within a cell.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-class CChanceTreeTraceView : public QTableWidget
+class CChanceTreeTraceView : public QTableView
 {
     Q_OBJECT
 
@@ -55,29 +63,65 @@ public:
 
     QSpinBox *getDepthSelector();
     QSpinBox *getQSDepthSelector();
+    int depthLimit() const;
+    int qsDepth() const;
     QSpinBox *getLowerBoundSelector();
     QSpinBox *getUpperBoundSelector();
     QToolButton * getAIConfigButton();
     QLabel *getAILabel();
-
+    QWidget *getProgressWidget();
 
     void setGraphModel( CChanceTreeGraphModel *model );
 
-    QList<QStringList> gridFromCall( SChanceTreeCall *call );
-    QList<QStringList> gridFromTrace( SChanceTreeTrace *trace );
-
-	void signalRepaint(void) { retrace(); }
+	void signalRepaint(void) { updateTable(); }
 
 protected slots:
     void retrace();
+    void startTrace();
+    void showTrace();
     void saveTrace();
 
 private:
+    void updateTable();
+
     CChanceTreeGraphModel    *m_graphModel;
     CChanceTreeTracerSelector *m_selector;
+    CTraceRunner             *m_runner;
+    CTraceCache<SChanceTreeTrace> m_cache;
+    CTraceTableModel *m_model;
+    CChanceTreeTraceRows *m_rows;
 
     SChanceTreeTrace      *m_trace;
     CStyleToolkit   *m_style;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceRows
+///
+/// @description  The rows of a chance tree trace, for a CTraceTableModel and
+///               for saving. The lines of each depth come in the order of a
+///               depth first walk of its calls, with a blank row between
+///               depths. The rows are indexed once per trace and the text is
+///               only made as rows are asked for.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CChanceTreeTraceRows : public ITraceRowSource
+{
+public:
+    typedef CTraceRowIndex<SChanceTreeCall, SExpectMLine> CIndex;
+
+    CChanceTreeTraceRows( SChanceTreeTrace *trace );
+
+    int rowCount() const;
+    QStringList row( int index ) const;
+    const CIndex &index() const;
+
+private:
+    const SChanceTreeTrace *m_trace;
+    CIndex                  m_index;
+    int                     m_columns;
+};
+
 #endif /*_CTREETRACEVIEW_H_*/
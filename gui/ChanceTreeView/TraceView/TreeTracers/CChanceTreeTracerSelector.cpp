@@ -15,10 +15,38 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "CChanceTreeTracerSelector.h"
 #include "CExpectMTracer.h"
+#include "../../SChanceTreeTrace.h"
 #include <QComboBox>
 #include <QMenu>
 #include <QSpinBox>
 #include <QLabel>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes everything about a subtree that can change its trace. Positions are
+/// left out since the child lists are already kept in left to right order.
+////////////////////////////////////////////////////////////////////////////////
+static void writeTree( QDataStream &stream, const SChanceTreeNode *node )
+{
+    if( node == NULL )
+    {
+        stream << (qint32)-1;
+        return;
+    }
+
+    stream << (qint32)node->s_childList.count();
+    stream << node->s_name << node->s_chance << node->s_probability
+           << node->s_max << node->s_quiescent << node->s_value
+           << (qint32)node->s_history;
+
+    const SChanceTreeNode *child;
+    foreach( child, node->s_childList )
+        writeTree( stream, child );
+}
+#include <QInputDialog>
+#include <QThread>
+#include <climits>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeTracerSelector::CChanceTreeTracerSelector
@@ -51,9 +79,18 @@ CChanceTreeTracerSelector::CChanceTreeTracerSelector( QObject *parent )
     m_traceConf.s_isDL = false;
     m_traceConf.s_isAB = false;
     m_traceConf.s_isCP = false;
+    m_traceConf.s_isStar2 = false;
+    m_traceConf.s_isSampled = false;
+    m_traceConf.s_samples = 8;
+    m_traceConf.s_seed = 1;
+    m_traceConf.s_isParallel = false;
     m_traceConf.s_isHT = false;
     m_traceConf.s_isQS = false;
     m_traceConf.s_allowSSS = false;
+    m_traceConf.s_isTT = false;
+    m_traceConf.s_isMCTS = false;
+    m_traceConf.s_playouts = 10000;
+    m_traceConf.s_threads = qMax( 2, QThread::idealThreadCount() );
 
     // Enable / disable widgets accordingly.
     m_qsDepthSelector->setEnabled(m_traceConf.s_isQS);
@@ -105,9 +142,21 @@ CChanceTreeTracerSelector::CChanceTreeTracerSelector( QObject *parent )
 void CChanceTreeTracerSelector::updateLabel() const
 {
     QString newLabel = "";
+    if(m_traceConf.s_isMCTS)
+    {
+        if(m_traceConf.s_isQS) newLabel += "QS";
+        newLabel += "MCTS";
+        if(m_traceConf.s_isDL) newLabel += "DL";
+        m_aiLabel->setText(newLabel);
+        return;
+    }
+    if(m_traceConf.s_isTT) newLabel += "TT";
     if(m_traceConf.s_isHT) newLabel += "HT";
     if(m_traceConf.s_isQS) newLabel += "QS";
-    if(m_traceConf.s_isAB) newLabel += "*1";
+    if(m_traceConf.s_isSampled) newLabel += "Sparse";
+    if(m_traceConf.s_isParallel && !m_traceConf.s_isAB) newLabel += "Par";
+    if(m_traceConf.s_isStar2) newLabel += "*2";
+    else if(m_traceConf.s_isAB) newLabel += "*1";
     if(m_traceConf.s_isCP) newLabel += "C";
     if(m_traceConf.s_isID) newLabel += "ID";
     if(m_traceConf.s_isDL) newLabel += "DLEM";
@@ -240,6 +289,44 @@ QSpinBox *CChanceTreeTracerSelector::getQSDepthSelector()
     return m_qsDepthSelector;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::depthLimit
+///
+/// @description          This function returns the depth a trace would be
+///                       limited to.
+/// @pre                  None
+/// @post                 None
+///
+/// @return int:          The value of the depth selector, or -1 if depth
+///                       limiting is off.
+///
+/// @limitations          None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CChanceTreeTracerSelector::depthLimit() const
+{
+    return m_traceConf.s_isDL ? m_depthSelector->value() : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::qsDepth
+///
+/// @description          This function returns the quiescence depth a trace
+///                       would use.
+/// @pre                  None
+/// @post                 None
+///
+/// @return int:          The value of the qs depth selector, or 0 if
+///                       quiescence search is off.
+///
+/// @limitations          None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CChanceTreeTracerSelector::qsDepth() const
+{
+    return m_traceConf.s_isQS ? m_qsDepthSelector->value() : 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeTracerSelector::getLowerBoundSelector
 ///
@@ -337,34 +424,112 @@ void CChanceTreeTracerSelector::setupBoundLists()
     m_upperBoundSelector->setMaximum( 255 );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::createJob
+///
+/// @description  Makes a job that traces the tree with the currently selected
+///               tracer, pulling the depth, qs depth and bound values from the
+///               spin boxes. The label is brought up to date for the new
+///               search.
+/// @pre          None
+/// @post         None
+///
+/// @param rootNode: This is the root of the tree that is to be traced. The
+///                  job takes a copy of it.
+///
+/// @return CChanceTreeTraceJob *: The job, which the caller owns.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CChanceTreeTraceJob *CChanceTreeTracerSelector::createJob(
+    const SChanceTreeNode *rootNode ) const
+{
+    updateLabel();
+    return new CChanceTreeTraceJob( this, rootNode, m_traceConf,
+                                    m_depthSelector->value(),
+                                    m_qsDepthSelector->value(),
+                                    m_lowerBoundSelector->value(),
+                                    m_upperBoundSelector->value() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::traceKey
+///
+/// @description  Makes a key for the trace that createJob() would run: a hash
+///               of the current settings and of everything in the tree that
+///               the tracers look at. Two calls give the same key only if the
+///               traces would be the same.
+/// @pre          None
+/// @post         None
+///
+/// @param rootNode: This is the root of the tree that is to be traced.
+///
+/// @return QByteArray: The key.
+///
+/// @limitations  MCTS can give a slightly different trace each run; the key
+///               treats those runs as the same.
+///
+////////////////////////////////////////////////////////////////////////////////
+QByteArray CChanceTreeTracerSelector::traceKey(
+    const SChanceTreeNode *rootNode ) const
+{
+    QByteArray data;
+    QDataStream stream( &data, QIODevice::WriteOnly );
+
+    const STraceConfig &conf = m_traceConf;
+    stream << conf.s_isQS << conf.s_isHT << conf.s_isDL << conf.s_isID
+           << conf.s_isAB << conf.s_isCP << conf.s_isStar2
+           << conf.s_allowSSS << conf.s_isTT
+           << conf.s_isMCTS << (qint32)conf.s_playouts
+           << (qint32)conf.s_threads << conf.s_isSampled
+           << (qint32)conf.s_samples << (quint32)conf.s_seed
+           << conf.s_isParallel;
+    stream << (qint32)m_depthSelector->value()
+           << (qint32)m_qsDepthSelector->value()
+           << (qint32)m_lowerBoundSelector->value()
+           << (qint32)m_upperBoundSelector->value();
+    writeTree( stream, rootNode );
+
+    return QCryptographicHash::hash( data, QCryptographicHash::Sha1 );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeTracerSelector::trace
 ///
 /// @description  This is a forwarding function that encapsulates the interface
 ///               with the tracers. Calling it will call the trace() function
-///               on the currently selected tracer and it will pull the depth
-///               and qs depth values from the spin boxes.
-/// @pre          None
-/// @post         The trace is returned as determined by the selector widgets'
-///               current states.
+///               on the tracer that traceConf selects. It does not touch the
+///               widgets, so it may be called from a worker thread.
+/// @pre          No other trace is running on this selector.
+/// @post         None
 ///
-/// @param rootNode: This is the root of the tree that is to be traced.
+/// @param rootNode:   This is the root of the tree that is to be traced.
+/// @param traceConf:  The search to run.
+/// @param depth:      The depth limit.
+/// @param qsDepth:    The quiescence search depth.
+/// @param lowerBound: The lowest value an end point may have.
+/// @param upperBound: The highest value an end point may have.
+/// @param cancel:     Stops the trace early when set non-zero. May be NULL.
 ///
-/// @return SChanceTreeTrace *: This is the trace generated by the IChanceTreeTracer
-///                       subclass.
+/// @return SChanceTreeTrace *: This is the trace generated by the tracer.
 ///
 /// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
-SChanceTreeTrace *CChanceTreeTracerSelector::trace( const SChanceTreeNode *rootNode ) const
+SChanceTreeTrace *CChanceTreeTracerSelector::trace(
+    const SChanceTreeNode *rootNode, const STraceConfig &traceConf,
+    int depth, int qsDepth, int lowerBound, int upperBound,
+    const QAtomicInt *cancel ) const
 {
-    int depth = m_depthSelector->value();
-    int qsDepth = m_qsDepthSelector->value();
-    int lowerBound = m_lowerBoundSelector->value();
-    int upperBound = m_upperBoundSelector->value();
-    updateLabel();
-    return m_generalTracer.trace( rootNode, depth, qsDepth, m_traceConf,
-                                  lowerBound, upperBound );
+    if(traceConf.s_isMCTS)
+    {
+        SExpectMCTSContext context( traceConf, cancel );
+        return m_mctsTracer.trace( rootNode, depth, qsDepth, context );
+    }
+
+    SExpectMContext context( traceConf, lowerBound, upperBound, cancel );
+    return m_generalTracer.trace( rootNode, depth, qsDepth, context );
 }
 
 
@@ -441,7 +606,9 @@ void CChanceTreeTracerSelector::toggleDL()
 ///
 /// @description  Toggles Alpha Beta Pruning on/off
 /// @pre          None
-/// @post         Value of m_traceConf.s_isAB is changed. Trace is updated.
+/// @post         Value of m_traceConf.s_isAB is changed. If it was changed to
+///               true, MCTS and Sparse Sampling are turned off, otherwise
+///               Star2 Probing is turned off. Trace is updated.
 ///
 /// @limitations  None
 ///
@@ -453,8 +620,60 @@ void CChanceTreeTracerSelector::toggleAB()
     m_upperBoundSelector->setEnabled(b);
     m_traceConf.s_isAB = b;
     m_traceConf.s_isCP = b;
-    activate();
-    m_aiConfigButton->showMenu();
+
+    if(b && m_traceConf.s_isMCTS)
+    {
+        m_actionMCTS->setChecked(false);
+    }
+
+    if(b && m_traceConf.s_isSampled)
+    {
+        m_actionSampling->setChecked(false);
+    }
+
+    if(!b && m_traceConf.s_isStar2)
+    {
+        m_actionStar2->setChecked(false);
+    }
+
+    // If AB has just been toggled manually, not turned off by MCTS.
+    if(!m_traceConf.s_isMCTS)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::toggleStar2
+///
+/// @description  Toggles Star2 Probing on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isStar2 is changed. If it was changed
+///               to true, Star-1 Pruning is also turned on. Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTracerSelector::toggleStar2()
+{
+    bool b = !m_traceConf.s_isStar2;
+    m_traceConf.s_isStar2 = b;
+
+    // Probing is done with the windows of Star-1. Turning it on updates the
+    // trace.
+    if(b && !m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(true);
+        return;
+    }
+
+    // If Star2 has just been toggled manually, not turned off by AB.
+    if(m_traceConf.s_isAB)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -521,6 +740,241 @@ void CChanceTreeTracerSelector::toggleSSS()
     m_aiConfigButton->showMenu();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::toggleTT
+///
+/// @description  Toggles the Transposition Table on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isTT is changed. Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTracerSelector::toggleTT()
+{
+    m_traceConf.s_isTT = !m_traceConf.s_isTT;
+    activate();
+    m_aiConfigButton->showMenu();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::toggleMCTS
+///
+/// @description  Toggles Monte Carlo Tree Search on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isMCTS is changed. If it was changed
+///               to true, Star-1 Pruning and Sparse Sampling are turned off.
+///               Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTracerSelector::toggleMCTS()
+{
+    bool b = !m_traceConf.s_isMCTS;
+    m_traceConf.s_isMCTS = b;
+
+    if(b && m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(false);
+    }
+
+    if(b && m_traceConf.s_isSampled)
+    {
+        m_actionSampling->setChecked(false);
+    }
+
+    // If MCTS has just been toggled manually, not turned off by AB.
+    if(!m_traceConf.s_isAB)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::toggleSampling
+///
+/// @description  Toggles Sparse Sampling on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isSampled is changed. If it was
+///               changed to true, Star-1 Pruning and MCTS are turned off.
+///               Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTracerSelector::toggleSampling()
+{
+    bool b = !m_traceConf.s_isSampled;
+    m_traceConf.s_isSampled = b;
+
+    // Turning the others off updates the trace.
+    if(b && m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(false);
+        return;
+    }
+    if(b && m_traceConf.s_isMCTS)
+    {
+        m_actionMCTS->setChecked(false);
+        return;
+    }
+
+    // If sampling has just been toggled manually, not turned off by AB or
+    // MCTS.
+    if(!m_traceConf.s_isAB && !m_traceConf.s_isMCTS)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::toggleParallel
+///
+/// @description  Toggles Parallel Expectimax on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isParallel is changed. Trace is
+///               updated.
+///
+/// @limitations  Star-1 Pruning searches chance nodes on one thread.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTracerSelector::toggleParallel()
+{
+    m_traceConf.s_isParallel = !m_traceConf.s_isParallel;
+    activate();
+    m_aiConfigButton->showMenu();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::setPlayouts
+///
+/// @description  Asks the user for the number of simulations run by MCTS.
+/// @pre          None
+/// @post         If the dialog was accepted, m_traceConf.s_playouts is changed
+///               and the trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTracerSelector::setPlayouts()
+{
+    bool ok;
+    int playouts = QInputDialog::getInteger( m_aiConfigButton,
+                    tr("Playouts"), // Title
+                    tr("Enter number of simulations for MCTS"), // Label
+                    m_traceConf.s_playouts, // Value
+                    1, // MinValue
+                    1000000, // MaxValue
+                    1000, // Step
+                    &ok ); // Ok
+
+    if(!ok) return;
+    m_traceConf.s_playouts = playouts;
+    m_actionPlayouts->setText(tr("Pla&youts (%1)...").arg(playouts));
+
+    if(m_traceConf.s_isMCTS)
+        activate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::setThreads
+///
+/// @description  Asks the user for the number of threads used by MCTS and
+///               Parallel Expectimax.
+/// @pre          None
+/// @post         If the dialog was accepted, m_traceConf.s_threads is changed
+///               and the trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTracerSelector::setThreads()
+{
+    bool ok;
+    int threads = QInputDialog::getInteger( m_aiConfigButton,
+                    tr("Threads"), // Title
+                    tr("Enter number of threads for MCTS and parallel"
+                       " expectimax"), // Label
+                    m_traceConf.s_threads, // Value
+                    1, // MinValue
+                    64, // MaxValue
+                    1, // Step
+                    &ok ); // Ok
+
+    if(!ok) return;
+    m_traceConf.s_threads = threads;
+    m_actionThreads->setText(tr("Thr&eads (%1)...").arg(threads));
+
+    if(m_traceConf.s_isMCTS || m_traceConf.s_isParallel)
+        activate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::setSamples
+///
+/// @description  Asks the user for the number of outcomes drawn at each
+///               chance node by Sparse Sampling.
+/// @pre          None
+/// @post         If the dialog was accepted, m_traceConf.s_samples is changed
+///               and the trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTracerSelector::setSamples()
+{
+    bool ok;
+    int samples = QInputDialog::getInteger( m_aiConfigButton,
+                    tr("Samples"), // Title
+                    tr("Enter number of outcomes drawn at each chance node"),
+                    m_traceConf.s_samples, // Value
+                    1, // MinValue
+                    1000, // MaxValue
+                    1, // Step
+                    &ok ); // Ok
+
+    if(!ok) return;
+    m_traceConf.s_samples = samples;
+    m_actionSamples->setText(tr("Sa&mples (%1)...").arg(samples));
+
+    if(m_traceConf.s_isSampled)
+        activate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTracerSelector::setSeed
+///
+/// @description  Asks the user for the seed of the draws of Sparse Sampling.
+/// @pre          None
+/// @post         If the dialog was accepted, m_traceConf.s_seed is changed
+///               and the trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTracerSelector::setSeed()
+{
+    bool ok;
+    int seed = QInputDialog::getInteger( m_aiConfigButton,
+                    tr("Seed"), // Title
+                    tr("Enter seed of the sampling draws"), // Label
+                    m_traceConf.s_seed, // Value
+                    0, // MinValue
+                    INT_MAX, // MaxValue
+                    1, // Step
+                    &ok ); // Ok
+
+    if(!ok) return;
+    m_traceConf.s_seed = seed;
+    m_actionSeed->setText(tr("&Random Seed (%1)...").arg(seed));
+
+    if(m_traceConf.s_isSampled)
+        activate();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeTracerSelector::setupConfigMenuActions
 ///
@@ -561,6 +1015,14 @@ void CChanceTreeTracerSelector::setupConfigMenuActions()
 
     m_aiConfigMenu->addAction(m_actionAB);
 
+    // Star2 Probing toggle
+    m_actionStar2 = new QAction(tr("Star-&2 Probing"), this);
+    m_actionStar2->setCheckable(true);
+    m_actionStar2->setChecked(m_traceConf.s_isStar2);
+    connect(m_actionStar2, SIGNAL(toggled(bool)), this, SLOT(toggleStar2()));
+
+    m_aiConfigMenu->addAction(m_actionStar2);
+
     // Quiescent Search toggle
     m_actionQS = new QAction(tr("&Quiescent Search"), this);
     m_actionQS->setCheckable(true);
@@ -578,6 +1040,68 @@ void CChanceTreeTracerSelector::setupConfigMenuActions()
     //connect(m_actionHT, SIGNAL(toggled(bool)), m_aiConfigButton, SLOT(showMenu ()));
 
     m_aiConfigMenu->addAction(m_actionHT);
+
+    // Transposition Table toggle
+    m_actionTT = new QAction(tr("&Transposition Table"), this);
+    m_actionTT->setCheckable(true);
+    m_actionTT->setChecked(m_traceConf.s_isTT);
+    connect(m_actionTT, SIGNAL(toggled(bool)), this, SLOT(toggleTT()));
+
+    m_aiConfigMenu->addAction(m_actionTT);
+
+    // MCTS toggle
+    m_actionMCTS = new QAction(tr("Mo&nte Carlo Tree Search"), this);
+    m_actionMCTS->setCheckable(true);
+    m_actionMCTS->setChecked(m_traceConf.s_isMCTS);
+    connect(m_actionMCTS, SIGNAL(toggled(bool)), this, SLOT(toggleMCTS()));
+
+    m_aiConfigMenu->addAction(m_actionMCTS);
+
+    // MCTS playout budget
+    m_actionPlayouts = new QAction(tr("Pla&youts (%1)...")
+                                   .arg(m_traceConf.s_playouts), this);
+    connect(m_actionPlayouts, SIGNAL(triggered()), this, SLOT(setPlayouts()));
+
+    m_aiConfigMenu->addAction(m_actionPlayouts);
+
+    // MCTS thread count
+    m_actionThreads = new QAction(tr("Thr&eads (%1)...")
+                                  .arg(m_traceConf.s_threads), this);
+    connect(m_actionThreads, SIGNAL(triggered()), this, SLOT(setThreads()));
+
+    m_aiConfigMenu->addAction(m_actionThreads);
+
+    // Sparse Sampling toggle
+    m_actionSampling = new QAction(tr("S&parse Sampling"), this);
+    m_actionSampling->setCheckable(true);
+    m_actionSampling->setChecked(m_traceConf.s_isSampled);
+    connect(m_actionSampling, SIGNAL(toggled(bool)),
+            this, SLOT(toggleSampling()));
+
+    m_aiConfigMenu->addAction(m_actionSampling);
+
+    // Outcomes drawn at each chance node
+    m_actionSamples = new QAction(tr("Sa&mples (%1)...")
+                                  .arg(m_traceConf.s_samples), this);
+    connect(m_actionSamples, SIGNAL(triggered()), this, SLOT(setSamples()));
+
+    m_aiConfigMenu->addAction(m_actionSamples);
+
+    // Seed of the draws
+    m_actionSeed = new QAction(tr("&Random Seed (%1)...")
+                               .arg(m_traceConf.s_seed), this);
+    connect(m_actionSeed, SIGNAL(triggered()), this, SLOT(setSeed()));
+
+    m_aiConfigMenu->addAction(m_actionSeed);
+
+    // Parallel Expectimax toggle
+    m_actionParallel = new QAction(tr("Para&llel Expectimax"), this);
+    m_actionParallel->setCheckable(true);
+    m_actionParallel->setChecked(m_traceConf.s_isParallel);
+    connect(m_actionParallel, SIGNAL(toggled(bool)),
+            this, SLOT(toggleParallel()));
+
+    m_aiConfigMenu->addAction(m_actionParallel);
 /*
     m_aiConfigMenu->addSeparator();
 
@@ -598,3 +1122,96 @@ void CChanceTreeTracerSelector::setupConfigMenuActions()
     //connect(m_aiConfigMenu, SIGNAL(activated(int)), m_aiConfigButton, SLOT(showMenu ()));
 
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceJob::CChanceTreeTraceJob
+///
+/// @description  This is the constructor of the CChanceTreeTraceJob class. It
+///               is called on the GUI thread and copies the tree.
+/// @pre          None
+/// @post         None
+///
+/// @param selector:   The selector whose tracers are used.
+/// @param rootNode:   The root of the tree to trace. May be NULL.
+/// @param traceConf:  The search to run.
+/// @param depth:      The depth limit.
+/// @param qsDepth:    The quiescence search depth.
+/// @param lowerBound: The lowest value an end point may have.
+/// @param upperBound: The highest value an end point may have.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CChanceTreeTraceJob::CChanceTreeTraceJob(
+    const CChanceTreeTracerSelector *selector,
+    const SChanceTreeNode *rootNode, const STraceConfig &traceConf,
+    int depth, int qsDepth, int lowerBound, int upperBound )
+: m_traceConf( traceConf )
+{
+    m_selector = selector;
+    m_rootNode = rootNode != NULL ? rootNode->clone() : NULL;
+    m_depth = depth;
+    m_qsDepth = qsDepth;
+    m_lowerBound = lowerBound;
+    m_upperBound = upperBound;
+    m_trace = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceJob::~CChanceTreeTraceJob
+///
+/// @description  This is the destructor of the CChanceTreeTraceJob class.
+/// @pre          The job is not running.
+/// @post         The copy of the tree and any trace not taken are deleted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CChanceTreeTraceJob::~CChanceTreeTraceJob()
+{
+    delete m_rootNode;
+    delete m_trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceJob::takeTrace
+///
+/// @description  Hands over the trace made by the job.
+/// @pre          The job has finished.
+/// @post         The caller owns the trace.
+///
+/// @return SChanceTreeTrace *: The trace.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+SChanceTreeTrace *CChanceTreeTraceJob::takeTrace()
+{
+    SChanceTreeTrace *trace = m_trace;
+    m_trace = NULL;
+    return trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceJob::execute
+///
+/// @description  Runs the trace. This is called on a worker thread.
+/// @pre          None
+/// @post         The trace is made and owns the copy of the tree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CChanceTreeTraceJob::execute()
+{
+    m_trace = m_selector->trace( m_rootNode, m_traceConf, m_depth, m_qsDepth,
+                                 m_lowerBound, m_upperBound, cancelToken() );
+
+    // The lines of the trace refer to the nodes of the copy, so it goes with
+    // the trace.
+    if( m_trace != NULL )
+    {
+        m_trace->s_graph = m_rootNode;
+        m_rootNode = NULL;
+    }
+}
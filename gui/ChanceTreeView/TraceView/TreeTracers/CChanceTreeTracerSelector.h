@@ -21,10 +21,50 @@
 #include <QToolButton>
 
 #include "CExpectMTracer.h"
+#include "CExpectMCTSTracer.h"
+#include "../../../CTraceRunner.h"
 class QComboBox;
 class QSpinBox;
 class QMenu;
 class QLabel;
+class CChanceTreeTracerSelector;
+
+////////////////////////////////////////////////////////////////////////////////
+/// CChanceTreeTraceJob
+///
+/// @description  A trace of a chance tree to be run by a CTraceRunner. It
+///               holds a copy of the tree and of the selector settings as they
+///               were when the job was made.
+///
+/// @limitations  The selector must outlive the job.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CChanceTreeTraceJob : public ITraceJob
+{
+public:
+    CChanceTreeTraceJob( const CChanceTreeTracerSelector *selector,
+                         const SChanceTreeNode *rootNode,
+                         const STraceConfig &traceConf,
+                         int depth, int qsDepth,
+                         int lowerBound, int upperBound );
+    ~CChanceTreeTraceJob();
+
+    SChanceTreeTrace *takeTrace();
+
+protected:
+    void execute();
+
+private:
+    const CChanceTreeTracerSelector    *m_selector;
+    SChanceTreeNode                    *m_rootNode;
+    STraceConfig                        m_traceConf;
+    int                                 m_depth;
+    int                                 m_qsDepth;
+    int                                 m_lowerBound;
+    int                                 m_upperBound;
+    SChanceTreeTrace                   *m_trace;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CChanceTreeTracerSelector
 ///
@@ -49,10 +89,18 @@ public:
     QToolButton * getAIConfigButton();
     QSpinBox *getDepthSelector();
     QSpinBox *getQSDepthSelector();
+    int depthLimit() const;
+    int qsDepth() const;
     QSpinBox *getLowerBoundSelector();
     QSpinBox *getUpperBoundSelector();
     QLabel *getAILabel();
-    SChanceTreeTrace *trace( const SChanceTreeNode *rootNode ) const;
+    CChanceTreeTraceJob *createJob( const SChanceTreeNode *rootNode ) const;
+    QByteArray traceKey( const SChanceTreeNode *rootNode ) const;
+    SChanceTreeTrace *trace( const SChanceTreeNode *rootNode,
+                             const STraceConfig &traceConf,
+                             int depth, int qsDepth,
+                             int lowerBound, int upperBound,
+                             const QAtomicInt *cancel = NULL ) const;
 
 
 public slots:
@@ -60,9 +108,18 @@ public slots:
     void toggleID();
     void toggleDL();
     void toggleAB();
+    void toggleStar2();
     void toggleHT();
     void toggleQS();
     void toggleSSS();
+    void toggleTT();
+    void toggleMCTS();
+    void toggleSampling();
+    void toggleParallel();
+    void setPlayouts();
+    void setThreads();
+    void setSamples();
+    void setSeed();
     void activate();
 
 signals:
@@ -86,15 +143,25 @@ private:
     QLabel               *m_aiLabel;
     QList<CExpectMTracer *>  m_tracers;
     CExpectMTracer       m_generalTracer;
+    CExpectMCTSTracer    m_mctsTracer;
 
     STraceConfig m_traceConf;
 
     QAction * m_actionID;
     QAction * m_actionDL;
     QAction * m_actionAB;
+    QAction * m_actionStar2;
     QAction * m_actionHT;
     QAction * m_actionQS;
     QAction * m_actionSSS;
+    QAction * m_actionTT;
+    QAction * m_actionMCTS;
+    QAction * m_actionPlayouts;
+    QAction * m_actionThreads;
+    QAction * m_actionSampling;
+    QAction * m_actionSamples;
+    QAction * m_actionSeed;
+    QAction * m_actionParallel;
 
 };
 
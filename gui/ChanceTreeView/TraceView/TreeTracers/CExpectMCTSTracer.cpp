@@ -0,0 +1,696 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CExpectMCTSTracer.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the
+///               CExpectMCTSTracer class. It estimates the value of a chance
+///               tree with Monte Carlo Tree Search run over several threads.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CExpectMCTSTracer.h"
+#include <QRunnable>
+#include <QtAlgorithms>
+#include <cmath>
+#include <cstring>
+#define INF 10000
+// Exploration constant of UCB1, for results scaled to [0,1].
+#define UCT_C 1.414f
+// Number of snapshots of the root taken over the whole search.
+#define SNAPSHOTS 10
+
+////////////////////////////////////////////////////////////////////////////////
+/// Helpers for keeping floats in a QAtomicInt.
+////////////////////////////////////////////////////////////////////////////////
+static float toFloat( int bits )
+{
+    float value;
+    memcpy( &value, &bits, sizeof(value) );
+    return value;
+}
+
+static int toBits( float value )
+{
+    int bits;
+    memcpy( &bits, &value, sizeof(bits) );
+    return bits;
+}
+
+static void atomicAdd( QAtomicInt &target, float delta )
+{
+    int oldBits;
+    do
+    {
+        oldBits = target;
+    } while( !target.testAndSetOrdered( oldBits,
+                                        toBits( toFloat(oldBits) + delta ) ) );
+}
+
+static void atomicMin( QAtomicInt &target, float value )
+{
+    int oldBits;
+    do
+    {
+        oldBits = target;
+        if( toFloat(oldBits) <= value )
+            return;
+    } while( !target.testAndSetOrdered( oldBits, toBits(value) ) );
+}
+
+static void atomicMax( QAtomicInt &target, float value )
+{
+    int oldBits;
+    do
+    {
+        oldBits = target;
+        if( toFloat(oldBits) >= value )
+            return;
+    } while( !target.testAndSetOrdered( oldBits, toBits(value) ) );
+}
+
+// Simple generator so each thread has its own random sequence.
+static quint32 nextRandom( quint32 &seed )
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+static bool snapshotLessThan( const SExpectMCTSSnapshot &a,
+                              const SExpectMCTSSnapshot &b )
+{
+    return a.s_playouts < b.s_playouts;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSWorker
+///
+/// @description  Runs simulations on a pool thread until the playout budget
+///               is used up.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CExpectMCTSWorker : public QRunnable
+{
+public:
+    CExpectMCTSWorker( const CExpectMCTSTracer *tracer,
+                       SExpectMCTSContext *context, quint32 seed )
+        : m_tracer( tracer ), m_context( context ), m_seed( seed ) {}
+
+    void run()
+    {
+        m_tracer->runWorker( *m_context, m_seed );
+    }
+
+private:
+    const CExpectMCTSTracer *m_tracer;
+    SExpectMCTSContext      *m_context;
+    quint32                  m_seed;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer::CExpectMCTSTracer
+///
+/// @description    This is the constructor of the CExpectMCTSTracer class.
+/// @pre            None
+/// @post           Object is created.
+///
+/// @param          None.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+CExpectMCTSTracer::CExpectMCTSTracer()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer::trace
+///
+/// @description    Runs a trace on the root node with a context of its own.
+/// @pre            rootNode points to node trace from.
+/// @post           returns trace.
+///
+/// @param rootNode: Node to trace from.
+///        depthLimit: Depth Limit.
+///        qsDepth: Quiessance depth.
+///        traceConf: struct with trace parameters.
+///
+/// @return SChanceTreeTrace *: Pointer to chance tree trace.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SChanceTreeTrace *CExpectMCTSTracer::trace( const SChanceTreeNode *rootNode,
+    int depthLimit, int qsDepth, const STraceConfig &traceConf ) const
+{
+    SExpectMCTSContext context( traceConf );
+    return trace( rootNode, depthLimit, qsDepth, context );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer::trace
+///
+/// @description    Runs the configured number of simulations from the root
+///                 node and builds a trace of the root statistics. All of
+///                 the state of the run is kept in context.
+/// @pre            rootNode points to node trace from.
+/// @post           returns trace.
+///
+/// @param rootNode: Node to trace from.
+///        depthLimit: Depth Limit.
+///        qsDepth: Quiessance depth.
+///        context: State of the run, with the trace parameters.
+///
+/// @return SChanceTreeTrace *: Pointer to chance tree trace.
+///
+/// @limitations    A cancelled trace only has the snapshots taken so far.
+///
+////////////////////////////////////////////////////////////////////////////////
+SChanceTreeTrace *CExpectMCTSTracer::trace( const SChanceTreeNode *rootNode,
+    int depthLimit, int qsDepth, SExpectMCTSContext &context ) const
+{
+    const STraceConfig &traceConf = context.s_conf;
+
+    SChanceTreeTrace *newTrace = new SChanceTreeTrace;
+    newTrace->s_columnNames =
+        QString("playouts|action|visits|value|best action,value").split('|');
+
+    if( rootNode == NULL )
+        return newTrace;
+    if( rootNode->s_childList.isEmpty() || rootNode->s_chance )
+        return newTrace;
+
+    int depth = traceConf.s_isDL ? depthLimit : INF;
+    if( !traceConf.s_isQS )
+        qsDepth = 0;
+
+    // The root is expanded up front so the snapshots always have its
+    // children to look at.
+    context.s_root = new SExpectMCTSNode( rootNode, depth, qsDepth, true );
+    context.s_root->s_endPoint = false;
+    expand( context.s_root );
+    context.s_root->s_expanded = SExpectMCTSNode::Expanded;
+    context.s_playouts = qMax( 1, traceConf.s_playouts );
+    context.s_snapshotInterval = qMax( 1, context.s_playouts / SNAPSHOTS );
+    context.s_started = 0;
+    context.s_completed = 0;
+    context.s_lowValue = toBits( INF );
+    context.s_highValue = toBits( -INF );
+    context.s_snapshots.clear();
+
+    int threads = qMax( 1, traceConf.s_threads );
+    context.s_pool.setMaxThreadCount( qMax( 1, threads - 1 ) );
+    for( int i = 1; i < threads; ++i )
+        context.s_pool.start( new CExpectMCTSWorker( this, &context, i ) );
+    runWorker( context, 0 );
+    context.s_pool.waitForDone();
+
+    // Snapshots are taken by whichever thread finished the playout, so they
+    // may have been added out of order.
+    qSort( context.s_snapshots.begin(), context.s_snapshots.end(),
+           snapshotLessThan );
+
+    QList<const SChanceTreeNode *> actions;
+    SExpectMCTSNode *child;
+    foreach( child, context.s_root->s_children )
+        actions.append( child->s_node );
+
+    SExpectMCTSSnapshot snapshot;
+    foreach( snapshot, context.s_snapshots )
+    {
+        SChanceTreeCall *call = new SChanceTreeCall;
+
+        // The most visited child is the move MCTS would play.
+        int best = 0;
+        for( int i = 1; i < snapshot.s_visits.count(); ++i )
+            if( snapshot.s_visits.at(i) > snapshot.s_visits.at(best) )
+                best = i;
+
+        for( int i = 0; i < actions.count(); ++i )
+        {
+            SExpectMLine *curLine = new SExpectMLine;
+            curLine->s_cells << (i == 0 ? QString::number(snapshot.s_playouts)
+                                        : QString())
+                             << CExpectMTracer::moveName( actions.at(i) )
+                             << QString::number( snapshot.s_visits.at(i) );
+            if( snapshot.s_visits.at(i) > 0 )
+                curLine->s_cells << SExpectMLine::numberToString(
+                                        snapshot.s_values.at(i) );
+            else
+                curLine->s_cells << "-";
+            if( i == actions.count() - 1 )
+                curLine->s_cells << QString("%1,%2")
+                    .arg( CExpectMTracer::moveName( actions.at(best) ) )
+                    .arg( SExpectMLine::numberToString(
+                              snapshot.s_values.at(best) ) );
+            else
+                curLine->s_cells << "";
+            call->s_lines.append( curLine );
+        }
+        call->s_returnValue = snapshot.s_values.at(best);
+        newTrace->s_depths.append( call );
+    }
+
+    delete context.s_root;
+    context.s_root = NULL;
+    return newTrace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer::runWorker
+///
+/// @description    Runs simulations until the playout budget is used up or
+///                 the trace is cancelled.
+/// @pre            context.s_root points to the root of the search tree.
+/// @post           None
+///
+/// @param context: State of the run.
+///        seed:    Seed of the random playouts of this thread.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CExpectMCTSTracer::runWorker( SExpectMCTSContext &context,
+                                   quint32 seed ) const
+{
+    int playouts;
+    while( !context.isCancelled()
+           && context.s_started.fetchAndAddRelaxed(1) < context.s_playouts )
+    {
+        simulate( context, seed );
+
+        playouts = context.s_completed.fetchAndAddOrdered(1) + 1;
+        if( playouts % context.s_snapshotInterval == 0
+            || playouts == context.s_playouts )
+            takeSnapshot( context, playouts );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer::simulate
+///
+/// @description    Runs one simulation: selection, expansion, a random
+///                 playout and backing up the result.
+/// @pre            context.s_root points to the root of the search tree.
+/// @post           The statistics of the nodes on the path are updated.
+///
+/// @param context: State of the run.
+///        seed:    Seed of the random playouts of this thread.
+///
+/// @return float:  Result of the simulation, from max's point of view.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+float CExpectMCTSTracer::simulate( SExpectMCTSContext &context,
+                                  quint32 &seed ) const
+{
+    QList<SExpectMCTSNode *> path;
+    SExpectMCTSNode *node = context.s_root;
+    path.append( node );
+    node->s_virtualLoss.ref();
+
+    while( !node->s_endPoint )
+    {
+        if( node->s_expanded.fetchAndAddOrdered(0)
+            != SExpectMCTSNode::Expanded )
+        {
+            // Only one thread expands a node. Any other that gets here first
+            // plays out from the node as it is.
+            if( !node->s_expanded.testAndSetOrdered(
+                                      SExpectMCTSNode::Unexpanded,
+                                      SExpectMCTSNode::Expanding ) )
+                break;
+            expand( node );
+            node->s_expanded.fetchAndStoreOrdered( SExpectMCTSNode::Expanded );
+
+            node = select( context, node, seed );
+            path.append( node );
+            node->s_virtualLoss.ref();
+            break;
+        }
+
+        node = select( context, node, seed );
+        path.append( node );
+        node->s_virtualLoss.ref();
+    }
+
+    float value = rollout( node, seed );
+    atomicMin( context.s_lowValue, value );
+    atomicMax( context.s_highValue, value );
+
+    foreach( node, path )
+    {
+        atomicAdd( node->s_valueSum, value );
+        node->s_visits.ref();
+        node->s_virtualLoss.deref();
+    }
+    return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer::select
+///
+/// @description    Picks the child of an expanded node. At a chance node the
+///                 child is drawn by its probability. Otherwise it is the one
+///                 with the highest UCB1 score for the player to move, and
+///                 children that have not been tried yet are picked first.
+/// @pre            node has been expanded.
+/// @post           None
+///
+/// @param context: State of the run.
+///        node:    Node to pick a child of.
+///        seed:    Seed of the random draws of this thread.
+///
+/// @return SExpectMCTSNode *: Chosen child.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SExpectMCTSNode *CExpectMCTSTracer::select(
+    const SExpectMCTSContext &context, const SExpectMCTSNode *node,
+    quint32 &seed ) const
+{
+    if( node->s_node->s_chance )
+        return node->s_children.at( sampleChance( node->s_node, seed ) );
+
+    float low = toFloat( context.s_lowValue );
+    float high = toFloat( context.s_highValue );
+    float range = (high > low) ? high - low : 1;
+    // A virtual loss is the worst result for the player to move.
+    float loss = node->s_max ? low : high;
+    if( low > high )
+        loss = 0;
+
+    int parentVisits = node->s_visits + node->s_virtualLoss;
+    float logVisits = log( (float)qMax( 1, parentVisits ) );
+
+    SExpectMCTSNode *best = NULL;
+    float bestScore = 0;
+    float score, mean;
+    int visits, virtualLoss;
+    SExpectMCTSNode *child;
+    foreach( child, node->s_children )
+    {
+        virtualLoss = child->s_virtualLoss;
+        visits = child->s_visits + virtualLoss;
+        if( visits == 0 )
+            return child;
+
+        mean = (toFloat( child->s_valueSum ) + virtualLoss * loss) / visits;
+        score = (node->s_max ? mean : -mean)
+                + UCT_C * range * sqrt( logVisits / visits );
+        if( best == NULL || score > bestScore )
+        {
+            best = child;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer::expand
+///
+/// @description    Adds the children of a node to the search tree. Depth is
+///                 only used up by moving into a decision node, as in the
+///                 expectiminimax trace.
+/// @pre            This thread has set node->s_expanded to Expanding.
+/// @post           node->s_children holds a node for each child.
+///
+/// @param node:    Node to expand.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CExpectMCTSTracer::expand( SExpectMCTSNode *node ) const
+{
+    int depth, qsDepth;
+    SChanceTreeNode *curNode;
+    foreach( curNode, node->s_node->s_childList )
+    {
+        depth = node->s_depth;
+        qsDepth = node->s_qsDepth;
+        if( !curNode->s_chance )
+        {
+            if( depth > 0 )
+                depth--;
+            else
+                qsDepth--;
+        }
+        node->s_children.append( new SExpectMCTSNode( curNode, depth, qsDepth,
+                                   curNode->s_chance ? node->s_max
+                                                     : !node->s_max ) );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer::rollout
+///
+/// @description    Plays random moves from a node until an end point is
+///                 reached. Chance nodes are played by their probabilities.
+/// @pre            None
+/// @post           None
+///
+/// @param node:    Node to play out from.
+///        seed:    Seed of the random playouts of this thread.
+///
+/// @return float:  Value of the end point reached.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+float CExpectMCTSTracer::rollout( const SExpectMCTSNode *node,
+                                  quint32 &seed ) const
+{
+    const SChanceTreeNode *curNode = node->s_node;
+    int depth = node->s_depth;
+    int qsDepth = node->s_qsDepth;
+    bool endPoint = node->s_endPoint;
+
+    int i;
+    while( !endPoint )
+    {
+        const QList<SChanceTreeNode *> &children = curNode->s_childList;
+        if( curNode->s_chance )
+            i = sampleChance( curNode, seed );
+        else
+            i = nextRandom(seed) % children.count();
+        curNode = children.at(i);
+
+        if( curNode->s_chance )
+        {
+            endPoint = (curNode->s_childList.count() == 0);
+            continue;
+        }
+        if( depth > 0 )
+            depth--;
+        else
+            qsDepth--;
+        endPoint = (curNode->s_childList.count() == 0)
+                   || (depth == 0 && (!curNode->s_quiescent || qsDepth == 0));
+    }
+    return curNode->s_value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer::sampleChance
+///
+/// @description    Draws a child of a chance node by the probabilities of
+///                 the children.
+/// @pre            node is a chance node with children.
+/// @post           None
+///
+/// @param node:    Chance node to draw a child of.
+///        seed:    Seed of the random draws of this thread.
+///
+/// @return int:    Index of the child drawn.
+///
+/// @limitations    If no child has a positive probability, each is equally
+///                 likely.
+///
+////////////////////////////////////////////////////////////////////////////////
+int CExpectMCTSTracer::sampleChance( const SChanceTreeNode *node,
+                                     quint32 &seed ) const
+{
+    const QList<SChanceTreeNode *> &children = node->s_childList;
+
+    qreal total = 0;
+    SChanceTreeNode *curNode;
+    foreach( curNode, children )
+        total += qMax( (qreal)0, curNode->s_probability );
+    if( total <= 0 )
+        return nextRandom(seed) % children.count();
+
+    qreal draw = total * (nextRandom(seed) % 32768) / 32768;
+    for( int i = 0; i < children.count(); ++i )
+    {
+        draw -= qMax( (qreal)0, children.at(i)->s_probability );
+        if( draw < 0 )
+            return i;
+    }
+    return children.count() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer::takeSnapshot
+///
+/// @description    Records the statistics of the children of the root.
+/// @pre            context.s_root has been expanded.
+/// @post           A snapshot is added to context.s_snapshots.
+///
+/// @param context: State of the run.
+///        playouts: Number of simulations finished so far.
+///
+/// @return         None.
+///
+/// @limitations    Simulations still running on other threads may be partly
+///                 counted.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CExpectMCTSTracer::takeSnapshot( SExpectMCTSContext &context,
+                                      int playouts ) const
+{
+    SExpectMCTSSnapshot snapshot;
+    snapshot.s_playouts = playouts;
+
+    int visits;
+    SExpectMCTSNode *child;
+    foreach( child, context.s_root->s_children )
+    {
+        visits = child->s_visits;
+        snapshot.s_visits.append( visits );
+        snapshot.s_values.append( visits > 0
+                                  ? toFloat( child->s_valueSum ) / visits
+                                  : 0 );
+    }
+
+    QMutexLocker locker( &context.s_snapshotMutex );
+    context.s_snapshots.append( snapshot );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMCTSContext::SExpectMCTSContext
+///
+/// @description    This is the constructor of the SExpectMCTSContext struct.
+/// @pre            None
+/// @post           The context is ready for a run with no search tree.
+///
+/// @param conf:    The trace parameters.
+///        cancel:  Set to non zero to stop the run early, or NULL.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SExpectMCTSContext::SExpectMCTSContext( const STraceConfig &conf,
+                                        const QAtomicInt *cancel )
+{
+    s_conf = conf;
+    s_cancel = cancel;
+    s_root = NULL;
+    s_playouts = 0;
+    s_snapshotInterval = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMCTSContext::~SExpectMCTSContext
+///
+/// @description    This is the destructor of the SExpectMCTSContext struct.
+/// @pre            None
+/// @post           All pool threads have finished and the search tree is
+///                 deleted.
+///
+/// @param          None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SExpectMCTSContext::~SExpectMCTSContext()
+{
+    s_pool.waitForDone();
+    delete s_root;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMCTSContext::isCancelled
+///
+/// @description    Checks the cancellation token of the run.
+/// @pre            None
+/// @post           None
+///
+/// @param          None.
+///
+/// @return bool:   true if the run has been asked to stop.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool SExpectMCTSContext::isCancelled() const
+{
+    return s_cancel != NULL && (int)*s_cancel != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMCTSNode::SExpectMCTSNode
+///
+/// @description    This is the constructor of the SExpectMCTSNode struct.
+/// @pre            node points to a node of the chance tree.
+/// @post           Object is created with no statistics.
+///
+/// @param node:    Node of the chance tree.
+///        depth:   Remaining depth at the node.
+///        qsDepth: Remaining quiessence depth at the node.
+///        max:     true if max is to move at the node, or for a chance
+///                 node if max moved into it.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SExpectMCTSNode::SExpectMCTSNode( const SChanceTreeNode *node, int depth,
+                                  int qsDepth, bool max )
+{
+    s_node = node;
+    s_depth = depth;
+    s_qsDepth = qsDepth;
+    s_max = max;
+    if( node->s_chance )
+        s_endPoint = (node->s_childList.count() == 0);
+    else
+        s_endPoint = (node->s_childList.count() == 0)
+                     || (depth == 0 && (!node->s_quiescent || qsDepth == 0));
+
+    s_expanded = Unexpanded;
+    s_visits = 0;
+    s_virtualLoss = 0;
+    s_valueSum = toBits( 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMCTSNode::~SExpectMCTSNode
+///
+/// @description    This is the destructor of the SExpectMCTSNode struct.
+/// @pre            None
+/// @post           The children are deleted.
+///
+/// @param          None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SExpectMCTSNode::~SExpectMCTSNode()
+{
+    while( !s_children.isEmpty() )
+        delete s_children.takeFirst();
+}
@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CExpectMCTSTracer.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the CExpectMCTSTracer
+///               class. It estimates the value of a chance tree with Monte
+///               Carlo Tree Search run over several threads.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CEXPECTMCTSTRACER_H_
+#define _CEXPECTMCTSTRACER_H_
+
+#include "../../SChanceTreeTrace.h"
+#include "../../CChanceTreeGraph.h"
+#include "CExpectMTracer.h"
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QThreadPool>
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMCTSNode
+///
+/// @description  A node of the search tree grown by MCTS. It mirrors a node of
+///               the chance tree and holds the statistics of the simulations
+///               that went through it. The counters are only ever changed
+///               atomically, so threads never lock a node.
+///
+/// @limitations  s_children must not be read until s_expanded is Expanded.
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SExpectMCTSNode
+{
+    SExpectMCTSNode( const SChanceTreeNode *node, int depth, int qsDepth,
+                     bool max );
+    ~SExpectMCTSNode();
+
+    enum ExpandState
+    {
+        Unexpanded,
+        Expanding,
+        Expanded
+    };
+
+    const SChanceTreeNode    *s_node;
+    int                       s_depth;
+    int                       s_qsDepth;
+    // True if max is to move, or for a chance node if max moved into it.
+    bool                      s_max;
+    // True if the node is evaluated rather than searched.
+    bool                      s_endPoint;
+
+    QAtomicInt                s_expanded;
+    QList<SExpectMCTSNode *>  s_children;
+
+    QAtomicInt                s_visits;
+    // Simulations currently passing through the node. Each one counts as a
+    // loss until it is backed up, which steers other threads elsewhere.
+    QAtomicInt                s_virtualLoss;
+    // Sum of the simulation results, from max's point of view. Holds the bits
+    // of a float so it can be updated with compare and swap.
+    QAtomicInt                s_valueSum;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMCTSSnapshot
+///
+/// @description  The statistics of the children of the root after a given
+///               number of simulations.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SExpectMCTSSnapshot
+{
+    int                 s_playouts;
+    QList<int>          s_visits;
+    QList<float>        s_values;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMCTSContext
+///
+/// @description  Everything that belongs to one run of CExpectMCTSTracer: the
+///               configuration, the cancellation token, the thread pool, the
+///               search tree and the statistics the simulations share. The
+///               tracer itself holds no state, so several runs may share it
+///               as long as each has a context of its own.
+///
+/// @limitations  A context may only be used by one run at a time.
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SExpectMCTSContext
+{
+    SExpectMCTSContext( const STraceConfig &conf,
+                        const QAtomicInt *cancel = NULL );
+    ~SExpectMCTSContext();
+
+    bool isCancelled() const;
+
+    STraceConfig        s_conf;
+    // The run stops early once this is set to non-zero. May be NULL.
+    const QAtomicInt   *s_cancel;
+
+    QThreadPool         s_pool;
+    SExpectMCTSNode    *s_root;
+    int                 s_playouts;
+    int                 s_snapshotInterval;
+
+    QAtomicInt          s_started;
+    QAtomicInt          s_completed;
+    // Lowest and highest simulation results so far, as float bits. They scale
+    // the exploration term to the values found in the tree.
+    QAtomicInt          s_lowValue;
+    QAtomicInt          s_highValue;
+
+    QMutex              s_snapshotMutex;
+    QList<SExpectMCTSSnapshot> s_snapshots;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMCTSTracer
+///
+/// @description  This class runs UCT Monte Carlo Tree Search. Each simulation
+///               walks down the search tree picking children by UCB1, adds
+///               the children of the node it stops at, plays randomly to an
+///               end point and backs the value up the path. Several threads
+///               share the one search tree and use virtual loss to spread out
+///               over it.
+///
+///               At chance nodes the child is drawn by its probability
+///               rather than picked by UCB1, so the values found are
+///               expected values.
+///
+///               Rather than a line per simulation, the trace shows the
+///               statistics of the children of the root at regular intervals,
+///               so the answer can be read at any point of the search.
+///               The state of a run is kept in an SExpectMCTSContext.
+///
+/// @limitations  The result is an estimate. It approaches the expectiminimax value
+///               as the number of playouts grows. The root must be a
+///               decision node.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CExpectMCTSTracer
+{
+public:
+    CExpectMCTSTracer();
+
+    SChanceTreeTrace *trace( const SChanceTreeNode *rootNode, int depthLimit,
+                             int qsDepth, const STraceConfig &traceConf ) const;
+    SChanceTreeTrace *trace( const SChanceTreeNode *rootNode, int depthLimit,
+                             int qsDepth, SExpectMCTSContext &context ) const;
+
+private:
+    friend class CExpectMCTSWorker;
+
+    void runWorker( SExpectMCTSContext &context, quint32 seed ) const;
+    float simulate( SExpectMCTSContext &context, quint32 &seed ) const;
+    SExpectMCTSNode *select( const SExpectMCTSContext &context,
+                             const SExpectMCTSNode *node,
+                             quint32 &seed ) const;
+    void expand( SExpectMCTSNode *node ) const;
+    float rollout( const SExpectMCTSNode *node, quint32 &seed ) const;
+    int sampleChance( const SChanceTreeNode *node, quint32 &seed ) const;
+    void takeSnapshot( SExpectMCTSContext &context, int playouts ) const;
+};
+
+#endif//_CEXPECTMCTSTRACER_H_
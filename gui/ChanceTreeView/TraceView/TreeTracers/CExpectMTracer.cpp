@@ -14,9 +14,115 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "CExpectMTracer.h"
+#include "../../SChanceTreeTrace.h"
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <cmath>
 #define INF 10000
 #define MIN(a,b) ((a) <= (b) ? (a) : (b))
 #define MAX(a,b) ((a) >= (b) ? (a) : (b))
+// Chance nodes this many parallel chance nodes down are searched on one
+// thread; their subtrees are too small to be worth sharing out.
+#define MAX_SPLIT_LEVELS 3
+
+////////////////////////////////////////////////////////////////////////////////
+/// moveToFront
+///
+/// @description    Moves the child at position i of a search order to the
+///                 front, keeping the order of the others.
+///
+////////////////////////////////////////////////////////////////////////////////
+static void moveToFront( ExpectChildOrder &nodes, int i )
+{
+    int node = nodes[i];
+    for( ; i > 0; --i )
+        nodes[i] = nodes[i - 1];
+    nodes[0] = node;
+}
+
+// Simple generator, so a sampled trace is the same on every platform.
+static quint32 nextRandom( quint32 &seed )
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMTask
+///
+/// @description  The search of one child of a parallel chance node. It runs
+///               with a copy of the context of the chance node, so it sees the
+///               tables as they were when the chance node began whichever
+///               thread runs it and whenever it does.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SExpectMTask
+{
+    // Where the child is in the search order of the chance node.
+    int                 s_child;
+    int                 s_node;
+    int                 s_depth;
+    int                 s_qsDepth;
+    SChanceTreeCall    *s_call;
+    SExpectMContext    *s_context;
+    bool                s_success;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMSplit
+///
+/// @description  A chance node whose children are being searched by several
+///               threads at once. s_next and s_helpers are guarded by
+///               s_mutex; each task is only touched by the thread that took
+///               it until all are done.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SExpectMSplit
+{
+    const SExpectMContext  *s_context;
+    bool                    s_max;
+    QVector<SExpectMTask>   s_tasks;
+
+    int                     s_next;
+    int                     s_helpers;
+    QMutex                  s_mutex;
+    QWaitCondition          s_helpersDone;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMSplitHelper
+///
+/// @description  Runs on a pool thread and searches children of a parallel
+///               chance node until none are left.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CExpectMSplitHelper : public QRunnable
+{
+public:
+    CExpectMSplitHelper( const CExpectMTracer *tracer, SExpectMSplit *split )
+        : m_tracer( tracer ), m_split( split ) {}
+
+    void run()
+    {
+        m_tracer->searchSplit( m_split );
+
+        QMutexLocker locker( &m_split->s_mutex );
+        m_split->s_helpers--;
+        m_split->s_helpersDone.wakeAll();
+    }
+
+private:
+    const CExpectMTracer   *m_tracer;
+    SExpectMSplit          *m_split;
+};
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CExpectMTracer::CExpectMTracer
@@ -39,26 +145,55 @@ CExpectMTracer::CExpectMTracer()
 ////////////////////////////////////////////////////////////////////////////////
 /// CExpectMTracer::generateHistoryTable
 ///
-/// @description    Adds history table entries of node to internal history table,
-///                 and recurses on all children.
-/// @pre            "node" points to an SChanceTreeNode object.
-/// @post           History table entries of tree with "node" as the root have
-///                 been added to m_historyTable.
+/// @description    Fills the history table with the preset history value of
+///                 every node of the compiled tree.
+/// @pre            context.s_tree holds the tree.
+/// @post           Every node of the tree has an entry in
+///                 context.s_historyTable.
+///
+/// @param context: State of the run.
+///
+/// @return         None.
 ///
-/// @param node:    Pointer to a node.
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CExpectMTracer::generateHistoryTable( SExpectMContext &context ) const
+{
+    const CCompiledChanceTree &tree = context.s_tree;
+    int nodeCount = tree.count();
+
+    context.s_historyTable.resize( nodeCount );
+    for( int i = 0; i < nodeCount; ++i )
+        context.s_historyTable[i] = tree.history( i );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::childOrder
+///
+/// @description    Gets the children of a node in the order of the tree,
+///                 ready to be put in search order.
+/// @pre            None
+/// @post           nodes holds the children of node.
+///
+/// @param node:    The node.
+///        nodes:   Receives the children.
+///        context: State of the run.
 ///
 /// @return         None.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void CExpectMTracer::generateHistoryTable( const SChanceTreeNode *node ) const
+void CExpectMTracer::childOrder( SExpectMContext &context, int node,
+                                 ExpectChildOrder &nodes ) const
 {
-    m_historyTable.insert( node, node->s_history );
+    const CCompiledChanceTree &tree = context.s_tree;
+    int childCount = tree.childCount( node );
 
-    const SChanceTreeNode *i;
-    foreach( i, node->s_childList )
-        generateHistoryTable( i );
+    nodes.resize( childCount );
+    for( int i = 0; i < childCount; ++i )
+        nodes[i] = tree.child( node, i );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -76,7 +211,7 @@ void CExpectMTracer::generateHistoryTable( const SChanceTreeNode *node ) const
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QString CExpectMTracer::moveName( const SChanceTreeNode *node ) const
+QString CExpectMTracer::moveName( const SChanceTreeNode *node )
 {
     if( node == NULL )
         return QString();
@@ -99,16 +234,18 @@ QString CExpectMTracer::moveName( const SChanceTreeNode *node ) const
 /// @post           nodes is now sorted in order of descending history table
 ///                 entries.
 ///
-/// @param nodes:   List of pointers to SChanceTreeNode object.
+/// @param nodes:   The nodes.
+///        context: State of the run.
 ///
 /// @return         None.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void CExpectMTracer::sortNodes( QList<SChanceTreeNode *> &nodes) const
+void CExpectMTracer::sortNodes( SExpectMContext &context,
+                                ExpectChildOrder &nodes) const
 {
-    if(!m_conf.s_isHT)
+    if(!context.s_conf.s_isHT)
         return;
     int nodeCount = nodes.count();
     int i, j, h1, h2;
@@ -116,52 +253,299 @@ void CExpectMTracer::sortNodes( QList<SChanceTreeNode *> &nodes) const
     {
         for( j = 0; j < nodeCount-1-i; ++j )
         {
-            h1 = m_historyTable[nodes.at(j)];
-            h2 = m_historyTable[nodes.at(j+1)];
+            h1 = context.s_historyTable[nodes[j]];
+            h2 = context.s_historyTable[nodes[j+1]];
             if( h2 > h1 )
-                nodes.swap(j,j+1);
+                qSwap( nodes[j], nodes[j+1] );
+        }
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::sampleChildren
+///
+/// @description    Draws the outcomes of a chance node for sparse sampling.
+///                 Each draw picks a child in proportion to its probability.
+///                 Only the children drawn are kept, so the search of a
+///                 chance node costs at most one child per draw however many
+///                 outcomes it has.
+/// @pre            nodes are the children of a chance node in search order.
+/// @post           nodes holds the children drawn, in the same order, and
+///                 counts how many times each was drawn.
+///
+/// @param context: State of the run, whose random state is advanced.
+///        nodes:   The children, replaced by those drawn.
+///        counts:  Filled with the number of draws of each child kept.
+///
+/// @return         None.
+///
+/// @limitations    If no child has a positive probability, each is equally
+///                 likely.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CExpectMTracer::sampleChildren( SExpectMContext &context,
+                                     ExpectChildOrder &nodes,
+                                     ExpectChildOrder &counts ) const
+{
+    const CCompiledChanceTree &tree = context.s_tree;
+    qreal total = 0;
+    for( int i = 0; i < nodes.count(); ++i )
+        total += qMax( (qreal)0, tree.probability( nodes[i] ) );
+
+    ExpectChildOrder drawn;
+    drawn.resize( nodes.count() );
+    for( int i = 0; i < drawn.count(); ++i )
+        drawn[i] = 0;
+    for( int d = 0; d < context.s_conf.s_samples; ++d )
+    {
+        int pick = nodes.count() - 1;
+        if( total <= 0 )
+            pick = nextRandom( context.s_random ) % nodes.count();
+        else
+        {
+            qreal draw = total * (nextRandom( context.s_random ) % 32768)
+                         / 32768;
+            for( int i = 0; i < nodes.count(); ++i )
+            {
+                draw -= qMax( (qreal)0, tree.probability( nodes[i] ) );
+                if( draw < 0 )
+                {
+                    pick = i;
+                    break;
+                }
+            }
         }
+        drawn[pick]++;
     }
 
+    // Keep the children drawn, in search order.
+    int kept = 0;
+    counts.clear();
+    for( int i = 0; i < nodes.count(); ++i )
+    {
+        if( drawn[i] == 0 )
+            continue;
+        nodes[kept++] = nodes[i];
+        counts.append( drawn[i] );
+    }
+    nodes.resize( kept );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::ttKey
+///
+/// @description    Returns the key of a node in the transposition table. Nodes
+///                 with the same subtree and the same player to move have the
+///                 same value, so they share a key.
+/// @pre            node is a node of the compiled tree.
+/// @post           None
+///
+/// @param node:    The node.
+///        max:     true if max is to move at the node, or right after it for
+///                 a chance node.
+///        context: State of the run.
+///
+/// @return int:    The key.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+int CExpectMTracer::ttKey( const SExpectMContext &context, int node,
+                           bool max ) const
+{
+    return context.s_tree.shape( node ) * 2 + ( max ? 1 : 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::probeTT
+///
+/// @description    Looks up node in the transposition table and decides if the
+///                 stored result can stand in for a search of the node.
+/// @pre            None
+/// @post           If true is returned, value and exhaustive hold the stored
+///                 result.
+///
+/// @param node:       Node about to be searched.
+///        max:        true if max is to move at node.
+///        depth:      Remaining depth of the search.
+///        qsDepth:    Remaining quiessence depth of the search.
+///        value:      Receives the stored value.
+///        exhaustive: Receives the stored exhaustive flag.
+///        context: State of the run.
+///
+/// @return bool:   true if the stored result can be used, false otherwise.
+///
+/// @limitations    Only exact entries are used. The bounds returned by a
+///                 Star-1 chance node cutoff are not tight enough to be
+///                 reused against a different window.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CExpectMTracer::probeTT( SExpectMContext &context,
+                              int node, bool max, int depth,
+                              int qsDepth, float &value,
+                              bool &exhaustive ) const
+{
+    ExpectTTable::const_iterator it =
+        context.s_transTable.constFind( ttKey( context, node, max ) );
+    if( it == context.s_transTable.constEnd() )
+        return false;
+
+    const SExpectMTTEntry &entry = it.value();
+    if( entry.s_bound != SExpectMTTEntry::Exact )
+        return false;
+
+    // A result is usable if it was searched at least as deep, or if it was
+    // never cut off by the depth limit and this search is no shallower.
+    bool deepEnough = entry.s_depth >= depth && entry.s_qsDepth >= qsDepth;
+    if( entry.s_exhaustive && depth >= entry.s_depth
+        && qsDepth >= entry.s_qsDepth )
+        deepEnough = true;
+    if( !deepEnough )
+        return false;
+
+    value = entry.s_value;
+    exhaustive = entry.s_exhaustive;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::storeTT
+///
+/// @description    Records the result of searching node in the transposition
+///                 table, replacing any older entry.
+/// @pre            None
+/// @post           context.s_transTable holds an entry for node.
+///
+/// @param node:       Node that was searched.
+///        max:        true if max is to move at node.
+///        depth:      Remaining depth of the search.
+///        qsDepth:    Remaining quiessence depth of the search.
+///        alpha:      Alpha value the search was started with.
+///        beta:       Beta value the search was started with.
+///        value:      Value returned by the search.
+///        bestChild:  Child that produced value, -1 for chance nodes.
+///        exhaustive: true if no leaf was cut off by the depth limit.
+///        context: State of the run.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CExpectMTracer::storeTT( SExpectMContext &context,
+                              int node, bool max, int depth,
+                              int qsDepth, float alpha, float beta,
+                              float value, int bestChild,
+                              bool exhaustive ) const
+{
+    SExpectMTTEntry entry;
+    entry.s_depth = depth;
+    entry.s_qsDepth = qsDepth;
+    entry.s_value = value;
+    entry.s_bestChild = bestChild;
+    entry.s_exhaustive = exhaustive;
+
+    // A value outside of the window is only a bound on the true value.
+    if( value <= alpha )
+        entry.s_bound = SExpectMTTEntry::UpperBound;
+    else if( value >= beta )
+        entry.s_bound = SExpectMTTEntry::LowerBound;
+    else
+        entry.s_bound = SExpectMTTEntry::Exact;
+
+    int key = ttKey( context, node, max );
+    context.s_transTable.insert( key, entry );
+    if( context.s_isTask )
+        context.s_stored.append( key );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::orderBestChild
+///
+/// @description    Moves the best child found by an earlier search of node, or
+///                 of a node with the same subtree, to the front of nodes so
+///                 it is searched first. The child is matched by its shape.
+/// @pre            nodes is the child list of node.
+/// @post           The remembered best child, if any, is first in nodes. The
+///                 order of the other children is unchanged.
+///
+/// @param node:    Node whose children are being ordered.
+///        max:     true if max is to move at node.
+///        nodes:   The children of node.
+///        context: State of the run.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CExpectMTracer::orderBestChild( SExpectMContext &context, int node,
+                                     bool max, ExpectChildOrder &nodes ) const
+{
+    if( !context.s_conf.s_isTT )
+        return;
+
+    int best = context.s_transTable.value( ttKey( context, node, max ) )
+                                   .s_bestChild;
+    if( best < 0 )
+        return;
+
+    const CCompiledChanceTree &tree = context.s_tree;
+    int bestShape = tree.shape( best );
+    int nodeCount = nodes.count();
+    for( int i = 1; i < nodeCount; ++i )
+    {
+        if( tree.shape( nodes[i] ) == bestShape )
+        {
+            moveToFront( nodes, i );
+            return;
+        }
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CExpectMTracer::sssHistoryUpdates
 ///
 /// @description    Descends an SSS chain, updating history table accordingly.
-/// @pre            node is a pointer to a tree node.
-/// @post           String list of history table updates is returned.
+/// @pre            node is a node of the compiled tree.
+/// @post           List of history table updates is returned.
 ///
 /// @param node:    Node to begin from.
 ///        depth:   depth limit to descend.
 ///        qsDepth: Quiessence Search Depth
 ///        top:     Indicates weather this is being called from outside.
 ///                 false is this is a recursive call.
+///        context: State of the run.
 ///
-/// @return         String list of history table updates.
+/// @return         List of history table updates.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QStringList CExpectMTracer::sssHistoryUpdates( const SChanceTreeNode *node,
-                                           int depth, int qsDepth,
-                                           bool top) const
+QVector<SExpectMHistoryUpdate> CExpectMTracer::sssHistoryUpdates(
+                                               SExpectMContext &context,
+                                               int node,
+                                               int depth, int qsDepth,
+                                               bool top) const
 {
-    QStringList ret;
+    const CCompiledChanceTree &tree = context.s_tree;
+    QVector<SExpectMHistoryUpdate> ret;
     if( !top )
     {
-        m_historyTable[node]++;
-        ret += moveName( node )
-             + ':' + QString::number( m_historyTable[node] );
+        SExpectMHistoryUpdate update;
+        update.s_node = tree.node( node );
+        update.s_value = ++context.s_historyTable[node];
+        ret.append( update );
     }
-    if( node->s_childList.count() == 0 )
+    if( tree.childCount( node ) == 0 )
         return ret;
 
-    if( !node->s_chance )
+    if( !tree.isChance( node ) )
     {
         if( depth == 0 )
         {
-            if( (!node->s_quiescent) || qsDepth == 0 )
+            if( (!tree.isQuiescent( node )) || qsDepth == 0 )
                 return ret;
             qsDepth--;
         }
@@ -170,7 +554,8 @@ QStringList CExpectMTracer::sssHistoryUpdates( const SChanceTreeNode *node,
     }
 
 
-    return sssHistoryUpdates( node->s_childList.first(), depth, qsDepth, false )
+    return sssHistoryUpdates( context, tree.child( node, 0 ),
+                              depth, qsDepth, false )
            + ret;
 }
 
@@ -178,32 +563,34 @@ QStringList CExpectMTracer::sssHistoryUpdates( const SChanceTreeNode *node,
 /// CExpectMTracer::checkSSS
 ///
 /// @description    Determines if node can do single successor shortcut.
-/// @pre            node points to an SChanceTreeNode.
+/// @pre            node is a node of the compiled tree.
 /// @post
 ///
 /// @param node:    Node to start from.
 ///        depth:   Depth to search to.
 ///        qsDepth: Quiessance depth.
+///        context: State of the run.
 ///
 /// @return bool:   true if SSS is apropriate, false otherwise.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool CExpectMTracer::checkSSS( const SChanceTreeNode *node,
-                                 int depth, int qsDepth ) const
+bool CExpectMTracer::checkSSS( SExpectMContext &context, int node,
+                               int depth, int qsDepth ) const
 {
-    if(!m_conf.s_allowSSS)
+    if(!context.s_conf.s_allowSSS)
         return false;
 
-    if( node->s_childList.count() == 0 )
+    const CCompiledChanceTree &tree = context.s_tree;
+    if( tree.childCount( node ) == 0 )
         return true;
 
-    if( !node->s_chance )
+    if( !tree.isChance( node ) )
     {
         if( depth == 0 )
         {
-            if( (!node->s_quiescent) || qsDepth == 0 )
+            if( (!tree.isQuiescent( node )) || qsDepth == 0 )
                 return true;
             qsDepth--;
         }
@@ -211,8 +598,8 @@ bool CExpectMTracer::checkSSS( const SChanceTreeNode *node,
             depth--;
     }
 
-    if( node->s_childList.count() == 1 )
-        return checkSSS( node->s_childList.first(), depth, qsDepth );
+    if( tree.childCount( node ) == 1 )
+        return checkSSS( context, tree.child( node, 0 ), depth, qsDepth );
 
     return false;
 }
@@ -227,34 +614,37 @@ bool CExpectMTracer::checkSSS( const SChanceTreeNode *node,
 /// @param node:    Node to start from.
 ///        depth:   Depth to search to.
 ///        qsDepth: Quiessance depth.
+///        context: State of the run.
 ///
 /// @return float:  value of bottom child node.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-float CExpectMTracer::sssValue( const SChanceTreeNode *node,
-                                  int depth, int qsDepth ) const
+float CExpectMTracer::sssValue( SExpectMContext &context, int node,
+                                int depth, int qsDepth ) const
 {
-    if( node->s_childList.count() == 0 )
-        return node->s_value;
+    const CCompiledChanceTree &tree = context.s_tree;
+    if( tree.childCount( node ) == 0 )
+        return tree.value( node );
 
     if( depth == 0 )
     {
-        if( (!node->s_quiescent) || qsDepth == 0 )
-            return node->s_value;
+        if( (!tree.isQuiescent( node )) || qsDepth == 0 )
+            return tree.value( node );
         qsDepth--;
     }
     else
         depth--;
 
-    return sssValue( node->s_childList.first(), depth, qsDepth );
+    return sssValue( context, tree.child( node, 0 ), depth, qsDepth );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CExpectMTracer::trace
 ///
-/// @description    Executes a trace on the root node.
+/// @description    Executes a trace on the root node with a context of its
+///                 own.
 /// @pre            rootNode points to node trace from.
 /// @post           returns trace.
 ///
@@ -262,6 +652,8 @@ float CExpectMTracer::sssValue( const SChanceTreeNode *node,
 ///        depthLimit: Depth Limit.
 ///        qsDepth: Quiessance depth.
 ///        traceConf: struct with trace parameters.
+///        lowerBound: Lowest value an end point can have.
+///        upperBound: Highest value an end point can have.
 ///
 /// @return SChanceTreeTrace *: Pointer to tree trace.
 ///
@@ -272,23 +664,51 @@ SChanceTreeTrace * CExpectMTracer::trace( const SChanceTreeNode *rootNode,
     int depthLimit, int qsDepth, const STraceConfig &traceConf,
     qreal lowerBound, qreal upperBound) const
 {
-    m_conf = traceConf;
+    SExpectMContext context( traceConf, lowerBound, upperBound );
+    return trace( rootNode, depthLimit, qsDepth, context );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::trace
+///
+/// @description    Executes a trace on the root node. All of the state of the
+///                 run is kept in context, so one tracer can run several
+///                 traces at once as long as each has its own context.
+/// @pre            rootNode points to node trace from.
+/// @post           returns trace. The statistics of context are filled in.
+///                 If the run was cancelled only the iterations it finished
+///                 are in the trace.
+///
+/// @param rootNode: Node to trace from.
+///        depthLimit: Depth Limit.
+///        qsDepth: Quiessance depth.
+///        context: Configuration and state of the run.
+///
+/// @return SChanceTreeTrace *: Pointer to tree trace.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SChanceTreeTrace * CExpectMTracer::trace( const SChanceTreeNode *rootNode,
+    int depthLimit, int qsDepth, SExpectMContext &context ) const
+{
+    const STraceConfig &conf = context.s_conf;
+    qreal lowerBound = context.s_lowerBound;
+    qreal upperBound = context.s_upperBound;
 
     QString header;
 
     // Setup collumn headers based on which collumns will be used.
-    m_lowerBound = lowerBound;
-    m_upperBound = upperBound;
     //header = "call|open|eval|value";
     header = "call|open|value";
-    if(m_conf.s_isCP)
+    if(conf.s_isCP)
         header += "|LB,UB";
-    if(m_conf.s_isAB)
+    if(conf.s_isAB)
         header += "|a,B";
 
     header += "|best action,value";
 
-    if(!m_conf.s_isQS)
+    if(!conf.s_isQS)
     {
             qsDepth = 0;
     }
@@ -297,83 +717,138 @@ SChanceTreeTrace * CExpectMTracer::trace( const SChanceTreeNode *rootNode,
     //newTrace->s_aiName = name();
     newTrace->s_columnNames =
         header.split('|');
+    newTrace->s_conf = conf;
 // Uncomment this when stuff will work
     if( rootNode == NULL )
         return newTrace;
     if( rootNode->s_childList.isEmpty() )
         return newTrace;
-    if(m_conf.s_isHT)
+
+    // The search runs on a flat copy of the tree; the root is node 0.
+    context.s_tree.compile( rootNode );
+    if(conf.s_isHT)
+        generateHistoryTable( context );
+    // The table is kept between iterations so each one can reuse the results
+    // and best moves of the last.
+    context.s_transTable.clear();
+
+    context.s_nodeCount = 0;
+    context.s_cancelled = false;
+
+    // Parallel mode shares the children of chance nodes out on a pool of
+    // its own. Star-1 searches them one after another.
+    QThreadPool pool;
+    context.s_pool = NULL;
+    if( conf.s_isParallel && !conf.s_isAB && conf.s_threads > 1 )
     {
-        m_historyTable.clear();
-        generateHistoryTable( rootNode );
+        pool.setMaxThreadCount( conf.s_threads - 1 );
+        context.s_pool = &pool;
     }
 
     int depth;
     int d = depth = INF;
     SChanceTreeCall *curDepth;
-    if(m_conf.s_isDL) d = depth = depthLimit;
-    if(m_conf.s_isID) d = 1;
-    for(; d <= depth; ++d )
+    if(conf.s_isDL) d = depth = depthLimit;
+    if(conf.s_isID) d = 1;
+    for(; d <= depth && !context.isCancelled(); ++d )
     {
-        QString call;
         curDepth = new SChanceTreeCall;
+        // Every iteration draws the same outcomes.
+        context.s_random = conf.s_seed;
 
-        if(m_conf.s_isDL)
-        {
-            call = "DLM";
-        }
-        else
-        {
-            call = "Minimax";
-        }
-        call += QString("(%1")
-                .arg(rootNode->s_name);
-        if(m_conf.s_isDL)
-        {
-            call += QString(",%1")
-                .arg(d);
-        }
-        if(m_conf.s_isQS)
-        {
-            call += QString(",%1")
-                .arg(qsDepth);
-        }
-        if(m_conf.s_isAB)
+        if(conf.s_isAB)
         {
             //broken?
             //return newTrace;
-            bool success = ABtraceCall( curDepth, rootNode, d, qsDepth, 
-                           lowerBound, upperBound, true );
+            bool success = ABtraceCall( context, curDepth, 0, d,
+                           qsDepth, lowerBound, upperBound, true );
+            if (!success && context.isCancelled())
+            {
+                delete curDepth;
+                break;
+            }
             if (!success)
             {
                 delete newTrace;
                 return new SChanceTreeTrace;
             }
-
-            call += QString( ",%1,%2" ).arg(lowerBound).arg(upperBound);
-            //call += ",-INF,INF";
         }
         else
         {
-            bool success = traceCall( curDepth, rootNode, d, qsDepth, true );
+            bool success = traceCall( context, curDepth, 0, d,
+                                      qsDepth, true );
+            if (!success && context.isCancelled())
+            {
+                delete curDepth;
+                break;
+            }
             if (!success)
             {
+                context.s_pool = NULL;
                 delete newTrace;
                 return new SChanceTreeTrace;
             }
         }
-        call += ")";
+        curDepth->s_root = true;
         ((SExpectMLine*)(curDepth->s_lines.last()))->s_boxAction = true;
         ((SExpectMLine*)(curDepth->s_lines.last()))->s_boxValue = false;
 
-        ((SExpectMLine*)(*curDepth)[0])->s_call = call;
-
         newTrace->s_depths.append( curDepth );
 
     }
 
+    context.s_pool = NULL;
+    context.s_cancelled = context.isCancelled();
     return newTrace;
 }
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::recordCall
+///
+/// @description    Keeps what a call is made with, so that the text of its
+///                 lines can be made when they are shown.
+/// @pre            children are the children of node in the order they will
+///                 be searched.
+/// @post           The call holds its arguments and open list.
+///
+/// @param call:    The call.
+///        node:    Node the call is made on.
+///        children: The children of node, in search order.
+///        depth:   Depth Limit.
+///        qsDepth: Quiessance depth.
+///        alpha:   Alpha value.
+///        beta:    Beta value.
+///        max:     true if this is a max node, false for a min.
+///        context: State of the run.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CExpectMTracer::recordCall( SExpectMContext &context,
+                                 SChanceTreeCall *call, int node,
+                                 const ExpectChildOrder &children,
+                                 int depth, int qsDepth,
+                                 float alpha, float beta, bool max ) const
+{
+    const CCompiledChanceTree &tree = context.s_tree;
+    call->s_node = tree.node( node );
+    call->s_max = max;
+    call->s_depth = depth;
+    call->s_qsDepth = qsDepth;
+    call->s_alpha = alpha;
+    call->s_beta = beta;
+
+    call->s_open.reserve( children.count() );
+    if( context.s_conf.s_isHT )
+        call->s_openHistory.reserve( children.count() );
+    for( int i = 0; i < children.count(); ++i )
+    {
+        call->s_open.append( tree.node( children[i] ) );
+        if( context.s_conf.s_isHT )
+            call->s_openHistory.append(
+                context.s_historyTable[children[i]] );
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CExpectMTracer::traceECall
 ///
@@ -386,107 +861,150 @@ SChanceTreeTrace * CExpectMTracer::trace( const SChanceTreeNode *rootNode,
 ///        depthLimit: Depth Limit.
 ///        qsDepth: Quiessance depth.
 ///        traceConf: struct with trace parameters.
+///        context: State of the run.
 ///
 /// @return         None.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool CExpectMTracer::traceECall( SChanceTreeCall *call, const SChanceTreeNode *node,
-                               int depth, int qsDepth, bool max ) const
+bool CExpectMTracer::traceECall( SExpectMContext &context,
+                                 SChanceTreeCall *call, int node,
+                                 int depth, int qsDepth, bool max ) const
 {
-    if(call == NULL || node == NULL || !node->s_chance )
+    const CCompiledChanceTree &tree = context.s_tree;
+    if(call == NULL || node < 0 || !tree.isChance( node ) )
+        return false;
+    // A cancelled run fails the same way, which unwinds the whole search.
+    if( context.isCancelled() )
+        return false;
+    ExpectChildOrder curChildren;
+    childOrder( context, node, curChildren );
+    sortNodes( context, curChildren );
+    // A sampled chance node with more outcomes than draws only searches the
+    // outcomes drawn, each weighted by how often it was drawn.
+    ExpectChildOrder draws;
+    bool sampled = context.s_conf.s_isSampled
+        && context.s_conf.s_samples > 0
+        && curChildren.count() > context.s_conf.s_samples;
+    if( sampled )
+        sampleChildren( context, curChildren, draws );
+    recordCall( context, call, node, curChildren,
+                depth, qsDepth, -INF, INF, max );
+
+    // In parallel mode the children that need a search are searched first,
+    // as tasks on the pool, and the loop below takes their calls in order.
+    QVector<SChanceTreeCall *> searched;
+    if( context.s_pool != NULL && context.s_splitLevel < MAX_SPLIT_LEVELS
+        && !searchChildren( context, curChildren, depth, qsDepth, max,
+                            searched ) )
         return false;
-    QList<SChanceTreeNode*> curChildren = node->s_childList;
-    sortNodes( curChildren );
-    QString depthString;
-    QString open;
-    //QString sumString;
-    SChanceTreeNode *curNode;
-    foreach( curNode, curChildren )
-    {
-        open += curNode->s_name;
-        if(m_conf.s_isHT)
-        {
-            open += QString::number(m_historyTable[curNode]);
-        }
-        open += " ";
-    }
-    open = open.simplified();
+
+    int curNode;
 
     SExpectMLine *curLine;
     //SChanceTreeNode *bestAction = NULL;
     qreal sum = 0.0;
+    // The weighted sum of squared values, for the spread of a sample, and
+    // of the squared errors of values that were themselves sampled.
+    qreal squareSum = 0.0;
+    qreal errorSum = 0.0;
+    qreal childError;
     int curDepth, curQSDepth;
     bool isEndPoint;
-    foreach( curNode, curChildren )
+    bool exhaustive = true;
+    bool childExhaustive;
+    for( int c = 0; c < curChildren.count(); ++c )
     {
+        curNode = curChildren[c];
         curDepth = depth;
         curQSDepth = qsDepth;
 
         curLine = new SExpectMLine;
-        curLine->s_conf = m_conf;
+        context.s_nodeCount++;
         curLine->s_chance = true;
 
-        curLine->s_open = open;
-        if( m_conf.s_isHT )
-            curLine->s_open.remove(' ');
-        curLine->s_eval = curNode->s_name;
-        open = open.section( ' ', 1, -1 );
+        // There is one line for each child searched so far.
+        curLine->s_open = call->s_lines.count();
 
         if( curDepth > 0 )
             curDepth--;
         else
             curQSDepth--;
         isEndPoint = false;
-        if( (curNode->s_childList.count() == 0)
-            ||(curDepth == 0 && (!curNode->s_quiescent || curQSDepth == 0)) )
+        if( (tree.childCount( curNode ) == 0)
+            ||(curDepth == 0 && (!tree.isQuiescent( curNode )
+                                 || curQSDepth == 0)) )
             isEndPoint = true;
 
-        depthString = "";
-        if( m_conf.s_isDL )
-        {
-            depthString = QString(",%1").arg(curDepth);
-        }
-        if( m_conf.s_isQS )
-        {
-            depthString += QString(",%1").arg(curQSDepth);
-        }
-
-        curLine->s_valueCall = max?"Max":"Min";
-        curLine->s_valueCall += QString("(%1%2)")
-                                .arg(curNode->s_name)
-                                .arg(depthString);
+        curLine->s_depth = curDepth;
+        curLine->s_qsDepth = curQSDepth;
+        childError = 0.0;
+        bool wasSearched = !searched.isEmpty() && searched[c] != NULL;
         if( isEndPoint )
         {
-                curLine->s_valueValue = curNode->s_value;
+                curLine->s_valueValue = tree.value( curNode );
                 curLine->s_sss = false;
+                if( tree.childCount( curNode ) > 0 )
+                    exhaustive = false;
         }
-        else if( checkSSS( curNode, curDepth, curQSDepth ) )
+        else if( !wasSearched
+                 && checkSSS( context, curNode, curDepth, curQSDepth ) )
         {
-            curLine->s_valueValue = sssValue( curNode, curDepth, curQSDepth );
+            curLine->s_valueValue = sssValue( context, curNode,
+                                              curDepth, curQSDepth );
             curLine->s_sss = true;
-            if( m_conf.s_isHT )
-                curLine->s_historyUpdates = sssHistoryUpdates( curNode,
+            if( context.s_conf.s_isHT )
+                curLine->s_historyUpdates = sssHistoryUpdates( context, curNode,
                                                     curDepth, curQSDepth );
+            exhaustive = false;
+        }
+        else if( !wasSearched && context.s_conf.s_isTT
+                 && probeTT( context, curNode, max, curDepth, curQSDepth,
+                             curLine->s_valueValue, childExhaustive ) )
+        {
+            curLine->s_tt = true;
+            exhaustive = exhaustive && childExhaustive;
         }
         else
         {
-            call->s_children.append( new SChanceTreeCall() );
-            bool success = traceCall( call->s_children.last(), curNode, curDepth, curQSDepth, max );
-            if(!success)
+            // A child searched by a task already has its call.
+            if( wasSearched )
             {
-                delete curLine;
-                return false;
+                call->s_children.append( searched[c] );
+                searched[c] = NULL;
+            }
+            else
+            {
+                call->s_children.append( new SChanceTreeCall() );
+                bool success = traceCall( context, call->s_children.last(),
+                                          curNode, curDepth, curQSDepth, max );
+                if(!success)
+                {
+                    delete curLine;
+                    qDeleteAll( searched );
+                    return false;
+                }
             }
             curLine->s_valueValue = call->s_children.last()->s_returnValue;
+            childError = call->s_children.last()->s_error;
+            if( context.s_conf.s_isTT )
+                exhaustive = exhaustive && context.s_transTable
+                    .value( ttKey( context, curNode, max ) ).s_exhaustive;
         }
         curLine->s_qs = (curDepth == 0 && curQSDepth > 0
-                         && curNode->s_quiescent);
+                         && tree.isQuiescent( curNode ));
 
         qreal val = curLine->s_valueValue;
-        qreal prob = curNode->s_probability / 100.0;
+        qreal prob = tree.probability( curNode ) / 100.0;
+        if( sampled )
+        {
+            curLine->s_samples = draws[c];
+            prob = (qreal)draws[c] / context.s_conf.s_samples;
+        }
         sum += prob*val;
+        squareSum += prob*val*val;
+        errorSum += prob*prob*childError*childError;
         //sumString += QString("%1*%2 + ").arg(prob).arg(val);
         //curLine->s_bestAction = QString("%1*%2=%3")
         //                        .arg(prob)
@@ -500,33 +1018,219 @@ bool CExpectMTracer::traceECall( SChanceTreeCall *call, const SChanceTreeNode *n
     //sumString += QString("=%1").arg(sum);
     //curLine = new SExpectMLine;
     //curLine->s_valueValue = sum;
-    //curLine->s_conf = m_conf;
+    //curLine->s_conf = context.s_conf;
     //curLine->s_valueCall = sumString;
     //curLine->s_chance = true;
     //curLine->s_open = " "; // Prevent this line from being deleted later.
     
     //curLine->s_bestAction = sumString;
     //call->s_lines.append( curLine );  
-    curLine->s_bestAction = QString("[%1]").arg(SExpectMLine::numberToString(sum));
+    curLine->s_bestValue = sum;
     call->s_returnValue = sum;
-    depthString = "";
-    if( m_conf.s_isDL )
-    {
-        depthString = QString(",%1").arg(depth);
-    }
-    if( m_conf.s_isQS )
+    // The error of a sampled mean is the spread of the draws over the
+    // square root of their number, on top of the errors of the values.
+    int samples = context.s_conf.s_samples;
+    if( sampled && samples > 1 )
     {
-        depthString += QString(",%1").arg(qsDepth);
+        qreal spread = (squareSum - sum*sum) * samples / (samples - 1);
+        errorSum += qMax( spread, (qreal)0 ) / samples;
     }
-    ((SExpectMLine*)call->s_lines.first())->s_call =
-        QString(max?"MinChance(%1%2)":"MaxChance(%1%2)")
-        .arg(node->s_name)
-        .arg(depthString);
+    call->s_error = sqrt( errorSum );
+    // Sampled values are only estimates and are not kept.
+    if( context.s_conf.s_isTT && !context.s_conf.s_isSampled )
+        storeTT( context, node, max, depth, qsDepth, -INF, INF,
+                 sum, -1, exhaustive );
     ((SExpectMLine*)call->s_lines.last())->s_boxValue = true;
     return true;
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::searchChildren
+///
+/// @description    Searches the children of a chance node in parallel. Each
+///                 child the loop of traceECall would search is a task,
+///                 which this thread and any idle pool threads take in turn.
+///                 A task runs with its own copy of the context, and what it
+///                 adds to the tables is merged back in the order of the
+///                 children once all are done, so the trace is the same
+///                 however the tasks were scheduled.
+/// @pre            children are the children of a chance node in search
+///                 order. context.s_pool is set.
+/// @post           calls holds, for each child, the call a task made on it,
+///                 or NULL if it was not searched. The statistics and tables
+///                 of context include those of the tasks.
+///
+/// @param context:  State of the run.
+///        children: The children of the chance node.
+///        depth:    Depth left at the chance node.
+///        qsDepth:  Quiessance depth left at the chance node.
+///        max:      true if max moves at the children.
+///        calls:    Filled with the calls of the children searched.
+///
+/// @return bool:   false if the run was stopped, in which case calls is
+///                 empty.
+///
+/// @limitations    A child does not see the table entries of its siblings,
+///                 so transpositions between them are searched twice.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CExpectMTracer::searchChildren( SExpectMContext &context,
+                                     const ExpectChildOrder &children,
+                                     int depth, int qsDepth, bool max,
+                                     QVector<SChanceTreeCall *> &calls ) const
+{
+    const CCompiledChanceTree &tree = context.s_tree;
+    SExpectMSplit split;
+    split.s_context = &context;
+    split.s_max = max;
+    split.s_next = 0;
+    split.s_helpers = 0;
+    calls.fill( NULL, children.count() );
+
+    // The children that are end points, have a single successor or are in
+    // the table are left to the loop of traceECall.
+    float value;
+    bool exhaustive;
+    for( int c = 0; c < children.count(); ++c )
+    {
+        SExpectMTask task;
+        task.s_child = c;
+        task.s_node = children[c];
+        task.s_depth = depth;
+        task.s_qsDepth = qsDepth;
+        if( task.s_depth > 0 )
+            task.s_depth--;
+        else
+            task.s_qsDepth--;
+        if( (tree.childCount( task.s_node ) == 0)
+            || (task.s_depth == 0 && (!tree.isQuiescent( task.s_node )
+                                      || task.s_qsDepth == 0)) )
+            continue;
+        if( checkSSS( context, task.s_node, task.s_depth, task.s_qsDepth ) )
+            continue;
+        if( context.s_conf.s_isTT
+            && probeTT( context, task.s_node, max, task.s_depth,
+                        task.s_qsDepth, value, exhaustive ) )
+            continue;
+
+        task.s_call = new SChanceTreeCall();
+        task.s_context = NULL;
+        task.s_success = false;
+        split.s_tasks.append( task );
+    }
+    if( split.s_tasks.isEmpty() )
+        return true;
+
+    // Only threads that are idle right now are recruited, so this thread
+    // never waits on a helper that has not started.
+    int wanted = qMin( context.s_conf.s_threads - 1,
+                       split.s_tasks.count() - 1 );
+    for( int i = 0; i < wanted; ++i )
+    {
+        CExpectMSplitHelper *helper = new CExpectMSplitHelper( this, &split );
+        split.s_mutex.lock();
+        split.s_helpers++;
+        split.s_mutex.unlock();
+        if( !context.s_pool->tryStart( helper ) )
+        {
+            split.s_mutex.lock();
+            split.s_helpers--;
+            split.s_mutex.unlock();
+            delete helper;
+            break;
+        }
+    }
+
+    searchSplit( &split );
+
+    split.s_mutex.lock();
+    while( split.s_helpers > 0 )
+        split.s_helpersDone.wait( &split.s_mutex );
+    split.s_mutex.unlock();
+
+    // History values only go up, so each task adds what it added to its
+    // copy. Table entries are stored again in the order of the children.
+    HistTable before = context.s_historyTable;
+    bool success = true;
+    for( int i = 0; i < split.s_tasks.count(); ++i )
+    {
+        const SExpectMTask &task = split.s_tasks.at( i );
+        const SExpectMContext *result = task.s_context;
+        success = success && task.s_success;
+        calls[task.s_child] = task.s_call;
+        context.s_nodeCount += result->s_nodeCount;
+        if( context.s_conf.s_isHT )
+        {
+            for( int n = 0; n < before.count(); ++n )
+                context.s_historyTable[n] += result->s_historyTable.at( n )
+                                             - before.at( n );
+        }
+        for( int k = 0; k < result->s_stored.count(); ++k )
+        {
+            int key = result->s_stored.at( k );
+            context.s_transTable.insert( key,
+                                         result->s_transTable.value( key ) );
+            if( context.s_isTask )
+                context.s_stored.append( key );
+        }
+        delete result;
+    }
+    // Later draws don't repeat those of the tasks.
+    nextRandom( context.s_random );
+
+    if( !success )
+    {
+        qDeleteAll( calls );
+        calls.clear();
+    }
+    return success;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::searchSplit
+///
+/// @description    Takes children of a parallel chance node one at a time
+///                 and searches each with its own copy of the context, until
+///                 no children are left.
+/// @pre            split points to a parallel chance node.
+/// @post           Each task taken holds its call, context and result.
+///
+/// @param split:   The chance node to work on.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CExpectMTracer::searchSplit( SExpectMSplit *split ) const
+{
+    for(;;)
+    {
+        split->s_mutex.lock();
+        if( split->s_next >= split->s_tasks.count() )
+        {
+            split->s_mutex.unlock();
+            return;
+        }
+        SExpectMTask &task = split->s_tasks[split->s_next++];
+        split->s_mutex.unlock();
+
+        // The draws of a task depend only on which child it is.
+        SExpectMContext *context = new SExpectMContext( *split->s_context );
+        context->s_nodeCount = 0;
+        context->s_isTask = true;
+        context->s_stored.clear();
+        context->s_splitLevel++;
+        context->s_random ^= (quint32)(task.s_child + 1) * 2654435761U;
+
+        task.s_context = context;
+        task.s_success = traceCall( *context, task.s_call, task.s_node,
+                                    task.s_depth, task.s_qsDepth,
+                                    split->s_max );
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CExpectMTracer::traceCall
 ///
@@ -539,87 +1243,84 @@ bool CExpectMTracer::traceECall( SChanceTreeCall *call, const SChanceTreeNode *n
 ///        depthLimit: Depth Limit.
 ///        qsDepth: Quiessance depth.
 ///        traceConf: struct with trace parameters.
+///        context: State of the run.
 ///
 /// @return         None.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool CExpectMTracer::traceCall( SChanceTreeCall *call, const SChanceTreeNode *node,
-                               int depth, int qsDepth, bool max ) const
+bool CExpectMTracer::traceCall( SExpectMContext &context,
+                                SChanceTreeCall *call, int node,
+                                int depth, int qsDepth, bool max ) const
 {
-    if( call == NULL || node == NULL || node->s_chance || node->s_childList.size() == 0)
+    const CCompiledChanceTree &tree = context.s_tree;
+    if( call == NULL || node < 0 || tree.isChance( node )
+        || tree.childCount( node ) == 0 )
+        return false;
+    if( context.isCancelled() )
         return false;
-    QList<SChanceTreeNode*> curChildren = node->s_childList;
-    sortNodes( curChildren );
+    ExpectChildOrder curChildren;
+    childOrder( context, node, curChildren );
+    sortNodes( context, curChildren );
+    orderBestChild( context, node, max, curChildren );
 
-    QString depthString;
-    QString open;
-    SChanceTreeNode *curNode;
-    foreach( curNode, curChildren )
-    {
-        open += curNode->s_name;
-        if(m_conf.s_isHT)
-        {
-            open += QString::number(m_historyTable[curNode]);
-        }
-        open += " ";
-    }
-    open = open.simplified();
+    recordCall( context, call, node, curChildren,
+                depth, qsDepth, -INF, INF, max );
+
+    int curNode;
 
     SExpectMLine *curLine;
-    SChanceTreeNode *bestAction = NULL;
+    int bestAction = -1;
     float bestValue = -1;
+    float bestError = 0;
+    float childError;
     bool better;
     bool isEndPoint;
-    foreach( curNode, curChildren )
+    bool exhaustive = true;
+    bool childExhaustive;
+    for( int c = 0; c < curChildren.count(); ++c )
     {
+        curNode = curChildren[c];
+        childError = 0;
 
         curLine = new SExpectMLine;
-        curLine->s_conf = m_conf;
-
-        curLine->s_open = open;
-        if( m_conf.s_isHT )
-            curLine->s_open.remove(' ');
-        curLine->s_eval = curNode->s_name;
-        open = open.section( ' ', 1, -1 );
+        context.s_nodeCount++;
 
+        curLine->s_open = call->s_lines.count();
 
         isEndPoint = false;
-        if( curNode->s_childList.count() == 0 )
+        if( tree.childCount( curNode ) == 0 )
             isEndPoint = true;
 
-        depthString = "";
-        if( m_conf.s_isDL )
-        {
-            depthString = QString(",%1").arg(depth);
-        }
-        if( m_conf.s_isQS )
-        {
-            depthString += QString(",%1").arg(qsDepth);
-        }
-
-        curLine->s_valueCall = max?"MaxChance":"MinChance";
-        curLine->s_valueCall += QString("(%1%2)")
-                                .arg(curNode->s_name)
-                                .arg(depthString);
+        curLine->s_depth = depth;
+        curLine->s_qsDepth = qsDepth;
         if( isEndPoint )
         {
-                curLine->s_valueValue = curNode->s_value;
+                curLine->s_valueValue = tree.value( curNode );
                 curLine->s_sss = false;
         }
-        else if( checkSSS( curNode, depth, qsDepth ) )
+        else if( checkSSS( context, curNode, depth, qsDepth ) )
         {
-            curLine->s_valueValue = sssValue( curNode, depth, qsDepth );
+            curLine->s_valueValue = sssValue( context, curNode,
+                                              depth, qsDepth );
             curLine->s_sss = true;
-            if( m_conf.s_isHT )
-                curLine->s_historyUpdates = sssHistoryUpdates( curNode,
+            if( context.s_conf.s_isHT )
+                curLine->s_historyUpdates = sssHistoryUpdates( context, curNode,
                                                     depth, qsDepth );
+            exhaustive = false;
+        }
+        else if( context.s_conf.s_isTT
+                 && probeTT( context, curNode, !max, depth, qsDepth,
+                             curLine->s_valueValue, childExhaustive ) )
+        {
+            curLine->s_tt = true;
+            exhaustive = exhaustive && childExhaustive;
         }
         else
         {
             call->s_children.append( new SChanceTreeCall() );
-            bool success = traceECall( call->s_children.last(), 
+            bool success = traceECall( context, call->s_children.last(), 
                                        curNode, depth, qsDepth, !max );
             if(!success)
             {
@@ -627,9 +1328,13 @@ bool CExpectMTracer::traceCall( SChanceTreeCall *call, const SChanceTreeNode *no
                 return false;
             }
             curLine->s_valueValue = call->s_children.last()->s_returnValue;
+            childError = call->s_children.last()->s_error;
+            if( context.s_conf.s_isTT )
+                exhaustive = exhaustive && context.s_transTable
+                    .value( ttKey( context, curNode, !max ) ).s_exhaustive;
         }
 
-        if( bestAction == NULL )
+        if( bestAction < 0 )
             better = true;
         else
         {
@@ -640,35 +1345,183 @@ bool CExpectMTracer::traceCall( SChanceTreeCall *call, const SChanceTreeNode *no
         {
             bestAction = curNode;
             bestValue = curLine->s_valueValue;
+            bestError = childError;
         }
-        curLine->s_bestAction = node->s_name + bestAction->s_name;
+        curLine->s_bestAction = tree.node( bestAction );
         curLine->s_bestValue = bestValue;
 
         call->s_lines.append( curLine );
     }
-    if( m_conf.s_isHT )
+    if( context.s_conf.s_isHT )
     {
-        m_historyTable[bestAction]++;
+        SExpectMHistoryUpdate update;
+        update.s_node = tree.node( bestAction );
+        update.s_value = ++context.s_historyTable[bestAction];
         ((SExpectMLine*)call->s_lines.last())->s_historyUpdates
-            += moveName( bestAction )
-               + ':' + QString::number( m_historyTable[bestAction] );
+            .append( update );
     }
 
     call->s_returnValue = bestValue;
-    depthString = "";
-    if( m_conf.s_isDL )
+    call->s_error = bestError;
+    if( context.s_conf.s_isTT && !context.s_conf.s_isSampled )
+        storeTT( context, node, max, depth, qsDepth, -INF, INF,
+                 bestValue, bestAction, exhaustive );
+    ((SExpectMLine*)call->s_lines.last())->s_boxValue = true;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CExpectMTracer::probeChildren
+///
+/// @description    The probing phase of Star2. Each child of a chance node is
+///                 bounded by searching only its first successor: the value
+///                 of a max child is at least that of any successor, and of
+///                 a min child at most. The successor is searched with the
+///                 window that would let the bound alone cut the chance node
+///                 off, and probing stops as soon as the bounds so far do.
+/// @pre            children are the children of a chance node in the order
+///                 they are searched.
+/// @post           A probe line is added to call for each child probed.
+///                 bounds holds a bound on the value of each child: a lower
+///                 bound if max, an upper bound otherwise. If cutoff is set
+///                 the chance node was cut off and call is finished.
+///
+/// @param context:  State of the run.
+///        call:     The call of the chance node.
+///        children: The children of the chance node.
+///        depth:    Depth left at the chance node.
+///        qsDepth:  Quiessance depth left at the chance node.
+///        alpha:    Alpha value of the chance node.
+///        beta:     Beta value of the chance node.
+///        max:      true if max moves at the children.
+///        bounds:   Filled with the bounds on the children.
+///        cutoff:   Set if the chance node was cut off.
+///
+/// @return bool:   false if the run was stopped.
+///
+/// @limitations    Only a fail high can come of probing max children and a
+///                 fail low of probing min children.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CExpectMTracer::probeChildren( SExpectMContext &context,
+                                    SChanceTreeCall *call,
+                                    const ExpectChildOrder &children,
+                                    int depth, int qsDepth,
+                                    float alpha, float beta, bool max,
+                                    ExpectBounds &bounds, bool &cutoff ) const
+{
+    const CCompiledChanceTree &tree = context.s_tree;
+    qreal l = context.s_lowerBound;
+    qreal u = context.s_upperBound;
+    cutoff = false;
+
+    // Until a child is probed, the bound of the values is all that is known.
+    qreal known = max ? l : u;
+    qreal total = 0.0;
+    bounds.resize( children.count() );
+    for( int c = 0; c < children.count(); ++c )
     {
-        depthString = QString(",%1").arg(depth);
+        bounds[c] = known;
+        total += tree.probability( children[c] ) / 100.0 * known;
     }
-    if( m_conf.s_isQS )
+
+    SExpectMLine *curLine = NULL;
+    for( int c = 0; c < children.count(); ++c )
     {
-        depthString += QString(",%1").arg(qsDepth);
+        int curNode = children[c];
+        qreal prob = tree.probability( curNode ) / 100.0;
+        if( prob <= 0.0 )
+            continue;
+        if( context.isCancelled() )
+            return false;
+
+        int curDepth = depth;
+        int curQSDepth = qsDepth;
+        if( curDepth > 0 )
+            curDepth--;
+        else
+            curQSDepth--;
+        bool isEndPoint = tree.childCount( curNode ) == 0
+            || (curDepth == 0 && (!tree.isQuiescent( curNode )
+                                  || curQSDepth == 0));
+
+        // The value this child must pass for the bounds to cut off.
+        qreal rest = total - prob * bounds[c];
+        qreal ax = l, bx = u;
+        if( max )
+            bx = MIN( (beta - rest) / prob, u );
+        else
+            ax = MAX( (alpha - rest) / prob, l );
+        // This child can't bring about a cutoff on its own.
+        if( ax >= bx )
+            continue;
+
+        curLine = new SExpectMLine;
+        context.s_nodeCount++;
+        curLine->s_chance = true;
+        curLine->s_probe = true;
+        curLine->s_open = c;
+        curLine->s_alpha = alpha;
+        curLine->s_beta = beta;
+        curLine->s_depth = curDepth;
+        curLine->s_qsDepth = curQSDepth;
+        curLine->s_valueAlpha = ax;
+        curLine->s_valueBeta = bx;
+
+        qreal bound;
+        if( isEndPoint )
+            bound = tree.value( curNode );
+        else
+        {
+            ExpectChildOrder successors;
+            childOrder( context, curNode, successors );
+            sortNodes( context, successors );
+            orderBestChild( context, curNode, max, successors );
+            int first = successors[0];
+            if( tree.childCount( first ) == 0 )
+                bound = tree.value( first );
+            else
+            {
+                call->s_children.append( new SChanceTreeCall() );
+                SChanceTreeCall *probe = call->s_children.last();
+                if( !ABtraceECall( context, probe, first, curDepth,
+                                   curQSDepth, ax, bx, !max ) )
+                {
+                    delete curLine;
+                    return false;
+                }
+                bound = probe->s_returnValue;
+                // A cut off successor is only known to be outside the window.
+                const SExpectMLine *last = probe->s_lines.last();
+                if( last->s_cPrune )
+                {
+                    bool high = last->s_valueValue >= last->s_valueBeta;
+                    if( max )
+                        bound = high ? bx : l;
+                    else
+                        bound = high ? u : ax;
+                }
+            }
+        }
+        bound = max ? MAX( bound, l ) : MIN( bound, u );
+
+        total = rest + prob * bound;
+        bounds[c] = bound;
+        curLine->s_valueValue = bound;
+        curLine->s_lowerBound = max ? total : l;
+        curLine->s_upperBound = max ? u : total;
+        call->s_lines.append( curLine );
+
+        if( max ? total >= beta : total <= alpha )
+        {
+            curLine->s_cPrune = true;
+            curLine->s_bestValue = total;
+            curLine->s_boxValue = true;
+            call->s_returnValue = total;
+            cutoff = true;
+            return true;
+        }
     }
-    ((SExpectMLine*)call->s_lines.first())->s_call =
-        QString(max?"Max(%1%2)":"Min(%1%2)")
-        .arg(node->s_name)
-        .arg(depthString);
-    ((SExpectMLine*)call->s_lines.last())->s_boxValue = true;
     return true;
 }
 
@@ -685,43 +1538,42 @@ bool CExpectMTracer::traceCall( SChanceTreeCall *call, const SChanceTreeNode *no
 ///        qsDepth: Quiessance depth.
 ///        alpha: Alpha value.
 ///        beta: Beta value.
+///        context: State of the run.
 ///
 /// @return         None.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool CExpectMTracer::ABtraceECall( SChanceTreeCall *call, const SChanceTreeNode *node,
-                     int depth, int qsDepth, float alpha, float beta, bool max ) const
+bool CExpectMTracer::ABtraceECall( SExpectMContext &context,
+                                   SChanceTreeCall *call, int node,
+                                   int depth, int qsDepth,
+                                   float alpha, float beta, bool max ) const
 {
-    if(call == NULL || node == NULL || !node->s_chance || node->s_childList.size() == 0)
+    const CCompiledChanceTree &tree = context.s_tree;
+    if(call == NULL || node < 0 || !tree.isChance( node )
+       || tree.childCount( node ) == 0)
+        return false;
+    if( context.isCancelled() )
         return false;
-    QList<SChanceTreeNode*> curChildren = node->s_childList;
-    sortNodes( curChildren );
-    QString depthString;
-    QString open;
+    ExpectChildOrder curChildren;
+    childOrder( context, node, curChildren );
+    sortNodes( context, curChildren );
     bool failSoft = false;
     //QString boundPrefix = max ? "LB=" : "UB=";
     //QString sumString;
     //QString calcString;
-    SChanceTreeNode *curNode;
-    foreach( curNode, curChildren )
-    {
-        open += curNode->s_name;
-        if(m_conf.s_isHT)
-        {
-            open += QString::number(m_historyTable[curNode]);
-        }
-        open += " ";
-    }
-    open = open.simplified();
+    recordCall( context, call, node, curChildren,
+                depth, qsDepth, alpha, beta, max );
+
+    int curNode;
 
     SExpectMLine *curLine;
     //SChanceTreeNode *bestAction = NULL;
     float curAlpha = alpha, curBeta = beta;
     qreal n = curChildren.size();
-    qreal u = m_upperBound;
-    qreal l = m_lowerBound;
+    qreal u = context.s_upperBound;
+    qreal l = context.s_lowerBound;
     //qreal a = numChildren * (alpha - u) + u;
     //qreal b = numChildren * (beta  - l) + l;
     qreal v = 0;
@@ -730,76 +1582,110 @@ bool CExpectMTracer::ABtraceECall( SChanceTreeCall *call, const SChanceTreeNode
     qreal sum = 0.0;	
     qreal probSum = 0.0;
     qreal bound;
-    qreal curLowerBound = m_lowerBound;
-    qreal curUpperBound = m_upperBound;
+    qreal curLowerBound = context.s_lowerBound;
+    qreal curUpperBound = context.s_upperBound;
     int curDepth, curQSDepth;
     bool isEndPoint;
-    foreach( curNode, curChildren )
+    bool exhaustive = true;
+    bool childExhaustive;
+    float childValue;
+
+    // With Star2 the children are probed first. What the probes found over
+    // the bounds of the values is added to the expectation of the children
+    // not yet searched.
+    ExpectBounds probed;
+    qreal lowGain = 0.0;
+    qreal highGain = 0.0;
+    if( context.s_conf.s_isStar2 )
+    {
+        bool cutoff;
+        if( !probeChildren( context, call, curChildren, depth, qsDepth,
+                            alpha, beta, max, probed, cutoff ) )
+            return false;
+        if( cutoff )
+            return true;
+        for( int c = 0; c < probed.count(); ++c )
+        {
+            qreal prob = tree.probability( curChildren[c] ) / 100.0;
+            if( max )
+                lowGain += prob * (probed[c] - l);
+            else
+                highGain += prob * (probed[c] - u);
+        }
+    }
+
+    for( int c = 0; c < curChildren.count(); ++c )
     {
-        qreal prob = curNode->s_probability / 100.0;
+        curNode = curChildren[c];
+        qreal prob = tree.probability( curNode ) / 100.0;
         bool sssPrune = false;
         curDepth = depth;
         curQSDepth = qsDepth;
         y = y - prob;
-        qreal ax = (alpha  - u * y - x) / prob;
-        qreal bx = (beta   - l * y - x) / prob;
+        if( !probed.isEmpty() )
+        {
+            if( max )
+                lowGain -= prob * (probed[c] - l);
+            else
+                highGain -= prob * (probed[c] - u);
+        }
+        qreal ax = (alpha  - u * y - highGain - x) / prob;
+        qreal bx = (beta   - l * y - lowGain - x) / prob;
         ax = MAX(ax, l); 
         bx = MIN(bx, u); 
         // "x = x + v" will happen once v is established.
         curLine = new SExpectMLine;
-        curLine->s_conf = m_conf;
+        context.s_nodeCount++;
         curLine->s_chance = true;
         curLine->s_alpha = alpha;
         curLine->s_beta = beta;
 
-        curLine->s_open = open;
-        if( m_conf.s_isHT )
-            curLine->s_open.remove(' ');
-        curLine->s_eval = curNode->s_name;
-        open = open.section( ' ', 1, -1 ); 
+        curLine->s_open = call->s_lines.count();
 
         if( curDepth > 0 )
             curDepth--;
         else
             curQSDepth--;
         isEndPoint = false;
-        if( (curNode->s_childList.count() == 0)
-            ||(curDepth == 0 && (!curNode->s_quiescent || curQSDepth == 0)) )
+        if( (tree.childCount( curNode ) == 0)
+            ||(curDepth == 0 && (!tree.isQuiescent( curNode )
+                                 || curQSDepth == 0)) )
             isEndPoint = true;
 
-        depthString = "";
-        if( m_conf.s_isDL )
-        {
-            depthString = QString(",%1").arg(curDepth);
-        }
-        if( m_conf.s_isQS )
-        {
-            depthString += QString(",%1").arg(curQSDepth);
-        }
-
-        curLine->s_valueCall = max?"Max":"Min";
-        curLine->s_valueCall += QString("(%1%2,%3,%4)")
-                                .arg(curNode->s_name)
-                                .arg(depthString)
-                                .arg(SExpectMLine::numberToString(ax))
-                                .arg(SExpectMLine::numberToString(bx));
+        curLine->s_depth = curDepth;
+        curLine->s_qsDepth = curQSDepth;
+        curLine->s_valueAlpha = ax;
+        curLine->s_valueBeta = bx;
         if( isEndPoint )
         {
-                v = curLine->s_valueValue = curNode->s_value;
+                v = curLine->s_valueValue = tree.value( curNode );
                 curLine->s_sss = false;
+                if( tree.childCount( curNode ) > 0 )
+                    exhaustive = false;
         }
-        else if( checkSSS( curNode, curDepth, curQSDepth ) )
+        else if( checkSSS( context, curNode, curDepth, curQSDepth ) )
         {
-            curLine->s_valueValue = sssValue( curNode, curDepth, curQSDepth );
+            curLine->s_valueValue = sssValue( context, curNode,
+                                              curDepth, curQSDepth );
             curLine->s_sss = true;
-            if( m_conf.s_isHT )
-                curLine->s_historyUpdates = sssHistoryUpdates( curNode,
+            if( context.s_conf.s_isHT )
+                curLine->s_historyUpdates = sssHistoryUpdates( context, curNode,
                                                     curDepth, curQSDepth );
+            exhaustive = false;
+        }
+        else if( context.s_conf.s_isTT
+                 && probeTT( context, curNode, max, curDepth, curQSDepth,
+                             childValue, childExhaustive ) )
+        {
+            v = curLine->s_valueValue = childValue;
+            curLine->s_tt = true;
+            exhaustive = exhaustive && childExhaustive;
         }
         else
         {
             call->s_children.append( new SChanceTreeCall() );
-            bool success = ABtraceCall( call->s_children.last(), curNode, curDepth,
+            bool success = ABtraceCall( context, call->s_children.last(),
+                                        curNode, curDepth,
                                         curQSDepth, ax, bx, max );
             if(!success)
             {
@@ -807,13 +1693,16 @@ bool CExpectMTracer::ABtraceECall( SChanceTreeCall *call, const SChanceTreeNode
                 return false;
             }
             v = curLine->s_valueValue = call->s_children.last()->s_returnValue;
+            if( context.s_conf.s_isTT )
+                exhaustive = exhaustive && context.s_transTable
+                    .value( ttKey( context, curNode, max ) ).s_exhaustive;
             //x += prob * v;
             //y -= prob; Happened earlier
         }
         x += prob * v;
         //y -= prob; Happened earlier
         curLine->s_qs = (curDepth == 0 && curQSDepth > 0
-                         && curNode->s_quiescent);
+                         && tree.isQuiescent( curNode ));
         if( curLine->s_sss )
         {
             if( curLine->s_valueValue <= curAlpha )
@@ -826,9 +1715,10 @@ bool CExpectMTracer::ABtraceECall( SChanceTreeCall *call, const SChanceTreeNode
         probSum += prob;
         //sumString += QString("%1*%2 + ").arg(prob).arg(val);
 
-        curLowerBound = sum+(y)*m_lowerBound;
-        curUpperBound = sum+(y)*m_upperBound;
-        curLine->s_bounds = QString("%1, %2").arg(curLowerBound).arg(curUpperBound);
+        curLowerBound = sum+(y)*context.s_lowerBound + lowGain;
+        curUpperBound = sum+(y)*context.s_upperBound + highGain;
+        curLine->s_lowerBound = curLowerBound;
+        curLine->s_upperBound = curUpperBound;
         /*
         if(probSum < 0.999)
         {
@@ -881,7 +1771,7 @@ bool CExpectMTracer::ABtraceECall( SChanceTreeCall *call, const SChanceTreeNode
     //sumString += QString("=%1").arg(sum);
     //curLine = new SExpectMLine;
     //curLine->s_valueValue = sum;
-    //curLine->s_conf = m_conf;
+    //curLine->s_conf = context.s_conf;
     //curLine->s_valueCall = sumString;
     //curLine->s_chance = true;
     //curLine->s_open = " "; // Prevent this line from being deleted later.
@@ -890,23 +1780,12 @@ bool CExpectMTracer::ABtraceECall( SChanceTreeCall *call, const SChanceTreeNode
     //curLine->s_bestAction = QString("[%1]").arg(SExpectMLine::numberToString(sum));
     if( !curLine->s_cPrune )
         call->s_returnValue = sum;
-    curLine->s_bestAction = QString("[%1]").arg(sum);
+    curLine->s_bestValue = sum;
+    // A chance cutoff only yields a bound, so only full expectations are kept.
+    if( context.s_conf.s_isTT && !curLine->s_cPrune )
+        storeTT( context, node, max, depth, qsDepth, alpha, beta,
+                 sum, -1, exhaustive );
     //else call->s_returnValue = valueBound;
-    depthString = "";
-    if( m_conf.s_isDL )
-    {
-        depthString = QString(",%1").arg(depth);
-    }
-    if( m_conf.s_isQS )
-    {
-        depthString += QString(",%1").arg(qsDepth);
-    }
-    ((SExpectMLine*)call->s_lines.first())->s_call =
-        QString(max?"MinChance(%1%2,%3,%4)":"MaxChance(%1%2,%3,%4)")
-        .arg(node->s_name)
-        .arg(depthString)
-        .arg(SExpectMLine::numberToString(alpha))
-        .arg(SExpectMLine::numberToString(beta));
     ((SExpectMLine*)call->s_lines.last())->s_boxValue = true;
     return true;
 }
@@ -924,94 +1803,88 @@ bool CExpectMTracer::ABtraceECall( SChanceTreeCall *call, const SChanceTreeNode
 ///        qsDepth: Quiessance depth.
 ///        alpha: Alpha value.
 ///        beta: Beta value.
+///        context: State of the run.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool CExpectMTracer::ABtraceCall( SChanceTreeCall *call, const SChanceTreeNode *node,
-                     int depth, int qsDepth, float alpha, float beta, bool max ) const
+bool CExpectMTracer::ABtraceCall( SExpectMContext &context,
+                                  SChanceTreeCall *call, int node,
+                                  int depth, int qsDepth,
+                                  float alpha, float beta, bool max ) const
 {
-    if( call == NULL || node == NULL || node->s_chance)
+    const CCompiledChanceTree &tree = context.s_tree;
+    if( call == NULL || node < 0 || tree.isChance( node ))
+        return false;
+    if( context.isCancelled() )
         return false;
 
-    QList<SChanceTreeNode*> curChildren = node->s_childList;
-    sortNodes( curChildren );
+    ExpectChildOrder curChildren;
+    childOrder( context, node, curChildren );
+    sortNodes( context, curChildren );
+    orderBestChild( context, node, max, curChildren );
 
-    QString depthString;
-    QString open;
-    SChanceTreeNode *curNode;
-    foreach( curNode, curChildren )
-    {
-        open += curNode->s_name;
-        if( m_conf.s_isHT )
-        {
-            open += QString::number(m_historyTable[curNode]);
-        }
-        open += " ";
-    }
-    open = open.simplified();
+    recordCall( context, call, node, curChildren,
+                depth, qsDepth, alpha, beta, max );
+
+    int curNode;
 
     SExpectMLine *curLine;
-    SChanceTreeNode *bestAction = NULL;
+    int bestAction = -1;
     float bestValue = -1;
     float curAlpha = alpha, curBeta = beta;
 
     bool better;
     bool isEndPoint;
-    foreach( curNode, curChildren )
+    bool exhaustive = true;
+    bool childExhaustive;
+    for( int c = 0; c < curChildren.count(); ++c )
     {
+        curNode = curChildren[c];
         bool sssPrune = false;
 
         curLine = new SExpectMLine;
+        context.s_nodeCount++;
 
-        curLine->s_conf = m_conf;
-
-        curLine->s_open = open;
+        curLine->s_open = call->s_lines.count();
 
-        if( m_conf.s_isHT )
-            curLine->s_open.remove(' ');
-        curLine->s_eval = curNode->s_name;
-        open = open.section( ' ', 1, -1 );
-
-        depthString = "";
         isEndPoint = false;
-        if( curNode->s_childList.count() == 0 )
+        if( tree.childCount( curNode ) == 0 )
             isEndPoint = true;
 
-        if( m_conf.s_isDL )
-        {
-            depthString = QString(",%1").arg(depth);
-        }
-        if( m_conf.s_isQS )
-        {
-            depthString += QString(",%1").arg(qsDepth);
-        }
-        curLine->s_valueCall = max?"MaxChance":"MinChance";
-        curLine->s_valueCall += QString("(%1%2,%3,%4)")
-                                .arg(curNode->s_name)
-                                .arg(depthString)
-                                .arg(SExpectMLine::numberToString(curAlpha))
-                                .arg(SExpectMLine::numberToString(curBeta));
+        curLine->s_depth = depth;
+        curLine->s_qsDepth = qsDepth;
+        curLine->s_valueAlpha = curAlpha;
+        curLine->s_valueBeta = curBeta;
         if( isEndPoint )
         {
-            curLine->s_valueValue = curNode->s_value;
+            curLine->s_valueValue = tree.value( curNode );
             curLine->s_sss = false;
         }
-        else if( checkSSS( curNode, depth, qsDepth ) )
+        else if( checkSSS( context, curNode, depth, qsDepth ) )
         {
-            curLine->s_valueValue = sssValue( curNode, depth, qsDepth );
+            curLine->s_valueValue = sssValue( context, curNode,
+                                              depth, qsDepth );
 
             curLine->s_sss = true;
-            if(m_conf.s_isHT)
-                curLine->s_historyUpdates = sssHistoryUpdates( curNode,
+            if(context.s_conf.s_isHT)
+                curLine->s_historyUpdates = sssHistoryUpdates( context, curNode,
                                                     depth, qsDepth );
+            exhaustive = false;
 
         }
+        else if( context.s_conf.s_isTT
+                 && probeTT( context, curNode, !max, depth, qsDepth,
+                             curLine->s_valueValue, childExhaustive ) )
+        {
+            curLine->s_tt = true;
+            exhaustive = exhaustive && childExhaustive;
+        }
         else
         {
             call->s_children.append( new SChanceTreeCall() );
-            bool success = ABtraceECall( call->s_children.last(), curNode,
-                                         depth, qsDepth,
+            bool success = ABtraceECall( context, call->s_children.last(),
+                                         curNode, depth, qsDepth,
                                          curAlpha, curBeta, !max );
             if(!success)
             {
@@ -1019,6 +1892,9 @@ bool CExpectMTracer::ABtraceCall( SChanceTreeCall *call, const SChanceTreeNode *
                 return false;
             }
             curLine->s_valueValue = call->s_children.last()->s_returnValue;
+            if( context.s_conf.s_isTT )
+                exhaustive = exhaustive && context.s_transTable
+                    .value( ttKey( context, curNode, !max ) ).s_exhaustive;
         }
         // Chance nodes are not quiescent.
         // curLine->s_qs = (curDepth == 0 && curQSDepth > 0
@@ -1031,7 +1907,7 @@ bool CExpectMTracer::ABtraceCall( SChanceTreeCall *call, const SChanceTreeNode *
                 sssPrune = true;
         }
 
-        if( bestAction == NULL )
+        if( bestAction < 0 )
             better = true;
         else
         {
@@ -1062,7 +1938,7 @@ bool CExpectMTracer::ABtraceCall( SChanceTreeCall *call, const SChanceTreeNode *
         curLine->s_alpha = curAlpha;
         curLine->s_beta = curBeta;
 
-        curLine->s_bestAction = node->s_name + bestAction->s_name;
+        curLine->s_bestAction = tree.node( bestAction );
         curLine->s_bestValue = bestValue;
 
         call->s_lines.append( curLine );
@@ -1074,34 +1950,95 @@ bool CExpectMTracer::ABtraceCall( SChanceTreeCall *call, const SChanceTreeNode *
         if( sssPrune )
             curLine->s_prune = true;
     }
-    if( m_conf.s_isHT )
+    if( context.s_conf.s_isHT )
     {
-        m_historyTable[bestAction]++;
+        SExpectMHistoryUpdate update;
+        update.s_node = tree.node( bestAction );
+        update.s_value = ++context.s_historyTable[bestAction];
         ((SExpectMLine*)call->s_lines.last())->s_historyUpdates
-            += moveName( bestAction )
-               + ':' + QString::number( m_historyTable[bestAction] );
+            .append( update );
     }
 
     call->s_returnValue = bestValue;
-    depthString = "";
-    if( m_conf.s_isDL )
-    {
-        depthString = QString(",%1").arg(depth);
-    }
-    if( m_conf.s_isQS )
-    {
-        depthString += QString(",%1").arg(qsDepth);
-    }
-    ((SExpectMLine*)call->s_lines.first())->s_call =
-        QString(max?"Max(%1%2,%3,%4)":"Min(%1%2,%3,%4)")
-        .arg(node->s_name)
-        .arg(depthString)
-        .arg(SExpectMLine::numberToString(alpha))
-        .arg(SExpectMLine::numberToString(beta));
+    if( context.s_conf.s_isTT )
+        storeTT( context, node, max, depth, qsDepth, alpha, beta,
+                 bestValue, bestAction, exhaustive );
     ((SExpectMLine*)call->s_lines.last())->s_boxValue = true;
     return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMContext::SExpectMContext
+///
+/// @description    This is the constructor of the SExpectMContext struct.
+/// @pre            None
+/// @post           Object is created with empty tables.
+///
+/// @param conf:    Configuration of the run.
+///        lowerBound: Lowest value an end point can have.
+///        upperBound: Highest value an end point can have.
+///        cancel:  Cancellation token, or NULL if the run can't be cancelled.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SExpectMContext::SExpectMContext( const STraceConfig &conf,
+                                  qreal lowerBound, qreal upperBound,
+                                  const QAtomicInt *cancel )
+{
+    s_conf = conf;
+    s_lowerBound = lowerBound;
+    s_upperBound = upperBound;
+    s_cancel = cancel;
+    s_random = conf.s_seed;
+    s_pool = NULL;
+    s_splitLevel = 0;
+    s_isTask = false;
+    s_nodeCount = 0;
+    s_cancelled = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMContext::isCancelled
+///
+/// @description    Checks the cancellation token of the run.
+/// @pre            None
+/// @post           None
+///
+/// @param          None.
+///
+/// @return bool:   true if the run has been asked to stop.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool SExpectMContext::isCancelled() const
+{
+    return s_cancel != NULL && (int)*s_cancel != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMTTEntry::SExpectMTTEntry
+///
+/// @description    This is the constructor of the SExpectMTTEntry struct.
+/// @pre            None
+/// @post           Object is created as an empty entry.
+///
+/// @param          None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SExpectMTTEntry::SExpectMTTEntry()
+{
+    s_depth = -1;
+    s_qsDepth = -1;
+    s_bound = Exact;
+    s_value = 0.0;
+    s_bestChild = -1;
+    s_exhaustive = false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// SExpectMLine::SExpectMLine
 ///
@@ -1116,23 +2053,29 @@ bool CExpectMTracer::ABtraceCall( SChanceTreeCall *call, const SChanceTreeNode *
 ////////////////////////////////////////////////////////////////////////////////
 SExpectMLine::SExpectMLine()
 {
-    s_call = QString();
-    s_open = QString();
-    s_eval = QString();
-    s_bounds = QString();
+    s_open = 0;
+
+    s_depth = 0;
+    s_qsDepth = 0;
+    s_valueAlpha = -INF;
+    s_valueBeta = INF;
+    s_lowerBound = 0.0;
+    s_upperBound = 0.0;
 
-    s_valueCall = QString();
     s_valueValue = 0.0;
     s_qs = false;
     s_sss = false;
     s_prune = false;
     s_cPrune = false;
+    s_tt = false;
     s_chance = false;
+    s_probe = false;
+    s_samples = 0;
 
     s_alpha = -INF;
     s_beta = INF;
 
-    s_bestAction = QString();
+    s_bestAction = NULL;
     s_boxAction = false;
     s_bestValue = 0.0;
     s_boxValue = false;
@@ -1176,64 +2119,115 @@ QString SExpectMLine::numberToString( float val )
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// SExpectMLine::operator []
+/// callText
 ///
-/// @description
-/// @pre            None
-/// @post
+/// @description    Writes out a call of the search, such as Max(B,2,-INF,5),
+///                 showing only the arguments the configuration uses.
+///
+////////////////////////////////////////////////////////////////////////////////
+static QString callText( const char *name, const SChanceTreeNode *node,
+                         int depth, int qsDepth, float alpha, float beta,
+                         const STraceConfig &conf )
+{
+    QString ret = QString("%1(%2").arg(name).arg(node->s_name);
+    if( conf.s_isDL )
+        ret += QString(",%1").arg(depth);
+    if( conf.s_isQS )
+        ret += QString(",%1").arg(qsDepth);
+    if( conf.s_isAB )
+        ret += QString(",%1,%2")
+               .arg(SExpectMLine::numberToString(alpha))
+               .arg(SExpectMLine::numberToString(beta));
+    return ret + ")";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMLine::cell
+///
+/// @description    Makes the text of one cell of the line.
+/// @pre            call is the call the line belongs to, and was made by the
+///                 tracer.
+/// @post           None
 ///
 /// @param index:   index of collumn.
+///        call:    The call the line belongs to.
+///        conf:    The configuration the trace was made with.
+///
+/// @return QString: The text of the cell.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QString SExpectMLine::operator [](int index)
+QString SExpectMLine::cell( int index, const SChanceTreeCall *call,
+                            const STraceConfig &conf ) const
 {
     QString ret;
+    const SChanceTreeNode *child = call->s_open[s_open];
+    const char *name;
 
     switch( index )
     {
     case 0: //  CALL
-        ret = s_call;
+        if( call->s_lines.first() != this )
+            break;
+        // A chance call is named for the player before it.
+        if( call->s_root )
+            name = conf.s_isDL ? "DLM" : "Minimax";
+        else if( call->s_node->s_chance )
+            name = call->s_max ? "MinChance" : "MaxChance";
+        else
+            name = call->s_max ? "Max" : "Min";
+        ret = callText( name, call->s_node, call->s_depth, call->s_qsDepth,
+                        call->s_alpha, call->s_beta, conf );
         break;
     case 1: //  OPEN
-        ret = s_open;
+        for( int i = s_open; i < call->s_open.count(); ++i )
+        {
+            if( conf.s_isHT )
+                ret += call->s_open[i]->s_name
+                       + QString::number( call->s_openHistory[i] );
+            else
+            {
+                if( i > s_open )
+                    ret += " ";
+                ret += call->s_open[i]->s_name;
+            }
+        }
         break;
     case 2: //  EVAL
-        ret = s_eval;
+        ret = child->s_name;
         break;
     case 3: //  VALUE
-        ret = s_valueCall;
-        if(ret != "")
-            ret += "=" + QString::number( s_valueValue );
-        if( s_qs || s_sss || s_prune || s_cPrune )
+        if( s_chance )
+            name = call->s_max ? "Max" : "Min";
+        else
+            name = call->s_max ? "MaxChance" : "MinChance";
+        ret = callText( name, child, s_depth, s_qsDepth,
+                        s_valueAlpha, s_valueBeta, conf );
+        if( s_probe )
+            ret = "Probe" + ret;
+        ret += "=" + QString::number( s_valueValue );
+        if( s_qs || s_sss || s_tt || s_prune || s_cPrune || s_samples > 0 )
         {
-            ret += " (";
+            QStringList flags;
             if( s_qs )
-            {
-                ret += "QS";
-                if( s_sss || s_prune | s_cPrune )
-                    ret += ",";
-            }
+                flags += "QS";
             if( s_sss )
-            {
-                ret += "SSS";
-                if( s_prune || s_cPrune )
-                    ret += ",";
-            }
+                flags += "SSS";
+            if( s_tt )
+                flags += "TT";
             if( s_prune )
-	    {
-                ret += "Prune";
-                if( s_cPrune )
-                    ret += ",";
-            }
+                flags += "Prune";
             if( s_cPrune )
-                ret += "CP";
-            ret += ")";
+                flags += "CP";
+            if( s_samples > 0 )
+                flags += QString("%1/%2").arg(s_samples).arg(conf.s_samples);
+            ret += " (" + flags.join(",") + ")";
         }
         break;
     case 4:
-        ret = s_bounds;
+        if( s_chance && conf.s_isAB )
+            ret = QString("%1, %2").arg(s_lowerBound).arg(s_upperBound);
         break;
     case 5: //  a,b
         ret += numberToString(s_alpha);
@@ -1241,18 +2235,37 @@ QString SExpectMLine::operator [](int index)
         ret += numberToString(s_beta);
         break;
     case 6: //  BEST ACTION,VALUE
+        // The lines of a chance call have no best action. The last one shows
+        // the expected value.
         if( s_chance )
-            return s_bestAction;
+        {
+            if( s_boxValue )
+                ret = QString("[%1]").arg(numberToString(s_bestValue));
+            if( s_boxValue && call->s_error > 0 )
+                ret += QString(" +/- %1").arg(call->s_error, 0, 'g', 3);
+            return ret;
+        }
         else if( s_boxAction )
-            ret = QString("[%1], ").arg(s_bestAction);
+            ret = QString("[%1%2], ")
+                  .arg(call->s_node->s_name).arg(s_bestAction->s_name);
         else
-            ret = s_bestAction + ", ";
+            ret = call->s_node->s_name + s_bestAction->s_name + ", ";
         if( s_boxValue )
             ret += QString("[%1]").arg(s_bestValue);
         else
             ret += QString::number(s_bestValue);
-            if( !s_historyUpdates.isEmpty() )
-                ret += QString(" {%1}").arg(s_historyUpdates.join(","));
+        if( s_boxValue && call->s_error > 0 )
+            ret += QString(" +/- %1").arg(call->s_error, 0, 'g', 3);
+        if( !s_historyUpdates.isEmpty() )
+        {
+            QStringList updates;
+            for( int i = 0; i < s_historyUpdates.count(); ++i )
+                updates += CExpectMTracer::moveName(
+                               s_historyUpdates[i].s_node )
+                           + ':'
+                           + QString::number( s_historyUpdates[i].s_value );
+            ret += QString(" {%1}").arg(updates.join(","));
+        }
         break;
     default:
         break;
@@ -1264,26 +2277,33 @@ QString SExpectMLine::operator [](int index)
 ////////////////////////////////////////////////////////////////////////////////
 /// SExpectMLine::toStringList
 ///
-/// @description
-/// @pre            None
-/// @post
+/// @description    Makes the text of every cell the trace shows.
+/// @pre            call is the call the line belongs to.
+/// @post           None
 ///
-/// @param          None.
+/// @param call:    The call the line belongs to.
+///        conf:    The configuration the trace was made with.
+///
+/// @return QStringList: The cells, or s_cells if the line has them.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QStringList SExpectMLine::toStringList()
+QStringList SExpectMLine::toStringList( const SChanceTreeCall *call,
+                                        const STraceConfig &conf ) const
 {
+    if( !s_cells.isEmpty() || call == NULL || call->s_node == NULL )
+        return s_cells;
+
     QStringList ret;
 
     for( int i = 0; i < 7; ++i )
     {
         if(i == 2) continue;
-        if(i == 4 && !s_conf.s_isCP) continue;
-        if(i == 5 && !s_conf.s_isAB) continue;
+        if(i == 4 && !conf.s_isCP) continue;
+        if(i == 5 && !conf.s_isAB) continue;
 
-        ret += (*this)[i];
+        ret += cell( i, call, conf );
     }
     return ret;
 }
@@ -15,17 +15,37 @@
 #ifndef _CEXPECTMTRACER_H_
 #define _CEXPECTMTRACER_H_
 
-#include "../../SChanceTreeTrace.h"
 #include "../../CChanceTreeGraph.h"
+#include "../../CCompiledChanceTree.h"
 #include <QString>
 #include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QVarLengthArray>
+#include <QAtomicInt>
 
-typedef QMap<const SChanceTreeNode*, int> HistTable;
+struct SExpectMSplit;
+class QThreadPool;
+
+// History values are kept in a flat array indexed by the number each node has
+// in the compiled tree.
+typedef QVector<int> HistTable;
 // The name HistoryTable can't be used because there is another typedef
 // of that name with conflicting type in CChanceTreeGraphModel.h
 
 struct SChanceTreeTrace;
 struct SChanceTreeCall;
+struct SExpectMTTEntry;
+struct SExpectMHistoryUpdate;
+
+// The transposition table is keyed by the shape of a node and the player to
+// move there, so nodes with the same subtree share an entry.
+typedef QHash<int, SExpectMTTEntry> ExpectTTable;
+// The children of a node in the order they are searched. Most nodes have few
+// enough children to keep the order on the stack.
+typedef QVarLengthArray<int, 16> ExpectChildOrder;
+// A bound on the value of each child of a chance node, in search order.
+typedef QVarLengthArray<qreal, 16> ExpectBounds;
 
 struct STraceConfig
 {
@@ -41,16 +61,115 @@ struct STraceConfig
     bool s_isAB;
     // Chance Pruning
     bool s_isCP;
+    // Star2 probing?
+    bool s_isStar2;
+    // Sparse sampling of chance nodes?
+    bool s_isSampled;
+    // Number of outcomes drawn at each chance node when sampling.
+    int s_samples;
+    // Seed of the draws, so a sampled trace can be made again.
+    quint32 s_seed;
+    // Search the children of chance nodes in parallel?
+    bool s_isParallel;
     // Allow Single Successor Shortcut?
     bool s_allowSSS;
+    // Transposition Table?
+    bool s_isTT;
+    // Monte Carlo Tree Search instead of expectiminimax?
+    bool s_isMCTS;
+    // Number of simulations run by MCTS.
+    int s_playouts;
+    // Number of threads used by MCTS.
+    int s_threads;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMTTEntry
+///
+/// @description  An entry of the transposition table. It records the result
+///               of searching a node to a given remaining depth, whether that
+///               result is exact or only a bound, and which child was best.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SExpectMTTEntry
+{
+    SExpectMTTEntry();
+
+    enum BoundType
+    {
+        Exact,
+        LowerBound,
+        UpperBound
+    };
+
+    int                    s_depth;
+    int                    s_qsDepth;
+    BoundType              s_bound;
+    float                  s_value;
+    int                    s_bestChild;
+    // True if no leaf of the search was cut off by the depth limit, in which
+    // case the result also holds for any deeper search.
+    bool                   s_exhaustive;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMContext
+///
+/// @description  Everything that belongs to one run of CExpectMTracer: the
+///               configuration and value bounds, the cancellation token, the
+///               statistics, the compiled copy of the tree and the tables the
+///               search builds up.
+///
+/// @limitations  A context may only be used by one run at a time.
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SExpectMContext
+{
+    SExpectMContext( const STraceConfig &conf,
+                     qreal lowerBound, qreal upperBound,
+                     const QAtomicInt *cancel = NULL );
+
+    bool isCancelled() const;
+
+    STraceConfig        s_conf;
+    // Lowest and highest values an end point can have.
+    qreal               s_lowerBound;
+    qreal               s_upperBound;
+    // The run stops early once this is set to non-zero. May be NULL.
+    const QAtomicInt   *s_cancel;
+    // State of the random draws of sparse sampling.
+    quint32             s_random;
+    // Pool the children of chance nodes are shared out on in parallel mode,
+    // or NULL to search them one after another.
+    QThreadPool        *s_pool;
+    // How many chance nodes above are being searched in parallel.
+    int                 s_splitLevel;
+    // Keys this run stored in the transposition table, in order, when it
+    // searches one child of a parallel chance node.
+    bool                s_isTask;
+    QVector<int>        s_stored;
+
+    // Statistics, filled in by the run.
+    int                 s_nodeCount;
+    bool                s_cancelled;
+
+    // The tree being searched. Nodes are known by their number in it.
+    CCompiledChanceTree s_tree;
 
+    // Tables built up by the run.
+    HistTable           s_historyTable;
+    ExpectTTable        s_transTable;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CExpectMTracer
 ///
 /// @description  This class is capable of executing many combinations of
-///               MiniMax variations.
+///               MiniMax variations. The state of a run is kept in an
+///               SExpectMContext, so one tracer can run many traces at once.
 ///
 /// @limitations
 ///
@@ -62,42 +181,96 @@ public:
 
     SChanceTreeTrace *trace( const SChanceTreeNode *rootNode, int depthLimit, int qsDepth,
                        const STraceConfig &traceConf, qreal lowerBound, qreal upperBound ) const;
+    SChanceTreeTrace *trace( const SChanceTreeNode *rootNode,
+                             int depthLimit, int qsDepth,
+                             SExpectMContext &context ) const;
+
+    static QString moveName( const SChanceTreeNode *node );
 private:
-    bool traceCall( SChanceTreeCall *call, const SChanceTreeNode *node,
-                    int depth, int qsDepth, bool max ) const;
-    bool traceECall( SChanceTreeCall *call, const SChanceTreeNode *node,
-                    int depth, int qsDepth, bool max ) const;
-    bool ABtraceCall( SChanceTreeCall *call, const SChanceTreeNode *node,
-                    int depth, int qsDepth, float alpha, float beta, bool max ) const;
-    bool ABtraceECall( SChanceTreeCall *call, const SChanceTreeNode *node,
-                    int depth, int qsDepth, float alpha, float beta, bool max ) const;
-
-    bool checkSSS( const SChanceTreeNode *node, int depth, int qsDepth ) const;
-
-    float sssValue( const SChanceTreeNode *node, int depth, int qsDepth ) const;
-    QStringList sssHistoryUpdates( const SChanceTreeNode *node,
-                                   int depth, int qsDepth,
+    friend class CExpectMSplitHelper;
+
+    bool traceCall( SExpectMContext &context, SChanceTreeCall *call,
+                    int node, int depth, int qsDepth, bool max ) const;
+    bool traceECall( SExpectMContext &context, SChanceTreeCall *call,
+                    int node, int depth, int qsDepth, bool max ) const;
+    bool searchChildren( SExpectMContext &context,
+                         const ExpectChildOrder &children,
+                         int depth, int qsDepth, bool max,
+                         QVector<SChanceTreeCall *> &calls ) const;
+    void searchSplit( SExpectMSplit *split ) const;
+    bool ABtraceCall( SExpectMContext &context, SChanceTreeCall *call,
+                    int node, int depth, int qsDepth,
+                    float alpha, float beta, bool max ) const;
+    bool ABtraceECall( SExpectMContext &context, SChanceTreeCall *call,
+                    int node, int depth, int qsDepth,
+                    float alpha, float beta, bool max ) const;
+    bool probeChildren( SExpectMContext &context, SChanceTreeCall *call,
+                        const ExpectChildOrder &children,
+                        int depth, int qsDepth, float alpha, float beta,
+                        bool max, ExpectBounds &bounds, bool &cutoff ) const;
+    void recordCall( SExpectMContext &context, SChanceTreeCall *call,
+                     int node, const ExpectChildOrder &children,
+                     int depth, int qsDepth, float alpha, float beta,
+                     bool max ) const;
+
+    bool checkSSS( SExpectMContext &context,
+                   int node, int depth, int qsDepth ) const;
+
+    float sssValue( SExpectMContext &context,
+                    int node, int depth, int qsDepth ) const;
+    QVector<SExpectMHistoryUpdate> sssHistoryUpdates(
+                                   SExpectMContext &context,
+                                   int node, int depth, int qsDepth,
                                    bool top = true ) const;
-    void generateHistoryTable( const SChanceTreeNode *node ) const;
-    void sortNodes( QList<SChanceTreeNode *> &nodes ) const;
+    void generateHistoryTable( SExpectMContext &context ) const;
+    void childOrder( SExpectMContext &context, int node,
+                     ExpectChildOrder &nodes ) const;
+    void sortNodes( SExpectMContext &context,
+                    ExpectChildOrder &nodes ) const;
+    void sampleChildren( SExpectMContext &context, ExpectChildOrder &nodes,
+                         ExpectChildOrder &counts ) const;
 
-    QString moveName( const SChanceTreeNode *node ) const;
+    int ttKey( const SExpectMContext &context, int node, bool max ) const;
+    bool probeTT( SExpectMContext &context,
+                  int node, bool max, int depth, int qsDepth,
+                  float &value, bool &exhaustive ) const;
+    void storeTT( SExpectMContext &context,
+                  int node, bool max, int depth, int qsDepth,
+                  float alpha, float beta, float value,
+                  int bestChild, bool exhaustive ) const;
+    void orderBestChild( SExpectMContext &context, int node, bool max,
+                         ExpectChildOrder &nodes ) const;
+};
 
-    mutable HistTable m_historyTable;
-    mutable STraceConfig m_conf;
-    mutable qreal m_lowerBound;
-    mutable qreal m_upperBound;
+////////////////////////////////////////////////////////////////////////////////
+/// SExpectMHistoryUpdate
+///
+/// @description  A change made to the history table during a call: the node
+///               whose move was credited and its history value afterwards.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SExpectMHistoryUpdate
+{
+    const SChanceTreeNode  *s_node;
+    int                     s_value;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 /// SExpectMLine
 ///
 /// @description  The SExpectMLine represents an actual line in a trace grid. The
-///               different cells are returned as QStrings through the []
-///               operator or they can be extracted as a list by the
+///               different cells are returned as QStrings through the cell()
+///               function or they can be extracted as a list by the
 ///               toStringList function.
 ///
-/// @limitations
+///               A line only keeps numbers and the nodes it is about. Its
+///               text is made from them, and from the call it belongs to,
+///               when it is shown or saved.
+///
+/// @limitations  The nodes belong to the copy of the tree the trace was made
+///               from, which the trace keeps.
 ///
 ////////////////////////////////////////////////////////////////////////////////
 struct SExpectMLine
@@ -105,37 +278,56 @@ struct SExpectMLine
     SExpectMLine();
     ~SExpectMLine();
 
-    QString operator[](int index);
-    QStringList toStringList();
+    QString cell( int index, const SChanceTreeCall *call,
+                  const STraceConfig &conf ) const;
+    QStringList toStringList( const SChanceTreeCall *call,
+                              const STraceConfig &conf ) const;
 
     static QString numberToString( float val );
 
-    QString s_call;
+    // Where this line's child is in the open list of its call. The open
+    // column shows the child and the children after it.
+    int     s_open;
 
-    QString s_open;
+    // The depths and window the child's value was asked for with.
+    int     s_depth;
+    int     s_qsDepth;
+    float   s_valueAlpha;
+    float   s_valueBeta;
 
-    QString s_eval;
-
-    QString s_valueCall;
-    
-    QString s_bounds;
+    // The bounds on the expected value of a chance node once this line's
+    // child is known, shown by the lines of an Alpha Beta chance call.
+    float   s_lowerBound;
+    float   s_upperBound;
 
     float   s_valueValue;
     bool    s_sss;
     bool    s_qs;
     bool    s_prune;
     bool    s_cPrune;
+    bool    s_tt;
     bool    s_chance;
+    // True for a Star2 probe: the child's value was only bounded by
+    // searching its first successor.
+    bool    s_probe;
+    // How many of the outcomes drawn at a sampled chance node were this
+    // line's child, or 0 if the node was not sampled.
+    int     s_samples;
     float   s_alpha;
     float   s_beta;
 
-    QString s_bestAction;
+    // The best child so far, or for the last line of a chance call, NULL
+    // with the expected value in s_bestValue.
+    const SChanceTreeNode *s_bestAction;
     bool    s_boxAction;
     float   s_bestValue;
     bool    s_boxValue;
 
-    STraceConfig s_conf;
-    QStringList  s_historyUpdates;
+    QVector<SExpectMHistoryUpdate> s_historyUpdates;
+
+    // Cells of a line that doesn't follow the call layout above, such as the
+    // snapshot lines of MCTS. Used as is when not empty.
+    QStringList  s_cells;
 };
 
 
@@ -15,6 +15,7 @@
 
 #include <QFile>
 #include <QMessageBox>
+#include <QHash>
 #include "CPuzzleGraph.h"
 #include "../../gnat.h"
 
@@ -53,6 +54,60 @@ CPuzzleGraph::~CPuzzleGraph()
         delete m_nodeList.takeFirst();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleGraph::clone
+///
+/// @description            This function makes a deep copy of the puzzle. The
+///                         spans of the copy join the copied nodes.
+/// @pre                    None
+/// @post                   None
+///
+/// @return CPuzzleGraph *: The copy, which the caller owns.
+///
+/// @limitations            None
+///
+////////////////////////////////////////////////////////////////////////////////
+CPuzzleGraph *CPuzzleGraph::clone() const
+{
+    CPuzzleGraph *graph = new CPuzzleGraph;
+    graph->m_fileName = m_fileName;
+
+    QHash<const SPuzzleNode *, SPuzzleNode *> nodeCopies;
+    const SPuzzleNode *node;
+    foreach( node, m_nodeList )
+    {
+        SPuzzleNode *nodeCopy = new SPuzzleNode;
+        nodeCopy->s_name = node->s_name;
+        nodeCopy->s_heuristic = node->s_heuristic;
+        nodeCopy->s_position = node->s_position;
+        nodeCopy->s_flag = node->s_flag;
+        graph->m_nodeList.append( nodeCopy );
+        nodeCopies.insert( node, nodeCopy );
+    }
+
+    // Spans are added to the node span lists in the order the nodes hold
+    // them, since the tracers expand neighbours in that order.
+    QHash<const SPuzzleSpan *, SPuzzleSpan *> spanCopies;
+    const SPuzzleSpan *span;
+    foreach( span, m_spanList )
+    {
+        SPuzzleSpan *spanCopy =
+            new SPuzzleSpan( nodeCopies.value( span->s_node1 ),
+                             nodeCopies.value( span->s_node2 ) );
+        spanCopy->s_weightFrom1 = span->s_weightFrom1;
+        spanCopy->s_weightFrom2 = span->s_weightFrom2;
+        spanCopy->s_flag = span->s_flag;
+        graph->m_spanList.append( spanCopy );
+        spanCopies.insert( span, spanCopy );
+    }
+    foreach( node, m_nodeList )
+        foreach( span, node->s_spanList )
+            nodeCopies[node]->s_spanList.append( spanCopies.value( span ) );
+
+    graph->m_startNode = nodeCopies.value( m_startNode );
+    return graph;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CPuzzleGraph::getFileName
 ///
@@ -47,6 +47,8 @@ public:
     CPuzzleGraph();
     ~CPuzzleGraph();
 
+    CPuzzleGraph *clone() const;
+
     QString getFileName();
     QList<SPuzzleNode *> &getNodeList();
     QList<SPuzzleSpan *> &getSpanList();
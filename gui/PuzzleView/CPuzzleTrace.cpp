@@ -13,6 +13,7 @@
 ///
 ////////////////////////////////////////////////////////////////////////////////
 #include "CPuzzleTrace.h"
+#include <QDataStream>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// SPuzzleTrace::SPuzzleTrace
@@ -52,6 +53,97 @@ SPuzzleTrace::~SPuzzleTrace()
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// rowsFromCall
+///
+/// @description  Collects the rows of a call and, depth first, of the calls
+///               it makes, in the order the trace view shows them.
+///
+////////////////////////////////////////////////////////////////////////////////
+static void rowsFromCall( SPuzzleCall *call, QList<QStringList> &rows )
+{
+    IPuzzleLine *curLine;
+    foreach( curLine, call->s_lines )
+        rows.append( curLine->toStringList() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPuzzleTrace::write
+///
+/// @description     Writes the trace to a stream, for keeping on disk. Only
+///                  the rows of each depth are written, not the lines they
+///                  come from.
+/// @pre             None
+/// @post            None
+///
+/// @param out:      The stream to write to.
+///
+/// @limitations     None
+///
+////////////////////////////////////////////////////////////////////////////////
+void SPuzzleTrace::write( QDataStream &out ) const
+{
+    out << s_aiName << s_columnNames << (qint32)s_depths.count();
+
+    SPuzzleCall *curDepth;
+    foreach( curDepth, s_depths )
+    {
+        QList<QStringList> rows;
+        rowsFromCall( curDepth, rows );
+
+        out << curDepth->s_returnValue << curDepth->s_prelude
+            << curDepth->s_comment << (qint32)rows.count();
+        QStringList row;
+        foreach( row, rows )
+            out << row;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPuzzleTrace::read
+///
+/// @description     Reads a trace written by write(). Each depth is read back
+///                  as a single call whose lines hold the rows as they were
+///                  shown.
+/// @pre             None
+/// @post            None
+///
+/// @param in:       The stream to read from.
+///
+/// @return SPuzzleTrace *: The trace, owned by the caller, or NULL if the
+///                  stream did not hold one.
+///
+/// @limitations     None
+///
+////////////////////////////////////////////////////////////////////////////////
+SPuzzleTrace *SPuzzleTrace::read( QDataStream &in )
+{
+    SPuzzleTrace *trace = new SPuzzleTrace;
+    qint32 depths = 0, rows = 0;
+    in >> trace->s_aiName >> trace->s_columnNames >> depths;
+
+    for( ; depths > 0 && in.status() == QDataStream::Ok; --depths )
+    {
+        SPuzzleCall *call = new SPuzzleCall;
+        trace->s_depths.append( call );
+        in >> call->s_returnValue >> call->s_prelude >> call->s_comment >> rows;
+
+        for( ; rows > 0 && in.status() == QDataStream::Ok; --rows )
+        {
+            SPuzzleTextLine *line = new SPuzzleTextLine;
+            in >> line->s_cells;
+            call->s_lines.append( line );
+        }
+    }
+
+    if( in.status() != QDataStream::Ok )
+    {
+        delete trace;
+        return NULL;
+    }
+    return trace;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// SPuzzleCall::SPuzzleCall
 ///
@@ -135,3 +227,41 @@ IPuzzleLine *SPuzzleCall::operator[](int index)
 IPuzzleLine::~IPuzzleLine()
 {
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPuzzleTextLine::operator[]
+///
+/// @description     Returns the text of a cell.
+/// @pre             None
+/// @post            None
+///
+/// @param index:    The column of the cell.
+///
+/// @return QString: The text, or an empty string past the last cell.
+///
+/// @limitations     None
+///
+////////////////////////////////////////////////////////////////////////////////
+QString SPuzzleTextLine::operator[](int index)
+{
+    if( index >= 0 && index < s_cells.count() )
+        return s_cells[index];
+    return "";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPuzzleTextLine::toStringList
+///
+/// @description     Returns the text of all the cells.
+/// @pre             None
+/// @post            None
+///
+/// @return QStringList: A copy of s_cells.
+///
+/// @limitations     None
+///
+////////////////////////////////////////////////////////////////////////////////
+QStringList SPuzzleTextLine::toStringList()
+{
+    return s_cells;
+}
@@ -19,6 +19,7 @@
 #include <QStringList>
 #include <QSize>
 
+class QDataStream;
 struct SPuzzleCall;
 struct IPuzzleLine;
 
@@ -59,6 +60,9 @@ struct SPuzzleTrace
     //Iterative-Deepening(ID) trace. If the trace is not ID then there will only
     //be one entry in the list.
     QList<SPuzzleCall *>  s_depths;
+
+    void write( QDataStream &out ) const;
+    static SPuzzleTrace *read( QDataStream &in );
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -117,4 +121,21 @@ struct IPuzzleLine
 
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/// SPuzzleTextLine
+///
+/// @description  A line that only holds the text of its cells, as read back
+///               from a trace kept on disk.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SPuzzleTextLine : public IPuzzleLine
+{
+    QString operator[](int index);
+    QStringList toStringList();
+
+    QStringList s_cells;
+};
+
 #endif /*_STREETRACE_H_*/
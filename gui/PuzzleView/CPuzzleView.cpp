@@ -169,6 +169,12 @@ void CPuzzleView::setupToolBar()
     tempAction = m_toolBar->addAction(QIcon(":/autoname.png"), "Auto Name" );
     connect( tempAction, SIGNAL(activated()), m_graphView, SLOT(autoName()) );
 
+    // "Auto Heuristic" button
+    tempAction = m_toolBar->addAction(QIcon(":/autonumber.png"),
+                                      "Auto Heuristic" );
+    connect( tempAction, SIGNAL(activated()), m_graphView,
+             SLOT(autoHeuristic()) );
+
     // "Auto Number" button
     //tempAction = m_toolBar->addAction(QIcon(":/autonumber.png"), "Auto Number" );
     //connect( tempAction, SIGNAL(activated()), m_graphView, SLOT(autoNumber()) );
@@ -191,6 +197,9 @@ void CPuzzleView::setupToolBar()
     tempLabel = m_traceView->getAILabel();
     m_toolBar->addWidget( m_traceView->getAILabel() );
 
+    // Progress of the running trace
+    m_toolBar->addWidget( m_traceView->getProgressWidget() );
+
     // Depth spinbox
     tempLabel = new QLabel( m_toolBar );
     tempLabel->setTextFormat(Qt::AutoText);
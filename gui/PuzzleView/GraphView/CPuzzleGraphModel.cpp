@@ -19,6 +19,7 @@
 #include "CPuzzleGraphModel.h"
 #include "CPuzzleSpanArtist.h"
 #include <QBitmap>
+#include <QVector>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CPuzzleGraphModel::CPuzzleGraphModel
@@ -167,6 +168,31 @@ void CPuzzleGraphModel::addSpan(SPuzzleSpan *span)
 	emit changed();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleGraphModel::clone
+///
+/// @description                 This function makes a model holding a deep
+///                              copy of the puzzle, which can be traced on
+///                              another thread while this one is edited.
+/// @pre                         None
+/// @post                        None
+///
+/// @return CPuzzleGraphModel *: The copy. It has no parent and the caller
+///                              owns it.
+///
+/// @limitations                 None
+///
+////////////////////////////////////////////////////////////////////////////////
+CPuzzleGraphModel *CPuzzleGraphModel::clone() const
+{
+    CPuzzleGraphModel *model = new CPuzzleGraphModel( NULL );
+    if (m_data != NULL)
+    {
+        model->m_data = m_data->clone();
+    }
+    return model;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CPuzzleGraphModel::createNewData
 ///
@@ -1026,6 +1052,112 @@ int CPuzzleGraphModel::findSpan( int node1, int node2 ) const
     return -1;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleGraphModel::autoHeuristic
+///
+/// @description    Assigns every node a heuristic value equal to its geometric
+///                 distance to the nearest goal node, measured with the given
+///                 metric and scaled by the smallest weight per pixel found on
+///                 any edge. Since no edge costs less than its scaled length,
+///                 the resulting heuristic never overestimates and is
+///                 admissible.
+/// @pre            None
+/// @post           Every node's heuristic value is replaced.
+///
+/// @param metric:  This is the distance metric to be used.
+///
+/// @limitations    Values are truncated to one decimal place for display. If
+///                 the graph has no goal nodes or no weighted edges every
+///                 heuristic is set to zero.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPuzzleGraphModel::autoHeuristic( HeuristicMetric metric )
+{
+    if( m_data == NULL || m_data->getNodeList().size() == 0 ) return;
+
+    QList<SPuzzleNode *> goals = getGoalNodeList();
+    int goalCount = goals.size();
+    qreal scale = minWeightRatio( metric );
+
+    //The goal coordinates are copied into separate x and y arrays once, so
+    //the loops below read plain arrays instead of going through the goal
+    //list for every node.
+    QVector<qreal> goalX( goalCount );
+    QVector<qreal> goalY( goalCount );
+    for ( int i = 0; i < goalCount; i++ )
+    {
+        goalX[i] = goals[i]->s_position.x();
+        goalY[i] = goals[i]->s_position.y();
+    }
+    const qreal *gx = goalX.constData();
+    const qreal *gy = goalY.constData();
+
+    //This is the extra cost of a diagonal step over a straight one.
+    const qreal diagonal = sqrt( 2.0 ) - 2.0;
+
+    SPuzzleNode * node;
+    foreach( node, m_data->getNodeList() )
+    {
+        qreal x = node->s_position.x();
+        qreal y = node->s_position.y();
+        qreal best = 0;
+
+        // Description:     Find the distance to the nearest goal.  Each metric
+        //                  has its own loop so the metric is not tested for
+        //                  every goal.
+        // Precondition:    best is zero, goalCount may be zero.
+        // Postcondition:   best holds the smallest distance to any goal (the
+        //                  squared distance for the euclidean metric).
+        if ( goalCount > 0 )
+        {
+            qreal dx, dy, d;
+            switch ( metric )
+            {
+                case Euclidean:
+                    dx = gx[0] - x;
+                    dy = gy[0] - y;
+                    best = dx * dx + dy * dy;
+                    for ( int i = 1; i < goalCount; i++ )
+                    {
+                        dx = gx[i] - x;
+                        dy = gy[i] - y;
+                        d = dx * dx + dy * dy;
+                        best = d < best ? d : best;
+                    }
+                    best = sqrt( best );
+                    break;
+
+                case Manhattan:
+                    best = fabs( gx[0] - x ) + fabs( gy[0] - y );
+                    for ( int i = 1; i < goalCount; i++ )
+                    {
+                        d = fabs( gx[i] - x ) + fabs( gy[i] - y );
+                        best = d < best ? d : best;
+                    }
+                    break;
+
+                case Octile:
+                    dx = fabs( gx[0] - x );
+                    dy = fabs( gy[0] - y );
+                    best = dx + dy + diagonal * ( dx < dy ? dx : dy );
+                    for ( int i = 1; i < goalCount; i++ )
+                    {
+                        dx = fabs( gx[i] - x );
+                        dy = fabs( gy[i] - y );
+                        d = dx + dy + diagonal * ( dx < dy ? dx : dy );
+                        best = d < best ? d : best;
+                    }
+                    break;
+            }
+        }
+
+        //Truncate rather than round so the value stays a lower bound.
+        node->s_heuristic = floor( best * scale * 10.0 ) / 10.0;
+    }
+
+    emit changed();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CPuzzleGraphModel::autoName
 ///
@@ -1115,6 +1247,85 @@ void CPuzzleGraphModel::snapToGrid(int x, int y)
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleGraphModel::metricDistance
+///
+/// @description    This function measures the length of the offset (dx, dy)
+///                 with the given metric.
+/// @pre            None
+/// @post           None
+///
+/// @param metric:  This is the distance metric to be used.
+/// @param dx:      This is the horizontal offset.
+/// @param dy:      This is the vertical offset.
+///
+/// @return qreal:  Returns the length of the offset.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+qreal CPuzzleGraphModel::metricDistance( HeuristicMetric metric, qreal dx,
+                                         qreal dy ) const
+{
+    dx = fabs( dx );
+    dy = fabs( dy );
+    switch ( metric )
+    {
+        case Manhattan:
+            return dx + dy;
+        case Octile:
+            return qMax( dx, dy ) + ( sqrt( 2.0 ) - 1.0 ) * qMin( dx, dy );
+        case Euclidean:
+        default:
+            return sqrt( dx * dx + dy * dy );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleGraphModel::minWeightRatio
+///
+/// @description    This function finds the smallest ratio of edge weight to
+///                 edge length, in pixels, over every traversable direction of
+///                 every span.
+/// @pre            m_data is not NULL.
+/// @post           None
+///
+/// @param metric:  This is the distance metric used to measure edge lengths.
+///
+/// @return qreal:  Returns the smallest weight per pixel, or zero if there are
+///                 no edges or any edge has a negative weight.
+///
+/// @limitations    Spans whose two nodes share a position are ignored.
+///
+////////////////////////////////////////////////////////////////////////////////
+qreal CPuzzleGraphModel::minWeightRatio( HeuristicMetric metric ) const
+{
+    bool found = false;
+    qreal ratio = 0;
+    SPuzzleSpan * span;
+    foreach( span, m_data->getSpanList() )
+    {
+        QPoint offset = span->s_node2->s_position - span->s_node1->s_position;
+        qreal length = metricDistance( metric, offset.x(), offset.y() );
+        if ( length <= 0 )
+            continue;
+
+        if ( span->s_flag & SPuzzleSpan::From1 )
+        {
+            qreal r = span->s_weightFrom1 / length;
+            ratio = found ? qMin( ratio, r ) : r;
+            found = true;
+        }
+        if ( span->s_flag & SPuzzleSpan::From2 )
+        {
+            qreal r = span->s_weightFrom2 / length;
+            ratio = found ? qMin( ratio, r ) : r;
+            found = true;
+        }
+    }
+    return qMax( ratio, qreal( 0 ) );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CPuzzleGraphModel::getContainingRect
 ///
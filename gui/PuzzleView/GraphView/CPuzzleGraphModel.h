@@ -42,10 +42,18 @@ public:
     CPuzzleGraphModel( QObject *parent );
     ~CPuzzleGraphModel();
 
+    enum HeuristicMetric
+    {
+        Euclidean,
+        Manhattan,
+        Octile
+    };
+
     void addEdge( int node1, int node2, bool bidirectional );
     void addNode(SPuzzleNode *node);
     void addSpan(SPuzzleSpan *span);
 
+    CPuzzleGraphModel *clone() const;
     void createNewData();
 
     void deleteNodeAt(int index);
@@ -68,6 +76,7 @@ public:
     int findSpan( QPoint p ) const;
     int findSpan( int node1, int node2 ) const;
 
+    void autoHeuristic( HeuristicMetric metric );
     void autoName();
     void autoLayout();
     void snapToGrid(int x, int y);
@@ -93,6 +102,9 @@ public:
 
 private:
 
+    qreal metricDistance( HeuristicMetric metric, qreal dx, qreal dy ) const;
+    qreal minWeightRatio( HeuristicMetric metric ) const;
+
     bool testEdgeNormal(QPoint p, int index, int &type) const;
     bool testEdgeSplit (QPoint p, int index, int &type) const;
     bool testEdgeWeight(QPoint p, int index, int &type) const;
@@ -24,6 +24,7 @@
 #include "CPuzzleGraphModel.h"
 #include <QResizeEvent>
 #include <QMessageBox>
+#include <QInputDialog>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CPuzzleGraphView::CPuzzleGraphView
@@ -237,6 +238,41 @@ void CPuzzleGraphView::toggleHeuristics(bool b)
 	m_canvas->update();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleGraphView::autoHeuristic
+///
+/// @description  This function prompts the user for a distance metric and then
+///               calls the autoHeuristic function within the model.
+/// @pre          None
+/// @post         Every node has a heuristic value based on its distance to the
+///               nearest goal node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPuzzleGraphView::autoHeuristic()
+{
+    // Declaring this static will make the dialog default to the metric most
+    // recently chosen.
+    static int metric = CPuzzleGraphModel::Euclidean;
+    QStringList metrics;
+    metrics << tr("Euclidean") << tr("Manhattan") << tr("Octile");
+
+    bool ok;
+    QString item = QInputDialog::getItem( parentWidget(),
+                    tr("Auto Heuristic"), // Title
+                    tr("Distance metric"), // Label
+                    metrics, // Items
+                    metric, // Current
+                    false, // Editable
+                    &ok ); // Ok
+
+    if(!ok) return;
+
+    metric = metrics.indexOf( item );
+    m_model->autoHeuristic( CPuzzleGraphModel::HeuristicMetric( metric ) );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CPuzzleGraphView::autoName
 ///
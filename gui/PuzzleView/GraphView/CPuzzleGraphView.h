@@ -63,6 +63,7 @@ protected slots:
     void modelChanged();
     void moveDone();
     void toggleHeuristics(bool b);
+    void autoHeuristic();
     void autoName();
     void autoLayout();
 
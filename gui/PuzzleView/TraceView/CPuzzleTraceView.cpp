@@ -37,6 +37,8 @@ CPuzzleTraceView::CPuzzleTraceView( QWidget *parent )
 #include "../CPuzzleTrace.h"
 #include "../GraphView/CPuzzleGraphModel.h"
 #include "../../CStyleToolkit.h"
+#include "../../CTraceRunner.h"
+#include "../../CTraceTableModel.h"
 #include "PuzzleTracers/CPuzzleTracerSelector.h"
 #include <QComboBox>
 #include <QSpinBox>
@@ -63,9 +65,10 @@ CPuzzleTraceView::CPuzzleTraceView( QWidget *parent )
 ///
 ////////////////////////////////////////////////////////////////////////////////
 CPuzzleTraceView::CPuzzleTraceView( QWidget *parent )
-: QTableWidget( parent )
+: QTableView( parent ), m_cache( "puzzle" )
 {
     m_trace = NULL;
+    m_rows = NULL;
     m_style = CStyleToolkit::instance();
 
     //The m_selector encapsulates all the editables in the tool bar that have to
@@ -73,6 +76,13 @@ CPuzzleTraceView::CPuzzleTraceView( QWidget *parent )
     //three will emit the activiated() signal.
     m_selector = new CPuzzleTracerSelector( this );
     connect( m_selector, SIGNAL(activated()), this, SLOT( retrace() ) );
+
+    m_model = new CTraceTableModel( this );
+    setModel( m_model );
+
+    m_runner = new CTraceRunner( this );
+    connect( m_runner, SIGNAL(scheduled()), this, SLOT( startTrace() ) );
+    connect( m_runner, SIGNAL(finished()), this, SLOT( showTrace() ) );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -81,15 +91,16 @@ CPuzzleTraceView::CPuzzleTraceView( QWidget *parent )
 /// @description  This is the destructor for the CTreeTraceView class which
 ///               frees up dynamically allocated memory.
 /// @pre          None
-/// @post         The trace is deleted if it exists.
+/// @post         Any running trace is stopped. The traces are deleted with
+///               the cache.
 ///
 /// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
 CPuzzleTraceView::~CPuzzleTraceView()
 {
-    if ( m_trace != NULL )
-        delete m_trace;
+    //The running job uses the selector, so stop it first.
+    delete m_runner;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -160,126 +171,123 @@ QComboBox *CPuzzleTraceView::getTreeGraphSelector()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// CTreeGraphView::retrace
+/// CPuzzleTraceView::getProgressWidget
+///
+/// @description          This function returns a pointer to the widget that
+///                       shows a trace is running and lets the user cancel it.
+/// @pre                  None
+/// @post                 A pointer to the progress widget is returned.
+///
+/// @return QWidget *:    This is a pointer to the progress widget.
+///
+/// @limitations          None
+///
+////////////////////////////////////////////////////////////////////////////////
+QWidget *CPuzzleTraceView::getProgressWidget()
+{
+    return m_runner->getProgressWidget();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceView::retrace
 ///
-/// @description  This function is a Qt slot. Calling it will update the trace
-///               to reflect the current states of the Graph Model and the
-///               Trace Selector.
+/// @description  This function is a Qt slot. Calling it asks for a trace of
+///               the current states of the Graph Model and the Trace Selector.
+///               Calls that come in close together, such as those made while
+///               a node is dragged, lead to a single startTrace().
 /// @pre          None
-/// @post         The trace is updated and repainted.
+/// @post         startTrace() will be called.
 ///
 /// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
 void CPuzzleTraceView::retrace()
 {
-    //Delete any existing trace
-    if( m_trace != NULL )
-        delete m_trace;
-
-    //Perform the actual trace
-    m_trace = m_selector->trace( m_graphModel );
-
-    //Get the string grid
-    QList<QStringList> lines = gridFromTrace( m_trace );
-    int rows = lines.count();
-    int columns = m_trace->s_columnNames.count();
-
-    //Update the table parameters
-    setColumnCount(columns);
-    setHorizontalHeaderLabels( m_trace->s_columnNames );
-    setRowCount(rows);
-
-    //For loop through the 2d array of QStrings
-    QTableWidgetItem *item;
-    int i,j;
-    for( i = 0; i < rows; ++i )
-        for( j = 0; j < columns; ++j )
-        {
-            //create the item, set the text, set the font, plug it in.
-            item = new QTableWidgetItem(lines[i][j]);
-            item->setFont( m_style->getFont() );
-            setItem( i, j, item );
-        }
-
-    //Resize all the columns to be just the right width
-    for( j = 0; j < columns; ++j )
-        resizeColumnToContents(j);
+    m_runner->schedule();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// CTreeGraphView::gridFromCall
-///
-/// @description          This is a recursive function that returns a 2d array
-///                       of QStrings that represents the trace from the call.
-/// @pre                  None
-/// @post                 The grid is returned.
-///
-/// @param call:          This is the call to be converted to a grid of strings.
+/// CPuzzleTraceView::startTrace
 ///
-/// @return QList<QStringList>: This is the 2d array of QString
+/// @description  This function is a Qt slot. It starts a trace of the current
+///               states of the Graph Model and the Trace Selector in the
+///               background, unless the trace on show or on its way already
+///               reflects them or the cache holds one that does. A trace that
+///               is still running is abandoned.
+/// @pre          None
+/// @post         The trace is shown from the cache or started if needed.
+///               showTrace() is called when a started trace is done.
 ///
-/// @limitations          None
+/// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QList<QStringList> CPuzzleTraceView::gridFromCall( SPuzzleCall *call )
+void CPuzzleTraceView::startTrace()
 {
-    QList<QStringList> lineGrid;
+    QByteArray key = m_selector->traceKey( m_graphModel );
+    if( m_runner->isCurrent( key ) )
+        return;
 
-    IPuzzleLine *curLine;
-    foreach( curLine, call->s_lines )
-        lineGrid += curLine->toStringList();
-    //lineGrid.last().append("");
-/*
-    SPuzzleCall *curCall;
-    foreach( curCall, call->s_children )
-        lineGrid += gridFromCall( curCall );
-*/
-    return lineGrid;
+    //A trace made before for the same graph and settings is shown at once.
+    SPuzzleTrace *trace = m_cache.find( key );
+    if( trace != NULL )
+    {
+        m_runner->setCurrent( key );
+        m_trace = trace;
+        updateTable();
+        return;
+    }
+
+    m_runner->start( m_selector->createJob( m_graphModel ), key );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// CPuzzleTraceView::gridFromTrace
-///
-/// @description          This function returns a 2d array of QStrings that
-///                       represents the trace.
-/// @pre                  None
-/// @post                 The grid is returned.
-///
-/// @param trace:         This is the trace to be converted to a grid of strings.
+/// CPuzzleTraceView::showTrace
 ///
-/// @return QList<QStringList>: This is the 2d array of QString
+/// @description  This function is a Qt slot, called when a background trace
+///               is done. The new trace is cached and replaces the one on
+///               show.
+/// @pre          None
+/// @post         The trace is updated and repainted.
 ///
-/// @limitations          None
+/// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QList<QStringList> CPuzzleTraceView::gridFromTrace( SPuzzleTrace *trace )
+void CPuzzleTraceView::showTrace()
 {
-    QList<QStringList> stringGrid;
+    CPuzzleTraceJob *job =
+        static_cast<CPuzzleTraceJob *>( m_runner->takeResult() );
+    if( job == NULL )
+        return;
 
-    QStringList blankLine;
-    QStringList preludeLine;
-    QStringList commentLine;
-    for( int i = trace->s_columnNames.count(); i > 0; --i )
-        blankLine.append("");
+    //The cache owns the traces, the one on show included.
+    m_trace = job->takeTrace();
+    m_cache.insert( job->key(), m_trace );
+    delete job;
 
-    preludeLine = commentLine = blankLine;
+    updateTable();
+}
 
-    SPuzzleCall *rootCall;
-    foreach( rootCall, trace->s_depths )
-    {
-        preludeLine.last() = rootCall->s_prelude;
-        commentLine.last() = rootCall->s_comment;
-
-        if(rootCall->s_prelude != "")
-            stringGrid += preludeLine;
-        stringGrid += gridFromCall( rootCall );
-        stringGrid += commentLine;
-        //stringGrid += blankLine;
-    }
-    //if( !stringGrid.isEmpty() ) stringGrid.takeLast();
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceView::updateTable
+///
+/// @description  Fills the table from the trace on show, in the current font.
+/// @pre          None
+/// @post         The table is updated and repainted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPuzzleTraceView::updateTable()
+{
+    if( m_trace == NULL )
+        return;
 
-    return stringGrid;
+    //The rows are indexed once per trace, for showing and for saving,
+    //and the model makes the text of a cell only when it comes into sight.
+    m_model->setFont( m_style->getFont() );
+    m_rows = new CPuzzleTraceRows( m_trace );
+    m_model->setSource( m_trace->s_columnNames, m_rows );
+    m_model->fitView( this );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -331,14 +339,16 @@ void CPuzzleTraceView::saveTrace()
     collumns.pop_back();
 
     // \begin{tabluar}{l|l|l|l|l}
+    const CPuzzleTraceRows::CIndex &index = m_rows->index();
     SPuzzleCall *curDepth;
-    foreach(curDepth, m_trace->s_depths)
+    for( int d = 0; d < index.depthCount(); ++d )
     {
+        curDepth = m_trace->s_depths[d];
 
         if(curDepth->s_prelude != "")
             stream <<"\n\\emph{" << curDepth->s_prelude << "}\\\\";
     stream <<"\n\\begin{tabular}{l";
-        for( int i = columnCount(); i > 2; --i )
+        for( int i = m_model->columnCount(); i > 2; --i )
             stream<<"|l";
         stream<<"}\n\\hline\n";
 
@@ -351,10 +361,13 @@ void CPuzzleTraceView::saveTrace()
         stream<<rowEnd;
 
         // All the lines
-        QList<QStringList> grid = gridFromCall(curDepth);
         QStringList curLine;
-        foreach( curLine, grid )
+        for( int i = index.depthBegin( d ); i < index.depthEnd( d ); ++i )
         {
+            if( index.row( i ).s_kind != CPuzzleTraceRows::CIndex::LineRow )
+                continue;
+            curLine = m_rows->row( i );
+
             // If the first and second cells are empty then consider it a depth
             // seperation in the grid.
             if( curLine[0].isEmpty() && curLine[1].isEmpty() )
@@ -366,7 +379,7 @@ void CPuzzleTraceView::saveTrace()
                 stream<<rowSeparator<<"\n";
                 //QString comment = curLine.last();
 
-                while( curLine.size() >= columnCount() )
+                while( curLine.size() >= m_model->columnCount() )
                    curLine.pop_back();
                 output = curLine.join( "\t&" );
                 output.replace( "-INF", "$-\\infty$");
@@ -419,3 +432,96 @@ void CPuzzleTraceView::setGraphModel( CPuzzleGraphModel *model )
     connect( model, SIGNAL(changed()), this, SLOT(retrace()) );
     retrace();
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceRows::CPuzzleTraceRows
+///
+/// @description    This is the constructor of the CPuzzleTraceRows class.
+///                 It indexes the rows of the trace in one pass.
+/// @pre            None
+/// @post           None
+///
+/// @param trace:   This is the trace. It must outlive the object.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+CPuzzleTraceRows::CPuzzleTraceRows( SPuzzleTrace *trace )
+{
+    m_columns = trace->s_columnNames.count();
+
+    SPuzzleCall *rootCall;
+    foreach( rootCall, trace->s_depths )
+    {
+        m_index.beginDepth();
+        if( rootCall->s_prelude != "" )
+            m_index.addRow( CIndex::PreludeRow, rootCall );
+        m_index.addLines( rootCall );
+        m_index.addRow( CIndex::CommentRow, rootCall );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceRows::rowCount
+///
+/// @description    Returns the number of rows.
+/// @pre            None
+/// @post           None
+///
+/// @return int:    The number of rows.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CPuzzleTraceRows::rowCount() const
+{
+    return m_index.rowCount();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceRows::row
+///
+/// @description    Returns the cells of a row. A prelude or comment row has
+///                 its text in the last column.
+/// @pre            index is a row.
+/// @post           None
+///
+/// @param index:   The row.
+///
+/// @return QStringList: The cells of the row.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+QStringList CPuzzleTraceRows::row( int index ) const
+{
+    const CIndex::SRow &row = m_index.row( index );
+    if( row.s_kind == CIndex::LineRow )
+        return row.s_line->toStringList();
+
+    QStringList cells;
+    for( int i = m_columns; i > 0; --i )
+        cells.append( "" );
+    if( !cells.isEmpty() )
+        cells.last() = row.s_kind == CIndex::PreludeRow ? row.s_call->s_prelude
+                                                        : row.s_call->s_comment;
+    return cells;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceRows::index
+///
+/// @description    Returns the index of the rows, which tells what each row
+///                 shows and where each depth starts.
+/// @pre            None
+/// @post           None
+///
+/// @return const CIndex &: The index.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+const CPuzzleTraceRows::CIndex &CPuzzleTraceRows::index() const
+{
+    return m_index;
+}
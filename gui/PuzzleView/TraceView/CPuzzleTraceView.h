@@ -24,37 +24,45 @@ public:
     CPuzzleTraceView( QWidget *parent );
 };
 */
-#include <QTableWidget>
+#include <QTableView>
 #include <QList>
 #include <QStringList>
 #include <QMenu>
 #include <QToolButton>
 #include <QComboBox>
 #include <QLabel>
+#include "../../CTraceCache.h"
+#include "../../CTraceTableModel.h"
+#include "../../CTraceRowIndex.h"
 //class QLabel;
 //class QComboBox;
 class QSpinBox;
 class CPuzzleGraphModel;
 class CStyleToolkit;
 class CPuzzleTracerSelector;
+class CTraceRunner;
+class CPuzzleTraceRows;
 struct SPuzzleCall;
 struct SPuzzleTrace;
+struct IPuzzleLine;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CTreeTraceView
 ///
 /// @description  This class allows the user to view the trace of a tree. It is
-///               based on the QTableWidget which it uses for all of the display
-///               and drawing functionality.
+///               based on the QTableView which it uses for all of the display
+///               and drawing functionality. The cells are given by a
+///               CTraceTableModel, which makes their text only as they come
+///               into sight.
 ///
-/// @limitations  The QTableWidget allows for minimal customization in how the
+/// @limitations  The QTableView allows for minimal customization in how the
 ///               grid is drawn. Row and Column headers and the fonts can be
 ///               changed as well as the cell contents. It cannot change the
 ///               thickness or color of individual lines, nor can it display any
 ///               not within a cell.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-class CPuzzleTraceView : public QTableWidget
+class CPuzzleTraceView : public QTableView
 {
     Q_OBJECT
 
@@ -69,17 +77,16 @@ public:
     QComboBox *getAISelector();
     QComboBox *getTreeGraphSelector();
     QLabel *getAILabel();
-
+    QWidget *getProgressWidget();
 
     void setGraphModel( CPuzzleGraphModel *model );
 
-    QList<QStringList> gridFromCall( SPuzzleCall *call );
-    QList<QStringList> gridFromTrace( SPuzzleTrace *trace );
-
-    void signalRepaint(void) { retrace(); }
+    void signalRepaint(void) { updateTable(); }
 
 protected slots:
     void retrace();
+    void startTrace();
+    void showTrace();
     void saveTrace();
 
     /*
@@ -90,10 +97,45 @@ protected slots:
     void spawnConfigMenu();
     */
 private:
+    void updateTable();
+
     CPuzzleGraphModel     *m_graphModel;
     CPuzzleTracerSelector *m_selector;
+    CTraceRunner          *m_runner;
+    CTraceCache<SPuzzleTrace> m_cache;
+    CTraceTableModel *m_model;
+    CPuzzleTraceRows *m_rows;
 
     SPuzzleTrace    *m_trace;
     CStyleToolkit   *m_style;
 };
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceRows
+///
+/// @description  The rows of a puzzle trace, for a CTraceTableModel and for
+///               saving. Each depth has its lines, with a row for its prelude
+///               before them if it has one and a row for its comment after
+///               them. The rows are indexed once per trace and the text is
+///               only made as rows are asked for.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CPuzzleTraceRows : public ITraceRowSource
+{
+public:
+    typedef CTraceRowIndex<SPuzzleCall, IPuzzleLine> CIndex;
+
+    CPuzzleTraceRows( SPuzzleTrace *trace );
+
+    int rowCount() const;
+    QStringList row( int index ) const;
+    const CIndex &index() const;
+
+private:
+    CIndex  m_index;
+    int     m_columns;
+};
+
 #endif
@@ -29,6 +29,7 @@
 ///        depthLimit: Depth Limit.
 ///        iterativeDeepening: Toggles iterative deepening.
 ///        graphSearch: true for graph search, false for tree search.
+///        cancel: Set to non zero to stop the trace early, or NULL.
 ///
 /// @return STreeTrace *: This is the trace generated by the ITreeTracer
 ///                       subclass.
@@ -40,7 +41,8 @@ template <class OpenListType>
 SPuzzleTrace *CBDTracer<OpenListType>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const
 {
     bool goalFound = false;
     int openNoForward  = 0;
@@ -70,7 +72,7 @@ SPuzzleTrace *CBDTracer<OpenListType>::trace( const int depthLimit,
     else
         depth = depthLimit;
 
-    while(depth <= depthLimit && !goalFound)
+    while(depth <= depthLimit && !goalFound && !isCancelled( cancel ))
     {
         SPuzzleCall *curDepth = new SPuzzleCall;
         OpenListType openForward, openBackward;
@@ -97,6 +99,12 @@ SPuzzleTrace *CBDTracer<OpenListType>::trace( const int depthLimit,
         openBackward.push( CSATraceNode( goals.first() ) );
         for(;;)
         {
+            if( isCancelled( cancel ) )
+            {
+                curDepth->s_comment = "cancelled";
+                break;
+            }
+
             SBDLine *curLine = new SBDLine;
 
             if(exaustedForward)
@@ -266,17 +274,20 @@ backward:
 template SPuzzleTrace *CBDTracer<CDFOpenList>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const;
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const;
 
 template SPuzzleTrace *CBDTracer<CBFOpenList>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const;
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const;
 
 template SPuzzleTrace *CBDTracer<CUCOpenList>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const;
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const;
 
 // Bi-Directional versions of GBF and A* are presumed to be functional,
 // but heuristic values make no sense in reverse.
@@ -284,12 +295,14 @@ template SPuzzleTrace *CBDTracer<CUCOpenList>::trace( const int depthLimit,
 template SPuzzleTrace *CBDTracer<CGBFOpenList>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const;
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const;
 
 template SPuzzleTrace *CBDTracer<CAStarOpenList>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const;
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const;
 */
 
 // This function turned out to be unneeded.
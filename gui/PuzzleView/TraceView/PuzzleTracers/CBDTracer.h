@@ -38,7 +38,8 @@ public:
     SPuzzleTrace *trace( const int depthLimit,
                          const bool iterativeDeepening,
                          const bool graphSearch,
-                         const CPuzzleGraphModel *graph ) const;
+                         const CPuzzleGraphModel *graph,
+                         const QAtomicInt *cancel = NULL ) const;
     SPuzzleTrace *trace( const CPuzzleGraphModel *graph ) const { return NULL; };
 private:
     QString goalString(const CPuzzleGraphModel *graph,
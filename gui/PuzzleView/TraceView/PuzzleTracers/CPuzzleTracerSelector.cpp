@@ -23,6 +23,9 @@
 #include <QMenu>
 #include <QSpinBox>
 #include <QLabel>
+#include <QHash>
+#include <QDataStream>
+#include <QCryptographicHash>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CPuzzleTracerSelector::CPuzzleTracerSelector
@@ -312,45 +315,130 @@ void CPuzzleTracerSelector::setupDepthList()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// CPuzzleTracerSelector::trace
+/// CPuzzleTracerSelector::createJob
 ///
-/// @description  This is a forwarding function that encapsulates the interface
-///               with the tracers. Calling it will call the trace() function
-///               on the currently selected tracer and it will pull the depth
-///               and qs depth values from the spin boxes.
+/// @description  Makes a job that traces the puzzle with the currently
+///               selected tracer, pulling the depth value from the spin box.
+///               The label is brought up to date for the new search.
 /// @pre          None
-/// @post         The trace is returned as determined by the selector widgets'
-///               current states.
+/// @post         None
 ///
-/// @param rootNode: This is the root of the tree that is to be traced.
+/// @param graph: This is the puzzle that is to be traced. The job takes a
+///               copy of it.
 ///
-/// @return STreeTrace *: This is the trace generated by the ITreeTracer
-///                       subclass.
+/// @return CPuzzleTraceJob *: The job, which the caller owns.
 ///
 /// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
-SPuzzleTrace *CPuzzleTracerSelector::trace( const CPuzzleGraphModel *graph ) const
+CPuzzleTraceJob *CPuzzleTracerSelector::createJob(
+    const CPuzzleGraphModel *graph ) const
 {
     int depth;
     if(m_isDL)
         depth = m_depthSelector->value();
     else
         depth = -1;
-    //int qsDepth = m_qsDepthSelector->value();
-    //updateLabel();
-    ISingleAgentTracer *tracer = m_tracers[m_aiSelector->currentIndex()];
 
     updateLabel();
-    //m_aiLabel->setText("a");
-    CUDTracer<CBFOpenList> a;
-    //return a.trace(-1,false,false,graph);
-    return tracer->trace( depth,
-                          m_isID,
-                          (m_treeGraphSelector->currentIndex() == 1),
-                          graph );
-    //return tracer->trace( graph );
-    //return m_DFTSTracer->trace( graph );//rootNode );
+    return new CPuzzleTraceJob( this, graph, m_aiSelector->currentIndex(),
+                                depth, m_isID,
+                                (m_treeGraphSelector->currentIndex() == 1) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTracerSelector::traceKey
+///
+/// @description  Makes a key for the trace that createJob() would run: a hash
+///               of the current settings and of everything in the puzzle that
+///               the tracers look at. Positions only matter through the order
+///               in which each node's neighbours are expanded, so that order
+///               is hashed rather than the positions themselves, and moving a
+///               node changes the key only when it changes the order.
+/// @pre          None
+/// @post         None
+///
+/// @param graph: This is the puzzle that is to be traced.
+///
+/// @return QByteArray: The key.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+QByteArray CPuzzleTracerSelector::traceKey(
+    const CPuzzleGraphModel *graph ) const
+{
+    QByteArray data;
+    QDataStream stream( &data, QIODevice::WriteOnly );
+
+    stream << (qint32)m_aiSelector->currentIndex()
+           << (qint32)(m_isDL ? m_depthSelector->value() : -1)
+           << m_isID << (qint32)m_treeGraphSelector->currentIndex();
+
+    QHash<const SPuzzleNode *, int> indices;
+    int count = graph->getNodeCount();
+    int i;
+    for( i = 0; i < count; ++i )
+        indices.insert( graph->getNodeAt( i ), i );
+
+    stream << (qint32)count
+           << (qint32)indices.value( graph->getStartNode(), -1 );
+    for( i = 0; i < count; ++i )
+    {
+        const SPuzzleNode *node = graph->getNodeAt( i );
+        stream << node->s_name << node->s_heuristic << (qint32)node->s_flag;
+
+        // The nodes reached from this one, and those that reach it, in the
+        // order the tracers take them.
+        CSATraceNode traceNode( node );
+        QList<CSATraceNode> lists[2];
+        lists[0] = traceNode.expand( -1 );
+        lists[1] = traceNode.expandBackward( -1 );
+        for( int j = 0; j < 2; ++j )
+        {
+            stream << (qint32)lists[j].count();
+            CSATraceNode neighbour;
+            foreach( neighbour, lists[j] )
+                stream << (qint32)indices.value( neighbour.getNode() )
+                       << neighbour.getCost();
+        }
+    }
+
+    return QCryptographicHash::hash( data, QCryptographicHash::Sha1 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTracerSelector::trace
+///
+/// @description  This is a forwarding function that encapsulates the interface
+///               with the tracers. Calling it will call the trace() function
+///               on the given tracer. It does not touch the widgets, so it may
+///               be called from a worker thread.
+/// @pre          None
+/// @post         None
+///
+/// @param graph:              This is the puzzle that is to be traced.
+/// @param tracerIndex:        The index of the tracer in the AI selector.
+/// @param depth:              The depth limit, or -1 for none.
+/// @param iterativeDeepening: True to deepen one level at a time.
+/// @param graphSearch:        True for a graph search, false for a tree
+///                            search.
+/// @param cancel:             Stops the trace early when set non-zero. May
+///                            be NULL.
+///
+/// @return SPuzzleTrace *: This is the trace generated by the tracer.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+SPuzzleTrace *CPuzzleTracerSelector::trace( const CPuzzleGraphModel *graph,
+                                            int tracerIndex, int depth,
+                                            bool iterativeDeepening,
+                                            bool graphSearch,
+                                            const QAtomicInt *cancel ) const
+{
+    return m_tracers[tracerIndex]->trace( depth, iterativeDeepening,
+                                          graphSearch, graph, cancel );
 }
 
 
@@ -458,3 +546,87 @@ void CPuzzleTracerSelector::setupConfigMenuActions()
 
 
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceJob::CPuzzleTraceJob
+///
+/// @description  This is the constructor of the CPuzzleTraceJob class. It is
+///               called on the GUI thread and copies the puzzle.
+/// @pre          None
+/// @post         None
+///
+/// @param selector:           The selector whose tracers are used.
+/// @param graph:              The puzzle to trace.
+/// @param tracerIndex:        The index of the tracer in the AI selector.
+/// @param depth:              The depth limit, or -1 for none.
+/// @param iterativeDeepening: True to deepen one level at a time.
+/// @param graphSearch:        True for a graph search.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CPuzzleTraceJob::CPuzzleTraceJob( const CPuzzleTracerSelector *selector,
+                                  const CPuzzleGraphModel *graph,
+                                  int tracerIndex, int depth,
+                                  bool iterativeDeepening, bool graphSearch )
+{
+    m_selector = selector;
+    m_graph = graph->clone();
+    m_tracerIndex = tracerIndex;
+    m_depth = depth;
+    m_iterativeDeepening = iterativeDeepening;
+    m_graphSearch = graphSearch;
+    m_trace = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceJob::~CPuzzleTraceJob
+///
+/// @description  This is the destructor of the CPuzzleTraceJob class.
+/// @pre          The job is not running.
+/// @post         The copy of the puzzle and any trace not taken are deleted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CPuzzleTraceJob::~CPuzzleTraceJob()
+{
+    delete m_graph;
+    delete m_trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceJob::takeTrace
+///
+/// @description  Hands over the trace made by the job.
+/// @pre          The job has finished.
+/// @post         The caller owns the trace.
+///
+/// @return SPuzzleTrace *: The trace.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+SPuzzleTrace *CPuzzleTraceJob::takeTrace()
+{
+    SPuzzleTrace *trace = m_trace;
+    m_trace = NULL;
+    return trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceJob::execute
+///
+/// @description  Runs the trace. This is called on a worker thread.
+/// @pre          None
+/// @post         The trace is made.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPuzzleTraceJob::execute()
+{
+    m_trace = m_selector->trace( m_graph, m_tracerIndex, m_depth,
+                                 m_iterativeDeepening, m_graphSearch,
+                                 cancelToken() );
+}
@@ -20,6 +20,8 @@
 #include <QList>
 #include <QToolButton>
 
+#include "../../../CTraceRunner.h"
+
 class QComboBox;
 class QSpinBox;
 class QMenu;
@@ -27,6 +29,40 @@ class QLabel;
 struct SPuzzleTrace;
 class CPuzzleGraphModel;
 class ISingleAgentTracer;
+class CPuzzleTracerSelector;
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPuzzleTraceJob
+///
+/// @description  A trace of a puzzle to be run by a CTraceRunner. It holds a
+///               copy of the puzzle and of the selector settings as they were
+///               when the job was made.
+///
+/// @limitations  The selector must outlive the job.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CPuzzleTraceJob : public ITraceJob
+{
+public:
+    CPuzzleTraceJob( const CPuzzleTracerSelector *selector,
+                     const CPuzzleGraphModel *graph, int tracerIndex,
+                     int depth, bool iterativeDeepening, bool graphSearch );
+    ~CPuzzleTraceJob();
+
+    SPuzzleTrace *takeTrace();
+
+protected:
+    void execute();
+
+private:
+    const CPuzzleTracerSelector    *m_selector;
+    CPuzzleGraphModel              *m_graph;
+    int                             m_tracerIndex;
+    int                             m_depth;
+    bool                            m_iterativeDeepening;
+    bool                            m_graphSearch;
+    SPuzzleTrace                   *m_trace;
+};
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CPuzzleTracerSelector
@@ -52,7 +88,12 @@ public:
     QComboBox *getAISelector();
     QComboBox *getTreeGraphSelector();
     QLabel *getAILabel();
-    SPuzzleTrace *trace( const CPuzzleGraphModel *graph ) const;
+    CPuzzleTraceJob *createJob( const CPuzzleGraphModel *graph ) const;
+    QByteArray traceKey( const CPuzzleGraphModel *graph ) const;
+    SPuzzleTrace *trace( const CPuzzleGraphModel *graph, int tracerIndex,
+                         int depth, bool iterativeDeepening,
+                         bool graphSearch,
+                         const QAtomicInt *cancel = NULL ) const;
 
 public slots:
 
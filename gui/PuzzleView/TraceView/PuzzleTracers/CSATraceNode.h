@@ -120,6 +120,8 @@ public:
 
     QPoint getPoint() const {return m_node->s_position;}
 
+    const SPuzzleNode *getNode() const {return m_node;}
+
     QList<CSATraceNode> expand(const int maxDepth) //const
     {
         bool ignore=true;
@@ -29,6 +29,7 @@
 ///        depthLimit: Depth Limit.
 ///        iterativeDeepening: Toggles iterative deepening.
 ///        graphSearch: true for graph search, false for tree search.
+///        cancel: Set to non zero to stop the trace early, or NULL.
 ///
 /// @return STreeTrace *: This is the trace generated by the ITreeTracer
 ///                       subclass.
@@ -39,7 +40,8 @@ template <class OpenListType>
 SPuzzleTrace *CUDTracer<OpenListType>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const
 {
     bool goalFound = false;
     int openNo = 0;
@@ -62,7 +64,7 @@ SPuzzleTrace *CUDTracer<OpenListType>::trace( const int depthLimit,
     else
         depth = depthLimit;
 
-    while(depth <= depthLimit && !goalFound) {
+    while(depth <= depthLimit && !goalFound && !isCancelled( cancel )) {
     
         SPuzzleCall *curDepth = new SPuzzleCall;
         if(iterativeDeepening)
@@ -75,6 +77,11 @@ SPuzzleTrace *CUDTracer<OpenListType>::trace( const int depthLimit,
 
         for(;;) {
 
+            if( isCancelled( cancel ) ) {
+                curDepth->s_comment = "cancelled";
+                break;
+            }
+
             CSATraceNode evalNode = open.top();
             SUDLine *curLine = new SUDLine;
 
@@ -142,27 +149,32 @@ SPuzzleTrace *CUDTracer<OpenListType>::trace( const int depthLimit,
 template SPuzzleTrace *CUDTracer<CDFOpenList>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const;
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const;
 
 template SPuzzleTrace *CUDTracer<CBFOpenList>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const;
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const;
 
 template SPuzzleTrace *CUDTracer<CUCOpenList>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const;
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const;
 
 template SPuzzleTrace *CUDTracer<CGBFOpenList>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const;
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const;
 
 template SPuzzleTrace *CUDTracer<CAStarOpenList>::trace( const int depthLimit,
                                 const bool iterativeDeepening,
                                 const bool graphSearch,
-                                const CPuzzleGraphModel *graph ) const;
+                                const CPuzzleGraphModel *graph,
+                                const QAtomicInt *cancel ) const;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CUDTracer<OpenListType>::goalString
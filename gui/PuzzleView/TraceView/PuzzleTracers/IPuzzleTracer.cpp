@@ -42,3 +42,23 @@ ISingleAgentTracer::ISingleAgentTracer()
 ISingleAgentTracer::~ISingleAgentTracer()
 {
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// ISingleAgentTracer::isCancelled
+///
+/// @description    Checks if a trace has been cancelled. The tracers check it
+///                 before each node they evaluate.
+/// @pre            None
+/// @post           None
+///
+/// @param cancel:  The cancel token passed to trace(), or NULL.
+///
+/// @return bool:   true if the trace should stop.
+///
+/// @limitations    None
+///
+////////////////////////////////////////////////////////////////////////////////
+bool ISingleAgentTracer::isCancelled( const QAtomicInt *cancel )
+{
+    return cancel != NULL && (int)*cancel != 0;
+}
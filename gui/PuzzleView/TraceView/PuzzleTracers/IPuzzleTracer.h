@@ -17,6 +17,7 @@
 
 #include "../../CPuzzleTrace.h"
 #include "../../GraphView/CPuzzleGraphModel.h"
+#include <QAtomicInt>
 #include <QString>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -41,7 +42,11 @@ public:
     virtual SPuzzleTrace *trace( const int depthLimit,
                              const bool iterativeDeepening,
                              const bool graphSearch,
-                             const CPuzzleGraphModel *graph ) const { return NULL;}
+                             const CPuzzleGraphModel *graph,
+                             const QAtomicInt *cancel = NULL ) const { return NULL;}
+
+protected:
+    static bool isCancelled( const QAtomicInt *cancel );
 };
 
 #endif
@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTreeEvaluator.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the CTreeEvaluator
+///               class.
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "CTreeEvaluator.h"
+#include "CTreeGraph.h"
+#include "../CCompiledTree.h"
+#include <QHash>
+#include <climits>
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeEvaluator::evaluate
+///
+/// @description  Copies the tree below root a level at a time and works out
+///               the value of every node in the copy. The copy stops at the
+///               end points: leaves, and nodes at the depth limit that are
+///               not quiescent or have no quiescence depth left. All nodes
+///               of a level have the same depth left, so a node with the same
+///               subtree as one before it in its level shares its value.
+/// @pre          None
+/// @post         value() gives the minimax value of every node of the copy
+///               and node() the node it belongs to.
+///
+/// @param root:       The root of the tree, or NULL.
+/// @param depthLimit: The depth of the search, or less than 0 for none.
+/// @param qsDepth:    The quiescence depth of the search.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeEvaluator::evaluate( STreeNode *root, int depthLimit, int qsDepth )
+{
+    clearLevels();
+    m_nodes.clear();
+    if( root == NULL )
+        return;
+    if( depthLimit < 0 )
+        depthLimit = INT_MAX;
+
+    // The shapes of the nodes, for finding the same subtree twice.
+    CCompiledTree<STreeNode> tree;
+    tree.compile( root );
+
+    // The depth and quiescence depth left below each node of the copy, and
+    // its number in the compiled tree.
+    QVector<int> depths;
+    QVector<int> qsDepths;
+    QVector<int> ids;
+    // The first node of the next level with each shape.
+    QHash<int, int> shapes;
+
+    addNode( root->s_childList.isEmpty() ? EndPoint : MaxNode,
+             root->s_value, 1.0 );
+    m_nodes.append( root );
+    depths.append( depthLimit );
+    qsDepths.append( qsDepth );
+    ids.append( 0 );
+    endLevel();
+
+    for( int level = 0; level < levelCount(); ++level )
+    {
+        shapes.clear();
+        for( int i = levelStart( level ); i < levelEnd( level ); ++i )
+        {
+            if( kind( i ) == EndPoint || kind( i ) == SharedNode )
+                continue;
+
+            const STreeNode *node = m_nodes[i];
+            ENodeKind childKind = kind( i ) == MaxNode ? MinNode : MaxNode;
+            int first = count();
+            for( int c = 0; c < node->s_childList.count(); ++c )
+            {
+                STreeNode *child = node->s_childList[c];
+                int id = tree.child( ids[i], c );
+                int depth = depths[i];
+                int qs = qsDepths[i];
+                if( depth > 0 )
+                    depth--;
+                else
+                    qs--;
+
+                bool isEndPoint = child->s_childList.isEmpty()
+                    || (depth == 0 && (!child->s_quiescent || qs <= 0));
+                int index = addNode( isEndPoint ? EndPoint : childKind,
+                                     child->s_value, 1.0 );
+                m_nodes.append( child );
+                depths.append( depth );
+                qsDepths.append( qs );
+                ids.append( id );
+
+                if( !isEndPoint )
+                {
+                    int match = shapes.value( tree.shape( id ), -1 );
+                    if( match >= 0 )
+                        shareNode( index, match );
+                    else
+                        shapes.insert( tree.shape( id ), index );
+                }
+            }
+            setChildren( i, first, count() - first );
+        }
+        endLevel();
+    }
+
+    propagate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeEvaluator::node
+///
+/// @description  Returns the node of the tree a node of the copy stands for.
+/// @pre          index is a node of the copy.
+/// @post         None
+///
+/// @param index: The place of the node in the copy.
+///
+/// @return STreeNode *: The node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+STreeNode *CTreeEvaluator::node( int index ) const
+{
+    return m_nodes[index];
+}
@@ -0,0 +1,45 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTreeEvaluator.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the CTreeEvaluator
+///               class, which finds the minimax value of every node of a
+///               tree.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CTREEEVALUATOR_H_
+#define _CTREEEVALUATOR_H_
+
+#include "../CLevelEvaluator.h"
+
+struct STreeNode;
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeEvaluator
+///
+/// @description  Finds the minimax value of every node of a tree, the root
+///               being a max node. A node is an end point under the same
+///               depth limit and quiescence rules the minimax tracer uses, so
+///               the value of the root is the one a full trace returns.
+///
+/// @limitations  The copy refers to the nodes it was made from and must not
+///               outlive them.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CTreeEvaluator : public CLevelEvaluator
+{
+public:
+    void evaluate( STreeNode *root, int depthLimit, int qsDepth );
+
+    STreeNode *node( int index ) const;
+
+private:
+    QVector<STreeNode *>    m_nodes;
+};
+
+#endif//_CTREEEVALUATOR_H_
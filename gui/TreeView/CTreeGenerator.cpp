@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTreeGenerator.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the CTreeGenerator
+///               class.
+///
+////////////////////////////////////////////////////////////////////////////////
+#include "CTreeGenerator.h"
+#include "CTreeGraph.h"
+#include <QVector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGenerator::CTreeGenerator
+///
+/// @description  This is the constructor of the CTreeGenerator class.
+/// @pre          None
+/// @post         None
+///
+/// @param config: The tree to make.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CTreeGenerator::CTreeGenerator( const SGeneratorConfig &config )
+: CTreeGeneratorBase( config )
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGenerator::generate
+///
+/// @description  Grows a random tree below root, breadth first. Every node
+///               but the root may be made quiescent, and every node is given
+///               a value if the config asks for them.
+/// @pre          root has no children.
+/// @post         The tree is made, or as much of it as the node limit
+///               allows; isTruncated() tells which.
+///
+/// @param root:  The root of the new tree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeGenerator::generate( STreeNode *root )
+{
+    QVector<STreeNode *> level;
+    QVector<STreeNode *> nextLevel;
+    STreeNode *parent;
+
+    root->s_value = randomValue();
+    level.append( root );
+
+    for( int depth = 0; depth < m_config.s_depth && !m_truncated; depth++ )
+    {
+        nextLevel.clear();
+        nextLevel.reserve( qMin( level.count() * m_config.s_maxBranch,
+                                 m_config.s_maxNodes - m_nodeCount ) );
+
+        foreach( parent, level )
+        {
+            int branch = branchCount();
+            if( branch > m_config.s_maxNodes - m_nodeCount )
+            {
+                branch = m_config.s_maxNodes - m_nodeCount;
+                m_truncated = true;
+            }
+
+            parent->s_childList.reserve( branch );
+            for( int i = 0; i < branch; i++ )
+            {
+                STreeNode *child = new STreeNode;
+                child->s_parent = parent;
+                child->s_quiescent = randomPercent( m_config.s_quiescent );
+                child->s_value = randomValue();
+                parent->s_childList.append( child );
+                nextLevel.append( child );
+            }
+            m_nodeCount += branch;
+
+            if( m_truncated )
+                break;
+        }
+
+        level = nextLevel;
+    }
+}
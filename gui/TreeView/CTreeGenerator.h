@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CTreeGenerator.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the CTreeGenerator
+///               class, which makes random trees for the tree view.
+///
+////////////////////////////////////////////////////////////////////////////////
+#ifndef _CTREEGENERATOR_H_
+#define _CTREEGENERATOR_H_
+
+#include "../CTreeGeneratorBase.h"
+
+struct STreeNode;
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeGenerator
+///
+/// @description  Makes a random tree from an SGeneratorConfig. The tree is
+///               made a level at a time rather than by recursion, so a tree
+///               of millions of nodes needs no deep stack, and it stops
+///               cleanly at the node limit.
+///
+/// @limitations  The nodes are not named or laid out; that is left to the
+///               model.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CTreeGenerator : public CTreeGeneratorBase
+{
+public:
+    CTreeGenerator( const SGeneratorConfig &config );
+
+    void generate( STreeNode *root );
+};
+
+#endif//_CTREEGENERATOR_H_
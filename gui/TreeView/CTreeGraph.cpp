@@ -349,6 +349,8 @@ STreeNode::STreeNode()
     s_quiescent = false;
     s_value     = 0.0F;
     s_history   = 0;
+    s_backedUpValue = 0.0F;
+    s_evaluation = 0;
     s_parent    = NULL;
 }
 
@@ -368,3 +370,34 @@ STreeNode::~STreeNode()
     while( !s_childList.isEmpty() )
         delete s_childList.takeFirst();
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// STreeNode::clone
+///
+/// @description  Makes a deep copy of the node and everything below it.
+/// @pre          None
+/// @post         None
+///
+/// @return STreeNode *: The copy. Its parent is NULL and the caller owns it.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+STreeNode *STreeNode::clone() const
+{
+    STreeNode *node = new STreeNode;
+    node->s_name = s_name;
+    node->s_quiescent = s_quiescent;
+    node->s_value = s_value;
+    node->s_history = s_history;
+    node->s_position = s_position;
+
+    const STreeNode *child;
+    foreach( child, s_childList )
+    {
+        STreeNode *childCopy = child->clone();
+        childCopy->s_parent = node;
+        node->s_childList.append( childCopy );
+    }
+    return node;
+}
@@ -18,6 +18,7 @@
 #include <QString>
 #include <QList>
 #include <QPoint>
+#include <QRect>
 #include <QDataStream>
 
 struct STreeNode;
@@ -77,6 +78,8 @@ struct STreeNode
     STreeNode();
     ~STreeNode();
 
+    STreeNode *clone() const;
+
     ///This variable stores the name of the node.
     QString                 s_name;
 
@@ -89,12 +92,24 @@ struct STreeNode
     ///This variable stores the preset history table value
     int                     s_history;
 
+    ///This variable stores the value backed up to the node by the last
+    ///evaluation of the tree that reached it.
+    qreal                   s_backedUpValue;
+
+    ///This variable stores the number of the evaluation that set
+    ///s_backedUpValue, or 0 if none has.
+    int                     s_evaluation;
+
     ///This variable stores a pointer to the parent node of the node.
     STreeNode              *s_parent;
 
     ///This variable stores the location on the screen of the node.
     QPoint                  s_position;
 
+    ///This variable stores the smallest rectangle holding the positions of
+    ///the node and all the nodes below it, for finding nodes quickly.
+    QRect                   s_bounds;
+
     ///This variable holds a list of the child nodes of the node, sorted
     ///from left to right.
     QList<STreeNode *>      s_childList;
@@ -13,6 +13,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "CTreeView.h"
+#include "GraphView/CTreeGraphModel.h"
 #include "GraphView/CTreeGraphView.h"
 #include "TraceView/CTreeTraceView.h"
 #include <QAction>
@@ -111,6 +112,24 @@ void CTreeView::connectTraceAction( QAction *action )
     connect( action, SIGNAL(toggled(bool)), m_traceView, SLOT(setShown(bool)) );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeView::evaluateTree
+///
+/// @description  This function shows the backed-up value of every node of
+///               the tree, found with the depth limit and quiescence depth
+///               the trace is using.
+/// @pre          None
+/// @post         The backed-up values are shown until the tree is edited.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeView::evaluateTree()
+{
+    m_graphView->getModel()->evaluate( m_traceView->depthLimit(),
+                                       m_traceView->qsDepth() );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CTreeView::loadFromFile
 ///
@@ -250,6 +269,10 @@ void CTreeView::setupToolBar()
     tempAction = m_toolBar->addAction(QIcon(":/autolayout.png"), "Auto Layout");
     connect( tempAction, SIGNAL(activated()), m_graphView, SLOT(autoLayout()) );
 
+    // "Evaluate Tree" button
+    tempAction = m_toolBar->addAction(QIcon(":/trace.png"), "Evaluate Tree");
+    connect( tempAction, SIGNAL(activated()), this, SLOT(evaluateTree()) );
+
     m_toolBar->addSeparator();
 
     // "AI Config Menu" button
@@ -259,6 +282,9 @@ void CTreeView::setupToolBar()
     tempLabel = m_traceView->getAILabel();
     m_toolBar->addWidget( tempLabel );
 
+    // Progress of the running trace
+    m_toolBar->addWidget( m_traceView->getProgressWidget() );
+
     // Depth spinbox
     tempLabel = new QLabel( m_toolBar );
     tempLabel->setTextFormat(Qt::AutoText);
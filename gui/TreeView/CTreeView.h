@@ -53,6 +53,7 @@ public:
 	void signalRepaint(void);
 
 protected slots:
+    void evaluateTree();
     void quickEditOff();
     void switchOrientation();
 
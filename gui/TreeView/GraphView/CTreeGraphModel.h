@@ -19,9 +19,12 @@
 
 #include "../CTreeGraph.h"
 #include "../../CStyleToolkit.h"
+#include "../../CTreeBounds.h"
+#include "../../CTreeLayout.h"
 #include <QObject>
 #include <QRect>
 #include <QList>
+#include <QSet>
 
 typedef QPair<const STreeNode*, int> HistoryValue;
 typedef QList<HistoryValue> HistoryTable;
@@ -64,6 +67,7 @@ public:
     void editNodeQuiescentFlag( STreeNode *node, bool quiescent );
     void editNodeValue( STreeNode *node, qreal value );
     void editSubTreePosition( STreeNode *parent, QPoint point );
+    void evaluate( int depthLimit, int qsDepth );
 
     int findMaxDepth( STreeNode *node );
     STreeNode * findNode( QPoint point );
@@ -71,6 +75,8 @@ public:
     QPoint getHistoryPosition() const;
     HistoryTable getHistoryTable() const;
     STreeNode * getRootNode() const;
+    bool isEvaluated( const STreeNode *node ) const;
+    bool isPrincipal( const STreeNode *node ) const;
 
     void load( const QString &filename );
     void realignData();
@@ -81,15 +87,18 @@ public:
     void unhook( STreeNode *node );
 
 private:
-    void autoLayoutX( STreeNode *node, int &x );
-    void autoLayoutY( STreeNode *node );
     void autoNumberHelper( int min, int max, STreeNode *node );
+    void backUpEvaluation( STreeNode *node );
+    void clearEvaluation();
+    void copyEvaluation( const STreeNode *from, STreeNode *to );
     STreeNode * findNodeHelper( STreeNode *node, QRect &rect );
+    void findPrincipalVariation();
     QRect getContainingRectHelper( STreeNode *parent ) const;
     void getHistoryTableHelper( const STreeNode *node,
          HistoryTable &table ) const;
     void shiftSubTree( STreeNode *parent, QPoint point );
     bool sortChildNodes( STreeNode *parent );
+    void updateEvaluation( STreeNode *node );
 
     //This variable is a pointer to the data set currently being used.
     CTreeGraph     *m_data;
@@ -101,6 +110,25 @@ private:
     //This is a pointer to the style toolkit instance for quicker reference.
     CStyleToolkit  *m_style;
 
+    //This variable is the number of the evaluation whose backed-up values
+    //are shown, or 0 if none are.
+    int             m_evaluation;
+
+    //This variable counts the evaluations made so far.
+    int             m_evaluationCount;
+
+    //This variable holds the nodes on the principal variation of the last
+    //evaluation.
+    QSet<const STreeNode *> m_principalVariation;
+
+    //This variable holds the last auto layout, kept while the tree is only
+    //changed by adding and deleting nodes so those can be laid out alone.
+    CTreeLayout<STreeNode> m_layout;
+
+    //This variable keeps the rectangle around each subtree for finding the
+    //node at a point.
+    CTreeBounds<STreeNode> m_bounds;
+
 signals:
     void quickEditOff();
     void repaint();
@@ -20,6 +20,7 @@
 #include "CTreeNodeQuickEditor.h"
 #include "CTreeNodeMover.h"
 #include "CTreeGraphModel.h"
+#include "../CTreeGenerator.h"
 #include "../../../gnat.h"
 #include <QResizeEvent>
 #include <QInputDialog>
@@ -168,123 +169,33 @@ void CTreeGraphView::autoNumber()
 ////////////////////////////////////////////////////////////////////////////////
 /// CTreeGraphView::generateTree
 ///
-/// @description  This function prompts the user for a depth, a minimum and maximum
-///               branching factor, and a quiescent percentage. The current tree is
-///               then replaced by a random tree matching that description.
+/// @description  This function prompts the user for a description of a random
+///               tree: depth, branching factors, quiescent percentage, node
+///               limit, seed and node values. The current tree is then
+///               replaced by a random tree matching that description. The
+///               same description always gives the same tree.
 /// @pre          None
 /// @post         Tree is replaced by a random tree
 ///
-/// @limitations  Tree will stop being generated at 702 nodes, because the
-///               naming convention can accomodate no more.
+/// @limitations  Tree will stop being generated at the node limit.
 ///
 ////////////////////////////////////////////////////////////////////////////////
 void CTreeGraphView::generateTree()
 {
-    // Declaring these static will make the dialogs default to the value most
-    // recently entered.
-    static int depth = 4;
-    static int minBranch = 1;
-    static int maxBranch = 4;
-    static int qp = 0;
-    bool ok;
-    depth = QInputDialog::getInteger( parentWidget(),
-                    tr("Depth"), // Title
-                    tr("Enter depth"), // Label
-                    depth, // Value
-                    0, // MinValue
-                    20, // MaxValue
-                    1, // Step
-                    &ok ); // Ok
-
-    if(!ok) return;
-
-    minBranch = QInputDialog::getInteger( parentWidget(),
-                    tr("Branching Factor"), // Title
-                    tr("Enter MIN branching factor"), // Label
-                    minBranch, // Value
-                    1, // MinValue
-                    8, // MaxValue
-                    1, // Step
-                    &ok ); // Ok
-
-    if(!ok) return;
-
-    maxBranch = QInputDialog::getInteger( parentWidget(),
-                    tr("Branching Factor"), // Title
-                    tr("Enter MAX branching factor"), // Label
-                    maxBranch, // Value
-                    minBranch, // MinValue
-                    8, // MaxValue
-                    1, // Step
-                    &ok ); // Ok
-
-    if(!ok) return;
-
-
-    qp = QInputDialog::getInteger( parentWidget(),
-                    tr("Quiescent Percentage"), // Title
-                    tr("Enter Quiescent Percentage"), // Label
-                    qp, // Value
-                    0, // MinValue
-                    100, // MaxValue
-                    1, // Step
-                    &ok ); // Ok
-
-    if(!ok) return;
+    SGeneratorConfig config;
+    if( !CTreeGeneratorBase::askConfig( parentWidget(), config ) )
+        return;
+
     m_model->createNewData();
-    int treeSize = 1;
-    generateSubTree( m_model->getRootNode(), depth, minBranch, maxBranch, qp, treeSize );
+    CTreeGenerator generator( config );
+    generator.generate( m_model->getRootNode() );
+    if( generator.isTruncated() )
+        QMessageBox::information( this, "GNAT",
+            tr("Node limit reached.\n"
+               "Tree generation terminated.") );
 
     autoLayout();
     autoName();
-
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// CTreeGraphView::generateSubTree
-///
-/// @description  Helper for generateTree(). Generates a subtree with given node
-///               as the root.
-/// @pre          root must point to a node.
-/// @post         Random subtree with given features is created, treeSize is increased
-///               appropriately.
-///
-/// @param root:      Pointer to the beginning of the new subtree.
-/// @param depth:     Desired depth of the subtree.
-/// @param minBranch: Minimum branching factor.
-/// @param maxBranch: Maximum branching factor.
-/// @param qp:        quiescent percentage.
-/// @param treeSize:  Current treesize. This will be incremented as subtree grows, and
-///                   process will halt prematurely if it reaches 702.
-/// @return bool: True if tree was completed. False if not.               
-///
-/// @limitations  None
-///
-////////////////////////////////////////////////////////////////////////////////
-bool CTreeGraphView::generateSubTree( STreeNode * root, int depth, 
-                                      int minBranch, int maxBranch, int qp, int &treeSize)
-{
-    if(depth > 0)
-    {
-        int branch = minBranch + ( rand() % (maxBranch - minBranch + 1) );
-        for(int i=0; i<branch; i++)
-        {
-            STreeNode *child = m_model->addChildNodeBasic(root);
-            treeSize++;
-            if(treeSize >= 702)
-            {
-                QMessageBox::information(this, "GNAT",
-                    "Node limit reached.\n"
-                    "Tree generation terminated.");
-                return false;
-            }
-            if((rand() % 100) < qp)
-                child -> s_quiescent = true;
-            if(!generateSubTree( child, depth-1, minBranch, maxBranch, qp, treeSize ))
-                return false;
-        }
-    }
-    return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
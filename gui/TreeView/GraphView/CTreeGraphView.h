@@ -70,8 +70,6 @@ protected slots:
 private:
     void setupCanvas();
     void updateCanvasSize();
-    bool generateSubTree( STreeNode * root, int depth, 
-                          int minBranch, int maxBranch, int qp, int &treeSize);
 
     QWidget                *m_canvas;
     CTreeHistoryArtist     *m_historyArtist;
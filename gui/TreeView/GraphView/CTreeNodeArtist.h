@@ -41,6 +41,8 @@ public:
     void setModel( CTreeGraphModel *model );
 
 private:
+    void paintBackedUpValue( const STreeNode *node, QPainter *painter );
+
     //This is a pointer to the canvas on which the model is to be painted.
     QPaintDevice       *m_canvas;
 
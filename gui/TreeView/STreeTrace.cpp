@@ -13,6 +13,7 @@
 ///
 ////////////////////////////////////////////////////////////////////////////////
 #include "STreeTrace.h"
+#include <QDataStream>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// STreeTrace::STreeTrace
@@ -22,11 +23,14 @@
 /// @pre          None
 /// @post         None
 ///
-/// @limitations  It actually does nothing...
+/// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
 STreeTrace::STreeTrace()
 {
+    s_nodeCount = 0;
+    s_conf = STraceConfig();
+    s_graph = NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -50,6 +54,104 @@ STreeTrace::~STreeTrace()
         else
             delete s_depths.takeFirst();
     }
+    delete s_graph;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// rowsFromCall
+///
+/// @description  Collects the rows of a call and, depth first, of the calls
+///               it makes, in the order the trace view shows them.
+///
+////////////////////////////////////////////////////////////////////////////////
+static void rowsFromCall( STreeCall *call, const STraceConfig &conf,
+                          QList<QStringList> &rows )
+{
+    SGeneralMLine *curLine;
+    foreach( curLine, call->s_lines )
+        rows.append( curLine->toStringList( call, conf ) );
+
+    STreeCall *curCall;
+    foreach( curCall, call->s_children )
+        rowsFromCall( curCall, conf, rows );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// STreeTrace::write
+///
+/// @description     Writes the trace to a stream, for keeping on disk. Only
+///                  the rows of each depth are written, not the lines they
+///                  come from.
+/// @pre             None
+/// @post            None
+///
+/// @param out:      The stream to write to.
+///
+/// @limitations     None
+///
+////////////////////////////////////////////////////////////////////////////////
+void STreeTrace::write( QDataStream &out ) const
+{
+    out << s_aiName << s_columnNames << (qint32)s_nodeCount
+        << (qint32)s_depths.count();
+
+    STreeCall *curDepth;
+    foreach( curDepth, s_depths )
+    {
+        QList<QStringList> rows;
+        rowsFromCall( curDepth, s_conf, rows );
+
+        out << curDepth->s_returnValue << (qint32)rows.count();
+        QStringList row;
+        foreach( row, rows )
+            out << row;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// STreeTrace::read
+///
+/// @description     Reads a trace written by write(). Each depth is read back
+///                  as a single call whose lines hold the rows as they were
+///                  shown.
+/// @pre             None
+/// @post            None
+///
+/// @param in:       The stream to read from.
+///
+/// @return STreeTrace *: The trace, owned by the caller, or NULL if the
+///                  stream did not hold one.
+///
+/// @limitations     None
+///
+////////////////////////////////////////////////////////////////////////////////
+STreeTrace *STreeTrace::read( QDataStream &in )
+{
+    STreeTrace *trace = new STreeTrace;
+    qint32 nodeCount = 0, depths = 0, rows = 0;
+    in >> trace->s_aiName >> trace->s_columnNames >> nodeCount >> depths;
+    trace->s_nodeCount = nodeCount;
+
+    for( ; depths > 0 && in.status() == QDataStream::Ok; --depths )
+    {
+        STreeCall *call = new STreeCall;
+        trace->s_depths.append( call );
+        in >> call->s_returnValue >> rows;
+
+        for( ; rows > 0 && in.status() == QDataStream::Ok; --rows )
+        {
+            SGeneralMLine *line = new SGeneralMLine;
+            in >> line->s_cells;
+            call->s_lines.append( line );
+        }
+    }
+
+    if( in.status() != QDataStream::Ok )
+    {
+        delete trace;
+        return NULL;
+    }
+    return trace;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -66,6 +168,13 @@ STreeTrace::~STreeTrace()
 STreeCall::STreeCall()
 {
     s_returnValue = 0;
+    s_node = NULL;
+    s_root = false;
+    s_max = true;
+    s_depth = 0;
+    s_qsDepth = 0;
+    s_alpha = 0;
+    s_beta = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
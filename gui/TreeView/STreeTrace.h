@@ -18,8 +18,10 @@
 #include <QString>
 #include <QStringList>
 #include <QSize>
+#include <QVector>
 #include "TraceView/TreeTracers/CGeneralMTracer.h"
 
+class QDataStream;
 struct STreeCall;
 struct SGeneralMLine;
 //class ITreeLine;
@@ -61,6 +63,22 @@ struct STreeTrace
     //Iterative-Deepening(ID) trace. If the trace is not ID then there will only
     //be one entry in the list.
     QList<STreeCall *>  s_depths;
+
+    //This variable is the number of nodes the tracer examined, counting a
+    //node again each time it is re-searched.
+    int                 s_nodeCount;
+
+    //This variable is the configuration the trace was made with, which says
+    //what the cells of its lines show.
+    STraceConfig        s_conf;
+
+    //This variable is the copy of the tree the trace was made from. The
+    //lines refer to its nodes, so the trace owns it. It is NULL for a trace
+    //read back from disk, whose lines keep their own text.
+    STreeNode          *s_graph;
+
+    void write( QDataStream &out ) const;
+    static STreeTrace *read( QDataStream &in );
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -89,6 +107,21 @@ struct STreeCall
     QList<SGeneralMLine *>  s_lines;
     float               s_returnValue;
 
+    // What the call was made with, for the text of its lines.
+    const STreeNode    *s_node;
+    bool                s_root;
+    bool                s_max;
+    int                 s_depth;
+    int                 s_qsDepth;
+    float               s_alpha;
+    float               s_beta;
+
+    // The children of the node in the order they were searched, and their
+    // history values when the call began. Each line shows the part of this
+    // list from its own child on.
+    QVector<const STreeNode *>  s_open;
+    QVector<int>        s_openHistory;
+
     SGeneralMLine *operator[](int index);
 };
 
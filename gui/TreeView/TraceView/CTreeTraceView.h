@@ -16,11 +16,14 @@
 #ifndef _CTREETRACEVIEW_H_
 #define _CTREETRACEVIEW_H_
 
-#include <QTableWidget>
+#include <QTableView>
 #include <QList>
 #include <QStringList>
 #include <QMenu>
 #include <QToolButton>
+#include "../../CTraceCache.h"
+#include "../../CTraceTableModel.h"
+#include "../../CTraceRowIndex.h"
 
 class QLabel;
 class QComboBox;
@@ -28,24 +31,29 @@ class QSpinBox;
 class CTreeGraphModel;
 class CStyleToolkit;
 class CTreeTracerSelector;
+class CTraceRunner;
+class CTreeTraceRows;
 struct STreeCall;
 struct STreeTrace;
+struct SGeneralMLine;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CTreeTraceView
 ///
 /// @description  This class allows the user to view the trace of a tree. It is
-///               based on the QTableWidget which it uses for all of the display
-///               and drawing functionality.
+///               based on the QTableView which it uses for all of the display
+///               and drawing functionality. The cells are given by a
+///               CTraceTableModel, which makes their text only as they come
+///               into sight.
 ///
-/// @limitations  The QTableWidget allows for minimal customization in how the
+/// @limitations  The QTableView allows for minimal customization in how the
 ///               grid is drawn. Row and Column headers and the fonts can be
 ///               changed as well as the cell contents. It cannot change the
 ///               thickness or color of individual lines, nor can it display any
 ///               not within a cell.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-class CTreeTraceView : public QTableWidget
+class CTreeTraceView : public QTableView
 {
     Q_OBJECT
 
@@ -55,27 +63,63 @@ public:
 
     QSpinBox *getDepthSelector();
     QSpinBox *getQSDepthSelector();
+    int depthLimit() const;
+    int qsDepth() const;
     QToolButton * getAIConfigButton();
     QLabel *getAILabel();
-
+    QWidget *getProgressWidget();
 
     void setGraphModel( CTreeGraphModel *model );
 
-    QList<QStringList> gridFromCall( STreeCall *call );
-    QList<QStringList> gridFromTrace( STreeTrace *trace );
-
-	void signalRepaint(void) { retrace(); }
+	void signalRepaint(void) { updateTable(); }
 
 protected slots:
     void retrace();
+    void startTrace();
+    void showTrace();
     void saveTrace();
 
 private:
+    void updateTable();
+
     CTreeGraphModel    *m_graphModel;
     CTreeTracerSelector *m_selector;
+    CTraceRunner       *m_runner;
+    CTraceCache<STreeTrace>  m_cache;
+    CTraceTableModel *m_model;
+    CTreeTraceRows *m_rows;
 
     STreeTrace      *m_trace;
     CStyleToolkit   *m_style;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTraceRows
+///
+/// @description  The rows of a tree trace, for a CTraceTableModel and for
+///               saving. The lines of each depth come in the order of a depth
+///               first walk of its calls, with a blank row between depths.
+///               The rows are indexed once per trace and the text is only
+///               made as rows are asked for.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CTreeTraceRows : public ITraceRowSource
+{
+public:
+    typedef CTraceRowIndex<STreeCall, SGeneralMLine> CIndex;
+
+    CTreeTraceRows( STreeTrace *trace );
+
+    int rowCount() const;
+    QStringList row( int index ) const;
+    const CIndex &index() const;
+
+private:
+    const STreeTrace   *m_trace;
+    CIndex              m_index;
+    int                 m_columns;
+};
+
 #endif /*_CTREETRACEVIEW_H_*/
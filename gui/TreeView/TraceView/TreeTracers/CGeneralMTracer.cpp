@@ -14,7 +14,48 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "CGeneralMTracer.h"
+#include "../../STreeTrace.h"
+#include <QtAlgorithms>
 #define INF 10000
+// Width of the windows used by PVS scouts and MTD(f) passes.
+#define NULL_WINDOW 1
+
+typedef QPair<int, int> HistoryKey;
+
+////////////////////////////////////////////////////////////////////////////////
+/// moveToFront
+///
+/// @description    Moves the child at position i of a search order to the
+///                 front, keeping the order of the others.
+///
+////////////////////////////////////////////////////////////////////////////////
+static void moveToFront( ChildOrder &nodes, int i )
+{
+    int node = nodes[i];
+    for( ; i > 0; --i )
+        nodes[i] = nodes[i - 1];
+    nodes[0] = node;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// historyGreater
+///
+/// @description    Compares two children by their history table values.
+/// @pre            None
+/// @post           None
+///
+/// @param a:       History value and child.
+///        b:       History value and child.
+///
+/// @return bool:   true if a should be searched before b.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+static bool historyGreater( const HistoryKey &a, const HistoryKey &b )
+{
+    return a.first > b.first;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CGeneralMTracer::CGeneralMTracer
@@ -37,26 +78,77 @@ CGeneralMTracer::CGeneralMTracer()
 ////////////////////////////////////////////////////////////////////////////////
 /// CGeneralMTracer::generateHistoryTable
 ///
-/// @description    Adds history table entries of node to internal history table,
-///                 and recurses on all children.
-/// @pre            "node" points to an STreeNode object.
-/// @post           History table entries of tree with "node" as the root have
-///                 been added to m_historyTable.
+/// @description    Fills the history table with the preset history value of
+///                 every node of the compiled tree. A learned history table
+///                 starts out empty.
+/// @pre            context.s_tree holds the tree.
+/// @post           Every node of the tree has an entry in
+///                 context.s_historyTable.
 ///
-/// @param node:    Pointer to a node.
+/// @param context: State of the run.
 ///
 /// @return         None.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void CGeneralMTracer::generateHistoryTable( const STreeNode *node ) const
+void CGeneralMTracer::generateHistoryTable( SGeneralMContext &context ) const
 {
-    m_historyTable.insert( node, node->s_history );
+    const CompiledTree &tree = context.s_tree;
+    int nodeCount = tree.count();
+
+    context.s_historyTable.resize( nodeCount );
+    for( int i = 0; i < nodeCount; ++i )
+        context.s_historyTable[i] = context.s_conf.s_isLH ? 0
+                                                          : tree.history( i );
+}
 
-    const STreeNode *i;
-    foreach( i, node->s_childList )
-        generateHistoryTable( i );
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::history
+///
+/// @description    Gets the history table entry of a node.
+/// @pre            generateHistoryTable has been run.
+/// @post           None
+///
+/// @param node:    The node.
+///        context: State of the run.
+///
+/// @return int &:  Reference to the history table entry of node.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+int &CGeneralMTracer::history( SGeneralMContext &context, int node ) const
+{
+    return context.s_historyTable[ node ];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::childOrder
+///
+/// @description    Gets the children of a node in the order of the tree,
+///                 ready to be put in search order.
+/// @pre            None
+/// @post           nodes holds the children of node.
+///
+/// @param node:    The node.
+///        nodes:   Receives the children.
+///        context: State of the run.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CGeneralMTracer::childOrder( SGeneralMContext &context, int node,
+                                  ChildOrder &nodes ) const
+{
+    const CompiledTree &tree = context.s_tree;
+    int childCount = tree.childCount( node );
+
+    nodes.resize( childCount );
+    for( int i = 0; i < childCount; ++i )
+        nodes[i] = tree.child( node, i );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -74,7 +166,7 @@ void CGeneralMTracer::generateHistoryTable( const STreeNode *node ) const
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QString CGeneralMTracer::moveName( const STreeNode *node ) const
+QString CGeneralMTracer::moveName( const STreeNode *node )
 {
     if( node == NULL )
         return QString();
@@ -95,76 +187,339 @@ QString CGeneralMTracer::moveName( const STreeNode *node ) const
 /// @description    Sort given list of nodes in descending order.
 /// @pre
 /// @post           nodes is now sorted in order of descending history table
-///                 entries.
+///                 entries. Nodes with equal entries keep their order.
 ///
-/// @param nodes:   List of pointers to STreeNode object.
+/// @param nodes:   The nodes.
+///        context: State of the run.
 ///
 /// @return         None.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void CGeneralMTracer::sortNodes( QList<STreeNode *> &nodes) const
+void CGeneralMTracer::sortNodes( SGeneralMContext &context,
+                                 ChildOrder &nodes) const
 {
-    if(!m_conf.s_isHT)
+    if(!context.s_conf.s_isHT)
         return;
-    int nodeCount = nodes.count();
-    int i, j, h1, h2;
-    for( i = 0; i < nodeCount-1; ++i )
+
+    QVector<HistoryKey> keys;
+    keys.reserve( nodes.count() );
+    for( int i = 0; i < nodes.count(); ++i )
+        keys.append( HistoryKey( history( context, nodes[i] ), nodes[i] ) );
+
+    qStableSort( keys.begin(), keys.end(), historyGreater );
+
+    int nodeCount = keys.count();
+    for( int i = 0; i < nodeCount; ++i )
+        nodes[i] = keys.at(i).second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::storeKiller
+///
+/// @description    Records that node caused a cutoff at the given ply. The
+///                 move is remembered by its position among its siblings so
+///                 it can be tried first in other positions at the same ply.
+/// @pre            node has a parent.
+/// @post           node's move is in the first killer slot of ply and the old
+///                 first slot has moved to the second.
+///
+/// @param node:    Node that caused the cutoff.
+///        ply:     Distance of node's parent from the root.
+///        context: State of the run.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CGeneralMTracer::storeKiller( SGeneralMContext &context,
+                                   int node, int ply ) const
+{
+    const CompiledTree &tree = context.s_tree;
+    int parent = tree.parent( node );
+    if( parent < 0 )
+        return;
+
+    int move = 0;
+    while( tree.child( parent, move ) != node )
+        ++move;
+    while( context.s_killerMoves.count() < 2 * (ply + 1) )
+        context.s_killerMoves.append( -1 );
+
+    if( context.s_killerMoves[2 * ply] == move )
+        return;
+    context.s_killerMoves[2 * ply + 1] = context.s_killerMoves[2 * ply];
+    context.s_killerMoves[2 * ply] = move;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::orderKillers
+///
+/// @description    Moves the killer moves of a ply to the front of nodes so
+///                 they are searched first.
+/// @pre            nodes is the child list of node.
+/// @post           The children matching the killer slots of ply, if any, are
+///                 first in nodes, newest killer first. The order of the
+///                 other children is unchanged.
+///
+/// @param node:    Node whose children are being ordered.
+///        nodes:   The children of node.
+///        ply:     Distance of node from the root.
+///        context: State of the run.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CGeneralMTracer::orderKillers( SGeneralMContext &context, int node,
+                                    ChildOrder &nodes, int ply ) const
+{
+    if( !context.s_conf.s_isKM )
+        return;
+
+    const CompiledTree &tree = context.s_tree;
+    int childCount = tree.childCount( node );
+    // The older killer is moved first so the newer one ends up in front.
+    for( int slot = 1; slot >= 0; --slot )
     {
-        for( j = 0; j < nodeCount-1-i; ++j )
+        if( 2 * ply + slot >= context.s_killerMoves.count() )
+            continue;
+        int move = context.s_killerMoves.at( 2 * ply + slot );
+        if( move < 0 || move >= childCount )
+            continue;
+        int killer = tree.child( node, move );
+        for( int i = 1; i < nodes.count(); ++i )
         {
-            h1 = m_historyTable[nodes.at(j)];
-            h2 = m_historyTable[nodes.at(j+1)];
-            if( h2 > h1 )
-                nodes.swap(j,j+1);
+            if( nodes[i] == killer )
+            {
+                moveToFront( nodes, i );
+                break;
+            }
         }
     }
+}
 
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::ttKey
+///
+/// @description    Returns the key of a node in the transposition table. Nodes
+///                 with the same subtree and the same player to move have the
+///                 same value, so they share a key.
+/// @pre            node is a node of the compiled tree.
+/// @post           None
+///
+/// @param node:    The node.
+///        max:     true if max is to move at the node.
+///        context: State of the run.
+///
+/// @return int:    The key.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+int CGeneralMTracer::ttKey( const SGeneralMContext &context, int node,
+                            bool max ) const
+{
+    return context.s_tree.shape( node ) * 2 + ( max ? 1 : 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::probeTT
+///
+/// @description    Looks up node in the transposition table and decides if the
+///                 stored result can stand in for a search of the node.
+/// @pre            None
+/// @post           If true is returned, value and exhaustive hold the stored
+///                 result.
+///
+/// @param node:       Node about to be searched.
+///        max:        true if max is to move at node.
+///        depth:      Remaining depth of the search.
+///        qsDepth:    Remaining quiessence depth of the search.
+///        alpha:      Alpha value of the search.
+///        beta:       Beta value of the search.
+///        value:      Receives the stored value.
+///        exhaustive: Receives the stored exhaustive flag.
+///        context: State of the run.
+///
+/// @return bool:   true if the stored result causes a cutoff, false otherwise.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CGeneralMTracer::probeTT( SGeneralMContext &context,
+                               int node, bool max, int depth, int qsDepth,
+                               float alpha, float beta,
+                               float &value, bool &exhaustive ) const
+{
+    GeneralTTable::const_iterator it =
+        context.s_transTable.constFind( ttKey( context, node, max ) );
+    if( it == context.s_transTable.constEnd() )
+        return false;
+
+    const SGeneralMTTEntry &entry = it.value();
+
+    // A result is usable if it was searched at least as deep, or if it was
+    // never cut off by the depth limit and this search is no shallower.
+    bool deepEnough = entry.s_depth >= depth && entry.s_qsDepth >= qsDepth;
+    if( entry.s_exhaustive && depth >= entry.s_depth
+        && qsDepth >= entry.s_qsDepth )
+        deepEnough = true;
+    if( !deepEnough )
+        return false;
+
+    if( entry.s_bound == SGeneralMTTEntry::LowerBound && entry.s_value < beta )
+        return false;
+    if( entry.s_bound == SGeneralMTTEntry::UpperBound && entry.s_value > alpha )
+        return false;
+
+    value = entry.s_value;
+    exhaustive = entry.s_exhaustive;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::storeTT
+///
+/// @description    Records the result of searching node in the transposition
+///                 table, replacing any older entry.
+/// @pre            None
+/// @post           context.s_transTable holds an entry for node.
+///
+/// @param node:       Node that was searched.
+///        max:        true if max is to move at node.
+///        depth:      Remaining depth of the search.
+///        qsDepth:    Remaining quiessence depth of the search.
+///        alpha:      Alpha value the search was started with.
+///        beta:       Beta value the search was started with.
+///        value:      Value returned by the search.
+///        bestChild:  Child that produced value, or -1.
+///        exhaustive: true if no leaf was cut off by the depth limit.
+///        context: State of the run.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CGeneralMTracer::storeTT( SGeneralMContext &context,
+                               int node, bool max, int depth, int qsDepth,
+                               float alpha, float beta, float value,
+                               int bestChild, bool exhaustive ) const
+{
+    SGeneralMTTEntry entry;
+    entry.s_depth = depth;
+    entry.s_qsDepth = qsDepth;
+    entry.s_value = value;
+    entry.s_bestChild = bestChild;
+    entry.s_exhaustive = exhaustive;
+
+    // A value outside of the window is only a bound on the true value.
+    if( value <= alpha )
+        entry.s_bound = SGeneralMTTEntry::UpperBound;
+    else if( value >= beta )
+        entry.s_bound = SGeneralMTTEntry::LowerBound;
+    else
+        entry.s_bound = SGeneralMTTEntry::Exact;
+
+    context.s_transTable.insert( ttKey( context, node, max ), entry );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::orderBestChild
+///
+/// @description    Moves the best child found by an earlier search of node, or
+///                 of a node with the same subtree, to the front of nodes so
+///                 it is searched first. The child is matched by its shape.
+/// @pre            nodes is the child list of node.
+/// @post           The remembered best child, if any, is first in nodes. The
+///                 order of the other children is unchanged.
+///
+/// @param node:    Node whose children are being ordered.
+///        max:     true if max is to move at node.
+///        nodes:   The children of node.
+///        context: State of the run.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CGeneralMTracer::orderBestChild( SGeneralMContext &context, int node,
+                                      bool max, ChildOrder &nodes ) const
+{
+    if( !context.s_conf.s_isTT )
+        return;
+
+    int best = context.s_transTable.value( ttKey( context, node, max ) )
+                                   .s_bestChild;
+    if( best < 0 )
+        return;
+
+    const CompiledTree &tree = context.s_tree;
+    int bestShape = tree.shape( best );
+    int nodeCount = nodes.count();
+    for( int i = 1; i < nodeCount; ++i )
+    {
+        if( tree.shape( nodes[i] ) == bestShape )
+        {
+            moveToFront( nodes, i );
+            return;
+        }
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CGeneralMTracer::sssHistoryUpdates
 ///
 /// @description    Descends an SSS chain, updating history table accordingly.
-/// @pre            node is a pointer to a tree node.
-/// @post           String list of history table updates is returned.
+/// @pre            node is a node of the compiled tree.
+/// @post           List of history table updates is returned.
 ///
 /// @param node:    Node to begin from.
 ///        depth:   depth limit to descend.
 ///        qsDepth: Quiessence Search Depth
 ///        top:     Indicates weather this is being called from outside.
 ///                 false is this is a recursive call.
+///        context: State of the run.
 ///
-/// @return         String list of history table updates.
+/// @return         List of history table updates.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QStringList CGeneralMTracer::sssHistoryUpdates( const STreeNode *node,
-                                           int depth, int qsDepth,
-                                           bool top) const
+QVector<SGeneralMHistoryUpdate> CGeneralMTracer::sssHistoryUpdates(
+                                                SGeneralMContext &context,
+                                                int node,
+                                                int depth, int qsDepth,
+                                                bool top) const
 {
-    QStringList ret;
+    const CompiledTree &tree = context.s_tree;
+    QVector<SGeneralMHistoryUpdate> ret;
     if( !top )
     {
-        m_historyTable[node]++;
-        ret += moveName( node )
-             + ':' + QString::number( m_historyTable[node] );
+        SGeneralMHistoryUpdate update;
+        update.s_node = tree.node( node );
+        update.s_value = ++history( context, node );
+        ret.append( update );
     }
-    if( node->s_childList.count() == 0 )
+    if( tree.childCount( node ) == 0 )
         return ret;
 
     if( depth == 0 )
     {
-        if( (!node->s_quiescent) || qsDepth == 0 )
+        if( (!tree.isQuiescent( node )) || qsDepth == 0 )
             return ret;
         qsDepth--;
     }
     else
         depth--;
 
-    return sssHistoryUpdates( node->s_childList.first(), depth, qsDepth, false )
+    return sssHistoryUpdates( context, tree.child( node, 0 ),
+                              depth, qsDepth, false )
            + ret;
 }
 
@@ -172,38 +527,40 @@ QStringList CGeneralMTracer::sssHistoryUpdates( const STreeNode *node,
 /// CGeneralMTracer::checkSSS
 ///
 /// @description    Determines if node can do single successor shortcut.
-/// @pre            node points to an STreeNode.
+/// @pre            node is a node of the compiled tree.
 /// @post
 ///
 /// @param node:    Node to start from.
 ///        depth:   Depth to search to.
 ///        qsDepth: Quiessance depth.
+///        context: State of the run.
 ///
 /// @return bool:   true if SSS is apropriate, false otherwise.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-bool CGeneralMTracer::checkSSS( const STreeNode *node,
-                                 int depth, int qsDepth ) const
+bool CGeneralMTracer::checkSSS( SGeneralMContext &context, int node,
+                                int depth, int qsDepth ) const
 {
-    if(!m_conf.s_allowSSS)
+    if(!context.s_conf.s_allowSSS)
         return false;
 
-    if( node->s_childList.count() == 0 )
+    const CompiledTree &tree = context.s_tree;
+    if( tree.childCount( node ) == 0 )
         return true;
 
     if( depth == 0 )
     {
-        if( (!node->s_quiescent) || qsDepth == 0 )
+        if( (!tree.isQuiescent( node )) || qsDepth == 0 )
             return true;
         qsDepth--;
     }
     else
         depth--;
 
-    if( node->s_childList.count() == 1 )
-        return checkSSS( node->s_childList.first(), depth, qsDepth );
+    if( tree.childCount( node ) == 1 )
+        return checkSSS( context, tree.child( node, 0 ), depth, qsDepth );
 
     return false;
 }
@@ -218,34 +575,37 @@ bool CGeneralMTracer::checkSSS( const STreeNode *node,
 /// @param node:    Node to start from.
 ///        depth:   Depth to search to.
 ///        qsDepth: Quiessance depth.
+///        context: State of the run.
 ///
 /// @return float:  value of bottom child node.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-float CGeneralMTracer::sssValue( const STreeNode *node,
-                                  int depth, int qsDepth ) const
+float CGeneralMTracer::sssValue( SGeneralMContext &context, int node,
+                                 int depth, int qsDepth ) const
 {
-    if( node->s_childList.count() == 0 )
-        return node->s_value;
+    const CompiledTree &tree = context.s_tree;
+    if( tree.childCount( node ) == 0 )
+        return tree.value( node );
 
     if( depth == 0 )
     {
-        if( (!node->s_quiescent) || qsDepth == 0 )
-            return node->s_value;
+        if( (!tree.isQuiescent( node )) || qsDepth == 0 )
+            return tree.value( node );
         qsDepth--;
     }
     else
         depth--;
 
-    return sssValue( node->s_childList.first(), depth, qsDepth );
+    return sssValue( context, tree.child( node, 0 ), depth, qsDepth );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CGeneralMTracer::trace
 ///
-/// @description    Executes a trace on the root node.
+/// @description    Executes a trace on the root node with a context of its
+///                 own.
 /// @pre            rootNode points to node trace from.
 /// @post           returns trace.
 ///
@@ -262,19 +622,49 @@ float CGeneralMTracer::sssValue( const STreeNode *node,
 STreeTrace * CGeneralMTracer::trace( const STreeNode *rootNode,
     int depthLimit, int qsDepth, const STraceConfig &traceConf) const
 {
-    m_conf = traceConf;
+    SGeneralMContext context( traceConf );
+    return trace( rootNode, depthLimit, qsDepth, context );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::trace
+///
+/// @description    Executes a trace on the root node. All of the state of the
+///                 run is kept in context, so any number of traces may run
+///                 at once on one tracer as long as each has its own context.
+/// @pre            rootNode points to node trace from.
+/// @post           returns trace. The statistics of context are filled in.
+///                 If the run was cancelled the trace is only partial.
+///
+/// @param rootNode: Node to trace from.
+///        depthLimit: Depth Limit.
+///        qsDepth: Quiessance depth.
+///        context: Configuration and state of the run.
+///
+/// @return STreeTrace *: Pointer to tree trace.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+STreeTrace * CGeneralMTracer::trace( const STreeNode *rootNode,
+    int depthLimit, int qsDepth, SGeneralMContext &context ) const
+{
+    const STraceConfig &conf = context.s_conf;
 
     QString header;
 
     // Setup collumn headers based on which collumns will be used.
 
     header = "call|open|eval|value";
-    if(m_conf.s_isAB)
+    if(conf.s_isAB && (conf.s_isPVS || conf.s_isMTDF
+                       || (conf.s_isAW && conf.s_isID)))
+        header += "|re-search";
+    if(conf.s_isAB)
         header += "|a,B";
 
     header += "|best action,value";
 
-    if(!m_conf.s_isQS)
+    if(!conf.s_isQS)
     {
             qsDepth = 0;
     }
@@ -283,68 +673,195 @@ STreeTrace * CGeneralMTracer::trace( const STreeNode *rootNode,
     //newTrace->s_aiName = name();
     newTrace->s_columnNames =
         header.split('|');
+    newTrace->s_conf = conf;
 
     if( rootNode == NULL )
         return newTrace;
     if( rootNode->s_childList.isEmpty() )
         return newTrace;
-    if(m_conf.s_isHT)
-    {
-        m_historyTable.clear();
-        generateHistoryTable( rootNode );
-    }
+
+    // The search runs on a flat copy of the tree; the root is node 0.
+    context.s_tree.compile( rootNode );
+    if(conf.s_isHT)
+        generateHistoryTable( context );
+    context.s_killerMoves.clear();
+    // The table is kept between iterations so each one can reuse the results
+    // and best moves of the last.
+    context.s_transTable.clear();
+
+    context.s_nodeCount = 0;
+    context.s_cancelled = false;
 
     int depth;
     int d = depth = INF;
-    STreeCall *curDepth;
-    if(m_conf.s_isDL) d = depth = depthLimit;
-    if(m_conf.s_isID) d = 1;
-    for(; d <= depth; ++d )
+    float guess = 0;
+    if(conf.s_isDL) d = depth = depthLimit;
+    if(conf.s_isID) d = 1;
+    for(; d <= depth && !context.isCancelled(); ++d )
     {
-        QString call;
-        curDepth = new STreeCall;
-
-        if(m_conf.s_isDL)
+        if(conf.s_isAB && conf.s_isMTDF)
         {
-            call = "DLM";
-        }
-        else
-        {
-            call = "Minimax";
-        }
-        call += QString("(%1")
-                .arg(rootNode->s_name);
-        if(m_conf.s_isDL)
-        {
-            call += QString(",%1")
-                .arg(d);
-        }
-        if(m_conf.s_isQS)
-        {
-            call += QString(",%1")
-                .arg(qsDepth);
+            // MTD(f) closes in on the value with null window searches, each
+            // centered on the bound returned by the last one. The value of
+            // the previous iteration is the first guess.
+            float lower = -INF, upper = INF, beta;
+            STreeCall *pass;
+            while( lower < upper && !context.isCancelled() )
+            {
+                beta = (guess == lower) ? guess + NULL_WINDOW : guess;
+                pass = rootCall( context, 0, d, qsDepth,
+                                 beta - NULL_WINDOW, beta );
+                guess = pass->s_returnValue;
+
+                if( guess >= beta )
+                    lower = guess;
+                else if( guess <= beta - NULL_WINDOW )
+                    upper = guess;
+                else
+                    lower = upper = guess;
+
+                ((SGeneralMLine*)pass->s_lines.last())->s_researchCall =
+                    QString("[%1,%2]")
+                    .arg(SGeneralMLine::numberToString(lower))
+                    .arg(SGeneralMLine::numberToString(upper));
+                newTrace->s_depths.append( pass );
+            }
         }
-        if(m_conf.s_isAB)
+        else if(conf.s_isAB && conf.s_isID && conf.s_isAW
+                && !newTrace->s_depths.isEmpty())
         {
-            ABtraceCall( curDepth, rootNode, d, qsDepth, -INF, INF, true );
-
-            call += ",-INF,INF";
+            // The window is centered on the value of the previous iteration.
+            // If the value falls outside of it, that side is opened up and
+            // the iteration is searched again. The value returned by the
+            // failed search bounds the true value, so the other side can be
+            // moved up to it.
+            float alpha = guess - conf.s_aspirationWidth;
+            float beta = guess + conf.s_aspirationWidth;
+            SGeneralMLine *lastLine;
+            STreeCall *pass;
+            for(;;)
+            {
+                pass = rootCall( context, 0, d, qsDepth, alpha, beta );
+                guess = pass->s_returnValue;
+                newTrace->s_depths.append( pass );
+
+                lastLine = (SGeneralMLine*)pass->s_lines.last();
+                if( context.isCancelled() )
+                    break;
+                else if( guess <= alpha && alpha > -INF )
+                {
+                    lastLine->s_researchCall = "fail low";
+                    alpha = -INF;
+                    beta = qMin( beta, guess + NULL_WINDOW );
+                }
+                else if( guess >= beta && beta < INF )
+                {
+                    lastLine->s_researchCall = "fail high";
+                    alpha = qMax( alpha, guess - NULL_WINDOW );
+                    beta = INF;
+                }
+                else
+                    break;
+            }
         }
         else
         {
-            traceCall( curDepth, rootNode, d, qsDepth, true );
+            newTrace->s_depths.append(
+                rootCall( context, 0, d, qsDepth, -INF, INF ) );
+            guess = newTrace->s_depths.last()->s_returnValue;
         }
-        call += ")";
-        ((SGeneralMLine*)(curDepth->s_lines.last()))->s_boxAction = true;
-        ((SGeneralMLine*)(curDepth->s_lines.last()))->s_boxValue = false;
+    }
 
-        ((SGeneralMLine*)(*curDepth)[0])->s_call = call;
+    context.s_cancelled = context.isCancelled();
+    newTrace->s_nodeCount = context.s_nodeCount;
+    return newTrace;
+}
 
-        newTrace->s_depths.append( curDepth );
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::rootCall
+///
+/// @description    Executes one search of the root node and labels it.
+/// @pre            rootNode is the root of the compiled tree.
+/// @post           returns the call of the search.
+///
+/// @param rootNode: Node to trace from.
+///        depth:   Depth Limit.
+///        qsDepth: Quiessance depth.
+///        alpha:   Alpha value, ignored without Alpha Beta.
+///        beta:    Beta value, ignored without Alpha Beta.
+///        context: State of the run.
+///
+/// @return STreeCall *: Pointer to the call of the search.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+STreeCall *CGeneralMTracer::rootCall( SGeneralMContext &context,
+                                      int rootNode, int depth, int qsDepth,
+                                      float alpha, float beta ) const
+{
+    STreeCall *curDepth = new STreeCall;
 
+    if(context.s_conf.s_isAB)
+    {
+        ABtraceCall( context, curDepth, rootNode, depth, qsDepth,
+                     alpha, beta, true, 0 );
+    }
+    else
+    {
+        traceCall( context, curDepth, rootNode, depth, qsDepth, true );
     }
+    curDepth->s_root = true;
+    ((SGeneralMLine*)(curDepth->s_lines.last()))->s_boxAction = true;
+    ((SGeneralMLine*)(curDepth->s_lines.last()))->s_boxValue = false;
 
-    return newTrace;
+    return curDepth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CGeneralMTracer::recordCall
+///
+/// @description    Keeps what a call is made with, so that the text of its
+///                 lines can be made when they are shown.
+/// @pre            children are the children of node in the order they will
+///                 be searched.
+/// @post           The call holds its arguments and open list.
+///
+/// @param call:    The call.
+///        node:    Node the call is made on.
+///        children: The children of node, in search order.
+///        depth:   Depth Limit.
+///        qsDepth: Quiessance depth.
+///        alpha:   Alpha value.
+///        beta:    Beta value.
+///        max:     true if this is a max node, false for a min.
+///        context: State of the run.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CGeneralMTracer::recordCall( SGeneralMContext &context, STreeCall *call,
+                                  int node, const ChildOrder &children,
+                                  int depth, int qsDepth,
+                                  float alpha, float beta, bool max ) const
+{
+    const CompiledTree &tree = context.s_tree;
+    call->s_node = tree.node( node );
+    call->s_max = max;
+    call->s_depth = depth;
+    call->s_qsDepth = qsDepth;
+    call->s_alpha = alpha;
+    call->s_beta = beta;
+
+    call->s_open.reserve( children.count() );
+    if( context.s_conf.s_isHT )
+        call->s_openHistory.reserve( children.count() );
+    for( int i = 0; i < children.count(); ++i )
+    {
+        call->s_open.append( tree.node( children[i] ) );
+        if( context.s_conf.s_isHT )
+            call->s_openHistory.append( history( context, children[i] ) );
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -359,101 +876,106 @@ STreeTrace * CGeneralMTracer::trace( const STreeNode *rootNode,
 ///        depthLimit: Depth Limit.
 ///        qsDepth: Quiessance depth.
 ///        traceConf: struct with trace parameters.
+///        context: State of the run.
 ///
 /// @return         None.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void CGeneralMTracer::traceCall( STreeCall *call, const STreeNode *node,
-                               int depth, int qsDepth, bool max ) const
+void CGeneralMTracer::traceCall( SGeneralMContext &context,
+                                 STreeCall *call, int node,
+                                 int depth, int qsDepth, bool max ) const
 {
-    if( call == NULL || node == NULL )
+    if( call == NULL || node < 0 )
         return;
-    QList<STreeNode*> curChildren = node->s_childList;
-    sortNodes( curChildren );
+    const CompiledTree &tree = context.s_tree;
+    ChildOrder curChildren;
+    childOrder( context, node, curChildren );
+    sortNodes( context, curChildren );
+    orderBestChild( context, node, max, curChildren );
 
-    QString depthString;
-    QString open;
-    STreeNode *curNode;
-    foreach( curNode, curChildren )
-    {
-        open += curNode->s_name;
-        if(m_conf.s_isHT)
-        {
-            open += QString::number(m_historyTable[curNode]);
-        }
-        open += " ";
-    }
-    open = open.simplified();
+    recordCall( context, call, node, curChildren,
+                depth, qsDepth, -INF, INF, max );
+
+    int curNode;
 
     SGeneralMLine *curLine;
-    STreeNode *bestAction = NULL;
+    int bestAction = -1;
     float bestValue = -1;
     bool better;
     int curDepth, curQSDepth;
     bool isEndPoint;
-    foreach( curNode, curChildren )
+    bool exhaustive = true;
+    bool childExhaustive;
+    for( int c = 0; c < curChildren.count(); ++c )
     {
+        curNode = curChildren[c];
+        // A cancelled run finishes each call after its first line, which
+        // unwinds the search quickly while leaving every call well formed.
+        if( !call->s_lines.isEmpty() && context.isCancelled() )
+            break;
+
         curDepth = depth;
         curQSDepth = qsDepth;
 
         curLine = new SGeneralMLine;
-        curLine->s_conf = m_conf;
-
-        curLine->s_open = open;
-        if( m_conf.s_isHT )
-            curLine->s_open.remove(' ');
-        curLine->s_eval = curNode->s_name;
-        open = open.section( ' ', 1, -1 );
+        context.s_nodeCount++;
 
+        // There is one line for each child searched so far.
+        curLine->s_open = call->s_lines.count();
 
         if( curDepth > 0 )
             curDepth--;
         else
             curQSDepth--;
         isEndPoint = false;
-        if( (curNode->s_childList.count() == 0)
-              ||(curDepth == 0 && (!curNode->s_quiescent || curQSDepth == 0)) )
+        if( (tree.childCount( curNode ) == 0)
+              ||(curDepth == 0 && (!tree.isQuiescent( curNode )
+                                   || curQSDepth == 0)) )
             isEndPoint = true;
 
-        depthString = "";
-        if( m_conf.s_isDL )
-        {
-            depthString = QString(",%1").arg(curDepth);
-        }
-        if( m_conf.s_isQS )
-        {
-            depthString += QString(",%1").arg(curQSDepth);
-        }
-
-        curLine->s_valueCall = max?"Min":"Max";
-        curLine->s_valueCall += QString("V(%1%2)")
-                                .arg(curNode->s_name)
-                                .arg(depthString);
+        curLine->s_depth = curDepth;
+        curLine->s_qsDepth = curQSDepth;
         if( isEndPoint )
         {
-                curLine->s_valueValue = curNode->s_value;
+                curLine->s_valueValue = tree.value( curNode );
                 curLine->s_sss = false;
+                if( tree.childCount( curNode ) > 0 )
+                    exhaustive = false;
         }
-        else if( checkSSS( curNode, curDepth, curQSDepth ) )
+        else if( checkSSS( context, curNode, curDepth, curQSDepth ) )
         {
-            curLine->s_valueValue = sssValue( curNode, curDepth, curQSDepth );
+            curLine->s_valueValue = sssValue( context, curNode,
+                                              curDepth, curQSDepth );
             curLine->s_sss = true;
-            if( m_conf.s_isHT )
-                curLine->s_historyUpdates = sssHistoryUpdates( curNode,
+            if( context.s_conf.s_isHT && !context.s_conf.s_isLH )
+                curLine->s_historyUpdates = sssHistoryUpdates( context, curNode,
                                                     curDepth, curQSDepth );
+            exhaustive = false;
+        }
+        else if( context.s_conf.s_isTT
+                 && probeTT( context, curNode, !max, curDepth, curQSDepth,
+                             -INF, INF,
+                             curLine->s_valueValue, childExhaustive ) )
+        {
+            curLine->s_tt = true;
+            exhaustive = exhaustive && childExhaustive;
         }
         else
         {
             call->s_children.append( new STreeCall() );
-            traceCall( call->s_children.last(), curNode, curDepth, curQSDepth, !max );
+            traceCall( context, call->s_children.last(), curNode,
+                       curDepth, curQSDepth, !max );
             curLine->s_valueValue = call->s_children.last()->s_returnValue;
+            if( context.s_conf.s_isTT )
+                exhaustive = exhaustive && context.s_transTable
+                    .value( ttKey( context, curNode, !max ) ).s_exhaustive;
         }
         curLine->s_qs = (curDepth == 0 && curQSDepth > 0
-                         && curNode->s_quiescent);
+                         && tree.isQuiescent( curNode ));
 
-        if( bestAction == NULL )
+        if( bestAction < 0 )
             better = true;
         else
         {
@@ -465,26 +987,16 @@ void CGeneralMTracer::traceCall( STreeCall *call, const STreeNode *node,
             bestAction = curNode;
             bestValue = curLine->s_valueValue;
         }
-        curLine->s_bestAction = node->s_name + bestAction->s_name;
+        curLine->s_bestAction = tree.node( bestAction );
         curLine->s_bestValue = bestValue;
 
         call->s_lines.append( curLine );
     }
 
     call->s_returnValue = bestValue;
-    depthString = "";
-    if( m_conf.s_isDL )
-    {
-        depthString = QString(",%1").arg(depth);
-    }
-    if( m_conf.s_isQS )
-    {
-        depthString += QString(",%1").arg(qsDepth);
-    }
-    ((SGeneralMLine*)call->s_lines.first())->s_call =
-        QString(max?"MaxV(%1%2)":"MinV(%1%2)")
-        .arg(node->s_name)
-        .arg(depthString);
+    if( context.s_conf.s_isTT )
+        storeTT( context, node, max, depth, qsDepth, -INF, INF,
+                 bestValue, bestAction, exhaustive );
     ((SGeneralMLine*)call->s_lines.last())->s_boxValue = true;
 }
 
@@ -501,111 +1013,157 @@ void CGeneralMTracer::traceCall( STreeCall *call, const STreeNode *node,
 ///        qsDepth: Quiessance depth.
 ///        alpha: Alpha value.
 ///        beta: Beta value.
+///        ply: Distance of node from the root.
 ///        traceConf: struct with trace parameters.
+///        context: State of the run.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void CGeneralMTracer::ABtraceCall( STreeCall *call, const STreeNode *node,
-                     int depth, int qsDepth, float alpha, float beta, bool max ) const
+void CGeneralMTracer::ABtraceCall( SGeneralMContext &context,
+                                   STreeCall *call, int node,
+                                   int depth, int qsDepth,
+                                   float alpha, float beta, bool max,
+                                   int ply ) const
 {
-    if( call == NULL || node == NULL )
+    if( call == NULL || node < 0 )
         return;
 
-    QList<STreeNode*> curChildren = node->s_childList;
-    sortNodes( curChildren );
+    const CompiledTree &tree = context.s_tree;
+    ChildOrder curChildren;
+    childOrder( context, node, curChildren );
+    // Killers go first so the stable history sort keeps them in front of
+    // children with the same history value.
+    orderKillers( context, node, curChildren, ply );
+    sortNodes( context, curChildren );
+    orderBestChild( context, node, max, curChildren );
 
-    QString depthString;
-    QString open;
-    STreeNode *curNode;
-    foreach( curNode, curChildren )
-    {
-        open += curNode->s_name;
-        if( m_conf.s_isHT )
-        {
-            open += QString::number(m_historyTable[curNode]);
-        }
-        open += " ";
-    }
-    open = open.simplified();
+    recordCall( context, call, node, curChildren,
+                depth, qsDepth, alpha, beta, max );
+
+    int curNode;
 
     SGeneralMLine *curLine;
-    STreeNode *bestAction = NULL;
+    int bestAction = -1;
     float bestValue = -1;
     int curDepth, curQSDepth;
     float curAlpha = alpha, curBeta = beta;
+    float childAlpha, childBeta;
+    float curValue;
 
     bool better;
     bool isEndPoint;
-    foreach( curNode, curChildren )
+    bool exhaustive = true;
+    bool childExhaustive;
+    for( int c = 0; c < curChildren.count(); ++c )
     {
+        curNode = curChildren[c];
+        if( !call->s_lines.isEmpty() && context.isCancelled() )
+            break;
+
         bool sssPrune = false;
 
         curDepth = depth;
         curQSDepth = qsDepth;
         curLine = new SGeneralMLine;
+        context.s_nodeCount++;
 
-        curLine->s_conf = m_conf;
-
-        curLine->s_open = open;
-
-
-        if( m_conf.s_isHT )
-            curLine->s_open.remove(' ');
-        curLine->s_eval = curNode->s_name;
-        open = open.section( ' ', 1, -1 );
+        curLine->s_open = call->s_lines.count();
 
         if( curDepth > 0 )
             curDepth--;
         else
             curQSDepth--;
 
-        depthString = "";
         isEndPoint = false;
-        if( (curNode->s_childList.count() == 0)
-                  ||(curDepth == 0 && (!curNode->s_quiescent || curQSDepth == 0)) )
+        if( (tree.childCount( curNode ) == 0)
+                  ||(curDepth == 0 && (!tree.isQuiescent( curNode )
+                                       || curQSDepth == 0)) )
             isEndPoint = true;
 
-        if( m_conf.s_isDL )
-        {
-            depthString = QString(",%1").arg(curDepth);
-        }
-        if( m_conf.s_isQS )
+        // PVS searches every child after the first with a null window that
+        // only tests whether it can improve on the best value so far.
+        childAlpha = curAlpha;
+        childBeta = curBeta;
+        if( context.s_conf.s_isPVS && bestAction >= 0 && !isEndPoint )
         {
-            depthString += QString(",%1").arg(curQSDepth);
+            if( max )
+                childBeta = qMin( curAlpha + NULL_WINDOW, curBeta );
+            else
+                childAlpha = qMax( curBeta - NULL_WINDOW, curAlpha );
         }
-        curLine->s_valueCall = max?"Min":"Max";
-        curLine->s_valueCall += QString("V(%1%2,%3,%4)")
-                                .arg(curNode->s_name)
-                                .arg(depthString)
-                                .arg(SGeneralMLine::numberToString(curAlpha))
-                                .arg(SGeneralMLine::numberToString(curBeta));
+
+        curLine->s_depth = curDepth;
+        curLine->s_qsDepth = curQSDepth;
+        curLine->s_valueAlpha = childAlpha;
+        curLine->s_valueBeta = childBeta;
         if( isEndPoint )
         {
-            curLine->s_valueValue = curNode->s_value;
+            curLine->s_valueValue = tree.value( curNode );
             curLine->s_sss = false;
+            if( tree.childCount( curNode ) > 0 )
+                exhaustive = false;
         }
-        else if( checkSSS( curNode, curDepth, curQSDepth ) )
+        else if( checkSSS( context, curNode, curDepth, curQSDepth ) )
         {
             curLine->s_valueValue =
-                sssValue( curNode, curDepth, curQSDepth );
+                sssValue( context, curNode, curDepth, curQSDepth );
 
             curLine->s_sss = true;
-            if(m_conf.s_isHT)
+            if( context.s_conf.s_isHT && !context.s_conf.s_isLH )
                 curLine->s_historyUpdates =
-                    sssHistoryUpdates( curNode, curDepth, curQSDepth );
+                    sssHistoryUpdates( context, curNode, curDepth, curQSDepth );
+            exhaustive = false;
 
         }
+        else if( context.s_conf.s_isTT
+                 && probeTT( context, curNode, !max, curDepth, curQSDepth,
+                             childAlpha, childBeta,
+                             curLine->s_valueValue, childExhaustive ) )
+        {
+            curLine->s_tt = true;
+            exhaustive = exhaustive && childExhaustive;
+        }
         else
         {
             call->s_children.append( new STreeCall() );
-            ABtraceCall( call->s_children.last(), curNode,
+            ABtraceCall( context, call->s_children.last(), curNode,
                        curDepth, curQSDepth,
-                       curAlpha, curBeta, !max );
+                       childAlpha, childBeta, !max, ply + 1 );
             curLine->s_valueValue = call->s_children.last()->s_returnValue;
+            if( context.s_conf.s_isTT )
+                exhaustive = exhaustive && context.s_transTable
+                    .value( ttKey( context, curNode, !max ) ).s_exhaustive;
         }
+
+        // A scout that fails high (low for a min node) without reaching the
+        // real window's bound only gives a bound on the child, so the child is
+        // searched again with the real window to get its value.
+        if( !curLine->s_sss
+            && ( ( max && childBeta < curBeta
+                   && curLine->s_valueValue >= childBeta
+                   && curLine->s_valueValue < curBeta )
+              || ( !max && childAlpha > curAlpha
+                   && curLine->s_valueValue <= childAlpha
+                   && curLine->s_valueValue > curAlpha ) ) )
+        {
+            curLine->s_research = true;
+            curLine->s_researchAlpha = curAlpha;
+            curLine->s_researchBeta = curBeta;
+
+            call->s_children.append( new STreeCall() );
+            ABtraceCall( context, call->s_children.last(), curNode,
+                       curDepth, curQSDepth,
+                       curAlpha, curBeta, !max, ply + 1 );
+            curLine->s_researchValue = call->s_children.last()->s_returnValue;
+            if( context.s_conf.s_isTT )
+                exhaustive = exhaustive && context.s_transTable
+                    .value( ttKey( context, curNode, !max ) ).s_exhaustive;
+        }
+        curValue = curLine->s_research ? curLine->s_researchValue
+                                       : curLine->s_valueValue;
         curLine->s_qs = (curDepth == 0 && curQSDepth > 0
-                         && curNode->s_quiescent);
+                         && tree.isQuiescent( curNode ));
         if( curLine->s_sss )
         {
             if( curLine->s_valueValue <= curAlpha )
@@ -614,17 +1172,17 @@ void CGeneralMTracer::ABtraceCall( STreeCall *call, const STreeNode *node,
                 sssPrune = true;
         }
 
-        if( bestAction == NULL )
+        if( bestAction < 0 )
             better = true;
         else
         {
-            if( max )   better = (curLine->s_valueValue > bestValue );
-            else        better = (curLine->s_valueValue < bestValue );
+            if( max )   better = (curValue > bestValue );
+            else        better = (curValue < bestValue );
         }
         if( better )
         {
             bestAction = curNode;
-            bestValue = curLine->s_valueValue;
+            bestValue = curValue;
 
             if( max )
             {
@@ -645,45 +1203,105 @@ void CGeneralMTracer::ABtraceCall( STreeCall *call, const STreeNode *node,
         curLine->s_alpha = curAlpha;
         curLine->s_beta = curBeta;
 
-        curLine->s_bestAction = node->s_name + bestAction->s_name;
+        curLine->s_bestAction = tree.node( bestAction );
         curLine->s_bestValue = bestValue;
 
         call->s_lines.append( curLine );
 
         if( curLine->s_prune )
         {
+            if( context.s_conf.s_isKM )
+                storeKiller( context, curNode, ply );
             break;
         }
         if( sssPrune )
         curLine->s_prune = true;
     }
-    if( m_conf.s_isHT )
+    // A learned history table credits the move that caused the cutoff, or
+    // the best move if none did, by the square of the remaining depth. The
+    // selector only allows it with a depth limit; without one the depth is
+    // INF and the squares would soon overflow, so the credit is 1.
+    int historyBonus = context.s_conf.s_isLH && context.s_conf.s_isDL
+                     ? depth * depth : 1;
+    if( context.s_conf.s_isHT && historyBonus > 0 )
     {
-        m_historyTable[bestAction]++;
+        SGeneralMHistoryUpdate update;
+        update.s_node = tree.node( bestAction );
+        update.s_value = history( context, bestAction ) += historyBonus;
         ((SGeneralMLine*)call->s_lines.last())->s_historyUpdates
-            += moveName( bestAction )
-               + ':' + QString::number( m_historyTable[bestAction] );
+            .append( update );
     }
 
     call->s_returnValue = bestValue;
-    depthString = "";
-    if( m_conf.s_isDL )
-    {
-        depthString = QString(",%1").arg(depth);
-    }
-    if( m_conf.s_isQS )
-    {
-        depthString += QString(",%1").arg(qsDepth);
-    }
-    ((SGeneralMLine*)call->s_lines.first())->s_call =
-        QString(max?"MaxV(%1%2,%3,%4)":"MinV(%1%2,%3,%4)")
-        .arg(node->s_name)
-        .arg(depthString)
-        .arg(SGeneralMLine::numberToString(alpha))
-        .arg(SGeneralMLine::numberToString(beta));
+    if( context.s_conf.s_isTT )
+        storeTT( context, node, max, depth, qsDepth, alpha, beta,
+                 bestValue, bestAction, exhaustive );
     ((SGeneralMLine*)call->s_lines.last())->s_boxValue = true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// SGeneralMContext::SGeneralMContext
+///
+/// @description    This is the constructor of the SGeneralMContext struct.
+/// @pre            None
+/// @post           Object is created with empty tables.
+///
+/// @param conf:    Configuration of the run.
+///        cancel:  Cancellation token, or NULL if the run can't be cancelled.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SGeneralMContext::SGeneralMContext( const STraceConfig &conf,
+                                    const QAtomicInt *cancel )
+{
+    s_conf = conf;
+    s_cancel = cancel;
+    s_nodeCount = 0;
+    s_cancelled = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SGeneralMContext::isCancelled
+///
+/// @description    Checks the cancellation token of the run.
+/// @pre            None
+/// @post           None
+///
+/// @param          None.
+///
+/// @return bool:   true if the run has been asked to stop.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool SGeneralMContext::isCancelled() const
+{
+    return s_cancel != NULL && (int)*s_cancel != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SGeneralMTTEntry::SGeneralMTTEntry
+///
+/// @description    This is the constructor of the SGeneralMTTEntry struct.
+/// @pre            None
+/// @post           Object is created as an empty entry.
+///
+/// @param          None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SGeneralMTTEntry::SGeneralMTTEntry()
+{
+    s_depth = -1;
+    s_qsDepth = -1;
+    s_bound = Exact;
+    s_value = 0.0;
+    s_bestChild = -1;
+    s_exhaustive = false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// SGeneralMLine::SGeneralMLine
 ///
@@ -698,20 +1316,28 @@ void CGeneralMTracer::ABtraceCall( STreeCall *call, const STreeNode *node,
 ////////////////////////////////////////////////////////////////////////////////
 SGeneralMLine::SGeneralMLine()
 {
-    s_call = QString();
-    s_open = QString();
-    s_eval = QString();
+    s_open = 0;
 
-    s_valueCall = QString();
+    s_depth = 0;
+    s_qsDepth = 0;
+    s_valueAlpha = -INF;
+    s_valueBeta = INF;
     s_valueValue = 0.0;
     s_qs = false;
     s_sss = false;
     s_prune = false;
+    s_tt = false;
+
+    s_researchCall = QString();
+    s_researchAlpha = -INF;
+    s_researchBeta = INF;
+    s_researchValue = 0.0;
+    s_research = false;
 
     s_alpha = -INF;
     s_beta = INF;
 
-    s_bestAction = QString();
+    s_bestAction = NULL;
     s_boxAction = false;
     s_bestValue = 0.0;
     s_boxValue = false;
@@ -755,53 +1381,99 @@ QString SGeneralMLine::numberToString( float val )
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// SGeneralMLine::operator []
+/// callText
 ///
-/// @description
-/// @pre            None
-/// @post
+/// @description    Writes out a call of the search, such as MaxV(B,2,-INF,5),
+///                 showing only the arguments the configuration uses.
+///
+////////////////////////////////////////////////////////////////////////////////
+static QString callText( const char *name, const STreeNode *node,
+                         int depth, int qsDepth, float alpha, float beta,
+                         const STraceConfig &conf )
+{
+    QString ret = QString("%1(%2").arg(name).arg(node->s_name);
+    if( conf.s_isDL )
+        ret += QString(",%1").arg(depth);
+    if( conf.s_isQS )
+        ret += QString(",%1").arg(qsDepth);
+    if( conf.s_isAB )
+        ret += QString(",%1,%2")
+               .arg(SGeneralMLine::numberToString(alpha))
+               .arg(SGeneralMLine::numberToString(beta));
+    return ret + ")";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SGeneralMLine::cell
+///
+/// @description    Makes the text of one cell of the line.
+/// @pre            call is the call the line belongs to, and was made by the
+///                 tracer.
+/// @post           None
 ///
 /// @param index:   index of collumn.
+///        call:    The call the line belongs to.
+///        conf:    The configuration the trace was made with.
+///
+/// @return QString: The text of the cell.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QString SGeneralMLine::operator [](int index)
+QString SGeneralMLine::cell( int index, const STreeCall *call,
+                             const STraceConfig &conf ) const
 {
     QString ret;
+    const STreeNode *child = call->s_open[s_open];
+    const char *valueName = call->s_max ? "MinV" : "MaxV";
 
     switch( index )
     {
     case 0: //  CALL
-        ret = s_call;
+        if( call->s_lines.first() != this )
+            break;
+        if( call->s_root )
+            ret = callText( conf.s_isDL ? "DLM" : "Minimax", call->s_node,
+                            call->s_depth, call->s_qsDepth,
+                            call->s_alpha, call->s_beta, conf );
+        else
+            ret = callText( call->s_max ? "MaxV" : "MinV", call->s_node,
+                            call->s_depth, call->s_qsDepth,
+                            call->s_alpha, call->s_beta, conf );
         break;
     case 1: //  OPEN
-        ret = s_open;
+        for( int i = s_open; i < call->s_open.count(); ++i )
+        {
+            if( conf.s_isHT )
+                ret += call->s_open[i]->s_name
+                       + QString::number( call->s_openHistory[i] );
+            else
+            {
+                if( i > s_open )
+                    ret += " ";
+                ret += call->s_open[i]->s_name;
+            }
+        }
         break;
     case 2: //  EVAL
-        ret = s_eval;
+        ret = child->s_name;
         break;
     case 3: //  VALUE
-        ret = s_valueCall;
+        ret = callText( valueName, child, s_depth, s_qsDepth,
+                        s_valueAlpha, s_valueBeta, conf );
         ret += "=" + QString::number( s_valueValue );
-        if( s_qs || s_sss || s_prune)
+        if( s_qs || s_sss || s_tt || s_prune)
         {
-            ret += " (";
+            QStringList flags;
             if( s_qs )
-            {
-                ret += "QS";
-                if( s_sss || s_prune)
-                    ret += ",";
-            }
+                flags += "QS";
             if( s_sss )
-            {
-                ret += "SSS";
-                if( s_prune )
-                    ret += ",";
-            }
+                flags += "SSS";
+            if( s_tt )
+                flags += "TT";
             if( s_prune )
-                ret += "Prune";
-            ret += ")";
+                flags += "Prune";
+            ret += " (" + flags.join(",") + ")";
         }
         break;
     case 4: //  a,b
@@ -811,15 +1483,32 @@ QString SGeneralMLine::operator [](int index)
         break;
     case 5: //  BEST ACTION,VALUE
         if( s_boxAction )
-            ret = QString("[%1], ").arg(s_bestAction);
+            ret = QString("[%1%2], ")
+                  .arg(call->s_node->s_name).arg(s_bestAction->s_name);
         else
-            ret = s_bestAction + ", ";
+            ret = call->s_node->s_name + s_bestAction->s_name + ", ";
         if( s_boxValue )
             ret += QString("[%1]").arg(s_bestValue);
         else
             ret += QString::number(s_bestValue);
-            if( !s_historyUpdates.isEmpty() )
-                ret += QString(" {%1}").arg(s_historyUpdates.join(","));
+        if( !s_historyUpdates.isEmpty() )
+        {
+            QStringList updates;
+            for( int i = 0; i < s_historyUpdates.count(); ++i )
+                updates += CGeneralMTracer::moveName(
+                               s_historyUpdates[i].s_node )
+                           + ':'
+                           + QString::number( s_historyUpdates[i].s_value );
+            ret += QString(" {%1}").arg(updates.join(","));
+        }
+        break;
+    case 6: //  RE-SEARCH
+        ret = s_researchCall;
+        if( ret.isEmpty() && s_research )
+            ret = callText( valueName, child, s_depth, s_qsDepth,
+                            s_researchAlpha, s_researchBeta, conf );
+        if( s_research )
+            ret += "=" + QString::number( s_researchValue );
         break;
     default:
         break;
@@ -831,24 +1520,38 @@ QString SGeneralMLine::operator [](int index)
 ////////////////////////////////////////////////////////////////////////////////
 /// SGeneralMLine::toStringList
 ///
-/// @description
-/// @pre            None
-/// @post
+/// @description    Makes the text of every cell the trace shows.
+/// @pre            call is the call the line belongs to.
+/// @post           None
 ///
-/// @param          None.
+/// @param call:    The call the line belongs to.
+///        conf:    The configuration the trace was made with.
+///
+/// @return QStringList: The cells, or s_cells if the line has them.
 ///
 /// @limitations    None.
 ///
 ////////////////////////////////////////////////////////////////////////////////
-QStringList SGeneralMLine::toStringList()
+QStringList SGeneralMLine::toStringList( const STreeCall *call,
+                                         const STraceConfig &conf ) const
 {
+    if( !s_cells.isEmpty() || call == NULL || call->s_node == NULL )
+        return s_cells;
+
     QStringList ret;
 
-    for( int i = 0; i < 6; ++i )
+    // The re-search column is shown next to the value column.
+    static const int columns[] = { 0, 1, 2, 3, 6, 4, 5 };
+    int i;
+    for( int c = 0; c < 7; ++c )
     {
-        if(i == 4 && !s_conf.s_isAB) continue;
+        i = columns[c];
+        if(i == 4 && !conf.s_isAB) continue;
+        if(i == 6 && !(conf.s_isAB && (conf.s_isPVS || conf.s_isMTDF
+                                       || (conf.s_isAW && conf.s_isID))))
+            continue;
 
-        ret += (*this)[i];
+        ret += cell( i, call, conf );
     }
     return ret;
 }
@@ -16,17 +16,32 @@
 #ifndef _CGENERALMTRACER_H_
 #define _CGENERALMTRACER_H_
 
-#include "../../STreeTrace.h"
 #include "../../CTreeGraph.h"
+#include "../../../CCompiledTree.h"
 #include <QString>
 #include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QVarLengthArray>
+#include <QAtomicInt>
 
-typedef QMap<const STreeNode*, int> HistTable;
+// The search works on a CCompiledTree of the tree, so a node is its number
+// there. History values are kept in a flat array indexed by that number.
+typedef CCompiledTree<STreeNode> CompiledTree;
+typedef QVector<int> HistTable;
 // The name HistoryTable can't be used because there is another typedef
 // of that name with conflicting type in CTreeGraphModel.h
 
 struct STreeTrace;
 struct STreeCall;
+struct SGeneralMTTEntry;
+struct SGeneralMHistoryUpdate;
+
+// The transposition table is keyed by the shape of a node and the player to
+// move there, so nodes with the same subtree share an entry.
+typedef QHash<int, SGeneralMTTEntry> GeneralTTable;
+// The children of a node in the order they are searched.
+typedef QVarLengthArray<int, 16> ChildOrder;
 
 struct STraceConfig
 {
@@ -34,6 +49,10 @@ struct STraceConfig
     bool s_isQS;
     // History Table?
     bool s_isHT;
+    // Learn the History Table during the search instead of using preset values?
+    bool s_isLH;
+    // Killer Moves?
+    bool s_isKM;
     // Depth Limited?
     bool s_isDL;
     // Iterative Deepening?
@@ -42,14 +61,114 @@ struct STraceConfig
     bool s_isAB;
     // Allow Single Successor Shortcut?
     bool s_allowSSS;
+    // Transposition Table?
+    bool s_isTT;
+    // Principal Variation Search? (requires Alpha Beta)
+    bool s_isPVS;
+    // MTD(f)? (requires Alpha Beta)
+    bool s_isMTDF;
+    // Aspiration Windows? (requires Alpha Beta and Iterative Deepening)
+    bool s_isAW;
+    // Distance from the previous iteration's value to each side of the
+    // aspiration window.
+    float s_aspirationWidth;
+    // Young Brothers Wait parallel search? (requires Alpha Beta)
+    bool s_isYBWC;
+    // Lazy SMP parallel search? (requires Alpha Beta)
+    bool s_isLazySMP;
+    // Number of threads used by the parallel searches and MCTS.
+    int s_threads;
+    // Monte Carlo Tree Search instead of minimax?
+    bool s_isMCTS;
+    // Number of simulations run by MCTS.
+    int s_playouts;
+    // Proof-number search instead of minimax?
+    bool s_isPN;
+    // Depth-first proof-number search instead of minimax?
+    bool s_isDFPN;
+    // End points valued above this are wins for max in the proof-number
+    // searches, the rest are losses.
+    float s_proofThreshold;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SGeneralMTTEntry
+///
+/// @description  An entry of the transposition table. It records the result
+///               of searching a node to a given remaining depth, whether that
+///               result is exact or only a bound, and which child was best.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SGeneralMTTEntry
+{
+    SGeneralMTTEntry();
+
+    enum BoundType
+    {
+        Exact,
+        LowerBound,
+        UpperBound
+    };
+
+    int              s_depth;
+    int              s_qsDepth;
+    BoundType        s_bound;
+    float            s_value;
+    // The number of the best child in the compiled tree, or -1.
+    int              s_bestChild;
+    // True if no leaf of the search was cut off by the depth limit, in which
+    // case the result also holds for any deeper search.
+    bool             s_exhaustive;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SGeneralMContext
+///
+/// @description  Everything that belongs to one run of CGeneralMTracer: the
+///               configuration, the cancellation token, the statistics, the
+///               compiled copy of the tree and the tables the search builds
+///               up. The tracer itself holds no
+///               state, so several runs may share it from different threads
+///               as long as each has a context of its own.
+///
+/// @limitations  A context may only be used by one run at a time.
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SGeneralMContext
+{
+    SGeneralMContext( const STraceConfig &conf,
+                      const QAtomicInt *cancel = NULL );
 
+    bool isCancelled() const;
+
+    STraceConfig        s_conf;
+    // The run stops early once this is set to non-zero. May be NULL.
+    const QAtomicInt   *s_cancel;
+
+    // Statistics, filled in by the run.
+    int                 s_nodeCount;
+    bool                s_cancelled;
+
+    // The tree being searched.
+    CompiledTree        s_tree;
+
+    // Tables built up by the run.
+    HistTable           s_historyTable;
+    // Two killer slots per ply, each holding the child index of a move that
+    // recently caused a cutoff at that ply, or -1.
+    QVector<int>        s_killerMoves;
+    GeneralTTable       s_transTable;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CGeneralMTracer
 ///
 /// @description  This class is capable of executing many combinations of
-///               MiniMax variations.
+///               MiniMax variations. The state of a run is kept in an
+///               SGeneralMContext, so one tracer can run many traces at once.
 ///
 /// @limitations
 ///
@@ -61,36 +180,85 @@ public:
 
     STreeTrace *trace( const STreeNode *rootNode, int depthLimit, int qsDepth,
                        const STraceConfig &traceConf ) const;
+    STreeTrace *trace( const STreeNode *rootNode, int depthLimit, int qsDepth,
+                       SGeneralMContext &context ) const;
+
+    static QString moveName( const STreeNode *node );
 private:
-    void traceCall( STreeCall *call, const STreeNode *node,
+    void traceCall( SGeneralMContext &context, STreeCall *call, int node,
                     int depth, int qsDepth, bool max ) const;
-    void ABtraceCall( STreeCall *call, const STreeNode *node,
-                    int depth, int qsDepth, float alpha, float beta, bool max ) const;
+    void ABtraceCall( SGeneralMContext &context, STreeCall *call, int node,
+                    int depth, int qsDepth, float alpha, float beta, bool max,
+                    int ply ) const;
+    STreeCall *rootCall( SGeneralMContext &context, int rootNode,
+                         int depth, int qsDepth,
+                         float alpha, float beta ) const;
+    void recordCall( SGeneralMContext &context, STreeCall *call, int node,
+                     const ChildOrder &children,
+                     int depth, int qsDepth, float alpha, float beta,
+                     bool max ) const;
 
-    bool checkSSS( const STreeNode *node, int depth, int qsDepth ) const;
+    bool checkSSS( SGeneralMContext &context,
+                   int node, int depth, int qsDepth ) const;
 
-    float sssValue( const STreeNode *node, int depth, int qsDepth ) const;
-    QStringList sssHistoryUpdates( const STreeNode *node,
+    float sssValue( SGeneralMContext &context,
+                    int node, int depth, int qsDepth ) const;
+    QVector<SGeneralMHistoryUpdate> sssHistoryUpdates(
+                                   SGeneralMContext &context, int node,
                                    int depth, int qsDepth,
                                    bool top = true ) const;
-    void generateHistoryTable( const STreeNode *node ) const;
-    void sortNodes( QList<STreeNode *> &nodes ) const;
+    void generateHistoryTable( SGeneralMContext &context ) const;
+    int &history( SGeneralMContext &context, int node ) const;
+    void childOrder( SGeneralMContext &context, int node,
+                     ChildOrder &nodes ) const;
+    void sortNodes( SGeneralMContext &context, ChildOrder &nodes ) const;
+
+    void storeKiller( SGeneralMContext &context, int node, int ply ) const;
+    void orderKillers( SGeneralMContext &context, int node,
+                       ChildOrder &nodes, int ply ) const;
 
-    QString moveName( const STreeNode *node ) const;
+    int ttKey( const SGeneralMContext &context, int node, bool max ) const;
+    bool probeTT( SGeneralMContext &context,
+                  int node, bool max, int depth, int qsDepth,
+                  float alpha, float beta,
+                  float &value, bool &exhaustive ) const;
+    void storeTT( SGeneralMContext &context,
+                  int node, bool max, int depth, int qsDepth,
+                  float alpha, float beta, float value,
+                  int bestChild, bool exhaustive ) const;
+    void orderBestChild( SGeneralMContext &context, int node, bool max,
+                         ChildOrder &nodes ) const;
+};
 
-    mutable HistTable m_historyTable;
-    mutable STraceConfig m_conf;
+////////////////////////////////////////////////////////////////////////////////
+/// SGeneralMHistoryUpdate
+///
+/// @description  A change made to the history table during a call: the node
+///               whose move was credited and its history value afterwards.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SGeneralMHistoryUpdate
+{
+    const STreeNode    *s_node;
+    int                 s_value;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 /// SGeneralMLine
 ///
 /// @description  The SGeneralMLine represents an actual line in a trace grid. The
-///               different cells are returned as QStrings through the []
-///               operator or they can be extracted as a list by the
+///               different cells are returned as QStrings through the cell()
+///               function or they can be extracted as a list by the
 ///               toStringList function.
 ///
-/// @limitations
+///               A line only keeps numbers and the nodes it is about. Its
+///               text is made from them, and from the call it belongs to,
+///               when it is shown or saved.
+///
+/// @limitations  The nodes belong to the copy of the tree the trace was made
+///               from, which the trace keeps.
 ///
 ////////////////////////////////////////////////////////////////////////////////
 struct SGeneralMLine
@@ -98,32 +266,48 @@ struct SGeneralMLine
     SGeneralMLine();
     ~SGeneralMLine();
 
-    QString operator[](int index);
-    QStringList toStringList();
+    QString cell( int index, const STreeCall *call,
+                  const STraceConfig &conf ) const;
+    QStringList toStringList( const STreeCall *call,
+                              const STraceConfig &conf ) const;
 
     static QString numberToString( float val );
 
-    QString s_call;
-
-    QString s_open;
-
-    QString s_eval;
+    // Where this line's child is in the open list of its call. The open
+    // column shows the child and the children after it.
+    int     s_open;
 
-    QString s_valueCall;
+    // The depths and window the child's value was asked for with.
+    int     s_depth;
+    int     s_qsDepth;
+    float   s_valueAlpha;
+    float   s_valueBeta;
     float   s_valueValue;
     bool    s_sss;
     bool    s_qs;
     bool    s_prune;
+    bool    s_tt;
+
+    // Shown in the re-search column in place of the re-search call, such as
+    // the bounds after each pass of MTD(f). Usually empty.
+    QString s_researchCall;
+    float   s_researchAlpha;
+    float   s_researchBeta;
+    float   s_researchValue;
+    bool    s_research;
 
     float   s_alpha;
     float   s_beta;
-    QString s_bestAction;
+    const STreeNode *s_bestAction;
     bool    s_boxAction;
     float   s_bestValue;
     bool    s_boxValue;
 
-    STraceConfig s_conf;
-    QStringList  s_historyUpdates;
+    QVector<SGeneralMHistoryUpdate> s_historyUpdates;
+
+    // Cells of a line that doesn't follow the call layout above, such as the
+    // summary lines of the parallel search. Used as is when not empty.
+    QStringList  s_cells;
 };
 
 
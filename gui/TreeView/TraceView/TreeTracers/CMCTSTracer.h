@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CMCTSTracer.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the CMCTSTracer class.
+///               It estimates the value of a game tree with Monte Carlo Tree
+///               Search run over several threads.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CMCTSTRACER_H_
+#define _CMCTSTRACER_H_
+
+#include "../../STreeTrace.h"
+#include "../../CTreeGraph.h"
+#include "CGeneralMTracer.h"
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QThreadPool>
+
+////////////////////////////////////////////////////////////////////////////////
+/// SMCTSNode
+///
+/// @description  A node of the search tree grown by MCTS. It mirrors a node of
+///               the game tree and holds the statistics of the simulations
+///               that went through it. The counters are only ever changed
+///               atomically, so threads never lock a node.
+///
+/// @limitations  s_children must not be read until s_expanded is Expanded.
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SMCTSNode
+{
+    SMCTSNode( const STreeNode *node, int depth, int qsDepth, bool max );
+    ~SMCTSNode();
+
+    enum ExpandState
+    {
+        Unexpanded,
+        Expanding,
+        Expanded
+    };
+
+    const STreeNode    *s_node;
+    int                 s_depth;
+    int                 s_qsDepth;
+    bool                s_max;
+    // True if the node is evaluated rather than searched.
+    bool                s_endPoint;
+
+    QAtomicInt          s_expanded;
+    QList<SMCTSNode *>  s_children;
+
+    QAtomicInt          s_visits;
+    // Simulations currently passing through the node. Each one counts as a
+    // loss until it is backed up, which steers other threads elsewhere.
+    QAtomicInt          s_virtualLoss;
+    // Sum of the simulation results, from max's point of view. Holds the bits
+    // of a float so it can be updated with compare and swap.
+    QAtomicInt          s_valueSum;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SMCTSSnapshot
+///
+/// @description  The statistics of the children of the root after a given
+///               number of simulations.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SMCTSSnapshot
+{
+    int                 s_playouts;
+    QList<int>          s_visits;
+    QList<float>        s_values;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SMCTSContext
+///
+/// @description  Everything that belongs to one run of CMCTSTracer: the
+///               configuration, the cancellation token, the thread pool, the
+///               search tree and the statistics the simulations share. The
+///               tracer itself holds no state, so several runs may share it
+///               as long as each has a context of its own.
+///
+/// @limitations  A context may only be used by one run at a time.
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SMCTSContext
+{
+    SMCTSContext( const STraceConfig &conf, const QAtomicInt *cancel = NULL );
+    ~SMCTSContext();
+
+    bool isCancelled() const;
+
+    STraceConfig        s_conf;
+    // The run stops early once this is set to non-zero. May be NULL.
+    const QAtomicInt   *s_cancel;
+
+    QThreadPool         s_pool;
+    SMCTSNode          *s_root;
+    int                 s_playouts;
+    int                 s_snapshotInterval;
+
+    QAtomicInt          s_started;
+    QAtomicInt          s_completed;
+    QAtomicInt          s_nodeCount;
+    // Lowest and highest simulation results so far, as float bits. They scale
+    // the exploration term to the values found in the tree.
+    QAtomicInt          s_lowValue;
+    QAtomicInt          s_highValue;
+
+    QMutex              s_snapshotMutex;
+    QList<SMCTSSnapshot> s_snapshots;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CMCTSTracer
+///
+/// @description  This class runs UCT Monte Carlo Tree Search. Each simulation
+///               walks down the search tree picking children by UCB1, adds
+///               the children of the node it stops at, plays randomly to an
+///               end point and backs the value up the path. Several threads
+///               share the one search tree and use virtual loss to spread out
+///               over it.
+///
+///               Rather than a line per simulation, the trace shows the
+///               statistics of the children of the root at regular intervals,
+///               so the answer can be read at any point of the search.
+///               The state of a run is kept in an SMCTSContext.
+///
+/// @limitations  The result is an estimate. It approaches the minimax value
+///               as the number of playouts grows.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CMCTSTracer
+{
+public:
+    CMCTSTracer();
+
+    STreeTrace *trace( const STreeNode *rootNode, int depthLimit, int qsDepth,
+                       const STraceConfig &traceConf ) const;
+    STreeTrace *trace( const STreeNode *rootNode, int depthLimit, int qsDepth,
+                       SMCTSContext &context ) const;
+
+private:
+    friend class CMCTSWorker;
+
+    void runWorker( SMCTSContext &context, quint32 seed ) const;
+    float simulate( SMCTSContext &context, quint32 &seed ) const;
+    SMCTSNode *select( const SMCTSContext &context,
+                       const SMCTSNode *node ) const;
+    void expand( SMCTSContext &context, SMCTSNode *node ) const;
+    float rollout( const SMCTSNode *node, quint32 &seed ) const;
+    void takeSnapshot( SMCTSContext &context, int playouts ) const;
+};
+
+#endif//_CMCTSTRACER_H_
@@ -0,0 +1,746 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CPNTracer.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the CPNTracer
+///               class. It solves win/loss game trees with proof-number
+///               search.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CPNTracer.h"
+#include <QVector>
+#define INF 10000
+// Proof and disproof numbers can grow far beyond INF, so they have their own.
+#define PN_INF 100000000
+
+// Adds two proof numbers, keeping the sum at PN_INF at most.
+static int pnAdd( int a, int b )
+{
+    if( a >= PN_INF - b )
+        return PN_INF;
+    return a + b;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::CPNTracer
+///
+/// @description    This is the constructor of the CPNTracer class.
+/// @pre            None
+/// @post           Object is created.
+///
+/// @param          None.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+CPNTracer::CPNTracer()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::trace
+///
+/// @description    Runs a trace on the root node with a context of its own.
+/// @pre            rootNode points to node trace from.
+/// @post           returns trace.
+///
+/// @param rootNode: Node to trace from.
+///        depthLimit: Depth Limit.
+///        qsDepth: Quiessance depth.
+///        traceConf: struct with trace parameters.
+///
+/// @return STreeTrace *: Pointer to tree trace.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+STreeTrace *CPNTracer::trace( const STreeNode *rootNode, int depthLimit,
+                              int qsDepth,
+                              const STraceConfig &traceConf ) const
+{
+    SPNContext context( traceConf );
+    return trace( rootNode, depthLimit, qsDepth, context );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::trace
+///
+/// @description    Solves the root node with proof-number search or df-pn and
+///                 builds a trace of the search. All of the state of the run
+///                 is kept in context.
+/// @pre            rootNode points to node trace from.
+/// @post           returns trace.
+///
+/// @param rootNode: Node to trace from.
+///        depthLimit: Depth Limit.
+///        qsDepth: Quiessance depth.
+///        context: State of the run, with the trace parameters.
+///
+/// @return STreeTrace *: Pointer to tree trace.
+///
+/// @limitations    A cancelled trace is incomplete and its result is
+///                 neither proved nor disproved.
+///
+////////////////////////////////////////////////////////////////////////////////
+STreeTrace *CPNTracer::trace( const STreeNode *rootNode, int depthLimit,
+                              int qsDepth, SPNContext &context ) const
+{
+    const STraceConfig &traceConf = context.s_conf;
+
+    STreeTrace *newTrace = new STreeTrace;
+    if( traceConf.s_isDFPN )
+        newTrace->s_columnNames =
+            QString("call|thresholds|pn,dn").split('|');
+    else
+        newTrace->s_columnNames =
+            QString("step|most proving|path|pn,dn|root pn,dn").split('|');
+
+    if( rootNode == NULL )
+        return newTrace;
+    if( rootNode->s_childList.isEmpty() )
+        return newTrace;
+
+    int depth = traceConf.s_isDL ? depthLimit : INF;
+    if( !traceConf.s_isQS )
+        qsDepth = 0;
+
+    context.s_nodeCount = 0;
+
+    if( traceConf.s_isDFPN )
+        dfpnSearch( context, newTrace, rootNode, depth, qsDepth );
+    else
+        pnSearch( context, newTrace, rootNode, depth, qsDepth );
+
+    newTrace->s_nodeCount = context.s_nodeCount;
+    return newTrace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::pnSearch
+///
+/// @description    Solves the root with proof-number search. Each step
+///                 expands the most-proving node and updates the numbers of
+///                 its ancestors, until the root is proved or disproved or
+///                 the trace is cancelled.
+/// @pre            rootNode has children.
+/// @post           A line for each step and the result are added to trace.
+///
+/// @param context: State of the run.
+///        trace:   Trace to add to.
+///        rootNode: Node to solve.
+///        depth:   Depth Limit.
+///        qsDepth: Quiessance depth.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPNTracer::pnSearch( SPNContext &context, STreeTrace *trace,
+                          const STreeNode *rootNode,
+                          int depth, int qsDepth ) const
+{
+    SPNNode *root = new SPNNode( rootNode, NULL, depth, qsDepth, true );
+    context.s_nodeCount = 1;
+
+    STreeCall *steps = new STreeCall;
+    SPNNode *mostProving;
+    SPNNode *curNode;
+    QString path;
+    SGeneralMLine *curLine;
+    for( int step = 1;
+         root->s_pn != 0 && root->s_dn != 0 && !context.isCancelled();
+         ++step )
+    {
+        mostProving = selectMostProving( root );
+        expand( context, mostProving );
+
+        // Numbers only change along the path back to the root, and stop
+        // changing at the first ancestor whose numbers stay the same.
+        int pn, dn;
+        for( curNode = mostProving; curNode != NULL;
+             curNode = curNode->s_parent )
+        {
+            pn = curNode->s_pn;
+            dn = curNode->s_dn;
+            setNumbers( curNode );
+            if( curNode != mostProving
+                && pn == curNode->s_pn && dn == curNode->s_dn )
+                break;
+        }
+
+        path = QString();
+        for( curNode = mostProving; curNode != NULL;
+             curNode = curNode->s_parent )
+            path.prepend( curNode->s_node->s_name + " " );
+
+        curLine = new SGeneralMLine;
+        curLine->s_cells << QString::number( step )
+                         << mostProving->s_node->s_name
+                         << path.trimmed()
+                         << QString("%1,%2")
+                                .arg( numberToString( mostProving->s_pn ) )
+                                .arg( numberToString( mostProving->s_dn ) )
+                         << QString("%1,%2")
+                                .arg( numberToString( root->s_pn ) )
+                                .arg( numberToString( root->s_dn ) );
+        steps->s_lines.append( curLine );
+    }
+    steps->s_returnValue = (root->s_pn == 0) ? 1 : 0;
+    trace->s_depths.append( steps );
+
+    STreeCall *result = new STreeCall;
+    curLine = new SGeneralMLine;
+    curLine->s_cells << "result"
+                     << resultString( root->s_pn, root->s_dn )
+                     << "" << "" << "";
+    result->s_lines.append( curLine );
+    result->s_returnValue = steps->s_returnValue;
+    trace->s_depths.append( result );
+
+    delete root;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::selectMostProving
+///
+/// @description    Walks down from a node to the most-proving node. At a max
+///                 node it follows the child with the smallest proof number,
+///                 at a min node the child with the smallest disproof number.
+/// @pre            node is not solved.
+/// @post           None
+///
+/// @param node:    Node to start from.
+///
+/// @return SPNNode *: Unexpanded node to expand next.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SPNNode *CPNTracer::selectMostProving( SPNNode *node ) const
+{
+    SPNNode *best;
+    SPNNode *child;
+    while( node->s_expanded )
+    {
+        best = NULL;
+        foreach( child, node->s_children )
+        {
+            if( best == NULL
+                || (node->s_max && child->s_pn < best->s_pn)
+                || (!node->s_max && child->s_dn < best->s_dn) )
+                best = child;
+        }
+        node = best;
+    }
+    return node;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::expand
+///
+/// @description    Adds the children of a node to the tree kept in memory.
+///                 End points are evaluated straight away.
+/// @pre            node is not an end point and has not been expanded.
+/// @post           node->s_children holds a node for each child.
+///
+/// @param context: State of the run.
+///        node:    Node to expand.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPNTracer::expand( SPNContext &context, SPNNode *node ) const
+{
+    int depth, qsDepth;
+    SPNNode *child;
+    STreeNode *curNode;
+    foreach( curNode, node->s_node->s_childList )
+    {
+        depth = node->s_depth;
+        qsDepth = node->s_qsDepth;
+        // Depth only runs down when the search is depth limited.
+        if( depth != INF && depth > 0 )
+            depth--;
+        else if( depth != INF )
+            qsDepth--;
+
+        child = new SPNNode( curNode, node, depth, qsDepth, !node->s_max );
+        if( isEndPoint( curNode, depth, qsDepth ) )
+            evaluate( context, curNode, child->s_pn, child->s_dn );
+        node->s_children.append( child );
+    }
+    node->s_expanded = true;
+    context.s_nodeCount += node->s_children.count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::setNumbers
+///
+/// @description    Works out the proof and disproof numbers of an expanded
+///                 node from its children. A max node needs one child proved
+///                 but every child disproved, a min node the reverse.
+/// @pre            None
+/// @post           The numbers of node are updated if it has been expanded.
+///
+/// @param node:    Node to update.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPNTracer::setNumbers( SPNNode *node ) const
+{
+    if( !node->s_expanded )
+        return;
+
+    SPNNode *child;
+    if( node->s_max )
+    {
+        node->s_pn = PN_INF;
+        node->s_dn = 0;
+        foreach( child, node->s_children )
+        {
+            node->s_pn = qMin( node->s_pn, child->s_pn );
+            node->s_dn = pnAdd( node->s_dn, child->s_dn );
+        }
+    }
+    else
+    {
+        node->s_pn = 0;
+        node->s_dn = PN_INF;
+        foreach( child, node->s_children )
+        {
+            node->s_pn = pnAdd( node->s_pn, child->s_pn );
+            node->s_dn = qMin( node->s_dn, child->s_dn );
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::dfpnSearch
+///
+/// @description    Solves the root with depth-first proof-number search.
+/// @pre            rootNode has children.
+/// @post           A line for each call and the result are added to trace.
+///
+/// @param context: State of the run.
+///        trace:   Trace to add to.
+///        rootNode: Node to solve.
+///        depth:   Depth Limit.
+///        qsDepth: Quiessance depth.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPNTracer::dfpnSearch( SPNContext &context, STreeTrace *trace,
+                            const STreeNode *rootNode,
+                            int depth, int qsDepth ) const
+{
+    context.s_transTable.clear();
+
+    STreeCall *calls = new STreeCall;
+    int pn, dn;
+    mid( context, calls, rootNode, depth, qsDepth, true, PN_INF, PN_INF,
+         pn, dn );
+    calls->s_returnValue = (pn == 0) ? 1 : 0;
+    trace->s_depths.append( calls );
+
+    STreeCall *result = new STreeCall;
+    SGeneralMLine *curLine = new SGeneralMLine;
+    curLine->s_cells << "result"
+                     << resultString( pn, dn )
+                     << "";
+    result->s_lines.append( curLine );
+    result->s_returnValue = calls->s_returnValue;
+    trace->s_depths.append( result );
+
+    context.s_transTable.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::mid
+///
+/// @description    Searches a node until its proof number reaches thpn or its
+///                 disproof number reaches thdn. Each time round it searches
+///                 the child a proof-number search would pick, with
+///                 thresholds that send it back as soon as another child
+///                 would be picked instead. It also returns early if the
+///                 trace is cancelled.
+/// @pre            node is not an end point.
+/// @post           A line for the call, and for each call below it, is added
+///                 to call. The numbers found are stored in the transposition
+///                 table of context.
+///
+/// @param context: State of the run.
+///        call:    Call to add lines to.
+///        node:    Node to search.
+///        depth:   Remaining depth at the node.
+///        qsDepth: Remaining quiessence depth at the node.
+///        max:     true if this is a max node, false for a min.
+///        thpn:    Proof number threshold.
+///        thdn:    Disproof number threshold.
+///        pn:      Receives the proof number of node.
+///        dn:      Receives the disproof number of node.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPNTracer::mid( SPNContext &context, STreeCall *call,
+                     const STreeNode *node, int depth, int qsDepth, bool max,
+                     int thpn, int thdn, int &pn, int &dn ) const
+{
+    context.s_nodeCount++;
+
+    QString depthString;
+    if( depth != INF )
+        depthString = QString(",%1").arg(depth);
+
+    SGeneralMLine *curLine = new SGeneralMLine;
+    curLine->s_cells << QString("%1(%2%3)")
+                            .arg( max ? "OR" : "AND" )
+                            .arg( node->s_name )
+                            .arg( depthString )
+                     << QString("%1,%2")
+                            .arg( numberToString( thpn ) )
+                            .arg( numberToString( thdn ) )
+                     << "";
+    call->s_lines.append( curLine );
+
+    const QList<STreeNode *> &children = node->s_childList;
+    int count = children.count();
+    QVector<int> childPn( count );
+    QVector<int> childDn( count );
+    QVector<int> childDepth( count );
+    QVector<int> childQSDepth( count );
+    for( int i = 0; i < count; ++i )
+    {
+        childDepth[i] = depth;
+        childQSDepth[i] = qsDepth;
+        if( depth != INF && depth > 0 )
+            childDepth[i]--;
+        else if( depth != INF )
+            childQSDepth[i]--;
+        lookup( context, children.at(i), childDepth[i], childQSDepth[i],
+                childPn[i], childDn[i] );
+    }
+
+    int best, second;
+    int childThpn, childThdn;
+    for(;;)
+    {
+        // A max node is an OR of its children and a min node an AND.
+        best = 0;
+        second = PN_INF;
+        if( max )
+        {
+            pn = PN_INF;
+            dn = 0;
+            for( int i = 0; i < count; ++i )
+            {
+                dn = pnAdd( dn, childDn[i] );
+                if( childPn[i] < childPn[best] )
+                    best = i;
+            }
+            pn = childPn[best];
+            for( int i = 0; i < count; ++i )
+                if( i != best )
+                    second = qMin( second, childPn[i] );
+        }
+        else
+        {
+            pn = 0;
+            dn = PN_INF;
+            for( int i = 0; i < count; ++i )
+            {
+                pn = pnAdd( pn, childPn[i] );
+                if( childDn[i] < childDn[best] )
+                    best = i;
+            }
+            dn = childDn[best];
+            for( int i = 0; i < count; ++i )
+                if( i != best )
+                    second = qMin( second, childDn[i] );
+        }
+
+        if( pn >= thpn || dn >= thdn || context.isCancelled() )
+            break;
+
+        if( max )
+        {
+            childThpn = qMin( thpn, pnAdd( second, 1 ) );
+            childThdn = (thdn >= PN_INF) ? PN_INF
+                                         : pnAdd( thdn - dn, childDn[best] );
+        }
+        else
+        {
+            childThpn = (thpn >= PN_INF) ? PN_INF
+                                         : pnAdd( thpn - pn, childPn[best] );
+            childThdn = qMin( thdn, pnAdd( second, 1 ) );
+        }
+        mid( context, call, children.at(best),
+             childDepth[best], childQSDepth[best],
+             !max, childThpn, childThdn, childPn[best], childDn[best] );
+    }
+
+    // Once the table is full only nodes already in it are updated, so the
+    // memory used stays bounded however large the tree is.
+    if( context.s_transTable.count() < MaxTTSize
+        || context.s_transTable.contains( node ) )
+    {
+        SPNEntry entry;
+        entry.s_pn = pn;
+        entry.s_dn = dn;
+        context.s_transTable.insert( node, entry );
+    }
+
+    curLine->s_cells[2] = QString("%1,%2")
+                              .arg( numberToString( pn ) )
+                              .arg( numberToString( dn ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::lookup
+///
+/// @description    Finds the best known proof and disproof numbers of a node
+///                 without searching it.
+/// @pre            None
+/// @post           None
+///
+/// @param context: State of the run.
+///        node:    Node to look up.
+///        depth:   Remaining depth at the node.
+///        qsDepth: Remaining quiessence depth at the node.
+///        pn:      Receives the proof number.
+///        dn:      Receives the disproof number.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPNTracer::lookup( const SPNContext &context, const STreeNode *node,
+                        int depth, int qsDepth, int &pn, int &dn ) const
+{
+    if( isEndPoint( node, depth, qsDepth ) )
+    {
+        evaluate( context, node, pn, dn );
+        return;
+    }
+
+    QHash<const STreeNode*, SPNEntry>::const_iterator it =
+        context.s_transTable.constFind( node );
+    if( it != context.s_transTable.constEnd() )
+    {
+        pn = it.value().s_pn;
+        dn = it.value().s_dn;
+        return;
+    }
+
+    pn = 1;
+    dn = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::isEndPoint
+///
+/// @description    Checks if a node is evaluated rather than searched.
+/// @pre            None
+/// @post           None
+///
+/// @param node:    Node to check.
+///        depth:   Remaining depth at the node.
+///        qsDepth: Remaining quiessence depth at the node.
+///
+/// @return bool:   true if the node is an end point.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CPNTracer::isEndPoint( const STreeNode *node, int depth,
+                            int qsDepth ) const
+{
+    return (node->s_childList.count() == 0)
+           || (depth == 0 && (!node->s_quiescent || qsDepth == 0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::evaluate
+///
+/// @description    Gives the proof and disproof numbers of an end point: it
+///                 is proved if its value is above the threshold and
+///                 disproved otherwise.
+/// @pre            node is an end point.
+/// @post           None
+///
+/// @param context: State of the run.
+///        node:    End point to evaluate.
+///        pn:      Receives the proof number.
+///        dn:      Receives the disproof number.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CPNTracer::evaluate( const SPNContext &context, const STreeNode *node,
+                          int &pn, int &dn ) const
+{
+    if( node->s_value > context.s_conf.s_proofThreshold )
+    {
+        pn = 0;
+        dn = PN_INF;
+    }
+    else
+    {
+        pn = PN_INF;
+        dn = 0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::numberToString
+///
+/// @description    Converts a proof or disproof number to a string.
+/// @pre            None
+/// @post           None
+///
+/// @param n:       Number to convert.
+///
+/// @return QString: The number, or INF if it is infinite.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+QString CPNTracer::numberToString( int n )
+{
+    if( n >= PN_INF )
+        return QString("INF");
+    return QString::number(n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer::resultString
+///
+/// @description    Describes what the search found out about the root.
+/// @pre            None
+/// @post           None
+///
+/// @param pn:      Proof number of the root.
+///        dn:      Disproof number of the root.
+///
+/// @return QString: proved, disproved, or cancelled if the search was
+///                  stopped before either.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+QString CPNTracer::resultString( int pn, int dn )
+{
+    if( pn == 0 )
+        return QString("proved");
+    if( dn == 0 )
+        return QString("disproved");
+    return QString("cancelled");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPNContext::SPNContext
+///
+/// @description    This is the constructor of the SPNContext struct.
+/// @pre            None
+/// @post           The context is ready for a run.
+///
+/// @param conf:    The trace parameters.
+///        cancel:  Set to non zero to stop the run early, or NULL.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SPNContext::SPNContext( const STraceConfig &conf, const QAtomicInt *cancel )
+{
+    s_conf = conf;
+    s_cancel = cancel;
+    s_nodeCount = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPNContext::isCancelled
+///
+/// @description    Checks the cancellation token of the run.
+/// @pre            None
+/// @post           None
+///
+/// @param          None.
+///
+/// @return bool:   true if the run has been asked to stop.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool SPNContext::isCancelled() const
+{
+    return s_cancel != NULL && (int)*s_cancel != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPNNode::SPNNode
+///
+/// @description    This is the constructor of the SPNNode struct.
+/// @pre            node points to a node of the game tree.
+/// @post           Object is created as an unexpanded node.
+///
+/// @param node:    Node of the game tree.
+///        parent:  Parent in the tree kept in memory, or NULL for the root.
+///        depth:   Remaining depth at the node.
+///        qsDepth: Remaining quiessence depth at the node.
+///        max:     true if max is to move at the node.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SPNNode::SPNNode( const STreeNode *node, SPNNode *parent,
+                  int depth, int qsDepth, bool max )
+{
+    s_node = node;
+    s_parent = parent;
+    s_depth = depth;
+    s_qsDepth = qsDepth;
+    s_max = max;
+    s_expanded = false;
+    s_pn = 1;
+    s_dn = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPNNode::~SPNNode
+///
+/// @description    This is the destructor of the SPNNode struct.
+/// @pre            None
+/// @post           The children are deleted.
+///
+/// @param          None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SPNNode::~SPNNode()
+{
+    while( !s_children.isEmpty() )
+        delete s_children.takeFirst();
+}
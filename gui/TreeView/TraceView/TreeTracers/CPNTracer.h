@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CPNTracer.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the CPNTracer class.
+///               It solves win/loss game trees with proof-number search.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CPNTRACER_H_
+#define _CPNTRACER_H_
+
+#include "../../STreeTrace.h"
+#include "../../CTreeGraph.h"
+#include "CGeneralMTracer.h"
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPNNode
+///
+/// @description  A node of the tree kept in memory by proof-number search.
+///               The proof number is the least number of end points that
+///               must be shown to be wins for max to prove the node a win,
+///               and the disproof number the least that must be shown to be
+///               losses to disprove it.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SPNNode
+{
+    SPNNode( const STreeNode *node, SPNNode *parent,
+             int depth, int qsDepth, bool max );
+    ~SPNNode();
+
+    const STreeNode    *s_node;
+    SPNNode            *s_parent;
+    QList<SPNNode *>    s_children;
+    int                 s_depth;
+    int                 s_qsDepth;
+    bool                s_max;
+    bool                s_expanded;
+
+    int                 s_pn;
+    int                 s_dn;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPNEntry
+///
+/// @description  An entry of the df-pn transposition table.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SPNEntry
+{
+    int                 s_pn;
+    int                 s_dn;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SPNContext
+///
+/// @description  Everything that belongs to one run of CPNTracer: the
+///               configuration, the cancellation token, the node count and
+///               the df-pn transposition table. The tracer itself holds no
+///               state, so several runs may share it as long as each has a
+///               context of its own.
+///
+/// @limitations  A context may only be used by one run at a time.
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SPNContext
+{
+    SPNContext( const STraceConfig &conf, const QAtomicInt *cancel = NULL );
+
+    bool isCancelled() const;
+
+    STraceConfig        s_conf;
+    // The run stops early once this is set to non-zero. May be NULL.
+    const QAtomicInt   *s_cancel;
+
+    int                 s_nodeCount;
+    QHash<const STreeNode*, SPNEntry> s_transTable;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CPNTracer
+///
+/// @description  This class solves a tree where max either wins or does not:
+///               an end point is a win for max if its value is above the
+///               threshold and a loss otherwise. Two searches are available:
+///
+///               Proof-number search keeps the searched tree in memory and
+///               each step expands the most-proving node, the end point that
+///               does most to settle the root. The trace has a line for each
+///               step.
+///
+///               Depth-first proof-number search (df-pn) gets the same
+///               order with a depth-first search and a transposition table
+///               of bounded size. The trace has a line for each call, with
+///               the thresholds it was given.
+///
+///               The state of a run is kept in an SPNContext.
+///
+/// @limitations  Only the result is found, not the value of the root.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CPNTracer
+{
+public:
+    CPNTracer();
+
+    STreeTrace *trace( const STreeNode *rootNode, int depthLimit, int qsDepth,
+                       const STraceConfig &traceConf ) const;
+    STreeTrace *trace( const STreeNode *rootNode, int depthLimit, int qsDepth,
+                       SPNContext &context ) const;
+
+private:
+    void pnSearch( SPNContext &context, STreeTrace *trace,
+                   const STreeNode *rootNode, int depth, int qsDepth ) const;
+    SPNNode *selectMostProving( SPNNode *node ) const;
+    void expand( SPNContext &context, SPNNode *node ) const;
+    void setNumbers( SPNNode *node ) const;
+
+    void dfpnSearch( SPNContext &context, STreeTrace *trace,
+                     const STreeNode *rootNode, int depth, int qsDepth ) const;
+    void mid( SPNContext &context, STreeCall *call, const STreeNode *node,
+              int depth, int qsDepth, bool max, int thpn, int thdn,
+              int &pn, int &dn ) const;
+    void lookup( const SPNContext &context, const STreeNode *node,
+                 int depth, int qsDepth, int &pn, int &dn ) const;
+
+    bool isEndPoint( const STreeNode *node, int depth, int qsDepth ) const;
+    void evaluate( const SPNContext &context, const STreeNode *node,
+                   int &pn, int &dn ) const;
+    static QString numberToString( int n );
+    static QString resultString( int pn, int dn );
+
+    // Most entries the df-pn transposition table may hold.
+    enum { MaxTTSize = 65536 };
+};
+
+#endif//_CPNTRACER_H_
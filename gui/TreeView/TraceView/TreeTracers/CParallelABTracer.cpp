@@ -0,0 +1,873 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CParallelABTracer.cpp
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the implementation of the
+///               CParallelABTracer class. It solves a game tree with a
+///               multi-threaded alpha beta search and reports how it compares
+///               to a single thread.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CParallelABTracer.h"
+#include <QRunnable>
+#include <QThread>
+#include <QTime>
+#include <QWaitCondition>
+#define INF 10000
+// Nodes with less remaining depth than this are not worth sharing out.
+#define MIN_SPLIT_DEPTH 2
+
+////////////////////////////////////////////////////////////////////////////////
+/// SSplitPoint
+///
+/// @description  A node whose younger children are being searched by several
+///               threads at once. Everything but s_cutoff is guarded by
+///               s_mutex.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SSplitPoint
+{
+    // The split point the node itself is being searched under, if any.
+    SSplitPoint        *s_parent;
+
+    QList<STreeNode *>  s_children;
+    int                 s_next;
+    int                 s_depth;
+    int                 s_qsDepth;
+    bool                s_max;
+
+    float               s_alpha;
+    float               s_beta;
+    float               s_bestValue;
+    const STreeNode    *s_bestChild;
+
+    // Set once a child fails high; the remaining children are abandoned.
+    QAtomicInt          s_cutoff;
+
+    int                 s_helpers;
+    QMutex              s_mutex;
+    QWaitCondition      s_helpersDone;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CSplitPointHelper
+///
+/// @description  Runs on a pool thread and searches children of a split point
+///               until none are left.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CSplitPointHelper : public QRunnable
+{
+public:
+    CSplitPointHelper( const CParallelABTracer *tracer,
+                       SParallelContext *context, SSplitPoint *sp )
+        : m_tracer( tracer ), m_context( context ), m_sp( sp ) {}
+
+    void run()
+    {
+        int nodes = 0;
+        m_tracer->searchSplitPoint( *m_context, m_sp, nodes );
+        m_tracer->addWorkerNodes( *m_context, nodes );
+
+        QMutexLocker locker( &m_sp->s_mutex );
+        m_sp->s_helpers--;
+        m_sp->s_helpersDone.wakeAll();
+    }
+
+private:
+    const CParallelABTracer *m_tracer;
+    SParallelContext        *m_context;
+    SSplitPoint             *m_sp;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CLazySMPHelper
+///
+/// @description  Runs on a pool thread and repeats the iterative deepening
+///               search of the main thread, filling the shared transposition
+///               table, until the main thread is done.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+class CLazySMPHelper : public QRunnable
+{
+public:
+    CLazySMPHelper( const CParallelABTracer *tracer, SParallelContext *context,
+                    const STreeNode *rootNode, int depth, int qsDepth, int id )
+        : m_tracer( tracer ), m_context( context ), m_rootNode( rootNode ),
+          m_depth( depth ), m_qsDepth( qsDepth ), m_id( id ) {}
+
+    void run()
+    {
+        int nodes = 0;
+        // Each helper tries the root children in a different order so they
+        // do not all search the same subtrees.
+        for( int d = 1; d <= m_depth && !m_context->s_stop; ++d )
+            m_tracer->searchNode( *m_context, m_rootNode, d, m_qsDepth,
+                                  -INF, INF, true, NULL, nodes, NULL, m_id );
+        m_tracer->addWorkerNodes( *m_context, nodes );
+    }
+
+private:
+    const CParallelABTracer *m_tracer;
+    SParallelContext        *m_context;
+    const STreeNode         *m_rootNode;
+    int                      m_depth;
+    int                      m_qsDepth;
+    int                      m_id;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::CParallelABTracer
+///
+/// @description    This is the constructor of the CParallelABTracer class.
+/// @pre            None
+/// @post           Object is created.
+///
+/// @param          None.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+CParallelABTracer::CParallelABTracer()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::trace
+///
+/// @description    Runs a trace on the root node with a context of its own.
+/// @pre            rootNode points to node trace from.
+/// @post           returns trace.
+///
+/// @param rootNode: Node to trace from.
+///        depthLimit: Depth Limit.
+///        qsDepth: Quiessance depth.
+///        traceConf: struct with trace parameters.
+///
+/// @return STreeTrace *: Pointer to tree trace.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+STreeTrace *CParallelABTracer::trace( const STreeNode *rootNode,
+    int depthLimit, int qsDepth, const STraceConfig &traceConf ) const
+{
+    SParallelContext context( traceConf );
+    return trace( rootNode, depthLimit, qsDepth, context );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::trace
+///
+/// @description    Searches the root node with one thread and then with the
+///                 configured number of threads, and builds a trace comparing
+///                 the two. All of the state of the run is kept in context.
+/// @pre            rootNode points to node trace from.
+/// @post           returns trace.
+///
+/// @param rootNode: Node to trace from.
+///        depthLimit: Depth Limit.
+///        qsDepth: Quiessance depth.
+///        context: State of the run, with the trace parameters.
+///
+/// @return STreeTrace *: Pointer to tree trace.
+///
+/// @limitations    A cancelled trace is incomplete.
+///
+////////////////////////////////////////////////////////////////////////////////
+STreeTrace *CParallelABTracer::trace( const STreeNode *rootNode,
+    int depthLimit, int qsDepth, SParallelContext &context ) const
+{
+    const STraceConfig &traceConf = context.s_conf;
+
+    STreeTrace *newTrace = new STreeTrace;
+    newTrace->s_columnNames =
+        QString("search|threads|value|best action|nodes|time (ms)"
+                "|speedup|overhead").split('|');
+
+    if( rootNode == NULL )
+        return newTrace;
+    if( rootNode->s_childList.isEmpty() )
+        return newTrace;
+
+    SParallelContext::Mode mode = traceConf.s_isLazySMP
+                                  ? SParallelContext::LazySMP
+                                  : SParallelContext::YoungBrothersWait;
+    int depth = traceConf.s_isDL ? depthLimit : INF;
+    if( !traceConf.s_isQS )
+        qsDepth = 0;
+    int threads = qMax( 1, traceConf.s_threads );
+
+    SParallelResult serial = search( context, rootNode, depth, qsDepth,
+                                     mode, 1 );
+    // Only the cancel token is checked here, since a Lazy SMP search sets
+    // s_stop when it finishes to send its helpers home.
+    if( context.isCancelled() )
+        return newTrace;
+    SParallelResult parallel = search( context, rootNode, depth, qsDepth,
+                                       mode, threads );
+
+    QString name = (mode == SParallelContext::LazySMP) ? "Lazy SMP" : "YBWC";
+    QString call = QString("(%1").arg(rootNode->s_name);
+    if( traceConf.s_isDL )
+        call += QString(",%1").arg(depth);
+    if( traceConf.s_isQS )
+        call += QString(",%1").arg(qsDepth);
+    call += ")";
+
+    QString speedup = "-";
+    if( parallel.s_time > 0 )
+        speedup = QString::number( (float)serial.s_time / parallel.s_time,
+                                   'f', 2 ) + "x";
+    QString overhead = "-";
+    if( serial.s_nodes > 0 )
+        overhead = QString::number( 100.0 * (parallel.s_nodes - serial.s_nodes)
+                                    / serial.s_nodes, 'f', 1 ) + "%";
+
+    STreeCall *summary = new STreeCall;
+    SGeneralMLine *curLine;
+
+    curLine = new SGeneralMLine;
+    curLine->s_cells << name + call
+                     << "1"
+                     << SGeneralMLine::numberToString( serial.s_value )
+                     << CGeneralMTracer::moveName( serial.s_bestAction )
+                     << QString::number( serial.s_nodes )
+                     << QString::number( serial.s_time )
+                     << "1.00x"
+                     << "-";
+    summary->s_lines.append( curLine );
+
+    curLine = new SGeneralMLine;
+    curLine->s_cells << name + call
+                     << QString::number( threads )
+                     << SGeneralMLine::numberToString( parallel.s_value )
+                     << CGeneralMTracer::moveName( parallel.s_bestAction )
+                     << QString::number( parallel.s_nodes )
+                     << QString::number( parallel.s_time )
+                     << speedup
+                     << overhead;
+    summary->s_lines.append( curLine );
+    newTrace->s_depths.append( summary );
+
+    // One line per thread shows how evenly the work was shared.
+    STreeCall *workers = new STreeCall;
+    for( int i = 0; i < parallel.s_workerNodes.count(); ++i )
+    {
+        curLine = new SGeneralMLine;
+        curLine->s_cells << QString("thread %1").arg(i + 1)
+                         << "" << "" << ""
+                         << QString::number( parallel.s_workerNodes.at(i) )
+                         << "" << "" << "";
+        workers->s_lines.append( curLine );
+    }
+    newTrace->s_depths.append( workers );
+
+    newTrace->s_nodeCount = parallel.s_nodes;
+    return newTrace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::search
+///
+/// @description    Searches the root node with the given scheme and number of
+///                 threads.
+/// @pre            rootNode points to a node with children.
+/// @post           None
+///
+/// @param context: State of the run.
+///        rootNode: Node to search from.
+///        depth:   Depth Limit.
+///        qsDepth: Quiessance depth.
+///        mode:    Scheme used to share the search between threads.
+///        threads: Number of threads, including the calling thread.
+///
+/// @return SParallelResult: Value, best action, node counts and time taken.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SParallelResult CParallelABTracer::search( SParallelContext &context,
+                                           const STreeNode *rootNode,
+                                           int depth, int qsDepth,
+                                           SParallelContext::Mode mode,
+                                           int threads ) const
+{
+    SParallelResult result;
+
+    context.s_mode = mode;
+    context.s_threads = threads;
+    context.s_stop = 0;
+    context.s_pool.setMaxThreadCount( qMax( 1, threads - 1 ) );
+    context.s_workerThreads.clear();
+    context.s_workerNodes.clear();
+    for( int i = 0; i < SParallelContext::TTShards; ++i )
+        context.s_transTable[i].clear();
+
+    // The calling thread is always listed first.
+    context.s_workerThreads.append( QThread::currentThread() );
+    context.s_workerNodes.append( 0 );
+
+    QTime timer;
+    timer.start();
+
+    int nodes = 0;
+    if( mode == SParallelContext::LazySMP )
+    {
+        int maxDepth = qMin( depth, treeHeight( rootNode ) );
+        for( int i = 1; i < threads; ++i )
+            context.s_pool.start( new CLazySMPHelper( this, &context, rootNode,
+                                                      maxDepth, qsDepth, i ) );
+
+        for( int d = 1; d <= maxDepth && !isAborted( context, NULL ); ++d )
+            result.s_value = searchNode( context, rootNode, d, qsDepth,
+                                         -INF, INF, true, NULL, nodes,
+                                         &result.s_bestAction, 0 );
+
+        context.s_stop = 1;
+    }
+    else
+    {
+        result.s_value = searchNode( context, rootNode, depth, qsDepth,
+                                     -INF, INF, true, NULL, nodes,
+                                     &result.s_bestAction, 0 );
+    }
+    addWorkerNodes( context, nodes );
+    context.s_pool.waitForDone();
+
+    result.s_time = timer.elapsed();
+    result.s_workerNodes = context.s_workerNodes;
+    int workerNodes;
+    foreach( workerNodes, context.s_workerNodes )
+        result.s_nodes += workerNodes;
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::searchNode
+///
+/// @description    Negamax alpha beta search of a node. Under Young Brothers
+///                 Wait the eldest child is searched first, and if it does
+///                 not cause a cutoff the rest are shared with idle threads.
+/// @pre            node has children.
+/// @post           nodes has been increased by the number of nodes examined.
+///
+/// @param context:   State of the run.
+///        node:      Node to search.
+///        depth:     Remaining depth.
+///        qsDepth:   Remaining quiessence depth.
+///        alpha:     Alpha value, from the point of view of the player to move.
+///        beta:      Beta value, from the point of view of the player to move.
+///        max:       true if this is a max node, false for a min.
+///        parent:    Innermost split point this search is part of, or NULL.
+///        nodes:     Counter of nodes examined by this thread.
+///        bestChild: If not NULL, receives the best child.
+///        rotate:    Number of places to rotate the child order by.
+///
+/// @return float:  Value of node from the point of view of the player to move.
+///                 Meaningless if the search was aborted.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+float CParallelABTracer::searchNode( SParallelContext &context,
+                                     const STreeNode *node, int depth,
+                                     int qsDepth, float alpha, float beta,
+                                     bool max, SSplitPoint *parent, int &nodes,
+                                     const STreeNode **bestChild,
+                                     int rotate ) const
+{
+    if( isAborted( context, parent ) )
+        return 0;
+
+    float origAlpha = alpha;
+    QList<STreeNode*> curChildren = node->s_childList;
+    int childCount = curChildren.count();
+
+    if( context.s_mode == SParallelContext::LazySMP )
+    {
+        SParallelTTEntry entry;
+        if( probeTT( context, node, depth, qsDepth, alpha, beta, entry ) )
+        {
+            if( bestChild != NULL )
+                *bestChild = entry.s_bestChild;
+            return entry.s_value;
+        }
+        int i = curChildren.indexOf( (STreeNode *)entry.s_bestChild );
+        if( i > 0 )
+            curChildren.move( i, 0 );
+    }
+    for( int i = rotate % childCount; i > 0; --i )
+        curChildren.append( curChildren.takeFirst() );
+
+    // The eldest brother is always searched alone.
+    const STreeNode *best = curChildren.first();
+    float bestValue = searchChild( context, best, depth, qsDepth,
+                                   alpha, beta, max, parent, nodes );
+    if( bestValue > alpha )
+        alpha = bestValue;
+
+    if( alpha < beta && !isAborted( context, parent ) && childCount > 1 )
+    {
+        if( context.s_mode == SParallelContext::YoungBrothersWait
+            && context.s_threads > 1 && depth >= MIN_SPLIT_DEPTH )
+        {
+            SSplitPoint sp;
+            sp.s_parent = parent;
+            sp.s_children = curChildren.mid( 1 );
+            sp.s_next = 0;
+            sp.s_depth = depth;
+            sp.s_qsDepth = qsDepth;
+            sp.s_max = max;
+            sp.s_alpha = alpha;
+            sp.s_beta = beta;
+            sp.s_bestValue = bestValue;
+            sp.s_bestChild = best;
+            sp.s_helpers = 0;
+
+            // Only threads that are idle right now are recruited, so this
+            // thread never waits on a helper that has not started.
+            int wanted = qMin( context.s_threads - 1,
+                               sp.s_children.count() - 1 );
+            for( int i = 0; i < wanted; ++i )
+            {
+                CSplitPointHelper *helper = new CSplitPointHelper( this,
+                                                                   &context,
+                                                                   &sp );
+                sp.s_mutex.lock();
+                sp.s_helpers++;
+                sp.s_mutex.unlock();
+                if( !context.s_pool.tryStart( helper ) )
+                {
+                    sp.s_mutex.lock();
+                    sp.s_helpers--;
+                    sp.s_mutex.unlock();
+                    delete helper;
+                    break;
+                }
+            }
+
+            searchSplitPoint( context, &sp, nodes );
+
+            sp.s_mutex.lock();
+            while( sp.s_helpers > 0 )
+                sp.s_helpersDone.wait( &sp.s_mutex );
+            bestValue = sp.s_bestValue;
+            best = sp.s_bestChild;
+            sp.s_mutex.unlock();
+        }
+        else
+        {
+            float value;
+            for( int i = 1; i < childCount && alpha < beta; ++i )
+            {
+                value = searchChild( context, curChildren.at(i), depth,
+                                     qsDepth, alpha, beta, max, parent,
+                                     nodes );
+                if( isAborted( context, parent ) )
+                    return 0;
+                if( value > bestValue )
+                {
+                    bestValue = value;
+                    best = curChildren.at(i);
+                    if( value > alpha )
+                        alpha = value;
+                }
+            }
+        }
+    }
+
+    if( isAborted( context, parent ) )
+        return 0;
+
+    if( context.s_mode == SParallelContext::LazySMP )
+        storeTT( context, node, depth, qsDepth, origAlpha, beta,
+                 bestValue, best );
+    if( bestChild != NULL )
+        *bestChild = best;
+    return bestValue;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::searchChild
+///
+/// @description    Finds the value of a child, either from its own value if
+///                 it is an end point or by searching it.
+/// @pre            None
+/// @post           nodes has been increased by the number of nodes examined.
+///
+/// @param context: State of the run.
+///        child:   Child to evaluate.
+///        depth:   Remaining depth at the child's parent.
+///        qsDepth: Remaining quiessence depth at the child's parent.
+///        alpha:   Alpha value of the parent.
+///        beta:    Beta value of the parent.
+///        max:     true if the parent is a max node, false for a min.
+///        parent:  Innermost split point this search is part of, or NULL.
+///        nodes:   Counter of nodes examined by this thread.
+///
+/// @return float:  Value of child from the point of view of its parent.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+float CParallelABTracer::searchChild( SParallelContext &context,
+                                      const STreeNode *child, int depth,
+                                      int qsDepth, float alpha, float beta,
+                                      bool max, SSplitPoint *parent,
+                                      int &nodes ) const
+{
+    nodes++;
+
+    if( depth > 0 )
+        depth--;
+    else
+        qsDepth--;
+
+    if( (child->s_childList.count() == 0)
+          ||(depth == 0 && (!child->s_quiescent || qsDepth == 0)) )
+        return max ? child->s_value : -child->s_value;
+
+    return -searchNode( context, child, depth, qsDepth, -beta, -alpha, !max,
+                        parent, nodes, NULL, 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::searchSplitPoint
+///
+/// @description    Takes children of a split point one at a time and searches
+///                 them with the latest bounds, until no children are left or
+///                 one of them causes a cutoff.
+/// @pre            sp points to a split point.
+/// @post           nodes has been increased by the number of nodes examined.
+///
+/// @param context: State of the run.
+///        sp:      Split point to work on.
+///        nodes:   Counter of nodes examined by this thread.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CParallelABTracer::searchSplitPoint( SParallelContext &context,
+                                          SSplitPoint *sp, int &nodes ) const
+{
+    const STreeNode *child;
+    float alpha, beta, value;
+    for(;;)
+    {
+        sp->s_mutex.lock();
+        if( sp->s_next >= sp->s_children.count()
+            || isAborted( context, sp ) )
+        {
+            sp->s_mutex.unlock();
+            return;
+        }
+        child = sp->s_children.at( sp->s_next++ );
+        alpha = sp->s_alpha;
+        beta = sp->s_beta;
+        sp->s_mutex.unlock();
+
+        value = searchChild( context, child, sp->s_depth, sp->s_qsDepth,
+                             alpha, beta, sp->s_max, sp, nodes );
+
+        QMutexLocker locker( &sp->s_mutex );
+        if( isAborted( context, sp ) )
+            return;
+        if( value > sp->s_bestValue )
+        {
+            sp->s_bestValue = value;
+            sp->s_bestChild = child;
+            if( value > sp->s_alpha )
+                sp->s_alpha = value;
+            if( sp->s_alpha >= sp->s_beta )
+                sp->s_cutoff = 1;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::isAborted
+///
+/// @description    Checks if the results of a search are no longer needed,
+///                 because one of the split points it is part of has had a
+///                 cutoff, the run has been cancelled or the search is over.
+/// @pre            None
+/// @post           None
+///
+/// @param context: State of the run.
+///        sp:      Innermost split point the search is part of, or NULL.
+///
+/// @return bool:   true if the search should be abandoned.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CParallelABTracer::isAborted( const SParallelContext &context,
+                                   const SSplitPoint *sp ) const
+{
+    for( ; sp != NULL; sp = sp->s_parent )
+        if( sp->s_cutoff )
+            return true;
+    if( context.isCancelled() )
+        return true;
+    return context.s_stop;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::probeTT
+///
+/// @description    Looks up node in the shared transposition table.
+/// @pre            None
+/// @post           entry holds the stored entry, or an empty one.
+///
+/// @param context: State of the run.
+///        node:    Node about to be searched.
+///        depth:   Remaining depth of the search.
+///        qsDepth: Remaining quiessence depth of the search.
+///        alpha:   Alpha value of the search.
+///        beta:    Beta value of the search.
+///        entry:   Receives the stored entry.
+///
+/// @return bool:   true if the stored value can be used instead of searching.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool CParallelABTracer::probeTT( SParallelContext &context,
+                                 const STreeNode *node, int depth,
+                                 int qsDepth, float alpha, float beta,
+                                 SParallelTTEntry &entry ) const
+{
+    int shard = qHash( node ) % SParallelContext::TTShards;
+    context.s_ttMutex[shard].lock();
+    entry = context.s_transTable[shard].value( node );
+    context.s_ttMutex[shard].unlock();
+
+    if( entry.s_bestChild == NULL )
+        return false;
+    if( entry.s_depth < depth || entry.s_qsDepth < qsDepth )
+        return false;
+    if( entry.s_bound == SParallelTTEntry::LowerBound && entry.s_value < beta )
+        return false;
+    if( entry.s_bound == SParallelTTEntry::UpperBound && entry.s_value > alpha )
+        return false;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::storeTT
+///
+/// @description    Records the result of searching node in the shared
+///                 transposition table, unless a deeper result is there.
+/// @pre            None
+/// @post           None
+///
+/// @param context:   State of the run.
+///        node:      Node that was searched.
+///        depth:     Remaining depth of the search.
+///        qsDepth:   Remaining quiessence depth of the search.
+///        alpha:     Alpha value the search was started with.
+///        beta:      Beta value the search was started with.
+///        value:     Value returned by the search.
+///        bestChild: Child that produced value.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CParallelABTracer::storeTT( SParallelContext &context,
+                                 const STreeNode *node, int depth, int qsDepth,
+                                 float alpha, float beta, float value,
+                                 const STreeNode *bestChild ) const
+{
+    SParallelTTEntry entry;
+    entry.s_depth = depth;
+    entry.s_qsDepth = qsDepth;
+    entry.s_value = value;
+    entry.s_bestChild = bestChild;
+    if( value <= alpha )
+        entry.s_bound = SParallelTTEntry::UpperBound;
+    else if( value >= beta )
+        entry.s_bound = SParallelTTEntry::LowerBound;
+    else
+        entry.s_bound = SParallelTTEntry::Exact;
+
+    int shard = qHash( node ) % SParallelContext::TTShards;
+    QMutexLocker locker( &context.s_ttMutex[shard] );
+    QHash<const STreeNode*, SParallelTTEntry>::iterator it =
+        context.s_transTable[shard].find( node );
+    if( it != context.s_transTable[shard].end() && it.value().s_depth > depth )
+        return;
+    context.s_transTable[shard].insert( node, entry );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::addWorkerNodes
+///
+/// @description    Adds nodes examined by the current thread to its total.
+/// @pre            None
+/// @post           The node counts of context have been updated.
+///
+/// @param context: State of the run.
+///        nodes:   Number of nodes examined.
+///
+/// @return         None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CParallelABTracer::addWorkerNodes( SParallelContext &context,
+                                        int nodes ) const
+{
+    QMutexLocker locker( &context.s_workerMutex );
+    QThread *thread = QThread::currentThread();
+    int i = context.s_workerThreads.indexOf( thread );
+    if( i < 0 )
+    {
+        context.s_workerThreads.append( thread );
+        context.s_workerNodes.append( nodes );
+    }
+    else
+        context.s_workerNodes[i] += nodes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer::treeHeight
+///
+/// @description    Finds the number of levels below a node.
+/// @pre            node points to a node.
+/// @post           None
+///
+/// @param node:    Node to measure from.
+///
+/// @return int:    Length of the longest path from node to a leaf.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+int CParallelABTracer::treeHeight( const STreeNode *node ) const
+{
+    int height = 0;
+    const STreeNode *i;
+    foreach( i, node->s_childList )
+        height = qMax( height, treeHeight( i ) + 1 );
+    return height;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SParallelContext::SParallelContext
+///
+/// @description    This is the constructor of the SParallelContext struct.
+/// @pre            None
+/// @post           The context is ready for a run.
+///
+/// @param conf:    The trace parameters.
+///        cancel:  Set to non zero to stop the run early, or NULL.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SParallelContext::SParallelContext( const STraceConfig &conf,
+                                    const QAtomicInt *cancel )
+{
+    s_conf = conf;
+    s_cancel = cancel;
+    s_mode = YoungBrothersWait;
+    s_threads = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SParallelContext::~SParallelContext
+///
+/// @description    This is the destructor of the SParallelContext struct.
+/// @pre            None
+/// @post           All pool threads have finished.
+///
+/// @param          None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SParallelContext::~SParallelContext()
+{
+    s_stop = 1;
+    s_pool.waitForDone();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SParallelContext::isCancelled
+///
+/// @description    Checks the cancellation token of the run.
+/// @pre            None
+/// @post           None
+///
+/// @param          None.
+///
+/// @return bool:   true if the run has been asked to stop.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+bool SParallelContext::isCancelled() const
+{
+    return s_cancel != NULL && (int)*s_cancel != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SParallelTTEntry::SParallelTTEntry
+///
+/// @description    This is the constructor of the SParallelTTEntry struct.
+/// @pre            None
+/// @post           Object is created as an empty entry.
+///
+/// @param          None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SParallelTTEntry::SParallelTTEntry()
+{
+    s_depth = -1;
+    s_qsDepth = -1;
+    s_bound = Exact;
+    s_value = 0.0;
+    s_bestChild = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// SParallelResult::SParallelResult
+///
+/// @description    This is the constructor of the SParallelResult struct.
+/// @pre            None
+/// @post           Object is created.
+///
+/// @param          None.
+///
+/// @limitations    None.
+///
+////////////////////////////////////////////////////////////////////////////////
+SParallelResult::SParallelResult()
+{
+    s_value = 0.0;
+    s_bestAction = NULL;
+    s_nodes = 0;
+    s_time = 0;
+}
@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @file         CParallelABTracer.h
+///
+/// @author       Ray Myers
+///
+/// @compiler     Windows: MinGW / Linux: GNU G++
+///
+/// @project      GNAT
+///
+/// @description  This file contains the declaration of the CParallelABTracer
+///               class. It solves a game tree with a multi-threaded alpha
+///               beta search and reports how it compares to a single thread.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CPARALLELABTRACER_H_
+#define _CPARALLELABTRACER_H_
+
+#include "../../STreeTrace.h"
+#include "../../CTreeGraph.h"
+#include "CGeneralMTracer.h"
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QThreadPool>
+
+struct SSplitPoint;
+class QThread;
+
+////////////////////////////////////////////////////////////////////////////////
+/// SParallelTTEntry
+///
+/// @description  An entry of the transposition table shared by the Lazy SMP
+///               threads. Values are from the point of view of the player to
+///               move at the node.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SParallelTTEntry
+{
+    SParallelTTEntry();
+
+    enum BoundType
+    {
+        Exact,
+        LowerBound,
+        UpperBound
+    };
+
+    int              s_depth;
+    int              s_qsDepth;
+    BoundType        s_bound;
+    float            s_value;
+    const STreeNode *s_bestChild;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SParallelResult
+///
+/// @description  The outcome of one search of the root.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SParallelResult
+{
+    SParallelResult();
+
+    float            s_value;
+    const STreeNode *s_bestAction;
+    int              s_nodes;
+    int              s_time;
+    // Nodes examined by each thread that took part, the calling thread first.
+    QList<int>       s_workerNodes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SParallelContext
+///
+/// @description  Everything that belongs to one run of CParallelABTracer: the
+///               configuration, the cancellation token, the thread pool, the
+///               shared transposition table and the node counts of the
+///               threads. The tracer itself holds no state, so several runs
+///               may share it as long as each has a context of its own.
+///
+/// @limitations  A context may only be used by one run at a time.
+///
+////////////////////////////////////////////////////////////////////////////////
+struct SParallelContext
+{
+    SParallelContext( const STraceConfig &conf,
+                      const QAtomicInt *cancel = NULL );
+    ~SParallelContext();
+
+    enum Mode
+    {
+        YoungBrothersWait,
+        LazySMP
+    };
+
+    bool isCancelled() const;
+
+    STraceConfig        s_conf;
+    // The run stops early once this is set to non-zero. May be NULL.
+    const QAtomicInt   *s_cancel;
+
+    QThreadPool         s_pool;
+    Mode                s_mode;
+    int                 s_threads;
+    // Set once a search is over, to send the helper threads home.
+    QAtomicInt          s_stop;
+
+    enum { TTShards = 16 };
+
+    // The transposition table is split in shards, each with its own lock, so
+    // threads rarely wait on each other to use it.
+    QMutex              s_ttMutex[TTShards];
+    QHash<const STreeNode*, SParallelTTEntry> s_transTable[TTShards];
+
+    QMutex              s_workerMutex;
+    QList<QThread*>     s_workerThreads;
+    QList<int>          s_workerNodes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// CParallelABTracer
+///
+/// @description  This class searches a tree with alpha beta pruning spread
+///               over several threads. Two schemes are available:
+///
+///               Young Brothers Wait searches the eldest child of a node on
+///               its own and then lets idle threads help with the younger
+///               siblings, sharing the alpha beta bounds between them.
+///
+///               Lazy SMP runs an iterative deepening search on every thread
+///               and lets them share a transposition table.
+///
+///               Rather than a line per call, the trace it produces is a
+///               table comparing the search to one thread: value, nodes,
+///               time, speedup and search overhead.
+///
+///               The state of a run is kept in an SParallelContext.
+///
+/// @limitations  Iterative deepening only applies to Lazy SMP.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CParallelABTracer
+{
+public:
+    CParallelABTracer();
+
+    STreeTrace *trace( const STreeNode *rootNode, int depthLimit, int qsDepth,
+                       const STraceConfig &traceConf ) const;
+    STreeTrace *trace( const STreeNode *rootNode, int depthLimit, int qsDepth,
+                       SParallelContext &context ) const;
+
+    SParallelResult search( SParallelContext &context,
+                            const STreeNode *rootNode, int depth, int qsDepth,
+                            SParallelContext::Mode mode, int threads ) const;
+
+private:
+    friend class CSplitPointHelper;
+    friend class CLazySMPHelper;
+
+    float searchNode( SParallelContext &context,
+                      const STreeNode *node, int depth, int qsDepth,
+                      float alpha, float beta, bool max, SSplitPoint *parent,
+                      int &nodes, const STreeNode **bestChild,
+                      int rotate ) const;
+    float searchChild( SParallelContext &context,
+                       const STreeNode *child, int depth, int qsDepth,
+                       float alpha, float beta, bool max, SSplitPoint *parent,
+                       int &nodes ) const;
+    void searchSplitPoint( SParallelContext &context,
+                           SSplitPoint *sp, int &nodes ) const;
+    bool isAborted( const SParallelContext &context,
+                    const SSplitPoint *sp ) const;
+
+    bool probeTT( SParallelContext &context,
+                  const STreeNode *node, int depth, int qsDepth,
+                  float alpha, float beta, SParallelTTEntry &entry ) const;
+    void storeTT( SParallelContext &context,
+                  const STreeNode *node, int depth, int qsDepth,
+                  float alpha, float beta, float value,
+                  const STreeNode *bestChild ) const;
+
+    void addWorkerNodes( SParallelContext &context, int nodes ) const;
+    int treeHeight( const STreeNode *node ) const;
+};
+
+#endif//_CPARALLELABTRACER_H_
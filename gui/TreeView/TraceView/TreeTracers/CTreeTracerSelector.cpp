@@ -15,10 +15,36 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include "CTreeTracerSelector.h"
 #include "CGeneralMTracer.h"
+#include "../../STreeTrace.h"
 #include <QComboBox>
 #include <QMenu>
 #include <QSpinBox>
 #include <QLabel>
+#include <QInputDialog>
+#include <QThread>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+////////////////////////////////////////////////////////////////////////////////
+/// Writes everything about a subtree that can change its trace. Positions are
+/// left out since the child lists are already kept in left to right order.
+////////////////////////////////////////////////////////////////////////////////
+static void writeTree( QDataStream &stream, const STreeNode *node )
+{
+    if( node == NULL )
+    {
+        stream << (qint32)-1;
+        return;
+    }
+
+    stream << (qint32)node->s_childList.count();
+    stream << node->s_name << node->s_value << node->s_quiescent
+           << (qint32)node->s_history;
+
+    const STreeNode *child;
+    foreach( child, node->s_childList )
+        writeTree( stream, child );
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CTreeTracerSelector::CTreeTracerSelector
@@ -49,8 +75,23 @@ CTreeTracerSelector::CTreeTracerSelector( QObject *parent )
     m_traceConf.s_isDL = false;
     m_traceConf.s_isAB = false;
     m_traceConf.s_isHT = false;
+    m_traceConf.s_isLH = false;
+    m_traceConf.s_isKM = false;
     m_traceConf.s_isQS = false;
     m_traceConf.s_allowSSS = true;
+    m_traceConf.s_isTT = false;
+    m_traceConf.s_isPVS = false;
+    m_traceConf.s_isMTDF = false;
+    m_traceConf.s_isAW = false;
+    m_traceConf.s_aspirationWidth = 5;
+    m_traceConf.s_isYBWC = false;
+    m_traceConf.s_isLazySMP = false;
+    m_traceConf.s_threads = qMax( 2, QThread::idealThreadCount() );
+    m_traceConf.s_isMCTS = false;
+    m_traceConf.s_playouts = 10000;
+    m_traceConf.s_isPN = false;
+    m_traceConf.s_isDFPN = false;
+    m_traceConf.s_proofThreshold = 0;
 
     // Enable / disable widgets accordingly.
     m_qsDepthSelector->setEnabled(m_traceConf.s_isQS);
@@ -89,18 +130,48 @@ CTreeTracerSelector::CTreeTracerSelector( QObject *parent )
 /// @pre          m_aiLabel has been initialized.
 /// @post         m_aiLabel now contains a meaningfull search description.
 ///
+/// @param trace: The last trace performed, if any. Its node count is shown
+///               after the search description.
+///
 /// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
-void CTreeTracerSelector::updateLabel() const
+void CTreeTracerSelector::updateLabel( const STreeTrace *trace ) const
 {
     QString newLabel = "";
-    if(m_traceConf.s_isHT) newLabel += "HT";
-    if(m_traceConf.s_isQS) newLabel += "QS";
-    if(m_traceConf.s_isAB) newLabel += "AB";
-    if(m_traceConf.s_isID) newLabel += "ID";
-    if(m_traceConf.s_isDL) newLabel += "DLM";
-    else newLabel += "Minimax";
+    if(m_traceConf.s_isMCTS)
+    {
+        if(m_traceConf.s_isQS) newLabel += "QS";
+        newLabel += "MCTS";
+        if(m_traceConf.s_isDL) newLabel += "DL";
+    }
+    else if(m_traceConf.s_isPN || m_traceConf.s_isDFPN)
+    {
+        if(m_traceConf.s_isQS) newLabel += "QS";
+        newLabel += m_traceConf.s_isDFPN ? "DFPN" : "PN";
+        if(m_traceConf.s_isDL) newLabel += "DL";
+    }
+    else
+    {
+        if(m_traceConf.s_isTT) newLabel += "TT";
+        if(m_traceConf.s_isKM) newLabel += "KM";
+        if(m_traceConf.s_isHT) newLabel += m_traceConf.s_isLH ? "LH" : "HT";
+        if(m_traceConf.s_isQS) newLabel += "QS";
+        if(m_traceConf.s_isAW) newLabel += "AW";
+        if(m_traceConf.s_isYBWC) newLabel += "YBWC";
+        if(m_traceConf.s_isLazySMP) newLabel += "LazySMP";
+        if(m_traceConf.s_isAB)
+        {
+            if(m_traceConf.s_isMTDF) newLabel += "MTD(f)";
+            else if(m_traceConf.s_isPVS) newLabel += "PVS";
+            else newLabel += "AB";
+        }
+        if(m_traceConf.s_isID) newLabel += "ID";
+        if(m_traceConf.s_isDL) newLabel += "DLM";
+        else newLabel += "Minimax";
+    }
+    if(trace != NULL)
+        newLabel += QString(" (%1 nodes)").arg(trace->s_nodeCount);
     m_aiLabel->setText(newLabel);
 }
 ////////////////////////////////////////////////////////////////////////////////
@@ -229,6 +300,44 @@ QSpinBox *CTreeTracerSelector::getQSDepthSelector()
     return m_qsDepthSelector;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::depthLimit
+///
+/// @description          This function returns the depth a trace would be
+///                       limited to.
+/// @pre                  None
+/// @post                 None
+///
+/// @return int:          The value of the depth selector, or -1 if depth
+///                       limiting is off.
+///
+/// @limitations          None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CTreeTracerSelector::depthLimit() const
+{
+    return m_traceConf.s_isDL ? m_depthSelector->value() : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::qsDepth
+///
+/// @description          This function returns the quiescence depth a trace
+///                       would use.
+/// @pre                  None
+/// @post                 None
+///
+/// @return int:          The value of the qs depth selector, or 0 if
+///                       quiescence search is off.
+///
+/// @limitations          None
+///
+////////////////////////////////////////////////////////////////////////////////
+int CTreeTracerSelector::qsDepth() const
+{
+    return m_traceConf.s_isQS ? m_qsDepthSelector->value() : 0;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// CTreeTracerSelector::setupDepthList
@@ -266,31 +375,113 @@ void CTreeTracerSelector::setupQSDepthList()
     m_qsDepthSelector->setMaximum( 255 );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::createJob
+///
+/// @description  Makes a job that traces the tree with the currently selected
+///               tracer, pulling the depth and qs depth values from the spin
+///               boxes. The label is brought up to date for the new search.
+/// @pre          None
+/// @post         None
+///
+/// @param rootNode: This is the root of the tree that is to be traced. The
+///                  job takes a copy of it.
+///
+/// @return CTreeTraceJob *: The job, which the caller owns.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CTreeTraceJob *CTreeTracerSelector::createJob( const STreeNode *rootNode ) const
+{
+    updateLabel();
+    return new CTreeTraceJob( this, rootNode, m_traceConf,
+                              m_depthSelector->value(),
+                              m_qsDepthSelector->value() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::traceKey
+///
+/// @description  Makes a key for the trace that createJob() would run: a hash
+///               of the current settings and of everything in the tree that
+///               the tracers look at. Two calls give the same key only if the
+///               traces would be the same.
+/// @pre          None
+/// @post         None
+///
+/// @param rootNode: This is the root of the tree that is to be traced.
+///
+/// @return QByteArray: The key.
+///
+/// @limitations  The MCTS and parallel searches can give a slightly different
+///               trace each run; the key treats those runs as the same.
+///
+////////////////////////////////////////////////////////////////////////////////
+QByteArray CTreeTracerSelector::traceKey( const STreeNode *rootNode ) const
+{
+    QByteArray data;
+    QDataStream stream( &data, QIODevice::WriteOnly );
+
+    const STraceConfig &conf = m_traceConf;
+    stream << conf.s_isQS << conf.s_isHT << conf.s_isLH << conf.s_isKM
+           << conf.s_isDL << conf.s_isID << conf.s_isAB << conf.s_allowSSS
+           << conf.s_isTT << conf.s_isPVS << conf.s_isMTDF << conf.s_isAW
+           << conf.s_aspirationWidth << conf.s_isYBWC << conf.s_isLazySMP
+           << (qint32)conf.s_threads << conf.s_isMCTS
+           << (qint32)conf.s_playouts << conf.s_isPN << conf.s_isDFPN
+           << conf.s_proofThreshold;
+    stream << (qint32)m_depthSelector->value()
+           << (qint32)m_qsDepthSelector->value();
+    writeTree( stream, rootNode );
+
+    return QCryptographicHash::hash( data, QCryptographicHash::Sha1 );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CTreeTracerSelector::trace
 ///
 /// @description  This is a forwarding function that encapsulates the interface
 ///               with the tracers. Calling it will call the trace() function
-///               on the currently selected tracer and it will pull the depth
-///               and qs depth values from the spin boxes.
-/// @pre          None
-/// @post         The trace is returned as determined by the selector widgets'
-///               current states.
+///               on the tracer that traceConf selects. It does not touch the
+///               widgets, so it may be called from a worker thread.
+/// @pre          No other trace is running on this selector.
+/// @post         None
 ///
-/// @param rootNode: This is the root of the tree that is to be traced.
+/// @param rootNode:  This is the root of the tree that is to be traced.
+/// @param traceConf: The search to run.
+/// @param depth:     The depth limit.
+/// @param qsDepth:   The quiescence search depth.
+/// @param cancel:    Stops the trace early when set non-zero. May be NULL.
 ///
-/// @return STreeTrace *: This is the trace generated by the ITreeTracer
-///                       subclass.
+/// @return STreeTrace *: This is the trace generated by the tracer.
 ///
 /// @limitations  None
 ///
 ////////////////////////////////////////////////////////////////////////////////
-STreeTrace *CTreeTracerSelector::trace( const STreeNode *rootNode ) const
+STreeTrace *CTreeTracerSelector::trace( const STreeNode *rootNode,
+                                        const STraceConfig &traceConf,
+                                        int depth, int qsDepth,
+                                        const QAtomicInt *cancel ) const
 {
-    int depth = m_depthSelector->value();
-    int qsDepth = m_qsDepthSelector->value();
-    updateLabel();
-    return m_generalTracer.trace( rootNode, depth, qsDepth, m_traceConf );
+    if(traceConf.s_isMCTS)
+    {
+        SMCTSContext context( traceConf, cancel );
+        return m_mctsTracer.trace( rootNode, depth, qsDepth, context );
+    }
+    if(traceConf.s_isPN || traceConf.s_isDFPN)
+    {
+        SPNContext context( traceConf, cancel );
+        return m_pnTracer.trace( rootNode, depth, qsDepth, context );
+    }
+    if(traceConf.s_isYBWC || traceConf.s_isLazySMP)
+    {
+        SParallelContext context( traceConf, cancel );
+        return m_parallelTracer.trace( rootNode, depth, qsDepth, context );
+    }
+
+    SGeneralMContext context( traceConf, cancel );
+    return m_generalTracer.trace( rootNode, depth, qsDepth, context );
 }
 
 
@@ -300,7 +491,9 @@ STreeTrace *CTreeTracerSelector::trace( const STreeNode *rootNode ) const
 /// @description  Toggles Iterative Deepening on/off
 /// @pre          None
 /// @post         Value of m_traceConf.s_isID is changed. If it was changed to
-///               true, Depth Limited is also turned on. Trace is updated.
+///               true, Depth Limited is also turned on. If it was changed to
+///               false, Aspiration Windows are also turned off. Trace is
+///               updated.
 ///
 /// @limitations  None
 ///
@@ -310,6 +503,11 @@ void CTreeTracerSelector::toggleID()
     bool b = !m_traceConf.s_isID;
     m_traceConf.s_isID = b;
 
+    if(!b && m_traceConf.s_isAW)
+    {
+        m_actionAW->setChecked(false);
+    }
+
     if(b && !m_traceConf.s_isDL)
     {
         m_actionDL->setChecked(true);
@@ -329,8 +527,8 @@ void CTreeTracerSelector::toggleID()
 /// @description  Toggles Depth Limited on/off
 /// @pre          None
 /// @post         Value of m_traceConf.s_isDL is changed. If it was changed to
-///               false, Iterative Deepening and Quiessence Search are also
-///               turned off. Trace is updated.
+///               false, Iterative Deepening, Quiessence Search and Learned
+///               History are also turned off. Trace is updated.
 ///
 /// @limitations  None
 ///
@@ -349,11 +547,15 @@ void CTreeTracerSelector::toggleDL()
     {
         m_actionQS->setChecked(false);
     }
+    if(!b && m_traceConf.s_isLH)
+    {
+        m_actionLH->setChecked(false);
+    }
 
 
 
     // If DL has just been toggled manually, not a a prereq to something else.
-    if(!m_traceConf.s_isID && !m_traceConf.s_isQS)
+    if(!m_traceConf.s_isID && !m_traceConf.s_isQS && !m_traceConf.s_isLH)
     {
         activate();
         m_aiConfigButton->showMenu();
@@ -367,7 +569,11 @@ void CTreeTracerSelector::toggleDL()
 ///
 /// @description  Toggles Alpha Beta Pruning on/off
 /// @pre          None
-/// @post         Value of m_traceConf.s_isAB is changed. Trace is updated.
+/// @post         Value of m_traceConf.s_isAB is changed. If it was changed to
+///               false, PVS, MTD(f), Aspiration Windows and the parallel
+///               searches are also turned off. If it was changed to true,
+///               MCTS and the proof-number searches are turned off. Trace is
+///               updated.
 ///
 /// @limitations  None
 ///
@@ -376,8 +582,49 @@ void CTreeTracerSelector::toggleAB()
 {
     bool b = !m_traceConf.s_isAB;
     m_traceConf.s_isAB = b;
-    activate();
-    m_aiConfigButton->showMenu();
+
+    if(b && m_traceConf.s_isMCTS)
+    {
+        m_actionMCTS->setChecked(false);
+    }
+    if(b && m_traceConf.s_isPN)
+    {
+        m_actionPN->setChecked(false);
+    }
+    if(b && m_traceConf.s_isDFPN)
+    {
+        m_actionDFPN->setChecked(false);
+    }
+    if(!b && m_traceConf.s_isPVS)
+    {
+        m_actionPVS->setChecked(false);
+    }
+    if(!b && m_traceConf.s_isMTDF)
+    {
+        m_actionMTDF->setChecked(false);
+    }
+    if(!b && m_traceConf.s_isAW)
+    {
+        m_actionAW->setChecked(false);
+    }
+    if(!b && m_traceConf.s_isYBWC)
+    {
+        m_actionYBWC->setChecked(false);
+    }
+    if(!b && m_traceConf.s_isLazySMP)
+    {
+        m_actionLazySMP->setChecked(false);
+    }
+
+    // If AB has just been toggled manually, not a a prereq to something else.
+    if(!m_traceConf.s_isPVS && !m_traceConf.s_isMTDF && !m_traceConf.s_isAW
+       && !m_traceConf.s_isYBWC && !m_traceConf.s_isLazySMP
+       && !m_traceConf.s_isMCTS && !m_traceConf.s_isPN
+       && !m_traceConf.s_isDFPN)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -385,7 +632,8 @@ void CTreeTracerSelector::toggleAB()
 ///
 /// @description  Toggles History Table on/off
 /// @pre          None
-/// @post         Value of m_traceConf.s_isHT is changed. Trace is updated.
+/// @post         Value of m_traceConf.s_isHT is changed. If it was changed to
+///               false, Learned History is also turned off. Trace is updated.
 ///
 /// @limitations  None
 ///
@@ -394,6 +642,68 @@ void CTreeTracerSelector::toggleHT()
 {
     bool b = !m_traceConf.s_isHT;
     m_traceConf.s_isHT = b;
+
+    if(!b && m_traceConf.s_isLH)
+    {
+        m_actionLH->setChecked(false);
+    }
+
+    // If HT has just been toggled manually, not a a prereq to something else.
+    if(!m_traceConf.s_isLH)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::toggleLH
+///
+/// @description  Toggles Learned History on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isLH is changed. If it was changed to
+///               true, History Table and Depth Limited are also turned on,
+///               as the credit of a move is worked out from the depth left.
+///               Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::toggleLH()
+{
+    bool b = !m_traceConf.s_isLH;
+    m_traceConf.s_isLH = b;
+
+    if(b && !m_traceConf.s_isHT)
+    {
+        m_actionHT->setChecked(true);
+    }
+    if(b && !m_traceConf.s_isDL)
+    {
+        m_actionDL->setChecked(true);
+    }
+
+    // Unless HT or DL is being turned off, which updates the trace itself.
+    if(m_traceConf.s_isHT && m_traceConf.s_isDL)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::toggleKM
+///
+/// @description  Toggles Killer Moves on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isKM is changed. Trace is updated.
+///
+/// @limitations  Killer moves only affect Alpha Beta searches.
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::toggleKM()
+{
+    m_traceConf.s_isKM = !m_traceConf.s_isKM;
     activate();
     m_aiConfigButton->showMenu();
 }
@@ -444,6 +754,434 @@ void CTreeTracerSelector::toggleSSS()
     m_aiConfigButton->showMenu();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::toggleTT
+///
+/// @description  Toggles the Transposition Table on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isTT is changed. Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::toggleTT()
+{
+    m_traceConf.s_isTT = !m_traceConf.s_isTT;
+    activate();
+    m_aiConfigButton->showMenu();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::togglePVS
+///
+/// @description  Toggles Principal Variation Search on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isPVS is changed. If it was changed to
+///               true, Alpha Beta Pruning is also turned on and MTD(f) is
+///               turned off. Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::togglePVS()
+{
+    bool b = !m_traceConf.s_isPVS;
+    m_traceConf.s_isPVS = b;
+
+    if(b && m_traceConf.s_isMTDF)
+    {
+        m_actionMTDF->setChecked(false);
+    }
+    if(b && !m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(true);
+    }
+
+    if(m_traceConf.s_isAB)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::toggleMTDF
+///
+/// @description  Toggles MTD(f) on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isMTDF is changed. If it was changed
+///               to true, Alpha Beta Pruning is also turned on and PVS is
+///               turned off. Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::toggleMTDF()
+{
+    bool b = !m_traceConf.s_isMTDF;
+    m_traceConf.s_isMTDF = b;
+
+    if(b && m_traceConf.s_isPVS)
+    {
+        m_actionPVS->setChecked(false);
+    }
+    if(b && !m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(true);
+    }
+
+    if(m_traceConf.s_isAB)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::toggleAW
+///
+/// @description  Toggles Aspiration Windows on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isAW is changed. If it was changed to
+///               true, Alpha Beta Pruning and Iterative Deepening are also
+///               turned on. Trace is updated.
+///
+/// @limitations  Aspiration windows are not used by MTD(f).
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::toggleAW()
+{
+    bool b = !m_traceConf.s_isAW;
+    m_traceConf.s_isAW = b;
+
+    if(b && !m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(true);
+    }
+    if(b && !m_traceConf.s_isID)
+    {
+        m_actionID->setChecked(true);
+    }
+
+    if(m_traceConf.s_isAB && m_traceConf.s_isID)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::setAspirationWidth
+///
+/// @description  Asks the user for the width of the aspiration windows.
+/// @pre          None
+/// @post         If the dialog was accepted, m_traceConf.s_aspirationWidth is
+///               changed and the trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::setAspirationWidth()
+{
+    bool ok;
+    double width = QInputDialog::getDouble( m_aiConfigButton,
+                    tr("Aspiration Width"), // Title
+                    tr("Enter distance from the previous value to each side "
+                       "of the window"), // Label
+                    m_traceConf.s_aspirationWidth, // Value
+                    0, // MinValue
+                    10000, // MaxValue
+                    2, // Decimals
+                    &ok ); // Ok
+
+    if(!ok) return;
+    m_traceConf.s_aspirationWidth = width;
+    m_actionAWWidth->setText(tr("Aspiration &Width (%1)...").arg(width));
+
+    if(m_traceConf.s_isAW)
+        activate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::toggleYBWC
+///
+/// @description  Toggles the Young Brothers Wait parallel search on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isYBWC is changed. If it was changed
+///               to true, Alpha Beta Pruning is also turned on and Lazy SMP is
+///               turned off. Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::toggleYBWC()
+{
+    bool b = !m_traceConf.s_isYBWC;
+    m_traceConf.s_isYBWC = b;
+
+    if(b && m_traceConf.s_isLazySMP)
+    {
+        m_actionLazySMP->setChecked(false);
+    }
+    if(b && !m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(true);
+    }
+
+    if(m_traceConf.s_isAB)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::toggleLazySMP
+///
+/// @description  Toggles the Lazy SMP parallel search on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isLazySMP is changed. If it was
+///               changed to true, Alpha Beta Pruning is also turned on and
+///               Young Brothers Wait is turned off. Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::toggleLazySMP()
+{
+    bool b = !m_traceConf.s_isLazySMP;
+    m_traceConf.s_isLazySMP = b;
+
+    if(b && m_traceConf.s_isYBWC)
+    {
+        m_actionYBWC->setChecked(false);
+    }
+    if(b && !m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(true);
+    }
+
+    if(m_traceConf.s_isAB)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::setThreads
+///
+/// @description  Asks the user for the number of threads used by the parallel
+///               searches and MCTS.
+/// @pre          None
+/// @post         If the dialog was accepted, m_traceConf.s_threads is changed
+///               and the trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::setThreads()
+{
+    bool ok;
+    int threads = QInputDialog::getInteger( m_aiConfigButton,
+                    tr("Threads"), // Title
+                    tr("Enter number of threads for the parallel "
+                       "searches"), // Label
+                    m_traceConf.s_threads, // Value
+                    1, // MinValue
+                    64, // MaxValue
+                    1, // Step
+                    &ok ); // Ok
+
+    if(!ok) return;
+    m_traceConf.s_threads = threads;
+    m_actionThreads->setText(tr("Thr&eads (%1)...").arg(threads));
+
+    if(m_traceConf.s_isYBWC || m_traceConf.s_isLazySMP
+       || m_traceConf.s_isMCTS)
+        activate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::toggleMCTS
+///
+/// @description  Toggles Monte Carlo Tree Search on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isMCTS is changed. If it was changed
+///               to true, Alpha Beta Pruning and the proof-number searches
+///               are turned off. Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::toggleMCTS()
+{
+    bool b = !m_traceConf.s_isMCTS;
+    m_traceConf.s_isMCTS = b;
+
+    if(b && m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(false);
+    }
+    if(b && m_traceConf.s_isPN)
+    {
+        m_actionPN->setChecked(false);
+    }
+    if(b && m_traceConf.s_isDFPN)
+    {
+        m_actionDFPN->setChecked(false);
+    }
+
+    // If MCTS has just been toggled manually, not turned off by something
+    // else.
+    if(!m_traceConf.s_isAB && !m_traceConf.s_isPN && !m_traceConf.s_isDFPN)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::setPlayouts
+///
+/// @description  Asks the user for the number of simulations run by MCTS.
+/// @pre          None
+/// @post         If the dialog was accepted, m_traceConf.s_playouts is changed
+///               and the trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::setPlayouts()
+{
+    bool ok;
+    int playouts = QInputDialog::getInteger( m_aiConfigButton,
+                    tr("Playouts"), // Title
+                    tr("Enter number of simulations for MCTS"), // Label
+                    m_traceConf.s_playouts, // Value
+                    1, // MinValue
+                    1000000, // MaxValue
+                    1000, // Step
+                    &ok ); // Ok
+
+    if(!ok) return;
+    m_traceConf.s_playouts = playouts;
+    m_actionPlayouts->setText(tr("Pla&youts (%1)...").arg(playouts));
+
+    if(m_traceConf.s_isMCTS)
+        activate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::togglePN
+///
+/// @description  Toggles Proof-Number Search on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isPN is changed. If it was changed to
+///               true, df-pn, Alpha Beta Pruning and MCTS are turned off.
+///               Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::togglePN()
+{
+    bool b = !m_traceConf.s_isPN;
+    m_traceConf.s_isPN = b;
+
+    if(b && m_traceConf.s_isDFPN)
+    {
+        m_actionDFPN->setChecked(false);
+    }
+    if(b && m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(false);
+    }
+    if(b && m_traceConf.s_isMCTS)
+    {
+        m_actionMCTS->setChecked(false);
+    }
+
+    // If PN has just been toggled manually, not turned off by something else.
+    if(!m_traceConf.s_isDFPN && !m_traceConf.s_isAB && !m_traceConf.s_isMCTS)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::toggleDFPN
+///
+/// @description  Toggles Depth-First Proof-Number Search on/off
+/// @pre          None
+/// @post         Value of m_traceConf.s_isDFPN is changed. If it was changed
+///               to true, PN, Alpha Beta Pruning and MCTS are turned off.
+///               Trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::toggleDFPN()
+{
+    bool b = !m_traceConf.s_isDFPN;
+    m_traceConf.s_isDFPN = b;
+
+    if(b && m_traceConf.s_isPN)
+    {
+        m_actionPN->setChecked(false);
+    }
+    if(b && m_traceConf.s_isAB)
+    {
+        m_actionAB->setChecked(false);
+    }
+    if(b && m_traceConf.s_isMCTS)
+    {
+        m_actionMCTS->setChecked(false);
+    }
+
+    // If df-pn has just been toggled manually, not turned off by something
+    // else.
+    if(!m_traceConf.s_isPN && !m_traceConf.s_isAB && !m_traceConf.s_isMCTS)
+    {
+        activate();
+        m_aiConfigButton->showMenu();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTracerSelector::setProofThreshold
+///
+/// @description  Asks the user for the value an end point must be above to
+///               count as a win for max in the proof-number searches.
+/// @pre          None
+/// @post         If the dialog was accepted, m_traceConf.s_proofThreshold is
+///               changed and the trace is updated.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTracerSelector::setProofThreshold()
+{
+    bool ok;
+    double threshold = QInputDialog::getDouble( m_aiConfigButton,
+                    tr("Proof Threshold"), // Title
+                    tr("Enter value above which max wins"), // Label
+                    m_traceConf.s_proofThreshold, // Value
+                    -10000, // MinValue
+                    10000, // MaxValue
+                    2, // Decimals
+                    &ok ); // Ok
+
+    if(!ok) return;
+    m_traceConf.s_proofThreshold = threshold;
+    m_actionProofThreshold->setText(tr("Proof Th&reshold (%1)...")
+                                    .arg(threshold));
+
+    if(m_traceConf.s_isPN || m_traceConf.s_isDFPN)
+        activate();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CTreeTracerSelector::setupConfigMenuActions
 ///
@@ -484,6 +1222,101 @@ void CTreeTracerSelector::setupConfigMenuActions()
 
     m_aiConfigMenu->addAction(m_actionAB);
 
+    // Principal Variation Search toggle
+    m_actionPVS = new QAction(tr("&Principal Variation Search"), this);
+    m_actionPVS->setCheckable(true);
+    m_actionPVS->setChecked(m_traceConf.s_isPVS);
+    connect(m_actionPVS, SIGNAL(toggled(bool)), this, SLOT(togglePVS()));
+
+    m_aiConfigMenu->addAction(m_actionPVS);
+
+    // MTD(f) toggle
+    m_actionMTDF = new QAction(tr("&MTD(f)"), this);
+    m_actionMTDF->setCheckable(true);
+    m_actionMTDF->setChecked(m_traceConf.s_isMTDF);
+    connect(m_actionMTDF, SIGNAL(toggled(bool)), this, SLOT(toggleMTDF()));
+
+    m_aiConfigMenu->addAction(m_actionMTDF);
+
+    // Aspiration Windows toggle
+    m_actionAW = new QAction(tr("Aspiration Windo&ws"), this);
+    m_actionAW->setCheckable(true);
+    m_actionAW->setChecked(m_traceConf.s_isAW);
+    connect(m_actionAW, SIGNAL(toggled(bool)), this, SLOT(toggleAW()));
+
+    m_aiConfigMenu->addAction(m_actionAW);
+
+    // Aspiration Window width
+    m_actionAWWidth = new QAction(tr("Aspiration &Width (%1)...")
+                                  .arg(m_traceConf.s_aspirationWidth), this);
+    connect(m_actionAWWidth, SIGNAL(triggered()),
+            this, SLOT(setAspirationWidth()));
+
+    m_aiConfigMenu->addAction(m_actionAWWidth);
+
+    // Young Brothers Wait toggle
+    m_actionYBWC = new QAction(tr("&Young Brothers Wait"), this);
+    m_actionYBWC->setCheckable(true);
+    m_actionYBWC->setChecked(m_traceConf.s_isYBWC);
+    connect(m_actionYBWC, SIGNAL(toggled(bool)), this, SLOT(toggleYBWC()));
+
+    m_aiConfigMenu->addAction(m_actionYBWC);
+
+    // Lazy SMP toggle
+    m_actionLazySMP = new QAction(tr("La&zy SMP"), this);
+    m_actionLazySMP->setCheckable(true);
+    m_actionLazySMP->setChecked(m_traceConf.s_isLazySMP);
+    connect(m_actionLazySMP, SIGNAL(toggled(bool)),
+            this, SLOT(toggleLazySMP()));
+
+    m_aiConfigMenu->addAction(m_actionLazySMP);
+
+    // Parallel search thread count
+    m_actionThreads = new QAction(tr("Thr&eads (%1)...")
+                                  .arg(m_traceConf.s_threads), this);
+    connect(m_actionThreads, SIGNAL(triggered()), this, SLOT(setThreads()));
+
+    m_aiConfigMenu->addAction(m_actionThreads);
+
+    // MCTS toggle
+    m_actionMCTS = new QAction(tr("Mo&nte Carlo Tree Search"), this);
+    m_actionMCTS->setCheckable(true);
+    m_actionMCTS->setChecked(m_traceConf.s_isMCTS);
+    connect(m_actionMCTS, SIGNAL(toggled(bool)), this, SLOT(toggleMCTS()));
+
+    m_aiConfigMenu->addAction(m_actionMCTS);
+
+    // MCTS playout budget
+    m_actionPlayouts = new QAction(tr("Pla&youts (%1)...")
+                                   .arg(m_traceConf.s_playouts), this);
+    connect(m_actionPlayouts, SIGNAL(triggered()), this, SLOT(setPlayouts()));
+
+    m_aiConfigMenu->addAction(m_actionPlayouts);
+
+    // Proof-Number Search toggle
+    m_actionPN = new QAction(tr("Proof Number &Search"), this);
+    m_actionPN->setCheckable(true);
+    m_actionPN->setChecked(m_traceConf.s_isPN);
+    connect(m_actionPN, SIGNAL(toggled(bool)), this, SLOT(togglePN()));
+
+    m_aiConfigMenu->addAction(m_actionPN);
+
+    // Depth-First Proof-Number Search toggle
+    m_actionDFPN = new QAction(tr("Depth-&First Proof Number Search"), this);
+    m_actionDFPN->setCheckable(true);
+    m_actionDFPN->setChecked(m_traceConf.s_isDFPN);
+    connect(m_actionDFPN, SIGNAL(toggled(bool)), this, SLOT(toggleDFPN()));
+
+    m_aiConfigMenu->addAction(m_actionDFPN);
+
+    // Proof-number search win threshold
+    m_actionProofThreshold = new QAction(tr("Proof Th&reshold (%1)...")
+                                   .arg(m_traceConf.s_proofThreshold), this);
+    connect(m_actionProofThreshold, SIGNAL(triggered()),
+            this, SLOT(setProofThreshold()));
+
+    m_aiConfigMenu->addAction(m_actionProofThreshold);
+
     // Quiescent Search toggle
     m_actionQS = new QAction(tr("&Quiescent Search"), this);
     m_actionQS->setCheckable(true);
@@ -502,6 +1335,30 @@ void CTreeTracerSelector::setupConfigMenuActions()
 
     m_aiConfigMenu->addAction(m_actionHT);
 
+    // Learned History toggle
+    m_actionLH = new QAction(tr("&Learned History"), this);
+    m_actionLH->setCheckable(true);
+    m_actionLH->setChecked(m_traceConf.s_isLH);
+    connect(m_actionLH, SIGNAL(toggled(bool)), this, SLOT(toggleLH()));
+
+    m_aiConfigMenu->addAction(m_actionLH);
+
+    // Killer Moves toggle
+    m_actionKM = new QAction(tr("&Killer Moves"), this);
+    m_actionKM->setCheckable(true);
+    m_actionKM->setChecked(m_traceConf.s_isKM);
+    connect(m_actionKM, SIGNAL(toggled(bool)), this, SLOT(toggleKM()));
+
+    m_aiConfigMenu->addAction(m_actionKM);
+
+    // Transposition Table toggle
+    m_actionTT = new QAction(tr("&Transposition Table"), this);
+    m_actionTT->setCheckable(true);
+    m_actionTT->setChecked(m_traceConf.s_isTT);
+    connect(m_actionTT, SIGNAL(toggled(bool)), this, SLOT(toggleTT()));
+
+    m_aiConfigMenu->addAction(m_actionTT);
+
     m_aiConfigMenu->addSeparator();
 
     // SSS toggle
@@ -521,3 +1378,92 @@ void CTreeTracerSelector::setupConfigMenuActions()
     //connect(m_aiConfigMenu, SIGNAL(activated(int)), m_aiConfigButton, SLOT(showMenu ()));
 
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTraceJob::CTreeTraceJob
+///
+/// @description  This is the constructor of the CTreeTraceJob class. It is
+///               called on the GUI thread and copies the tree.
+/// @pre          None
+/// @post         None
+///
+/// @param selector:  The selector whose tracers are used.
+/// @param rootNode:  The root of the tree to trace. May be NULL.
+/// @param traceConf: The search to run.
+/// @param depth:     The depth limit.
+/// @param qsDepth:   The quiescence search depth.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CTreeTraceJob::CTreeTraceJob( const CTreeTracerSelector *selector,
+                              const STreeNode *rootNode,
+                              const STraceConfig &traceConf,
+                              int depth, int qsDepth )
+: m_traceConf( traceConf )
+{
+    m_selector = selector;
+    m_rootNode = rootNode != NULL ? rootNode->clone() : NULL;
+    m_depth = depth;
+    m_qsDepth = qsDepth;
+    m_trace = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTraceJob::~CTreeTraceJob
+///
+/// @description  This is the destructor of the CTreeTraceJob class.
+/// @pre          The job is not running.
+/// @post         The copy of the tree and any trace not taken are deleted.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+CTreeTraceJob::~CTreeTraceJob()
+{
+    delete m_rootNode;
+    delete m_trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTraceJob::takeTrace
+///
+/// @description  Hands over the trace made by the job.
+/// @pre          The job has finished.
+/// @post         The caller owns the trace.
+///
+/// @return STreeTrace *: The trace.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+STreeTrace *CTreeTraceJob::takeTrace()
+{
+    STreeTrace *trace = m_trace;
+    m_trace = NULL;
+    return trace;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTraceJob::execute
+///
+/// @description  Runs the trace. This is called on a worker thread.
+/// @pre          None
+/// @post         The trace is made and owns the copy of the tree.
+///
+/// @limitations  None
+///
+////////////////////////////////////////////////////////////////////////////////
+void CTreeTraceJob::execute()
+{
+    m_trace = m_selector->trace( m_rootNode, m_traceConf, m_depth, m_qsDepth,
+                                 cancelToken() );
+
+    // The lines of the trace refer to the nodes of the copy, so it goes with
+    // the trace.
+    if( m_trace != NULL )
+    {
+        m_trace->s_graph = m_rootNode;
+        m_rootNode = NULL;
+    }
+}
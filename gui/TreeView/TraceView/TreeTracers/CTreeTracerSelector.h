@@ -21,10 +21,48 @@
 #include <QToolButton>
 
 #include "CGeneralMTracer.h"
+#include "CParallelABTracer.h"
+#include "CMCTSTracer.h"
+#include "CPNTracer.h"
+#include "../../../CTraceRunner.h"
 class QComboBox;
 class QSpinBox;
 class QMenu;
 class QLabel;
+class CTreeTracerSelector;
+
+////////////////////////////////////////////////////////////////////////////////
+/// CTreeTraceJob
+///
+/// @description  A trace of a tree to be run by a CTraceRunner. It holds a
+///               copy of the tree and of the selector settings as they were
+///               when the job was made.
+///
+/// @limitations  The selector must outlive the job.
+///
+////////////////////////////////////////////////////////////////////////////////
+class CTreeTraceJob : public ITraceJob
+{
+public:
+    CTreeTraceJob( const CTreeTracerSelector *selector,
+                   const STreeNode *rootNode, const STraceConfig &traceConf,
+                   int depth, int qsDepth );
+    ~CTreeTraceJob();
+
+    STreeTrace *takeTrace();
+
+protected:
+    void execute();
+
+private:
+    const CTreeTracerSelector  *m_selector;
+    STreeNode                  *m_rootNode;
+    STraceConfig                m_traceConf;
+    int                         m_depth;
+    int                         m_qsDepth;
+    STreeTrace                 *m_trace;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 /// CTreeTracerSelector
 ///
@@ -49,8 +87,15 @@ public:
     QToolButton * getAIConfigButton();
     QSpinBox *getDepthSelector();
     QSpinBox *getQSDepthSelector();
+    int depthLimit() const;
+    int qsDepth() const;
     QLabel *getAILabel();
-    STreeTrace *trace( const STreeNode *rootNode ) const;
+    CTreeTraceJob *createJob( const STreeNode *rootNode ) const;
+    QByteArray traceKey( const STreeNode *rootNode ) const;
+    STreeTrace *trace( const STreeNode *rootNode,
+                       const STraceConfig &traceConf, int depth, int qsDepth,
+                       const QAtomicInt *cancel = NULL ) const;
+    void updateLabel( const STreeTrace *trace = NULL ) const;
 
 
 public slots:
@@ -59,8 +104,23 @@ public slots:
     void toggleDL();
     void toggleAB();
     void toggleHT();
+    void toggleLH();
+    void toggleKM();
     void toggleQS();
     void toggleSSS();
+    void toggleTT();
+    void togglePVS();
+    void toggleMTDF();
+    void toggleAW();
+    void setAspirationWidth();
+    void toggleYBWC();
+    void toggleLazySMP();
+    void setThreads();
+    void toggleMCTS();
+    void setPlayouts();
+    void togglePN();
+    void toggleDFPN();
+    void setProofThreshold();
     void activate();
 
 signals:
@@ -72,7 +132,6 @@ private:
     void setupQSDepthList();
     void setupFPThresholdList();
     void setupConfigMenuActions();
-    void updateLabel() const;
 
     QMenu                *m_aiConfigMenu;
     QSpinBox             *m_depthSelector;
@@ -81,6 +140,9 @@ private:
     QLabel               *m_aiLabel;
     QList<CGeneralMTracer *>  m_tracers;
     CGeneralMTracer       m_generalTracer;
+    CParallelABTracer     m_parallelTracer;
+    CMCTSTracer           m_mctsTracer;
+    CPNTracer             m_pnTracer;
 
     STraceConfig m_traceConf;
 
@@ -88,8 +150,23 @@ private:
     QAction * m_actionDL;
     QAction * m_actionAB;
     QAction * m_actionHT;
+    QAction * m_actionLH;
+    QAction * m_actionKM;
     QAction * m_actionQS;
     QAction * m_actionSSS;
+    QAction * m_actionTT;
+    QAction * m_actionPVS;
+    QAction * m_actionMTDF;
+    QAction * m_actionAW;
+    QAction * m_actionAWWidth;
+    QAction * m_actionYBWC;
+    QAction * m_actionLazySMP;
+    QAction * m_actionThreads;
+    QAction * m_actionMCTS;
+    QAction * m_actionPlayouts;
+    QAction * m_actionPN;
+    QAction * m_actionDFPN;
+    QAction * m_actionProofThreshold;
 
 };
 